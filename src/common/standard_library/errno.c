@@ -46,7 +46,7 @@ const char* const sys_errlist[] = {
 	"", /* 23 */
 	"Too many open files", /* 24 */
 	"Not a typewriter", /* 25 */
-	"", /* 26 */
+	"Text file busy", /* 26 */
 	"File too large", /* 27 */
 	"No space left on device", /* 28 */
 	"Illegal seek", /* 29 */
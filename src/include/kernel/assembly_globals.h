@@ -22,5 +22,6 @@
 
 	extern void interruptionHandlerEntryPointAdresses(void);
 	extern void callInterruptionManagerRunCommandsAfterInterruptionHandler(void);
+	extern void sysenterEntryPoint(void);
 
 #endif
@@ -20,6 +20,8 @@
 #ifndef KERNEL_ATA_H
 	#define KERNEL_ATA_H
 
-	void ataInitialize(void);
+	#include <stdint.h>
+
+	void ataInitialize(uint8_t primaryIDEChannelInterruptionVector, uint8_t secondaryIDEChannelInterruptionVector);
 
 #endif
@@ -26,6 +26,8 @@
 	void commandSchedulerInitialize(void);
 
 	void* commandSchedulerSchedule(uint64_t delayInMilliseconds, bool repeat, void (*command)(void*), void* argument);
+	void* commandSchedulerScheduleInNanoseconds(uint64_t delayInNanoseconds, bool repeat, void (*command)(void*), void* argument);
+	/* It returns how many nanoseconds were left until the command would run. */
 	uint64_t commandSchedulerCancel(void* commandId);
 
 #endif
@@ -26,6 +26,7 @@
 
 	#include "kernel/cmos.h"
 	#include "kernel/memory_manager.h"
+	#include "kernel/slab_allocator.h"
 
 	#include "kernel/file_system/file_system.h"
 
@@ -119,6 +120,8 @@
 
 	#define EXT2_SUPER_MAGIC 0xEF53
 
+	#define EXT2_FEATURE_COMPAT_DIR_INDEX 0x0020
+
 	#define EXT2_FEATURE_INCOMPAT_FILETYPE 0x0002
 
 	#define EXT2_FEATURE_RO_COMPAT_SPARSE_SUPER 0x0001
@@ -128,6 +131,15 @@
 	#define EXT2_VALID_FS 1
 	#define EXT2_ERROR_FS 2
 
+	#define EXT2_FLAGS_SIGNED_HASH 0x0001
+	#define EXT2_FLAGS_UNSIGNED_HASH 0x0002
+
+	#define EXT2_INDEX_FL 0x00001000
+
+	#define EXT2_HASH_LEGACY 0
+	#define EXT2_HASH_HALF_MD4 1
+	#define EXT2_HASH_TEA 2
+
 	struct Ext2SuperBlock {
 		uint32_t s_inodes_count;
 		uint32_t s_blocks_count;
@@ -186,7 +198,9 @@
 		/* Other options: */
 		uint32_t s_default_mount_options;
 		uint32_t s_first_meta_bg;
-		uint8_t reserved[760];
+		uint8_t reserved1[88];
+		uint32_t s_flags;
+		uint8_t reserved2[668];
 	} __attribute__((packed));
 	_Static_assert(sizeof(struct Ext2SuperBlock) == 1024, "Expecting Ext2Superblock with 1024 bytes.");
 
@@ -230,6 +244,38 @@
 		char nameFirstCharacter;
 	} __attribute__((packed));
 
+	/*
+	 * Indexed directories (see "dir_index" feature) keep a hashed B-tree on their first data block. The leaves are
+	 * regular data blocks with linked directory entries.
+	 */
+	struct Ext2DirectoryIndexRootInfo {
+		uint32_t reserved_zero;
+		uint8_t hash_version;
+		uint8_t info_length;
+		uint8_t indirect_levels;
+		uint8_t unused_flags;
+	} __attribute__((packed));
+
+	struct Ext2DirectoryIndexEntry {
+		uint32_t hash;
+		uint32_t block;
+	} __attribute__((packed));
+
+	/* It overlaps the hash of the first entry. */
+	struct Ext2DirectoryIndexCountLimit {
+		uint16_t limit;
+		uint16_t count;
+	} __attribute__((packed));
+
+	#define EXT2_EXTENT_CACHE_SIZE 4
+
+	/* A run of data blocks that are consecutive on both the file and the device. */
+	struct Ext2Extent {
+		uint32_t firstDataBlockIndex;
+		uint32_t firstDataBlockId;
+		uint32_t length;
+	};
+
 	struct Ext2FileSystem;
 
 	struct Ext2VirtualFileSystemNode {
@@ -237,8 +283,13 @@
 		struct Ext2FileSystem* fileSystem;
 		struct Ext2INode iNode;
 		uint32_t iNodeIndex;
-		struct DoubleLinkedListElement availableListElement;
 		bool isDirty;
+		/* These blocks are marked as used but they do not belong to the inode yet (see "acquireDataBlockForINode"). */
+		uint32_t firstPreallocatedDataBlockId;
+		uint32_t preallocatedDataBlockCount;
+		/* It is filled while the indirection blocks are decoded (see "getInodeDataBlockId"). */
+		struct Ext2Extent extentCache[EXT2_EXTENT_CACHE_SIZE];
+		uint32_t nextExtentCacheIndex;
 	};
 	_Static_assert(sizeof(struct Ext2VirtualFileSystemNode) <= PAGE_FRAME_SIZE, "The Ext2VirtualFileSystemNode must fit inside a page frame.");
 
@@ -252,11 +303,12 @@
 
 		struct DoubleLinkedList blockGroupDescriptorsPageFrameList;
 
-		struct DoubleLinkedList ext2VirtualFileSystemNodesPageFrameList;
-		struct DoubleLinkedList availableExt2VirtualFileSystemNodesList;
+		struct SlabCache ext2VirtualFileSystemNodeCache;
+		uint32_t maxSimultaneouslyOpenINodes;
 
 		struct BTree ext2VirtualFileSystemNodeByINodeIndex;
 		int ext2VirtualFileSystemNodeByINodeIndexMemoryReservationId;
+		struct SlabCache ext2VirtualFileSystemNodeByINodeIndexNodeCache;
 
 		uint32_t blockSize;
 		uint32_t blockGroupsCount;
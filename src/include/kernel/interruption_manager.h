@@ -29,6 +29,8 @@
 	void interruptionManagerInitialize(uint32_t interruptionVectorToHandleSystemCall);
 	void interruptionManagerRegisterInterruptionHandler(uint8_t interruptionVector,
 		void (*handler)(uint32_t, struct ProcessExecutionState1*, struct ProcessExecutionState2*));
+	/* It reports the interruption and sends a signal to the current process. */
+	void interruptionManagerDefaultHandler(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2);
 	void interruptionManagerRegisterSystemCallHandler(void (*systemCallHandler)(struct ProcessExecutionState1*, struct ProcessExecutionState2*));
 
 	void __attribute__ ((cdecl)) interruptionManagerHandler(uint32_t, struct ProcessExecutionState1*, struct ProcessExecutionState2*);
@@ -19,21 +19,38 @@
 
 #include <stdint.h>
 
+#include <myos.h>
+
 #include "kernel/api_status_code.h"
 
 #include "kernel/io/block_device.h"
 
+struct BlockCacheSegment {
+	void* data;
+	uint64_t firstBlockId;
+	uint32_t blockCount; /* All of them belong to the same page frame. */
+};
+
 APIStatusCode blockCacheManagerPrintDebugReport(void);
 
 APIStatusCode blockCacheManagerInitialize(uint32_t maxPageFramesToCacheBlocks);
 
 APIStatusCode blockCacheManagerReserve(struct BlockDevice* blockDevice, uint64_t firstBlockId, uint32_t blockCount, void** data);
 APIStatusCode blockCacheManagerReadAndReserve(struct BlockDevice* blockDevice, uint64_t firstBlockId, uint32_t blockCount, void** data);
+APIStatusCode blockCacheManagerReserveRange(struct BlockDevice* blockDevice, uint64_t firstBlockId, uint32_t blockCount, bool read,
+	struct BlockCacheSegment* segments, size_t maximumSegmentCount, size_t* segmentCount);
 APIStatusCode blockCacheManagerReadAndReserveByOffset(struct BlockDevice* blockDevice, uint32_t offset, uint32_t blockCount, void** data, uint64_t* firstBlockId);
 
+void blockCacheManagerPrefetch(struct BlockDevice* blockDevice, uint64_t* blockIds, size_t blockIdCount);
+
 APIStatusCode blockCacheManagerReadDirectly(struct BlockDevice* blockDevice, uint64_t firstBlockId, uint32_t blockCount, void*);
 
 void blockCacheManageReleaseReservation(struct BlockDevice* blockDevice, uint64_t blockId, bool modified);
+void blockCacheManagerReleaseRange(struct BlockDevice* blockDevice, struct BlockCacheSegment* segments, size_t segmentCount, bool modified);
+
+APIStatusCode blockCacheManagerStartWriteBack(void);
+void blockCacheManagerGetWriteBackParameters(struct BlockCacheWriteBackParameters* parameters);
+APIStatusCode blockCacheManagerSetWriteBackParameters(struct BlockCacheWriteBackParameters* parameters);
 
 void blockCacheManageFlush(void);
 void blockCacheManageClear(void);
@@ -25,6 +25,26 @@
 
 	#include "kernel/io/virtual_file_system_node.h"
 
+	#include "util/double_linked_list.h"
+
+	#define BLOCK_DEVICE_MAXIMUM_PAGE_FRAMES_PER_TRANSFER 32
+
+	/*
+	 * A request always transfers a whole page frame. The first block must be the first one of a page frame
+	 * (as the block cache manager does).
+	 */
+	struct BlockDeviceRequest {
+		struct DoubleLinkedListElement listElement;
+		uint64_t firstBlockId;
+		void* pageFrame;
+		bool write;
+	};
+
+	struct BlockDeviceRequestQueue {
+		struct DoubleLinkedList pendingRequestsList;
+		uint64_t nextBlockId; /* Just after the last transferred block. */
+	};
+
 	struct BlockDevice {
 		dev_t id;
 		uint64_t blockCount;
@@ -32,6 +52,9 @@
 		size_t maximumBlocksPerRead;
 		bool (*readBlocks)(struct BlockDevice*, uint64_t firstBlockId, size_t blockCount, void*);
 		bool (*writeBlocks)(struct BlockDevice*, uint64_t firstBlockId, size_t blockCount, void*);
+		/* Optional. It transfers consecutive blocks scattered among page frames using a single command. */
+		bool (*transferPageFrames)(struct BlockDevice*, uint64_t firstBlockId, size_t pageFrameCount, void** pageFrames, bool write);
+		struct BlockDeviceRequestQueue requestQueue;
 	};
 
 	struct BlockDeviceVirtualFileSystemNode {
@@ -39,4 +62,8 @@
 		struct BlockDevice* blockDevice;
 	};
 
+	void blockDeviceInitializeRequestQueue(struct BlockDevice* blockDevice);
+	void blockDeviceSubmitRequest(struct BlockDevice* blockDevice, struct BlockDeviceRequest* blockDeviceRequest);
+	bool blockDeviceDispatchRequests(struct BlockDevice* blockDevice);
+
 #endif
@@ -26,12 +26,22 @@
 
 	#include "util/double_linked_list.h"
 
+	/*
+	 * It is used by the file systems that read blocks ahead to detect sequential access.
+	 */
+	struct ReadAheadState {
+		off_t expectedOffset; /* Where the next read must start to be considered sequential. */
+		uint32_t windowSize; /* In file system blocks. Zero means that the last access was not sequential. */
+		uint32_t nextBlockIndex; /* The first block that has not been prefetched yet. */
+	};
+
 	struct OpenFileDescription {
 		struct DoubleLinkedListElement doubleLinkedListElement;
 		struct VirtualFileSystemNode* virtualFileSystemNode;
 		uint32_t usageCount;
 		off_t offset;
 		int flags;
+		struct ReadAheadState readAheadState;
 	};
 	_Static_assert(sizeof(struct OpenFileDescription) <= PAGE_FRAME_SIZE, "The OpenFileDescription must fit inside a page frame.");
 
@@ -36,6 +36,10 @@
 	APIStatusCode virtualFileSystemManagerResolvePath(struct Process* process, struct PathUtilsContext* pathUtilsContext,
 			bool stopOnFirstSymbolicLink, bool createIfDoesNotExist, mode_t mode, bool failIfAlreadyExists,
 			struct VirtualFileSystemNode** resolvedVirtualFileSystemNode);
+	APIStatusCode virtualFileSystemManagerWalk(struct VirtualFileSystemNode* virtualFileSystemNode, struct Process* process, const char* name,
+			bool createIfDoesNotExist, mode_t mode, struct VirtualFileSystemNode** nextVirtualFileSystemNode, bool* created);
+	void virtualFileSystemManagerInvalidateName(struct VirtualFileSystemNode* parentVirtualFileSystemNode, const char* name);
+	void virtualFileSystemManagerInvalidateDirectory(struct VirtualFileSystemNode* virtualFileSystemNode);
 	struct OpenFileDescription* virtualFileSystemManagerAcquireOpenFileDescription(void);
 	void virtualFileSystemManagerReleaseOpenFileDescription(struct OpenFileDescription*);
 	APIStatusCode virtualFileSystemManagerCloseOpenFileDescription(struct Process* currentProcess, struct OpenFileDescription*);
@@ -75,6 +75,9 @@
 		APIStatusCode (*rename)(struct VirtualFileSystemNode*, struct Process*, struct VirtualFileSystemNode*, const char*,
 				struct VirtualFileSystemNode*, struct VirtualFileSystemNode*, const char*);
 		struct FileSystem* (*getFileSystem)(struct VirtualFileSystemNode*);
+		/* Optional. The identifiers must be unique inside a file system and different from zero (they allow name caching). */
+		uint32_t (*getIdentifier)(struct VirtualFileSystemNode*);
+		APIStatusCode (*acquireNodeByIdentifier)(struct VirtualFileSystemNode*, uint32_t, struct VirtualFileSystemNode**);
 	};
 
 #endif
@@ -25,5 +25,6 @@
 	#define FILE_MAX_SIZE 0x7FFFFFFF
 	#define MAX_FILE_DESCRIPTORS_PER_PROCESS 32
 	#define DATA_SEGMENT_MAX_SIZE (1024 * 1024 * 1024 * 1)
+	#define STACK_SEGMENT_MAX_SIZE (1024 * 1024 * 8)
 
 #endif
@@ -29,18 +29,34 @@
 
 	#include "util/double_linked_list.h"
 
+	/* One of the bits available to the software. The page is read only and it is shared until the first write. */
+	#define PAGE_ENTRY_COPY_ON_WRITE 0x200
+
+	/* The largest block of physically contiguous page frames has 2^PAGE_FRAME_MAX_ORDER page frames (4 MB). */
+	#define PAGE_FRAME_MAX_ORDER 10
+
 	void memoryManagerInitialize(uint32_t multibootAmountOfUpperMemory);
 	struct DoubleLinkedListElement* memoryManagerGetPageFrameDoubleLinkedListElement(uint32_t physicalAddress);
 	uint32_t memoryManagerGetPageFramePhysicalAddress(struct DoubleLinkedListElement* pageFrameListElement);
 	bool memoryManagerConfigureMapping(struct DoubleLinkedListElement** newPageFrame, uint32_t* pageDirectory,
 		uint32_t virtualAddress, uint32_t physicalAddress, uint32_t flags);
 	struct DoubleLinkedListElement* memoryManagerAcquirePageFrame(bool kernelSpace, int reservationId);
+	/* It only returns the page frame to the available ones after the last user releases it. */
 	void memoryManagerReleasePageFrame(struct DoubleLinkedListElement* pageFrameListElement, int reservationId);
+	/* They handle 2^order physically contiguous page frames. The returned element refers to the first one. */
+	struct DoubleLinkedListElement* memoryManagerAcquirePageFrames(bool kernelSpace, uint32_t order);
+	void memoryManagerReleasePageFrames(struct DoubleLinkedListElement* pageFrameListElement, uint32_t order);
+	void memoryManagerSharePageFrame(struct DoubleLinkedListElement* pageFrameListElement);
+	uint32_t memoryManagerGetPageFrameReferenceCount(struct DoubleLinkedListElement* pageFrameListElement);
 	void* memoryManagerGetSystemPageTableAddress(uint32_t pageTableIndex);
 	int memoryManagerReserveMemoryOnKernelSpace(uint32_t pageFrameCount);
+	/* The reclaimer is called when there is no kernel space page frame available. It returns how many page frames it has released. */
+	void memoryManagerRegisterPageFrameReclaimer(uint32_t (*reclaimer)(uint32_t pageFrameCount));
 
 	void memoryManagerRemovePageTableMapping(uint32_t* pageDirectory, uint32_t physicalAddress);
 	void memoryManagerRemovePageMapping(uint32_t* pageDirectory, uint32_t virtualAddress, uint32_t physicalAddress);
+	/* It returns NULL if there is no page table associated with the address. */
+	uint32_t* memoryManagerGetPageTableEntry(uint32_t* pageDirectory, uint32_t virtualAddress);
 
 	uint32_t memoryManagerGetSystemPageTablesCount(void);
 
@@ -51,6 +67,6 @@
 
 	struct Process;
 	inline __attribute__((always_inline)) uint32_t memoryManagerCalculateProcessFirstInvalidDataSegmentAddress(struct Process* process) {
-		return DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS + doubleLinkedListSize(&process->dataSegmentPageFramesList) * PAGE_FRAME_SIZE;
+		return DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS + process->dataSegmentPageCount * PAGE_FRAME_SIZE;
 	}
 #endif
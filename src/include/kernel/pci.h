@@ -0,0 +1,52 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNEL_PCI_H
+	#define KERNEL_PCI_H
+
+	#include <stdbool.h>
+	#include <stdint.h>
+
+	#define PCI_VENDOR_ID_AND_DEVICE_ID_REGISTER 0x00
+	#define PCI_COMMAND_AND_STATUS_REGISTER 0x04
+	#define PCI_CLASS_CODE_REGISTER 0x08
+	#define PCI_HEADER_TYPE_REGISTER 0x0C
+	#define PCI_BASE_ADDRESS_REGISTER_4 0x20
+
+	#define PCI_COMMAND_IO_SPACE_MASK 0x0001
+	#define PCI_COMMAND_BUS_MASTER_MASK 0x0004
+
+	#define PCI_MASS_STORAGE_CONTROLLER_CLASS_CODE 0x01
+	#define PCI_IDE_CONTROLLER_SUBCLASS 0x01
+
+	struct PCIFunction {
+		uint8_t bus;
+		uint8_t device;
+		uint8_t function;
+		uint16_t vendorId;
+		uint16_t deviceId;
+		uint8_t classCode;
+		uint8_t subclass;
+		uint8_t programmingInterface;
+	};
+
+	uint32_t pciReadConfigurationDoubleWord(struct PCIFunction* pciFunction, uint8_t registerOffset);
+	void pciWriteConfigurationDoubleWord(struct PCIFunction* pciFunction, uint8_t registerOffset, uint32_t value);
+	bool pciFindFunctionByClass(uint8_t classCode, uint8_t subclass, struct PCIFunction* pciFunction);
+#endif
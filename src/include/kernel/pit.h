@@ -25,8 +25,9 @@
 
 	void pitInitialize(uint8_t newPITInterruptionVector);
 	void pitStartChronometer(uint32_t count, void (*newChronometerCallback)(void));
-	void pitStartTickGenerator(uint32_t frequency);
-	void pitStopTickGenerator();
+	void pitStartTimer(void);
+	void pitStopTimer(void);
+	void pitArmTimer(uint64_t upTimeInNanoseconds);
 	void pitConfigureSpeakerCounter(uint32_t frequency);
 	bool pitRegisterCommandToRunOnTick(void (*command)(uint64_t, uint64_t));
 	uint64_t pitGetUpTimeInMilliseconds(void);
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNEL_EXECUTABLE_IMAGE_CACHE_H
+	#define KERNEL_EXECUTABLE_IMAGE_CACHE_H
+
+	#include <stdbool.h>
+	#include <stdint.h>
+	#include <time.h>
+
+	#include <sys/stat.h>
+	#include <sys/types.h>
+
+	#include "kernel/api_status_code.h"
+	#include "kernel/io/open_file_description.h"
+	#include "kernel/io/virtual_file_system_node.h"
+
+	#include "util/double_linked_list.h"
+
+	/*
+	 * An executable image keeps the code segment page frames already read from an executable file. They are shared
+	 * (read-only and copy-on-write) by all processes executing it.
+	 */
+	struct ExecutableImage {
+		struct DoubleLinkedListElement doubleLinkedListElement;
+		struct OpenFileDescription* openFileDescription;
+		dev_t deviceId;
+		ino_t iNodeNumber;
+		time_t modificationTime;
+		size_t size;
+		uint32_t usageCount;
+		/* An invalid image is no longer handed out. It is released as soon as it is not used anymore. */
+		bool isValid;
+		/* The physical address of each page frame (or zero if it has not been read yet). */
+		uint32_t* pageFrames;
+	};
+
+	struct Process;
+
+	APIStatusCode executableImageCacheInitialize(void);
+	APIStatusCode executableImageCacheAcquire(struct Process* process, struct OpenFileDescription* openFileDescription,
+		struct stat* statInstance, struct ExecutableImage** executableImage);
+	void executableImageCacheReserve(struct ExecutableImage* executableImage);
+	void executableImageCacheRelease(struct Process* process, struct ExecutableImage* executableImage);
+	uint32_t executableImageCacheGetPageFrame(struct ExecutableImage* executableImage, uint32_t pageIndex);
+	void executableImageCacheSetPageFrame(struct ExecutableImage* executableImage, uint32_t pageIndex, uint32_t physicalAddress);
+	APIStatusCode executableImageCacheInvalidate(struct Process* process, struct VirtualFileSystemNode* virtualFileSystemNode);
+	APIStatusCode executableImageCachePrintDebugReport(void);
+
+#endif
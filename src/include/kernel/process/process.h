@@ -39,16 +39,22 @@
 
 	#include "util/double_linked_list.h"
 
+	#define USER_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX 3
 	#define USER_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX 4
-	#define USER_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX 5
 
 	#define EXECUTABLE_MAX_SIZE (1024 * PAGE_FRAME_SIZE) /* Up to 4 MB */
 
 	#define CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS 0x40000000
 	#define DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS (CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS + EXECUTABLE_MAX_SIZE)
 	#define STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER 0xFFFFFFFC /* As the stack grows downward, the address refers to its top when it is empty. */
-	#define STACK_PAGE_FRAME_COUNT (16 + ARG_MAX / PAGE_FRAME_SIZE)
+	#define STACK_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS (STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER - (STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER % PAGE_FRAME_SIZE))
+	/* The whole stack segment is reserved. Its page frames are only acquired when they are accessed for the first time. */
+	#define STACK_SEGMENT_PAGE_COUNT (STACK_SEGMENT_MAX_SIZE / PAGE_FRAME_SIZE)
 	_Static_assert(ARG_MAX % PAGE_FRAME_SIZE == 0, "Expecting ARG_MAX as multiple of PAGE_FRAME_SIZE.");
+	_Static_assert(16 + ARG_MAX / PAGE_FRAME_SIZE <= STACK_SEGMENT_PAGE_COUNT, "The stack segment must fit \"argv\" and \"envp\".");
+	_Static_assert((MYOS_SHARED_DATA_PAGE_VIRTUAL_ADDRESS >> 22) > ((DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS + (uint32_t) DATA_SEGMENT_MAX_SIZE - 1) >> 22)
+			&& MYOS_SHARED_DATA_PAGE_VIRTUAL_ADDRESS + PAGE_FRAME_SIZE <= STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER - STACK_SEGMENT_MAX_SIZE,
+			"The shared data page must have its own page table between the data and the stack segments.");
 
 	#define INIT_PROCESS_ID 1
 
@@ -61,7 +67,9 @@
 		SUSPENDED_WAITING_WRITE = 5,
 		SUSPENDED_WAITING_IO_EVENT = 6,
 		STOPPED = 7,
-		WAITING_EXIT_STATUS_COLLECTION = 8 /* Also known as a "zombie" or "defunct" process. */
+		WAITING_EXIT_STATUS_COLLECTION = 8, /* Also known as a "zombie" or "defunct" process. */
+		SUSPENDED_WAITING_BLOCK_IO = 9, /* It can not be interrupted by a signal. */
+		SUSPENDED_WAITING_KERNEL_LOCK = 10 /* It can not be interrupted by a signal (see "processManagerAcquireKernelLock"). */
 	};
 
 	struct SignalInformation {
@@ -81,6 +89,7 @@
 		bool isBeingMonitored;
 	};
 
+	struct ExecutableImage;
 	struct ProcessGroup;
 	struct Session;
 	struct Process {
@@ -98,12 +107,17 @@
 
 		struct DoubleLinkedList pagingPageFramesList;
 
-		struct DoubleLinkedList codeSegmentPageFramesList;
-		struct DoubleLinkedList dataSegmentPageFramesList;
-		struct DoubleLinkedList stackSegmentPageFramesList;
+		/* The page tables keep the page frames of each segment as they can be shared with other processes. */
+		uint32_t codeSegmentPageCount;
+		uint32_t dataSegmentPageCount;
+		uint32_t stackSegmentPageCount;
 
-		struct X86TaskState x86TaskState;
-		uint64_t tssSegmentDescriptor;
+		/* The code segment pages are read from the executable file on demand (after the first access). */
+		struct ExecutableImage* executableImage;
+
+		uint32_t pageDirectory;
+		/* Where the kernel stack pointer is saved while another process executes. */
+		uint32_t kernelStackPointer;
 
 		struct ProcessExecutionState1* processExecutionState1;
 		struct ProcessExecutionState2* processExecutionState2;
@@ -118,8 +132,12 @@
 		pid_t id;
 
 		/* Scheduler related: */
-		volatile uint32_t ticksCountSinceSchedulerIterationBegin;
-		volatile uint32_t idOfLastKnownSchedulerIteration;
+		int niceValue; /* From -NZERO (highest priority) to NZERO - 1. */
+		volatile uint32_t schedulerLevel; /* The index of the runnable processes list (zero is the highest priority). */
+		volatile uint32_t ticksCountOnSchedulerLevel;
+
+		/* Kernel lock related: */
+		bool mustHoldKernelLock; /* While it is executing a system call or terminating. */
 
 		void* systemStack;
 
@@ -20,9 +20,11 @@
 #ifndef KERNEL_PROCESS_MANAGER_H
 	#define KERNEL_PROCESS_MANAGER_H
 
+	#include <stdbool.h>
 	#include <stdint.h>
 
 	#include "kernel/api_status_code.h"
+	#include "kernel/process/executable_image_cache.h"
 	#include "kernel/process/process.h"
 	#include "kernel/x86.h"
 
@@ -40,14 +42,21 @@
 	void processManagerStop(struct Process* currentProcess, int signalId);
 	void processManagerTerminate(struct Process* currentProcess, int exitStatus, int sourceSignalId);
 	APIStatusCode processManagerCreateInitProcess(__attribute__ ((cdecl)) void (*initializationCallback)(void*), void* argument);
+	APIStatusCode processManagerCreateKernelProcess(__attribute__ ((cdecl)) void (*entryPoint)(void*), void* argument, struct Process** kernelProcess);
 	APIStatusCode processManagerForkProcess(struct Process* parentProcess, struct Process** childProcess);
 	void processManagerStartScheduling(void);
 	__attribute__ ((cdecl)) struct Process* processManagerGetCurrentProcess(void);
 	void processManagerChangeProcessState(struct Process* currentProcess, struct Process* targetProcess, enum ProcessState state, int sourceSignalId);
+	void processManagerAcquireKernelLock(struct Process* currentProcess);
+	void processManagerReleaseKernelLock(struct Process* currentProcess);
+	bool processManagerIsHoldingKernelLock(struct Process* process);
+	bool processManagerIsKernelLockFree(void);
+	void processManagerChangeNiceValue(struct Process* process, int niceValue);
 	void processManagerReleaseProcessResources(struct Process* process);
 	struct Process* processGetProcessFromChildrenProcessListElement(struct DoubleLinkedListElement* listElement);
 	struct Process* processGetProcessFromIOProcessListElement(struct DoubleLinkedListElement* listElement);
-	APIStatusCode processManagerChangeCodeSegmentSize(struct Process* process, size_t executableSize, bool allowShrinkingIfNecessary);
+	void processManagerMapExecutable(struct Process* process, struct ExecutableImage* executableImage);
+	bool processManagerPopulateSegmentPages(struct Process* process, uint32_t firstAddress, uint32_t lastAddress);
 	APIStatusCode processManagerChangeDataSegmentSize(struct Process* process, int increment);
 	APIStatusCode processManagerPrintDebugReport(void);
 	void processManagerInitializeAllProcessesIterator(struct FixedCapacitySortedArrayIterator* fixedCapacitySortedArrayIterator);
@@ -29,6 +29,7 @@
 
 	#include "kernel/io/virtual_file_system_node.h"
 
+	void ioServicesInitialize(void);
 	APIStatusCode ioServicesCalculateNewOffset(int64_t fileSize, off_t currentOffset, off_t offset, int whence, int64_t* newOffset);
 
 	APIStatusCode ioServicesOpen(struct Process* process, bool verifyUserAddress, const char* path, bool isPathNormalized, int flags, mode_t mode, int* fileDescriptorIndex);
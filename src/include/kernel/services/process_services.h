@@ -28,6 +28,7 @@
 
 	#include "util/double_linked_list.h"
 
+	void processServicesInitialize(void);
 	void processServicesSuspendToWaitForIO(struct Process* currentProcess, struct DoubleLinkedList* list, enum ProcessState newState);
 	APIStatusCode processServicesExecuteExecutable(struct Process* process, bool verifyUserAddress, const char* executablePath, const char** argv, const char** envp);
 	APIStatusCode processServicesCreateSessionAndProcessGroup(struct Process* leaderProcess);
@@ -36,8 +37,10 @@
 	APIStatusCode processServicesWait(struct Process* currentProcess, pid_t scope, int options, int* status, pid_t* childProcessId);
 	void processServicesNotifyParentAboutChildStateChange(struct Process* currentProcess, struct Process* process,
 			enum ProcessState currentState, enum ProcessState newState, int sourceSignalId);
-	void processServicesSleep(struct Process* currentProcess, int seconds);
+	APIStatusCode processServicesSleep(struct Process* currentProcess, uint64_t nanoseconds, uint64_t* remainingNanoseconds);
 	APIStatusCode processServicesSetProcessGroup(struct Process* currentProcess, pid_t processId, pid_t processGroupId);
 	void processServicesWakeUpProcesses(struct Process* currentProcess, struct DoubleLinkedList* processList, enum ProcessState processState);
+	APIStatusCode processServicesGetPriority(struct Process* currentProcess, int which, id_t who, int* niceValue);
+	APIStatusCode processServicesSetPriority(struct Process* currentProcess, int which, id_t who, int niceValue);
 
 #endif
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KERNEL_SHARED_DATA_MANAGER_H
+	#define KERNEL_SHARED_DATA_MANAGER_H
+
+	#include <stdint.h>
+
+	#include <sys/types.h>
+
+	#include "kernel/api_status_code.h"
+
+	APIStatusCode sharedDataManagerInitialize(void);
+	uint32_t sharedDataManagerGetPagePhysicalAddress(void);
+	void sharedDataManagerSetCurrentProcess(pid_t processId, pid_t parentProcessId);
+
+#endif
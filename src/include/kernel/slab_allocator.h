@@ -0,0 +1,66 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNEL_SLAB_ALLOCATOR_H
+	#define KERNEL_SLAB_ALLOCATOR_H
+
+	#include <stdbool.h>
+	#include <stdint.h>
+	#include <stdlib.h>
+
+	#include "kernel/api_status_code.h"
+
+	#include "util/double_linked_list.h"
+
+	/*
+	 * A cache of objects of the same type. The objects are carved from kernel space page frames (the slabs) and they are
+	 * constructed only once: a released object keeps its state and it is handed out again by the next acquisition.
+	 */
+	struct SlabCache {
+		struct DoubleLinkedListElement slabCacheListElement;
+		const char* name;
+		size_t objectSize;
+		uint32_t objectsPerSlab;
+		uint32_t firstObjectOffset;
+		int reservationId;
+		void (*constructor)(void*);
+
+		/*
+		 * The objects that do not share a page frame with others ("objectsPerSlab" is one) do not have a slab header.
+		 * The list element of their page frame is used to keep them on the empty list.
+		 */
+		bool isLarge;
+		struct DoubleLinkedList partialSlabsList;
+		struct DoubleLinkedList fullSlabsList;
+		struct DoubleLinkedList emptySlabsList;
+
+		uint32_t slabCount;
+		uint32_t usedObjectCount;
+	};
+
+	/* The reservation identifier is used to acquire the page frames (see "memoryManagerReserveMemoryOnKernelSpace"). */
+	void slabAllocatorInitializeCache(struct SlabCache* slabCache, const char* name, size_t objectSize, int reservationId,
+		void (*constructor)(void*));
+	/* All objects must have been released. */
+	void slabAllocatorReleaseCache(struct SlabCache* slabCache);
+	void* slabAllocatorAcquire(struct SlabCache* slabCache);
+	void slabAllocatorRelease(struct SlabCache* slabCache, void* object);
+	APIStatusCode slabAllocatorPrintDebugReport(void);
+
+#endif
@@ -22,6 +22,11 @@
 
 	#define INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL 200
 
+	#ifndef KERNEL_CODE
+		/* The arguments are passed on registers. It uses SYSENTER when the processor supports it (see "system_call.asm"). */
+		#define SYSTEM_CALL_INSTRUCTION "call *systemCallEntryPoint"
+	#endif
+
 	#define SYSTEM_CALL_INEXISTENT 0x00
 	#define SYSTEM_CALL_SLEEP 0x01
 	#define SYSTEM_CALL_EXIT 0x02
@@ -65,6 +70,8 @@
 	#define SYSTEM_CALL_SET_FILE_MODE_CREATION_MASK 0x28
 	#define SYSTEM_CALL_RENAME 0x29
 	#define SYSTEM_CALL_CHANGE_FILE_DESCRIPTOR_PARAMETERS 0x30
+	#define SYSTEM_CALL_GET_PRIORITY 0x31
+	#define SYSTEM_CALL_SET_PRIORITY 0x32
 
 	#define SYSTEM_CALL_ASSERT_FALSE 0xD0
 	#define SYSTEM_CALL_BUSY_WAIT 0xD1
@@ -140,6 +140,10 @@
 			:);
 	}
 
+	#define X86_SYSENTER_CS_MSR 0x174
+	#define X86_SYSENTER_ESP_MSR 0x175
+	#define X86_SYSENTER_EIP_MSR 0x176
+
 	/* Some instructions. */
 	inline __attribute__((always_inline)) void x86Hlt(void) {
 		__asm__ __volatile__(
@@ -242,6 +246,25 @@
 			: "memory");
 	}
 
+	inline __attribute__((always_inline)) uint32_t x86InputDoubleWordFromPort(uint16_t port) {
+		uint32_t result;
+
+		__asm__ __volatile__(
+			"inl %%dx, %%eax"
+			: "=a"(result)
+			: "d"(port)
+			: "memory");
+		return result;
+	}
+
+	inline __attribute__((always_inline)) void x86OutputDoubleWordToPort(uint16_t port, uint32_t value) {
+		__asm__ __volatile__(
+			"outl %%eax, %%dx"
+			:
+			: "a"(value), "d"(port)
+			: "memory");
+	}
+
 	/*
 	 * Interruptions.
 	 */
@@ -266,10 +289,9 @@
 	/*
 	 * GDT.
 	 */
-	#define SYSTEM_KERNEL_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX 1
-	#define SYSTEM_KERNEL_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX 2
-	#define TASK_STATE_SEGMENT_DESCRIPTOR_INDEX 3
-	#define LDT_DESCRIPTOR_INDEX 4
+	#define SYSTEM_KERNEL_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX 1
+	#define SYSTEM_KERNEL_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX 2
+	#define TASK_STATE_SEGMENT_DESCRIPTOR_INDEX 5
 	uint64_t x86ReadFromGDT(int index);
 	void x86WriteOnGDT(int index, uint64_t segmentDescriptor);
 
@@ -496,4 +518,8 @@
 			:);
 	}
 
+	inline __attribute__((always_inline)) void x86SetTaskSwitchedFlag(void) {
+		x86SetCR0(x86GetCR0() | 0x8); /* Task Switched (bit 3 of CR0) <- true */
+	}
+
 #endif
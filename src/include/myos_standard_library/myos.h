@@ -31,6 +31,7 @@
 	#define NULL_DEVICE_ID 6
 	#define PIPE_ID 7
 	#define DEVICES_FILE_SYSTEM_ID 8
+	#define BLOCK_CACHE_DEVICE_ID 9
 
 	#include <assert.h>
 	#include <limits.h>
@@ -51,6 +52,38 @@
 		struct ProcessMemorySegmentLimits stack;
 	};
 
+	/* The requests accepted by the block cache device ("/dev/block_cache") through ioctl. */
+	#define BLOCK_CACHE_GET_WRITE_BACK_PARAMETERS 1
+	#define BLOCK_CACHE_SET_WRITE_BACK_PARAMETERS 2
+
+	/*
+	 * A read-only page mapped on every process. The kernel keeps it updated, so the information below can be read without a
+	 * system call.
+	 */
+	#define MYOS_SHARED_DATA_PAGE_VIRTUAL_ADDRESS 0x80400000
+
+	/*
+	 * The clocks are derived from the time stamp counter, which is calibrated against the PIT at boot. The up time in
+	 * nanoseconds is "((TSC - timeStampCountAtBoot) * nanosecondsPerCycleMultiplier) >> nanosecondsPerCycleShift".
+	 */
+	struct MyosClockParameters {
+		uint64_t timeStampCountAtBoot;
+		uint32_t nanosecondsPerCycleMultiplier;
+		uint32_t nanosecondsPerCycleShift;
+		time_t unixTimeAtBoot;
+	};
+
+	struct MyosSharedData {
+		pid_t currentProcessId;
+		pid_t currentParentProcessId;
+		struct MyosClockParameters clockParameters; /* It does not change after the boot. */
+	};
+
+	struct BlockCacheWriteBackParameters {
+		uint32_t dirtyRatio; /* The maximum percentage of the cache that can be dirty before it is written back. */
+		uint32_t dirtyExpirationInMilliseconds; /* How long a block can be dirty before it is written back. */
+	};
+
 	#ifndef KERNEL_CODE
 		int myosGetProcessMemorySegmentsLimits(struct ProcessMemorySegmentsLimits* processMemorySegmentsLimits);
 		void myosSystemAssert(bool value);
@@ -82,4 +115,23 @@
 			:);
 		return (((uint64_t) resultUpper) << 32) | resultLower;
 	}
+
+	inline __attribute__((always_inline)) const volatile struct MyosSharedData* myosGetSharedData(void) {
+		return (const volatile struct MyosSharedData*) MYOS_SHARED_DATA_PAGE_VIRTUAL_ADDRESS;
+	}
+
+	/* The Pentium Pro reports the SEP feature flag although it does not support SYSENTER and SYSEXIT. */
+	inline __attribute__((always_inline)) bool x86IsSysenterSupported(void) {
+		uint32_t signature;
+		uint32_t features;
+		__asm__ __volatile__(
+			"cpuid"
+			: "=a"(signature), "=d"(features)
+			: "a"(1)
+			: "ebx", "ecx");
+		uint32_t family = (signature >> 8) & 0xF;
+		uint32_t model = (signature >> 4) & 0xF;
+		uint32_t stepping = signature & 0xF;
+		return (features & (1 << 11)) != 0 && !(family == 6 && model < 3 && stepping < 3);
+	}
 #endif
@@ -101,6 +101,9 @@
 	/* Not a typewriter */
 	#define ENOTTY 25
 
+	/* Text file busy */
+	#define ETXTBSY 26
+
 	/* File too large */
 	#define EFBIG 27
 
@@ -65,4 +65,6 @@
 
 	#define OPEN_MAX MAX_FILE_DESCRIPTORS_PER_PROCESS
 
+	#define NZERO 20
+
 #endif
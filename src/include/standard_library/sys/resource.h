@@ -20,6 +20,8 @@
 #ifndef SYS_RESOURCE_H
 	#define SYS_RESOURCE_H
 
+	#include <sys/types.h>
+
 	typedef unsigned int rlim_t;
 
 	struct rlimit {
@@ -32,8 +34,15 @@
 	#define RLIMIT_FSIZE 1
 	#define RLIMIT_DATA 2
 	#define RLIMIT_NOFILE 3
+	#define RLIMIT_STACK 4
+
+	#define PRIO_PROCESS 0
+	#define PRIO_PGRP 1
+	#define PRIO_USER 2
 
 	int setrlimit(int, const struct rlimit*); // TODO: Implement me!
 	int getrlimit(int, struct rlimit*); // TODO: Implement me!
+	int getpriority(int, id_t);
+	int setpriority(int, id_t, int);
 
 #endif
@@ -33,8 +33,11 @@
 	typedef uint32_t nlink_t;
 	typedef uint32_t uid_t;
 	typedef uint32_t gid_t;
+	typedef uint32_t id_t;
 	typedef int32_t time_t;
 	typedef int32_t ssize_t;
 	typedef int32_t suseconds_t;
+	typedef uint32_t useconds_t;
+	typedef int32_t clockid_t;
 
 #endif
@@ -42,9 +42,14 @@
 		long tv_nsec; /* Nanoseconds. */
 	};
 
+	#define CLOCK_REALTIME 0
+	#define CLOCK_MONOTONIC 1
+
    extern char* tzname[2];
 
 	time_t time(time_t* timeInstance);
+	int clock_gettime(clockid_t clockId, struct timespec* timespecInstance);
+	int nanosleep(const struct timespec* requestedTime, struct timespec* remainingTime);
 	struct tm* gmtime(const time_t* timeInstance);
 	struct tm* localtime(const time_t* timeInstance);
    void tzset(void);	// TODO: Implement me!
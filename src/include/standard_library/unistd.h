@@ -36,6 +36,7 @@
 	extern char **environ;
 
 	unsigned int sleep(unsigned int seconds);
+	int usleep(useconds_t microseconds);
 
 	ssize_t read(int fileDescriptorIndex, void* buffer, size_t count);
 	ssize_t write(int fileDescriptorIndex, const void* buffer, size_t count);
@@ -48,6 +49,8 @@
 	pid_t getpid(void);
 	pid_t getppid(void);
 
+	int nice(int increment);
+
 	int truncate(const char* path, off_t newSize);
 	int ftruncate(int fileDescriptorIndex, off_t newSize);
 
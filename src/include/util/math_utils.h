@@ -22,6 +22,7 @@
 
 	#include <limits.h>
 	#include <stdbool.h>
+	#include <stddef.h>
 	#include <stdint.h>
 
 	#define mathUtilsMax(a,b) \
@@ -42,6 +43,30 @@
 		return result;
 	}
 
+	/* The compiler would call "__udivdi3", but the compiler runtime library is not linked. */
+	inline __attribute__((always_inline)) uint64_t mathUtilsDivideUint64ByUint32(uint64_t dividend, uint32_t divisor, uint32_t* remainder) {
+		uint32_t dividendUpper = (uint32_t) (dividend >> 32);
+		uint32_t quotientUpper = dividendUpper / divisor;
+		uint32_t quotientLower;
+		uint32_t lastRemainder;
+		__asm__(
+			"divl %4"
+			: "=a"(quotientLower), "=d"(lastRemainder)
+			: "a"((uint32_t) dividend), "d"(dividendUpper % divisor), "rm"(divisor)
+			: "cc");
+		if (remainder != NULL) {
+			*remainder = lastRemainder;
+		}
+		return (((uint64_t) quotientUpper) << 32) | quotientLower;
+	}
+
+	/* It calculates "(value * multiplier) >> shift" without losing the upper bits of the 96-bit product ("shift" <= 32). */
+	inline __attribute__((always_inline)) uint64_t mathUtilsMultiplyAndShiftRight(uint64_t value, uint32_t multiplier, uint32_t shift) {
+		uint64_t productLower = ((uint64_t) ((uint32_t) value)) * multiplier;
+		uint64_t productUpper = ((uint64_t) ((uint32_t) (value >> 32))) * multiplier;
+		return (productUpper << (32 - shift)) + (productLower >> shift);
+	}
+
 	inline __attribute__((always_inline)) int32_t mathUtilsClampInt32(int32_t value, int32_t min, int32_t max) {
 		value = mathUtilsMax(min, value);
 		value = mathUtilsMin(max, value);
@@ -0,0 +1,57 @@
+; Copyright 2022 Luis Henrique O. Rios
+;
+; This file is part of MyOS.
+;
+; MyOS is free software: you can redistribute it and/or modify
+; it under the terms of the GNU General Public License as published by
+; the Free Software Foundation, either version 3 of the License, or
+; (at your option) any later version.
+;
+; MyOS is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+; GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License
+; along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+
+
+BITS 32
+
+global contextSwitch
+
+section .text
+
+; void contextSwitch(uint32_t* currentStackPointer, uint32_t newStackPointer, uint32_t newPageDirectory)
+;
+; It saves the callee-saved registers (according to the cdecl calling convention) and EFLAGS on the current kernel stack,
+; stores the stack pointer and resumes the execution of the context whose stack pointer was received. The segment
+; registers are not touched: inside the kernel, they are always the kernel ones and the user ones are saved by the
+; interruption handler.
+contextSwitch:
+	mov eax, [esp + 4]
+	mov edx, [esp + 8]
+	mov ecx, [esp + 12]
+
+	pushfd
+	push ebp
+	push ebx
+	push esi
+	push edi
+	mov [eax], esp
+
+	mov esp, edx
+	; The kernel space is mapped on every page directory, so the stack remains valid after loading CR3. It is only loaded
+	; when it changes as it flushes the TLB.
+	mov eax, cr3
+	cmp eax, ecx
+	je afterPageDirectoryLoad
+	mov cr3, ecx
+	afterPageDirectoryLoad:
+
+	pop edi
+	pop esi
+	pop ebx
+	pop ebp
+	popfd
+	ret
@@ -22,6 +22,7 @@ SECTION .data
 
 global interruptionHandlerEntryPointAdresses
 global callInterruptionManagerRunCommandsAfterInterruptionHandler
+global sysenterEntryPoint
 
 extern x86InterruptionHasErrorCode
 extern interruptionManagerHandler
@@ -54,6 +55,27 @@ SECTION .text
    %assign i i + 1
 %endrep
 
+; The value of the "Is there an error code?" field when the system call has been requested through SYSENTER.
+ENTERED_THROUGH_SYSENTER equ 2
+; The user space stub resumes the execution after SYSEXIT at this offset from the address it passed on ESI
+; (see "systemCallUsingSysenter").
+SYSEXIT_RETURN_ADDRESS_OFFSET equ 2
+
+; SYSENTER loads CS, SS, EIP and ESP from MSRs and ESP points to the "esp0" field of the TSS. The user space stub passes
+; its stack pointer on EBP and the address to resume on ESI. The same stack frame an "int" instruction would build is
+; created, so the system call follows the common path below.
+sysenterEntryPoint:
+mov esp, [esp]
+push dword USER_LINEAR_DATA_SEGMENT_SELECTOR ; SS
+push ebp ; ESP
+pushfd
+or dword [esp], EFLAGS_INTERRUPT_ENABLE_FLAG_MASK ; SYSENTER clears it.
+push dword USER_LINEAR_CODE_SEGMENT_SELECTOR ; CS
+push esi ; EIP
+push dword ENTERED_THROUGH_SYSENTER
+push dword [interruptionManagerInterruptionVectorToHandleSystemCall]
+jmp localInterruptionHandler
+
 localInterruptionHandler:
 ; The interruptions will be disable here:
 ; "The only difference between an interrupt gate and a trap gate is the way the processor handles
@@ -166,8 +188,40 @@ popa
 ; Is there an error code? -> [ESP + 04]
 ; Interruption vector     -> [ESP + 00]
 
-cmp dword [esp + 4], 0
-je afterAlsoPopErrorCode
+cmp dword [esp + 4], ENTERED_THROUGH_SYSENTER
+jne returnThroughIret
+
+; The stack when the system call has been requested through SYSENTER (there is no error code):
+; SS                      -> [ESP + 24]
+; ESP                     -> [ESP + 20]
+; EFLAGS                  -> [ESP + 16]
+; CS                      -> [ESP + 12]
+; EIP                     -> [ESP + 08]
+; Is there an error code? -> [ESP + 04]
+; Interruption vector     -> [ESP + 00]
+
+; It only returns through SYSEXIT when the process will resume its execution where it requested the system call (a signal
+; handler may have been scheduled, for instance). SYSEXIT loads EIP from EDX and ESP from ECX. Therefore, they are passed
+; to the user space stub on ESI and EBP (which have already been saved on the user stack by the stub).
+cmp [esp + 8], esi
+jne returnThroughIret
+cmp [esp + 20], ebp
+jne returnThroughIret
+	mov esi, ecx
+	mov ebp, edx
+	mov edx, [esp + 8]
+	add edx, SYSEXIT_RETURN_ADDRESS_OFFSET
+	mov ecx, [esp + 20]
+	add esp, 16
+	and dword [esp], ~EFLAGS_INTERRUPT_ENABLE_FLAG_MASK
+	popfd
+	; The interruptions are only enabled after the next instruction.
+	sti
+	sysexit
+
+returnThroughIret:
+cmp dword [esp + 4], 1
+jne afterAlsoPopErrorCode
 alsoPopErrorCode:
 	add esp, 4
 
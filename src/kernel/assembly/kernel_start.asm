@@ -107,62 +107,65 @@ gdt:
 ;0x0 0 (the first descriptor in GDT is not used):
 	dq 0x0
 
+; The order of the first four descriptors is required by SYSENTER and SYSEXIT: kernel code, kernel data, user code and
+; user data.
+
 ;0x8 1:
-KERNEL_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
+KERNEL_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
 	dw 0xFFFF ; segment limit (15:0 - 16 bits): 15:0
 	dw 0x0000 ; base address (31:16 - 16 bits): 15:0
 
 	db 0x00 ; base address (7:0 - 8 bits): 23:16
 
-	db 0x92 ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_0 | DATA_READ_WRITE
+	db 0x9A ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_0 | CODE_EXECUTE_READ
 	db 0xCF ; segment limit (19:16 - 4 bits): 19:16
 			  ; flags 2 (23:20 - 4 bits):  GRANULARITY_4_KBYTES | 32_BIT_SEGMENT
 
-	db 0x00 ; Base address (31:24 - 8 bits): 31:24
+	db 0x00 ; base address (31:24 - 8 bits): 31:24
 
 ;0x10 2:
-KERNEL_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
+KERNEL_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
 	dw 0xFFFF ; segment limit (15:0 - 16 bits): 15:0
 	dw 0x0000 ; base address (31:16 - 16 bits): 15:0
 
 	db 0x00 ; base address (7:0 - 8 bits): 23:16
 
-	db 0x9A ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_0 | CODE_EXECUTE_READ
+	db 0x92 ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_0 | DATA_READ_WRITE
 	db 0xCF ; segment limit (19:16 - 4 bits): 19:16
 			  ; flags 2 (23:20 - 4 bits):  GRANULARITY_4_KBYTES | 32_BIT_SEGMENT
 
-	db 0x00 ; base address (31:24 - 8 bits): 31:24
-
-;0x18 3: It will be used to store a Task State segment descriptor.
-		;There will be no more than one TSS on GDT at any given time.
-	dq 0x0
+	db 0x00 ; Base address (31:24 - 8 bits): 31:24
 
-;0x20 4:
-USER_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
+;0x18 3:
+USER_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
 	dw 0xFFFF ; segment limit (15:0 - 16 bits): 15:0
 	dw 0x0000 ; base address (31:16 - 16 bits): 15:0
 
 	db 0x00 ; base address (7:0 - 8 bits): 23:16
 
-	db 0xF2 ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_3 | DATA_READ_WRITE
+	db 0xFA ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_3 | CODE_EXECUTE_READ
 	db 0xCF ; segment limit (19:16 - 4 bits): 19:16
 			  ; flags 2 (23:20 - 4 bits):  GRANULARITY_4_KBYTES | 32_BIT_SEGMENT
 
 	db 0x00 ; base address (31:24 - 8 bits): 31:24
 
-;0x28 5:
-USER_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
+;0x20 4:
+USER_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX equ ($-gdt) / 8
 	dw 0xFFFF ; segment limit (15:0 - 16 bits): 15:0
 	dw 0x0000 ; base address (31:16 - 16 bits): 15:0
 
 	db 0x00 ; base address (7:0 - 8 bits): 23:16
 
-	db 0xFA ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_3 | CODE_EXECUTE_READ
+	db 0xF2 ; flags 1 (15:8 - 8 bits): SEGMENT_PRESENT | DPL_3 | DATA_READ_WRITE
 	db 0xCF ; segment limit (19:16 - 4 bits): 19:16
 			  ; flags 2 (23:20 - 4 bits):  GRANULARITY_4_KBYTES | 32_BIT_SEGMENT
 
 	db 0x00 ; base address (31:24 - 8 bits): 31:24
 
+;0x28 5: It will be used to store a Task State segment descriptor.
+		;There will be no more than one TSS on GDT at any given time.
+	dq 0x0
+
 gdtEnd:
 
 gdtLimitAndAddress:
@@ -18,4 +18,7 @@
 BITS 32
 
 section .data
-KERNEL_LINEAR_DATA_SEGMENT_SELECTOR equ 0x8
+KERNEL_LINEAR_DATA_SEGMENT_SELECTOR equ 0x10
+USER_LINEAR_CODE_SEGMENT_SELECTOR equ 0x1B
+USER_LINEAR_DATA_SEGMENT_SELECTOR equ 0x23
+EFLAGS_INTERRUPT_ENABLE_FLAG_MASK equ 0x200
@@ -28,16 +28,28 @@
 
 #include "kernel/busy_waiting_manager.h"
 #include "kernel/cmos.h"
+#include "kernel/command_scheduler.h"
 #include "kernel/error_handler.h"
+#include "kernel/interruption_manager.h"
 #include "kernel/log.h"
 #include "kernel/mbr.h"
+#include "kernel/memory_manager.h"
+#include "kernel/pci.h"
+#include "kernel/pic.h"
+#include "kernel/priority.h"
 #include "kernel/x86.h"
 
 #include "kernel/file_system/devices_file_system.h"
 
+#include "kernel/io/block_cache_manager.h"
 #include "kernel/io/block_device.h"
 #include "kernel/io/open_file_description.h"
 
+#include "kernel/process/process_manager.h"
+
+#include "kernel/services/process_services.h"
+
+#include "util/double_linked_list.h"
 #include "util/math_utils.h"
 #include "util/string_utils.h"
 #include "util/string_stream_writer.h"
@@ -47,6 +59,8 @@
 #define IDENTIFY_DEVICE_COMMAND_CODE 0xEC
 #define READ_SECTORS_COMMAND_CODE 0x20
 #define WRITE_SECTORS_COMMAND_CODE 0x30
+#define READ_DMA_COMMAND_CODE 0xC8
+#define WRITE_DMA_COMMAND_CODE 0xCA
 
 #define ERROR_REGISTER 0x01
 #define SECTOR_COUNT_REGISTER 0x02
@@ -66,6 +80,35 @@
 #define STATUS_REGISTER_DRQ_MASK 0x08 /* Data request */
 #define STATUS_REGISTER_ERR_MASK 0x01 /* Error */
 
+/*
+ * References:
+ * - Programming Interface for Bus Master IDE Controller (Revision 1.0)
+ */
+#define BUS_MASTER_COMMAND_REGISTER 0x00
+#define BUS_MASTER_STATUS_REGISTER 0x02
+#define BUS_MASTER_PRD_TABLE_ADDRESS_REGISTER 0x04
+#define BUS_MASTER_REGISTERS_PER_CHANNEL 0x08
+
+#define BUS_MASTER_COMMAND_REGISTER_START_MASK 0x01
+#define BUS_MASTER_COMMAND_REGISTER_READ_MASK 0x08 /* The transfer direction is from the device to the memory. */
+
+#define BUS_MASTER_STATUS_REGISTER_ERROR_MASK 0x02
+#define BUS_MASTER_STATUS_REGISTER_INTERRUPT_MASK 0x04
+
+#define PCI_IDE_PROGRAMMING_INTERFACE_PRIMARY_NATIVE_MODE_MASK 0x01
+#define PCI_IDE_PROGRAMMING_INTERFACE_SECONDARY_NATIVE_MODE_MASK 0x04
+#define PCI_IDE_PROGRAMMING_INTERFACE_BUS_MASTER_MASK 0x80
+
+struct PhysicalRegionDescriptor {
+	uint32_t physicalAddress;
+	uint16_t byteCount; /* Zero means 64 KB. */
+	uint16_t flags;
+} __attribute__((packed));
+_Static_assert(sizeof(struct PhysicalRegionDescriptor) == 8, "Expecting PhysicalRegionDescriptor with 8 bytes.");
+
+#define PHYSICAL_REGION_DESCRIPTOR_END_OF_TABLE_MASK 0x8000
+#define PHYSICAL_REGION_MAX_SIZE 0x10000 /* A region can not cross a 64 KB boundary. */
+
 enum ATADeviceType {
 	PATA_DEVICE_TYPE = 0,
 	PATAPI_DEVICE_TYPE = 1,
@@ -120,6 +163,7 @@ struct ATADevice {
 	bool master;
 	uint8_t deviceType;
 	uint8_t id;
+	bool dmaSupported;
 	struct ATAIdentifyReturn ataIdentifyReturn;
 	char model[MODEL_LENGTH + 1];
 	struct MBR mbr;
@@ -134,6 +178,13 @@ struct IDEChannel {
 	struct ATADevice slaveATADevice;
 	uint8_t id;
 	uint8_t lastStatusRegisterContent;
+	uint16_t irq;
+	uint16_t busMasterRegistersBase; /* Zero when the channel can not use bus master DMA. */
+	struct PhysicalRegionDescriptor* physicalRegionDescriptorTable;
+	volatile bool isDMATransferInProgress;
+	bool hasDMATransferTimedOut;
+	uint8_t lastBusMasterStatusRegisterContent;
+	struct DoubleLinkedList waitingIOProcessList;
 };
 
 static struct IDEChannel primaryIDEChannel;
@@ -209,7 +260,7 @@ static bool ataSoftwareReset(struct IDEChannel* ideChannel) {
 	return waitWhileNotDone(ideChannel, 1500) == ATA_WAIT_SUCCESS;
 }
 
-static enum ATAChannelWaitResult readSectors(struct ATADevice* ataDevice, uint64_t sectorId, uint16_t* buffer, size_t sectorCount) {
+static void issueLBA28Command(struct ATADevice* ataDevice, uint64_t sectorId, size_t sectorCount, uint8_t commandCode) {
 	struct IDEChannel* ideChannel = ataDevice->ideChannel;
 
 	sectorId = sectorId & 0x0FFFFFFF;
@@ -230,8 +281,14 @@ static enum ATAChannelWaitResult readSectors(struct ATADevice* ataDevice, uint64
 	value = (sectorId >> 16) & 0xFF;
 	x86OutputByteToPort(ideChannel->commandsRegistersBase + LBA_HIGH_REGISTER, value);
 
-	x86OutputByteToPort(ideChannel->commandsRegistersBase + COMMAND_REGISTER, READ_SECTORS_COMMAND_CODE);
+	x86OutputByteToPort(ideChannel->commandsRegistersBase + COMMAND_REGISTER, commandCode);
 	wait400Nanoseconds(ideChannel);
+}
+
+static enum ATAChannelWaitResult readSectorsUsingPIO(struct ATADevice* ataDevice, uint64_t sectorId, uint16_t* buffer, size_t sectorCount) {
+	struct IDEChannel* ideChannel = ataDevice->ideChannel;
+
+	issueLBA28Command(ataDevice, sectorId, sectorCount, READ_SECTORS_COMMAND_CODE);
 
 	if (sectorCount == 0) {
 		sectorCount = 256;
@@ -248,36 +305,13 @@ static enum ATAChannelWaitResult readSectors(struct ATADevice* ataDevice, uint64
 		}
 	}
 
-	if (result != ATA_WAIT_SUCCESS) {
-		errorHandlerFatalError("There was a fatal error while reading from an ATA device");
-	}
-
 	return result;
 }
 
-static enum ATAChannelWaitResult writeSectors(struct ATADevice* ataDevice, uint64_t sectorId, uint16_t* buffer, size_t sectorCount) {
+static enum ATAChannelWaitResult writeSectorsUsingPIO(struct ATADevice* ataDevice, uint64_t sectorId, uint16_t* buffer, size_t sectorCount) {
 	struct IDEChannel* ideChannel = ataDevice->ideChannel;
 
-	sectorId = sectorId & 0x0FFFFFFF;
-
-	uint8_t bits27To24 = (sectorId >> 24) & 0x0F;
-	uint8_t value = 0xE0 | ((ataDevice->master ? 0 : 1) << 4) | bits27To24;
-	x86OutputByteToPort(ideChannel->commandsRegistersBase + DEVICE_REGISTER, value);
-	wait400Nanoseconds(ideChannel);
-
-	x86OutputByteToPort(ideChannel->commandsRegistersBase + SECTOR_COUNT_REGISTER, (uint8_t) sectorCount);
-
-	value = sectorId & 0xFF;
-	x86OutputByteToPort(ideChannel->commandsRegistersBase + LBA_LOW_REGISTER, value);
-
-	value = (sectorId >> 8) & 0xFF;
-	x86OutputByteToPort(ideChannel->commandsRegistersBase + LBA_MIDDLE_REGISTER, value);
-
-	value = (sectorId >> 16) & 0xFF;
-	x86OutputByteToPort(ideChannel->commandsRegistersBase + LBA_HIGH_REGISTER, value);
-
-	x86OutputByteToPort(ideChannel->commandsRegistersBase + COMMAND_REGISTER, WRITE_SECTORS_COMMAND_CODE);
-	wait400Nanoseconds(ideChannel);
+	issueLBA28Command(ataDevice, sectorId, sectorCount, WRITE_SECTORS_COMMAND_CODE);
 
 	if (sectorCount == 0) {
 		sectorCount = 256;
@@ -301,14 +335,229 @@ static enum ATAChannelWaitResult writeSectors(struct ATADevice* ataDevice, uint6
 		}
 	}
 
+	return result;
+}
+
+static bool canUseDMA(struct ATADevice* ataDevice, void* buffer, size_t sectorCount) {
+	struct IDEChannel* ideChannel = ataDevice->ideChannel;
+
+	if (sectorCount == 0) {
+		sectorCount = 256;
+	}
+
+	/* As the kernel space is identity mapped, the buffer address is also its physical address. */
+	uint32_t firstInvalidKernelSpaceAddress = SYSTEM_PAGE_TABLES_COUNT * PAGE_TABLE_LENGTH * PAGE_FRAME_SIZE;
+	uint32_t address = (uint32_t) buffer;
+	return ideChannel->busMasterRegistersBase != 0 && ataDevice->dmaSupported
+		&& address % sizeof(uint16_t) == 0
+		&& address < firstInvalidKernelSpaceAddress
+		&& sectorCount * BYTES_PER_SECTOR <= firstInvalidKernelSpaceAddress - address;
+}
+
+static void fillPhysicalRegionDescriptorTable(struct IDEChannel* ideChannel, void** buffers, size_t bufferCount, size_t bytesPerBuffer) {
+	struct PhysicalRegionDescriptor* physicalRegionDescriptorTable = ideChannel->physicalRegionDescriptorTable;
+
+	int i = 0;
+	for (int j = 0; j < bufferCount; j++) {
+		/* As the kernel space is identity mapped, the buffer address is also its physical address. */
+		uint32_t physicalAddress = (uint32_t) buffers[j];
+		size_t byteCount = bytesPerBuffer;
+		while (byteCount > 0) {
+			assert(i < PAGE_FRAME_SIZE / sizeof(struct PhysicalRegionDescriptor));
+			size_t regionSize = mathUtilsMin(byteCount, PHYSICAL_REGION_MAX_SIZE - (physicalAddress % PHYSICAL_REGION_MAX_SIZE));
+
+			struct PhysicalRegionDescriptor* physicalRegionDescriptor = &physicalRegionDescriptorTable[i++];
+			physicalRegionDescriptor->physicalAddress = physicalAddress;
+			physicalRegionDescriptor->byteCount = (uint16_t) regionSize;
+			physicalRegionDescriptor->flags = 0;
+
+			physicalAddress += regionSize;
+			byteCount -= regionSize;
+		}
+	}
+
+	assert(i > 0);
+	physicalRegionDescriptorTable[i - 1].flags = PHYSICAL_REGION_DESCRIPTOR_END_OF_TABLE_MASK;
+}
+
+/*
+ * It stops the bus master engine and acknowledges the interruption (both on the controller and on the device).
+ */
+static void completeDMATransfer(struct IDEChannel* ideChannel) {
+	uint16_t busMasterRegistersBase = ideChannel->busMasterRegistersBase;
+
+	uint8_t command = x86InputByteFromPort(busMasterRegistersBase + BUS_MASTER_COMMAND_REGISTER);
+	x86OutputByteToPort(busMasterRegistersBase + BUS_MASTER_COMMAND_REGISTER, command & ~BUS_MASTER_COMMAND_REGISTER_START_MASK);
+
+	/* The interrupt and error bits are cleared by writing one to them. */
+	uint8_t busMasterStatus = x86InputByteFromPort(busMasterRegistersBase + BUS_MASTER_STATUS_REGISTER);
+	x86OutputByteToPort(busMasterRegistersBase + BUS_MASTER_STATUS_REGISTER, busMasterStatus | BUS_MASTER_STATUS_REGISTER_INTERRUPT_MASK | BUS_MASTER_STATUS_REGISTER_ERROR_MASK);
+	ideChannel->lastBusMasterStatusRegisterContent = busMasterStatus;
+
+	/* Reading the status register also clears the device interrupt. */
+	ideChannel->lastStatusRegisterContent = x86InputByteFromPort(ideChannel->commandsRegistersBase + STATUS_REGISTER);
+	ideChannel->isDMATransferInProgress = false;
+}
+
+static bool tryToCompleteDMATransfer(struct IDEChannel* ideChannel) {
+	if (ideChannel->isDMATransferInProgress) {
+		uint8_t busMasterStatus = x86InputByteFromPort(ideChannel->busMasterRegistersBase + BUS_MASTER_STATUS_REGISTER);
+		if (busMasterStatus & (BUS_MASTER_STATUS_REGISTER_INTERRUPT_MASK | BUS_MASTER_STATUS_REGISTER_ERROR_MASK)) {
+			completeDMATransfer(ideChannel);
+		}
+	}
+	return !ideChannel->isDMATransferInProgress;
+}
+
+static bool busyWaitWhileDMATransferIsInProgress(struct IDEChannel* ideChannel, uint32_t milliseconds) {
+	bool hasTimeLeft = true;
+	uint64_t before = x86Rdtsc();
+
+	bool done;
+	do {
+		/*
+		 * The interruption handler might complete the transfer if the interruptions are enabled (during the kernel
+		 * initialization, for example).
+		 */
+		bool areInterruptionsEnabled = (x86GetEflags() & EFLAGS_INTERRUPT_ENABLE_FLAG_MASK) != 0;
+		x86Cli();
+		done = tryToCompleteDMATransfer(ideChannel);
+		if (!done && !(hasTimeLeft = busyWaitingHasTimeLeft(before, milliseconds))) {
+			completeDMATransfer(ideChannel);
+		}
+		if (areInterruptionsEnabled) {
+			x86Sti();
+		}
+	} while (!done && hasTimeLeft);
+
+	return hasTimeLeft;
+}
+
+static void handleDMATransferTimeout(struct IDEChannel* ideChannel) {
+	if (ideChannel->isDMATransferInProgress) {
+		completeDMATransfer(ideChannel);
+		ideChannel->hasDMATransferTimedOut = true;
+		processServicesWakeUpProcesses(processManagerGetCurrentProcess(), &ideChannel->waitingIOProcessList, SUSPENDED_WAITING_BLOCK_IO);
+	}
+}
+
+/*
+ * While the transfer is in progress, the processor is given to other processes. The interruption handler (or the timeout
+ * command) completes the transfer and resumes the process.
+ */
+static bool sleepWhileDMATransferIsInProgress(struct IDEChannel* ideChannel, struct Process* currentProcess, void* commandSchedulerId) {
+	while (ideChannel->isDMATransferInProgress) {
+		processServicesSuspendToWaitForIO(currentProcess, &ideChannel->waitingIOProcessList, SUSPENDED_WAITING_BLOCK_IO);
+		processManagerScheduleProcessExecution();
+	}
+
+	if (ideChannel->hasDMATransferTimedOut) {
+		return false;
+	} else {
+		commandSchedulerCancel(commandSchedulerId);
+		return true;
+	}
+}
+
+static enum ATAChannelWaitResult waitForDMATransferCompletion(struct IDEChannel* ideChannel, uint32_t milliseconds) {
+	/*
+	 * Only the kernel lock owner can sleep as it guarantees that no other process will use the block device (or the
+	 * structures built on top of it) meanwhile. Otherwise (during the kernel initialization or the process termination,
+	 * for example), it keeps polling.
+	 */
+	struct Process* currentProcess = processManagerGetCurrentProcess();
+	void* commandSchedulerId = NULL;
+	if (processManagerIsHoldingKernelLock(currentProcess) && currentProcess->state == RUNNABLE) {
+		ideChannel->hasDMATransferTimedOut = false;
+		commandSchedulerId = commandSchedulerSchedule(milliseconds, false, (void (*)(void*)) &handleDMATransferTimeout, ideChannel);
+	}
+
+	bool hasTimeLeft;
+	if (commandSchedulerId != NULL) {
+		hasTimeLeft = sleepWhileDMATransferIsInProgress(ideChannel, currentProcess, commandSchedulerId);
+	} else {
+		hasTimeLeft = busyWaitWhileDMATransferIsInProgress(ideChannel, milliseconds);
+	}
+
+	if (!hasTimeLeft) {
+		return ATA_WAIT_TIMEOUT;
+	} else if ((ideChannel->lastBusMasterStatusRegisterContent & BUS_MASTER_STATUS_REGISTER_ERROR_MASK)
+			|| (ideChannel->lastStatusRegisterContent & STATUS_REGISTER_ERR_MASK) || (ideChannel->lastStatusRegisterContent & STATUS_REGISTER_DF_MASK)) {
+		return ATA_WAIT_ERROR;
+	} else {
+		return ATA_WAIT_SUCCESS;
+	}
+}
+
+/*
+ * The sectors are scattered among the buffers (each one receives the same amount of them) but they are transferred
+ * using a single command.
+ */
+static enum ATAChannelWaitResult transferSectorsUsingDMA(struct ATADevice* ataDevice, uint64_t sectorId, void** buffers, size_t bufferCount, size_t sectorsPerBuffer, bool read) {
+	struct IDEChannel* ideChannel = ataDevice->ideChannel;
+	uint16_t busMasterRegistersBase = ideChannel->busMasterRegistersBase;
+	assert(!ideChannel->isDMATransferInProgress);
+
+	size_t sectorCount = bufferCount * sectorsPerBuffer;
+	assert(0 < sectorCount && sectorCount <= 256);
+	fillPhysicalRegionDescriptorTable(ideChannel, buffers, bufferCount, sectorsPerBuffer * BYTES_PER_SECTOR);
+
+	uint8_t command = read ? BUS_MASTER_COMMAND_REGISTER_READ_MASK : 0;
+	x86OutputByteToPort(busMasterRegistersBase + BUS_MASTER_COMMAND_REGISTER, command);
+	x86OutputDoubleWordToPort(busMasterRegistersBase + BUS_MASTER_PRD_TABLE_ADDRESS_REGISTER, (uint32_t) ideChannel->physicalRegionDescriptorTable);
+	uint8_t busMasterStatus = x86InputByteFromPort(busMasterRegistersBase + BUS_MASTER_STATUS_REGISTER);
+	x86OutputByteToPort(busMasterRegistersBase + BUS_MASTER_STATUS_REGISTER, busMasterStatus | BUS_MASTER_STATUS_REGISTER_INTERRUPT_MASK | BUS_MASTER_STATUS_REGISTER_ERROR_MASK);
+
+	ideChannel->isDMATransferInProgress = true;
+	issueLBA28Command(ataDevice, sectorId, sectorCount, read ? READ_DMA_COMMAND_CODE : WRITE_DMA_COMMAND_CODE);
+	x86OutputByteToPort(busMasterRegistersBase + BUS_MASTER_COMMAND_REGISTER, command | BUS_MASTER_COMMAND_REGISTER_START_MASK);
+
+	return waitForDMATransferCompletion(ideChannel, 1500);
+}
+
+static enum ATAChannelWaitResult transferSectors(struct ATADevice* ataDevice, uint64_t sectorId, void** buffers, size_t bufferCount, size_t sectorsPerBuffer, bool read) {
+	bool useDMA = true;
+	for (int i = 0; i < bufferCount && useDMA; i++) {
+		useDMA = canUseDMA(ataDevice, buffers[i], sectorsPerBuffer);
+	}
+
+	enum ATAChannelWaitResult result;
+	if (useDMA) {
+		result = transferSectorsUsingDMA(ataDevice, sectorId, buffers, bufferCount, sectorsPerBuffer, read);
+
+	} else {
+		result = ATA_WAIT_SUCCESS;
+		for (int i = 0; i < bufferCount && result == ATA_WAIT_SUCCESS; i++) {
+			if (read) {
+				result = readSectorsUsingPIO(ataDevice, sectorId + i * sectorsPerBuffer, buffers[i], sectorsPerBuffer);
+			} else {
+				result = writeSectorsUsingPIO(ataDevice, sectorId + i * sectorsPerBuffer, buffers[i], sectorsPerBuffer);
+			}
+		}
+	}
+
 	if (result != ATA_WAIT_SUCCESS) {
-		logDebug("id=%d sectorId=%llX sectorCount=%d", ataDevice->id, sectorId, sectorCount);
-		errorHandlerFatalError("There was a fatal error while writing to an ATA device");
+		logDebug("id=%d sectorId=%llX sectorCount=%d", ataDevice->id, sectorId, bufferCount * sectorsPerBuffer);
+		if (read) {
+			errorHandlerFatalError("There was a fatal error while reading from an ATA device");
+		} else {
+			errorHandlerFatalError("There was a fatal error while writing to an ATA device");
+		}
 	}
 
 	return result;
 }
 
+static enum ATAChannelWaitResult readSectors(struct ATADevice* ataDevice, uint64_t sectorId, uint16_t* buffer, size_t sectorCount) {
+	void* buffers[] = {buffer};
+	return transferSectors(ataDevice, sectorId, buffers, 1, sectorCount, true);
+}
+
+static enum ATAChannelWaitResult writeSectors(struct ATADevice* ataDevice, uint64_t sectorId, uint16_t* buffer, size_t sectorCount) {
+	void* buffers[] = {buffer};
+	return transferSectors(ataDevice, sectorId, buffers, 1, sectorCount, false);
+}
+
 static bool canUse48BitAddressFeature(struct ATAIdentifyReturn* ataIdentifyReturn) {
 	return (ataIdentifyReturn->commandSetsSupported[1] & (1 << 10)) && (ataIdentifyReturn->commandSetsEnabled[1] & (1 << 10));
 }
@@ -317,6 +566,10 @@ static bool isRemovableMediaDevice(struct ATAIdentifyReturn* ataIdentifyReturn)
 	return ataIdentifyReturn->flags & (1 << 7);
 }
 
+static bool isDMASupported(struct ATAIdentifyReturn* ataIdentifyReturn) {
+	return (ataIdentifyReturn->capabilities[0] & (1 << 8)) != 0;
+}
+
 static void initializeDevicePartitions(struct ATADevice* ataDevice) {
 	logDebug("    initializing device partitions:");
 
@@ -407,6 +660,7 @@ static void initializeDevice(struct ATADevice* ataDevice) {
 
 				ataDevice->operational = true;
 				ataDevice->deviceType = deviceType;
+				ataDevice->dmaSupported = isDMASupported(ataIdentifyReturn);
 
 				initializeDevicePartitions(ataDevice);
 			}
@@ -429,6 +683,12 @@ static void initializeDevices(struct IDEChannel* ideChannel) {
 	if (ataSoftwareReset(ideChannel)) {
 		initializeDevice(&ideChannel->masterATADevice);
 		initializeDevice(&ideChannel->slaveATADevice);
+
+		if (ideChannel->busMasterRegistersBase != 0) {
+			/* The DMA transfers are completed through interruptions. Therefore, they are now enabled. */
+			x86OutputByteToPort(ideChannel->controlRegistersBase + DEVICE_CONTROL_REGISTER, 0x00);
+		}
+
 	} else {
 		logDebug("  timeout while trying to reset the IDE channel %d", ideChannel->id);
 		ideChannel->masterATADevice.operational = false;
@@ -436,6 +696,87 @@ static void initializeDevices(struct IDEChannel* ideChannel) {
 	}
 }
 
+static void initializeBusMaster(void) {
+	struct PCIFunction pciFunction;
+	if (pciFindFunctionByClass(PCI_MASS_STORAGE_CONTROLLER_CLASS_CODE, PCI_IDE_CONTROLLER_SUBCLASS, &pciFunction)) {
+		uint32_t baseAddressRegister4 = pciReadConfigurationDoubleWord(&pciFunction, PCI_BASE_ADDRESS_REGISTER_4);
+
+		/* Is the bus master register block mapped on the I/O space? */
+		if ((pciFunction.programmingInterface & PCI_IDE_PROGRAMMING_INTERFACE_BUS_MASTER_MASK) && (baseAddressRegister4 & 0x1)
+				&& (baseAddressRegister4 & 0xFFFC) != 0) {
+			uint32_t commandAndStatus = pciReadConfigurationDoubleWord(&pciFunction, PCI_COMMAND_AND_STATUS_REGISTER);
+			commandAndStatus = (commandAndStatus & 0xFFFF) | PCI_COMMAND_IO_SPACE_MASK | PCI_COMMAND_BUS_MASTER_MASK;
+			pciWriteConfigurationDoubleWord(&pciFunction, PCI_COMMAND_AND_STATUS_REGISTER, commandAndStatus);
+
+			uint16_t busMasterRegistersBase = baseAddressRegister4 & 0xFFFC;
+			struct IDEChannel* ideChannels[NUMBER_OF_IDE_CHANNELS] = {&primaryIDEChannel, &secondaryIDEChannel};
+			uint8_t nativeModeMasks[NUMBER_OF_IDE_CHANNELS] = {PCI_IDE_PROGRAMMING_INTERFACE_PRIMARY_NATIVE_MODE_MASK, PCI_IDE_PROGRAMMING_INTERFACE_SECONDARY_NATIVE_MODE_MASK};
+
+			for (int i = 0; i < NUMBER_OF_IDE_CHANNELS; i++) {
+				struct IDEChannel* ideChannel = ideChannels[i];
+
+				/* The channels operating in native mode use other I/O ports and IRQs. They are not supported. */
+				if ((pciFunction.programmingInterface & nativeModeMasks[i]) == 0) {
+					struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
+					if (doubleLinkedListElement != NULL) {
+						ideChannel->physicalRegionDescriptorTable = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+						ideChannel->busMasterRegistersBase = busMasterRegistersBase + i * BUS_MASTER_REGISTERS_PER_CHANNEL;
+						logDebug("  IDE channel %d will use bus master DMA (busMasterRegistersBase=%X)", ideChannel->id, ideChannel->busMasterRegistersBase);
+					}
+				}
+			}
+		}
+
+	} else {
+		logDebug("  no PCI IDE controller found: only PIO mode will be used");
+	}
+}
+
+static void issueEndOfInterruption(struct IDEChannel* ideChannel) {
+	picIssueEndOfInterrupt(ideChannel->irq, false);
+}
+
+static void issueEndOfSpuriousInterruption(struct IDEChannel* ideChannel) {
+	picIssueEndOfInterrupt(ideChannel->irq, true);
+}
+
+static void resumeProcessesWaitingForDMATransfer(struct IDEChannel* ideChannel) {
+	processServicesWakeUpProcesses(processManagerGetCurrentProcess(), &ideChannel->waitingIOProcessList, SUSPENDED_WAITING_BLOCK_IO);
+
+	/* If the system is idle, there is no reason to wait for the next scheduler tick. */
+	if (processManagerGetCurrentProcess() == NULL) {
+		processManagerScheduleProcessExecution();
+	}
+}
+
+static void handleInterruption(struct IDEChannel* ideChannel) {
+	/* The secondary IDE channel shares its IRQ with the spurious IRQ of the slave PIC. */
+	if (picIsSpuriousIRQ(ideChannel->irq)) {
+		logDebug("An spurious IRQ just happened (IDE channel %d)", ideChannel->id);
+		interruptionManagerRegisterCommandToRunAfterInterruptionHandler(PRIORITY_LOWEST, (void(*)(void*)) &issueEndOfSpuriousInterruption, ideChannel);
+
+	} else {
+		if (ideChannel->busMasterRegistersBase != 0 && ideChannel->isDMATransferInProgress) {
+			if (tryToCompleteDMATransfer(ideChannel)) {
+				/* Like the PIT scheduler tick, it runs before the end of interruption is issued as it might switch to another process. */
+				interruptionManagerRegisterCommandToRunAfterInterruptionHandler(PRIORITY_HIGH, (void(*)(void*)) &resumeProcessesWaitingForDMATransfer, ideChannel);
+			}
+		} else {
+			/* It only acknowledges the interruption. */
+			ideChannel->lastStatusRegisterContent = x86InputByteFromPort(ideChannel->commandsRegistersBase + STATUS_REGISTER);
+		}
+		interruptionManagerRegisterCommandToRunAfterInterruptionHandler(PRIORITY_LOWEST, (void(*)(void*)) &issueEndOfInterruption, ideChannel);
+	}
+}
+
+static void handlePrimaryIDEChannelInterruption(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
+	handleInterruption(&primaryIDEChannel);
+}
+
+static void handleSecondaryIDEChannelInterruption(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
+	handleInterruption(&secondaryIDEChannel);
+}
+
 static mode_t deviceGetMode(struct VirtualFileSystemNode* virtualFileSystemNode) {
 	struct ATADeviceVirtualFileSystemNode* ataDeviceVirtualFileSystemNode = (void*) virtualFileSystemNode;
 	return ataDeviceVirtualFileSystemNode->mode;
@@ -464,7 +805,7 @@ static APIStatusCode deviceStatus(struct VirtualFileSystemNode* virtualFileSyste
 	statInstance->st_ctime = cmosGetInitializationTime();
 	statInstance->st_mtime = cmosGetInitializationTime();
 	statInstance->st_rdev = myosCalculateUniqueId(statInstance->st_dev, statInstance->st_ino);
-	statInstance->st_blksize = BYTES_PER_SECTOR; /* As it uses only PIO Mode. */
+	statInstance->st_blksize = BYTES_PER_SECTOR; /* As it reads and writes one sector at a time. */
 	statInstance->st_nlink = 1;
 
 	return SUCCESS;
@@ -479,7 +820,7 @@ static APIStatusCode devicePartitionStatus(struct VirtualFileSystemNode* virtual
 	statInstance->st_ctime = cmosGetInitializationTime();
 	statInstance->st_mtime = cmosGetInitializationTime();
 	statInstance->st_rdev = myosCalculateUniqueId(statInstance->st_dev, statInstance->st_ino);
-	statInstance->st_blksize = BYTES_PER_SECTOR; /* As it uses only PIO Mode. */
+	statInstance->st_blksize = BYTES_PER_SECTOR; /* As it reads and writes one sector at a time. */
 	statInstance->st_nlink = 1;
 
 	return SUCCESS;
@@ -569,11 +910,49 @@ static APIStatusCode deviceWrite(struct VirtualFileSystemNode* virtualFileSystem
 	return commonWrite(openFileDescription, buffer, bufferSize, ataDevice, 0, ataIdentifyReturn->maxLBAAddresss28, count);
 }
 
+/*
+ * The partitions are read through the block cache. Therefore, the data is consistent with the mounted file system and
+ * multiple sectors are read using a single command.
+ */
+#define MAXIMUM_SEGMENTS_PER_PARTITION_READ 8
+
 static APIStatusCode devicePartitionRead(struct VirtualFileSystemNode* virtualFileSystemNode, struct Process* process, struct OpenFileDescription* openFileDescription, void* buffer, size_t bufferSize, size_t* count) {
 	struct ATADevicePartitionVirtualFileSystemNode* ataDevicePartitionVirtualFileSystemNode = (void*) virtualFileSystemNode;
-	struct ATADevice* ataDevice = ataDevicePartitionVirtualFileSystemNode->ataDevice;
+	struct BlockDevice* blockDevice = &ataDevicePartitionVirtualFileSystemNode->blockDevice;
+	uint64_t size = ((uint64_t) ataDevicePartitionVirtualFileSystemNode->numberOfSectors) * BYTES_PER_SECTOR;
+
+	APIStatusCode result = SUCCESS;
+	*count = 0;
+
+	while (result == SUCCESS && bufferSize > 0 && openFileDescription->offset < size) {
+		uint32_t intraSectorOffset = openFileDescription->offset % BYTES_PER_SECTOR;
+		size_t localCount = mathUtilsMin(bufferSize, size - openFileDescription->offset);
+		uint32_t sectorCount = mathUtilsCeilOfUint32Division(intraSectorOffset + localCount, BYTES_PER_SECTOR);
+		sectorCount = mathUtilsMin(sectorCount, (MAXIMUM_SEGMENTS_PER_PARTITION_READ - 1) * (PAGE_FRAME_SIZE / BYTES_PER_SECTOR));
+
+		struct BlockCacheSegment segments[MAXIMUM_SEGMENTS_PER_PARTITION_READ];
+		size_t segmentCount;
+		result = blockCacheManagerReserveRange(blockDevice, openFileDescription->offset / BYTES_PER_SECTOR, sectorCount, true,
+			segments, MAXIMUM_SEGMENTS_PER_PARTITION_READ, &segmentCount);
+		if (result == SUCCESS) {
+			for (size_t i = 0; i < segmentCount && bufferSize > 0; i++) {
+				struct BlockCacheSegment* segment = &segments[i];
+				size_t segmentSize = segment->blockCount * BYTES_PER_SECTOR - intraSectorOffset;
+
+				localCount = mathUtilsMin(segmentSize, mathUtilsMin(bufferSize, size - openFileDescription->offset));
+				memcpy(buffer, segment->data + intraSectorOffset, localCount);
+				intraSectorOffset = 0;
+
+				buffer += localCount;
+				bufferSize -= localCount;
+				*count += localCount;
+				openFileDescription->offset += localCount;
+			}
+			blockCacheManagerReleaseRange(blockDevice, segments, segmentCount, false);
+		}
+	}
 
-	return commonRead(openFileDescription, buffer, bufferSize, count, ataDevice, ataDevicePartitionVirtualFileSystemNode->firstSectorId, ataDevicePartitionVirtualFileSystemNode->numberOfSectors);
+	return result;
 }
 
 static enum OpenFileDescriptionOffsetRepositionPolicy devicegetOpenFileDescriptionOffsetRepositionPolicy(struct VirtualFileSystemNode* virtualFileSystemNode) {
@@ -628,7 +1007,16 @@ static bool writeBlocks(struct BlockDevice* blockDevice, uint64_t firstBlockId,
 	return writeSectors(ataDevicePartitionVirtualFileSystemNode->ataDevice, sectorId, buffer, blockCount) == ATA_WAIT_SUCCESS;
 }
 
-void ataInitialize(void) {
+static bool transferPageFrames(struct BlockDevice* blockDevice, uint64_t firstBlockId, size_t pageFrameCount, void** pageFrames, bool write) {
+	struct ATADevicePartitionVirtualFileSystemNode* ataDevicePartitionVirtualFileSystemNode = (void*) (((uint32_t) blockDevice) - offsetof(struct ATADevicePartitionVirtualFileSystemNode, blockDevice));
+
+	assert(firstBlockId < ataDevicePartitionVirtualFileSystemNode->numberOfSectors);
+	uint64_t sectorId = ataDevicePartitionVirtualFileSystemNode->firstSectorId + firstBlockId;
+
+	return transferSectors(ataDevicePartitionVirtualFileSystemNode->ataDevice, sectorId, pageFrames, pageFrameCount, PAGE_FRAME_SIZE / BYTES_PER_SECTOR, !write) == ATA_WAIT_SUCCESS;
+}
+
+void ataInitialize(uint8_t primaryIDEChannelInterruptionVector, uint8_t secondaryIDEChannelInterruptionVector) {
 	logDebug("Initializing ATA devices:");
 
 	memset(&deviceOperations, 0, sizeof(struct VirtualFileSystemOperations));
@@ -651,11 +1039,21 @@ void ataInitialize(void) {
 	primaryIDEChannel.id = 0;
 	primaryIDEChannel.commandsRegistersBase = 0x1F0;
 	primaryIDEChannel.controlRegistersBase = 0x3F6;
-	initializeDevices(&primaryIDEChannel);
+	primaryIDEChannel.irq = IRQ14;
+	doubleLinkedListInitialize(&primaryIDEChannel.waitingIOProcessList);
 
 	secondaryIDEChannel.id = 1;
 	secondaryIDEChannel.commandsRegistersBase = 0x170;
 	secondaryIDEChannel.controlRegistersBase = 0x376;
+	secondaryIDEChannel.irq = IRQ15;
+	doubleLinkedListInitialize(&secondaryIDEChannel.waitingIOProcessList);
+
+	interruptionManagerRegisterInterruptionHandler(primaryIDEChannelInterruptionVector, &handlePrimaryIDEChannelInterruption);
+	interruptionManagerRegisterInterruptionHandler(secondaryIDEChannelInterruptionVector, &handleSecondaryIDEChannelInterruption);
+
+	initializeBusMaster();
+
+	initializeDevices(&primaryIDEChannel);
 	initializeDevices(&secondaryIDEChannel);
 
 	struct ATADevice* ataDevices[NUMBER_OF_ATA_DEVICES];
@@ -706,6 +1104,7 @@ void ataInitialize(void) {
 			streamWriterFormat(&stringStreamWriter.streamWriter, "  serial=\"%.20s\"\n", ataIdentifyReturn->serial);
 			streamWriterFormat(&stringStreamWriter.streamWriter, "  sectors (48)=%llX\n", ataIdentifyReturn->maxLBAAddresss48);
 			streamWriterFormat(&stringStreamWriter.streamWriter, "  sectors (28)=%d\n", ataIdentifyReturn->maxLBAAddresss28);
+			streamWriterFormat(&stringStreamWriter.streamWriter, "  transfer mode=%s\n", ataDevice->dmaSupported && ataDevice->ideChannel->busMasterRegistersBase != 0 ? "DMA" : "PIO");
 
 			if (ataDevice->partitionCount > 0) {
 				streamWriterFormat(&stringStreamWriter.streamWriter, "  partitions:\n");
@@ -746,6 +1145,8 @@ void ataInitialize(void) {
 						blockDevice->blockCount = partitionTableEntry->numberOfSectors;
 						blockDevice->readBlocks = &readBlocks;
 						blockDevice->writeBlocks = &writeBlocks;
+						blockDevice->transferPageFrames = &transferPageFrames;
+						blockDeviceInitializeRequestQueue(blockDevice);
 						ataDevicePartitionVirtualFileSystemNode->blockDeviceVirtualFileSystemNode.blockDevice = blockDevice;
 
 						struct VirtualFileSystemNode* virtualFileSystemNode = &ataDevicePartitionVirtualFileSystemNode->blockDeviceVirtualFileSystemNode.virtualFileSystemNode;
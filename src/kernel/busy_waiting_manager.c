@@ -21,28 +21,11 @@
 #include <stdint.h>
 
 #include "kernel/busy_waiting_manager.h"
-#include "kernel/log.h"
-#include "kernel/pic.h"
-#include "kernel/pit.h"
+#include "kernel/clock_manager.h"
 #include "kernel/x86.h"
 
-#include "util/math_utils.h"
-
 static uint32_t cyclesPerMillisecond;
-
-#define ITERATION_COUNT_BEFORE_STOP 5
-
 static bool initialized = false;
-static uint32_t iterationCount;
-static volatile bool stop;
-static void chronometerCallback(void) {
-	iterationCount++;
-	if (iterationCount == ITERATION_COUNT_BEFORE_STOP) {
-		stop = true;
-	} else {
-		pitStartChronometer(0, &chronometerCallback);
-	}
-}
 
 bool busyWaitingHasTimeLeft(uint64_t before, uint32_t milliseconds) {
 	uint64_t cycles = (uint64_t) milliseconds * (uint64_t) cyclesPerMillisecond;
@@ -77,19 +60,7 @@ void busyWaitingSleep(uint32_t milliseconds) {
 }
 
 void busyWaitingManagerInitialize(void) {
-	stop = false;
-	iterationCount = 0;
-
-	uint64_t before = x86Rdtsc();
-	pitStartChronometer(0, &chronometerCallback);
-	while (!stop);
-	uint64_t after = x86Rdtsc();
-
-	cyclesPerMillisecond = ((uint32_t)(after - before)) /
-			(55 /* time (in milliseconds) to count up to 65536 at a frequency of 1193182 Hz */ * ITERATION_COUNT_BEFORE_STOP);
-	cyclesPerMillisecond = mathUtilsMax(1, cyclesPerMillisecond);
-
+	/* The time stamp counter has already been calibrated by the clock manager. */
+	cyclesPerMillisecond = clockManagerGetCyclesPerMillisecond();
 	initialized = true;
-
-	logDebug("%d cyclesPerMillisecond", cyclesPerMillisecond);
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kernel/clock_manager.h"
+#include "kernel/cmos.h"
+#include "kernel/log.h"
+#include "kernel/pit.h"
+#include "kernel/x86.h"
+
+#include "util/math_utils.h"
+
+#define ITERATION_COUNT_BEFORE_STOP 5
+/* Each iteration of the chronometer counts 65536 times at a frequency of 1193182 Hz. */
+#define CALIBRATION_TIME_IN_NANOSECONDS ((uint32_t) ((65536ULL * ITERATION_COUNT_BEFORE_STOP * 1000000000ULL) / 1193182ULL))
+
+static struct MyosClockParameters clockParameters;
+static uint32_t cyclesPerMillisecond;
+
+static uint32_t iterationCount;
+static volatile bool stop;
+static void chronometerCallback(void) {
+	iterationCount++;
+	if (iterationCount == ITERATION_COUNT_BEFORE_STOP) {
+		stop = true;
+	} else {
+		pitStartChronometer(0, &chronometerCallback);
+	}
+}
+
+/**
+ * It measures how many cycles the time stamp counter counts while the PIT counts a known amount of time. Therefore, it
+ * requires the PIT IRQ to be enabled.
+ */
+void clockManagerInitialize(void) {
+	stop = false;
+	iterationCount = 0;
+
+	uint64_t before = x86Rdtsc();
+	pitStartChronometer(0, &chronometerCallback);
+	while (!stop);
+	uint64_t after = x86Rdtsc();
+	uint32_t cycles = mathUtilsMax(1, (uint32_t) (after - before));
+
+	cyclesPerMillisecond = mathUtilsMax(1, (uint32_t) mathUtilsDivideUint64ByUint32((uint64_t) cycles * 1000000, CALIBRATION_TIME_IN_NANOSECONDS, NULL));
+
+	/* The largest shift that keeps the multiplier on 32 bits gives the best precision. */
+	uint32_t shift = 32;
+	uint64_t multiplier;
+	while ((multiplier = mathUtilsDivideUint64ByUint32(((uint64_t) CALIBRATION_TIME_IN_NANOSECONDS) << shift, cycles, NULL)) > UINT32_MAX) {
+		shift--;
+	}
+
+	clockParameters.timeStampCountAtBoot = after;
+	clockParameters.nanosecondsPerCycleMultiplier = (uint32_t) multiplier;
+	clockParameters.nanosecondsPerCycleShift = shift;
+	clockParameters.unixTimeAtBoot = cmosGetUnixTime();
+
+	logDebug("%d cyclesPerMillisecond, nanoseconds per cycle multiplier is %u and shift is %u", cyclesPerMillisecond,
+		clockParameters.nanosecondsPerCycleMultiplier, clockParameters.nanosecondsPerCycleShift);
+}
+
+const struct MyosClockParameters* clockManagerGetParameters(void) {
+	return &clockParameters;
+}
+
+uint32_t clockManagerGetCyclesPerMillisecond(void) {
+	return cyclesPerMillisecond;
+}
+
+uint64_t clockManagerGetUpTimeInNanoseconds(void) {
+	return mathUtilsMultiplyAndShiftRight(x86Rdtsc() - clockParameters.timeStampCountAtBoot,
+		clockParameters.nanosecondsPerCycleMultiplier, clockParameters.nanosecondsPerCycleShift);
+}
+
+time_t clockManagerGetUnixTime(void) {
+	return clockParameters.unixTimeAtBoot + (time_t) mathUtilsDivideUint64ByUint32(clockManagerGetUpTimeInNanoseconds(), 1000000000, NULL);
+}
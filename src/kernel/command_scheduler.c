@@ -20,14 +20,15 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "kernel/clock_manager.h"
 #include "kernel/command_scheduler.h"
 #include "kernel/pit.h"
 
 #include "util/priority_queue.h"
 
 struct ScheduledCommand {
-	uint64_t upTimeInMilliseconds;
-	uint64_t delayInMilliseconds;
+	uint64_t upTimeInNanoseconds;
+	uint64_t delayInNanoseconds;
 	bool repeat;
 	void (*command)(void*);
 	void* argument;
@@ -40,20 +41,36 @@ static struct ScheduledCommand* queue[REGISTERED_SCHEDULED_COMMANDS_ARRAY_LENGTH
 static struct PriorityQueue priorityQueue;
 
 static bool scheduledCommandComparator(const void* scheduledCommand1, const void* scheduledCommand2, void* argument1, void* argument2, void* argument3) {
-	return (*((struct ScheduledCommand**) scheduledCommand1))->upTimeInMilliseconds < (*((struct ScheduledCommand**) scheduledCommand2))->upTimeInMilliseconds;
+	return (*((struct ScheduledCommand**) scheduledCommand1))->upTimeInNanoseconds < (*((struct ScheduledCommand**) scheduledCommand2))->upTimeInNanoseconds;
 }
 
+/* The timer is armed for the nearest deadline (the canceled commands would interrupt the processor for nothing). */
+static void armTimerForNextCommand(void) {
+	while (priorityQueueSize(&priorityQueue) > 0) {
+		struct ScheduledCommand* scheduledCommand;
+		priorityQueuePeek(&priorityQueue, &scheduledCommand);
+		if (scheduledCommand->canceled) {
+			priorityQueueRemove(&priorityQueue, &scheduledCommand);
+		} else {
+			pitArmTimer(scheduledCommand->upTimeInNanoseconds);
+			break;
+		}
+	}
+}
+
+/* The deadlines are kept on the time stamp counter based clock and the timer is armed for the nearest one. */
 static void commandSchedulerTick(uint64_t tickCount, uint64_t upTimeInMilliseconds) {
+	uint64_t upTimeInNanoseconds = clockManagerGetUpTimeInNanoseconds();
 	while (priorityQueueSize(&priorityQueue) > 0) {
 		struct ScheduledCommand* scheduledCommand;
 		priorityQueuePeek(&priorityQueue, &scheduledCommand);
-		if (scheduledCommand->upTimeInMilliseconds <= upTimeInMilliseconds) {
+		if (scheduledCommand->upTimeInNanoseconds <= upTimeInNanoseconds) {
 			 priorityQueueRemove(&priorityQueue, &scheduledCommand);
 			if (!scheduledCommand->canceled) {
 				scheduledCommand->command(scheduledCommand->argument);
 
 				if (scheduledCommand->repeat) {
-					scheduledCommand->upTimeInMilliseconds = scheduledCommand->delayInMilliseconds + upTimeInMilliseconds;
+					scheduledCommand->upTimeInNanoseconds = scheduledCommand->delayInNanoseconds + upTimeInNanoseconds;
 					bool result = priorityQueueInsert(&priorityQueue, &scheduledCommand);
 					assert(result);
 				}
@@ -63,14 +80,16 @@ static void commandSchedulerTick(uint64_t tickCount, uint64_t upTimeInMillisecon
 			break;
 		}
 	}
+
+	armTimerForNextCommand();
 }
 
 uint64_t commandSchedulerCancel(void* commandId) {
 	struct ScheduledCommand* scheduledCommand = commandId;
 	scheduledCommand->canceled = true;
-	uint64_t upTimeInMilliseconds = pitGetUpTimeInMilliseconds();
-	if (scheduledCommand->upTimeInMilliseconds >= upTimeInMilliseconds) {
-		return scheduledCommand->upTimeInMilliseconds - upTimeInMilliseconds;
+	uint64_t upTimeInNanoseconds = clockManagerGetUpTimeInNanoseconds();
+	if (scheduledCommand->upTimeInNanoseconds >= upTimeInNanoseconds) {
+		return scheduledCommand->upTimeInNanoseconds - upTimeInNanoseconds;
 	} else {
 		return 0;
 	}
@@ -86,13 +105,13 @@ void commandSchedulerInitialize(void) {
 	pitRegisterCommandToRunOnTick(&commandSchedulerTick);
 }
 
-void* commandSchedulerSchedule(uint64_t delayInMilliseconds, bool repeat, void (*command)(void*), void* argument) {
+void* commandSchedulerScheduleInNanoseconds(uint64_t delayInNanoseconds, bool repeat, void (*command)(void*), void* argument) {
 	int size = priorityQueueSize(&priorityQueue);
 
 	if (size + 1 < REGISTERED_SCHEDULED_COMMANDS_ARRAY_LENGTH) {
 		struct ScheduledCommand* scheduledCommand = queue[size];
-		scheduledCommand->upTimeInMilliseconds = pitGetUpTimeInMilliseconds() + delayInMilliseconds;
-		scheduledCommand->delayInMilliseconds = delayInMilliseconds;
+		scheduledCommand->upTimeInNanoseconds = clockManagerGetUpTimeInNanoseconds() + delayInNanoseconds;
+		scheduledCommand->delayInNanoseconds = delayInNanoseconds;
 		scheduledCommand->repeat = repeat;
 		scheduledCommand->command = command;
 		scheduledCommand->argument = argument;
@@ -100,9 +119,14 @@ void* commandSchedulerSchedule(uint64_t delayInMilliseconds, bool repeat, void (
 
 		bool result = priorityQueueInsert(&priorityQueue, &scheduledCommand);
 		assert(result);
+		pitArmTimer(scheduledCommand->upTimeInNanoseconds);
 		return scheduledCommand;
 
 	} else {
 		return NULL;
 	}
 }
+
+void* commandSchedulerSchedule(uint64_t delayInMilliseconds, bool repeat, void (*command)(void*), void* argument) {
+	return commandSchedulerScheduleInNanoseconds(delayInMilliseconds * 1000000, repeat, command, argument);
+}
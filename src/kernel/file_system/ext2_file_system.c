@@ -26,6 +26,7 @@
 #include "kernel/error_handler.h"
 #include "kernel/limits.h"
 #include "kernel/memory_manager.h"
+#include "kernel/slab_allocator.h"
 
 #include "kernel/file_system/ext2_file_system.h"
 
@@ -181,13 +182,62 @@ static inline __attribute__((always_inline)) uint32_t getINodeBlockCount(struct
 	return iNode->i_blocks / ((1024 << fileSystem->superBlock.s_log_block_size) / 512);
 }
 
-static APIStatusCode getSingleIndirectionDataBlockId(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t localDataBlockIndex, void* singleIndirectionDataBlockArray, uint32_t* dataBlockId) {
+/* All inodes handled by this file system are stored inside their nodes. */
+static inline __attribute__((always_inline)) struct Ext2VirtualFileSystemNode* getExt2VirtualFileSystemNodeByINode(struct Ext2INode* iNode) {
+	return (struct Ext2VirtualFileSystemNode*) (((uint32_t) iNode) - offsetof(struct Ext2VirtualFileSystemNode, iNode));
+}
+
+static bool searchExtentCache(struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode, uint32_t dataBlockIndex, uint32_t* dataBlockId) {
+	for (int i = 0; i < EXT2_EXTENT_CACHE_SIZE; i++) {
+		struct Ext2Extent* extent = &ext2VirtualFileSystemNode->extentCache[i];
+		/* As it is unsigned, it also handles indexes before the extent. */
+		if (dataBlockIndex - extent->firstDataBlockIndex < extent->length) {
+			*dataBlockId = extent->firstDataBlockId + (dataBlockIndex - extent->firstDataBlockIndex);
+			return true;
+		}
+	}
+	return false;
+}
+
+/* It caches the run of consecutive data blocks (stored on the same indirection block) that contains the data block. */
+static void cacheExtent(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t dataBlockIndex, uint32_t localDataBlockIndex,
+		uint32_t* dataBlockIds) {
+	uint32_t dataBlockCount = mathUtilsCeilOfUint32Division(localGetSize(fileSystem, iNode), fileSystem->blockSize);
+	if (dataBlockIndex >= dataBlockCount) {
+		return;
+	}
+
+	uint32_t first = localDataBlockIndex;
+	while (first > 0 && dataBlockIds[first - 1] != 0 && dataBlockIds[first - 1] + 1 == dataBlockIds[first]) {
+		first--;
+	}
+	/* The entries after the end of the file are not valid. */
+	uint32_t maximumLast = mathUtilsMin(fileSystem->dataBlockIndexesPerBlock, localDataBlockIndex + (dataBlockCount - dataBlockIndex)) - 1;
+	uint32_t last = localDataBlockIndex;
+	while (last < maximumLast && dataBlockIds[last + 1] == dataBlockIds[last] + 1) {
+		last++;
+	}
+
+	if (last > first) {
+		struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode = getExt2VirtualFileSystemNodeByINode(iNode);
+		struct Ext2Extent* extent = &ext2VirtualFileSystemNode->extentCache[ext2VirtualFileSystemNode->nextExtentCacheIndex];
+		ext2VirtualFileSystemNode->nextExtentCacheIndex = (ext2VirtualFileSystemNode->nextExtentCacheIndex + 1) % EXT2_EXTENT_CACHE_SIZE;
+		extent->firstDataBlockIndex = dataBlockIndex - (localDataBlockIndex - first);
+		extent->firstDataBlockId = dataBlockIds[first];
+		extent->length = last - first + 1;
+	}
+}
+
+static APIStatusCode getSingleIndirectionDataBlockId(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t dataBlockIndex, uint32_t localDataBlockIndex, void* singleIndirectionDataBlockArray, uint32_t* dataBlockId) {
 	assert(localDataBlockIndex < fileSystem->dataBlockIndexesPerBlock);
 	*dataBlockId = ((uint32_t*) singleIndirectionDataBlockArray)[localDataBlockIndex];
+	if (*dataBlockId != 0) {
+		cacheExtent(fileSystem, iNode, dataBlockIndex, localDataBlockIndex, singleIndirectionDataBlockArray);
+	}
 	return SUCCESS;
 }
 
-static APIStatusCode getDoubleIndirectionDataBlockId(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t localDataBlockIndex, void* doubleIndirectionDataBlockArray, uint32_t* dataBlockId) {
+static APIStatusCode getDoubleIndirectionDataBlockId(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t dataBlockIndex, uint32_t localDataBlockIndex, void* doubleIndirectionDataBlockArray, uint32_t* dataBlockId) {
 	uint32_t dataBlockIndexesPerBlock = fileSystem->dataBlockIndexesPerBlock;
 	uint32_t index = localDataBlockIndex / dataBlockIndexesPerBlock;
 
@@ -197,13 +247,13 @@ static APIStatusCode getDoubleIndirectionDataBlockId(struct Ext2FileSystem* file
 	uint32_t blockId = ((uint32_t*) doubleIndirectionDataBlockArray)[index];
 	APIStatusCode result = readAndReserveBlockById(fileSystem, blockId, &singleIndirectionDataBlockArray);
 	if (result == SUCCESS) {
-		result = getSingleIndirectionDataBlockId(fileSystem, iNode, localDataBlockIndex % dataBlockIndexesPerBlock, singleIndirectionDataBlockArray, dataBlockId);
+		result = getSingleIndirectionDataBlockId(fileSystem, iNode, dataBlockIndex, localDataBlockIndex % dataBlockIndexesPerBlock, singleIndirectionDataBlockArray, dataBlockId);
 		releaseCachedBlockReservation(fileSystem, blockId, false);
 	}
 	return result;
 }
 
-static APIStatusCode getTripleIndirectionDataBlockId(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t localDataBlockIndex, void* tripleIndirectionDataBlockArray, uint32_t* dataBlockId) {
+static APIStatusCode getTripleIndirectionDataBlockId(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t dataBlockIndex, uint32_t localDataBlockIndex, void* tripleIndirectionDataBlockArray, uint32_t* dataBlockId) {
 	uint32_t dataBlockIndexesPerBlock = fileSystem->dataBlockIndexesPerBlock;
 	uint32_t index = localDataBlockIndex / (dataBlockIndexesPerBlock * dataBlockIndexesPerBlock);
 
@@ -213,7 +263,7 @@ static APIStatusCode getTripleIndirectionDataBlockId(struct Ext2FileSystem* file
 	uint32_t blockId = ((uint32_t*) tripleIndirectionDataBlockArray)[index];
 	APIStatusCode result = readAndReserveBlockById(fileSystem, blockId, &doubleIndirectionDataBlockArray);
 	if (result == SUCCESS) {
-		result = getDoubleIndirectionDataBlockId(fileSystem, iNode, localDataBlockIndex % (dataBlockIndexesPerBlock * dataBlockIndexesPerBlock), doubleIndirectionDataBlockArray, dataBlockId);
+		result = getDoubleIndirectionDataBlockId(fileSystem, iNode, dataBlockIndex, localDataBlockIndex % (dataBlockIndexesPerBlock * dataBlockIndexesPerBlock), doubleIndirectionDataBlockArray, dataBlockId);
 		releaseCachedBlockReservation(fileSystem, blockId, false);
 	}
 	return result;
@@ -226,13 +276,16 @@ static APIStatusCode getInodeDataBlockId(struct Ext2FileSystem* fileSystem, stru
 	if (dataBlockIndex < EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT) {
 		*dataBlockId = iNode->i_block[dataBlockIndex];
 
+	} else if (searchExtentCache(getExt2VirtualFileSystemNodeByINode(iNode), dataBlockIndex, dataBlockId)) {
+		/* There is no need to read the indirection blocks. */
+
 	} else if (dataBlockIndex < EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT + dataBlockIndexesPerBlock) {
 		/* Single indirection blocks. */
 		void* singleIndirectionDataBlockArray;
 		uint32_t blockId = iNode->i_block[EXT2_SINGLE_INDIRECTION_ENTRY_INDEX];
 		result = readAndReserveBlockById(fileSystem, blockId, &singleIndirectionDataBlockArray);
 		if (result == SUCCESS) {
-			result = getSingleIndirectionDataBlockId(fileSystem, iNode, dataBlockIndex - EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT, singleIndirectionDataBlockArray, dataBlockId);
+			result = getSingleIndirectionDataBlockId(fileSystem, iNode, dataBlockIndex, dataBlockIndex - EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT, singleIndirectionDataBlockArray, dataBlockId);
 			releaseCachedBlockReservation(fileSystem, blockId, false);
 		}
 
@@ -242,7 +295,7 @@ static APIStatusCode getInodeDataBlockId(struct Ext2FileSystem* fileSystem, stru
 		uint32_t blockId = iNode->i_block[EXT2_DOUBLE_INDIRECTION_ENTRY_INDEX];
 		result = readAndReserveBlockById(fileSystem, blockId, &doubleIndirectionDataBlockArray);
 		if (result == SUCCESS) {
-			result = getDoubleIndirectionDataBlockId(fileSystem, iNode, dataBlockIndex - EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT - dataBlockIndexesPerBlock, doubleIndirectionDataBlockArray, dataBlockId);
+			result = getDoubleIndirectionDataBlockId(fileSystem, iNode, dataBlockIndex, dataBlockIndex - EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT - dataBlockIndexesPerBlock, doubleIndirectionDataBlockArray, dataBlockId);
 			releaseCachedBlockReservation(fileSystem, blockId, false);
 		}
 
@@ -253,7 +306,7 @@ static APIStatusCode getInodeDataBlockId(struct Ext2FileSystem* fileSystem, stru
 		result = readAndReserveBlockById(fileSystem, blockId, &tripleIndirectionDataBlockArray);
 		if (result == SUCCESS) {
 			uint32_t localDataBlockIndex = (dataBlockIndex - EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT - dataBlockIndexesPerBlock - dataBlockIndexesPerBlock * dataBlockIndexesPerBlock);
-			result = getTripleIndirectionDataBlockId(fileSystem, iNode, localDataBlockIndex, tripleIndirectionDataBlockArray, dataBlockId);
+			result = getTripleIndirectionDataBlockId(fileSystem, iNode, dataBlockIndex, localDataBlockIndex, tripleIndirectionDataBlockArray, dataBlockId);
 			releaseCachedBlockReservation(fileSystem, blockId, false);
 		}
 	}
@@ -271,6 +324,141 @@ static APIStatusCode readInodeDataBlock(struct Ext2FileSystem* fileSystem, struc
 	return result;
 }
 
+/*
+ * Sequential reads are detected per open file description. The window starts small and doubles at every sequential read
+ * (up to a maximum). Any other access disables the read ahead until the file is read sequentially again.
+ */
+#define READ_AHEAD_MINIMUM_WINDOW_SIZE 4
+#define READ_AHEAD_MAXIMUM_WINDOW_SIZE 32
+
+static void readAhead(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, struct ReadAheadState* readAheadState,
+		off_t offset, size_t bufferSize) {
+	uint32_t size = localGetSize(fileSystem, iNode);
+	if (offset >= size || bufferSize == 0) {
+		return;
+	}
+
+	uint32_t firstDataBlockIndex = offset / fileSystem->blockSize;
+	if (offset == readAheadState->expectedOffset) {
+		if (readAheadState->windowSize == 0) {
+			readAheadState->windowSize = READ_AHEAD_MINIMUM_WINDOW_SIZE;
+		} else {
+			readAheadState->windowSize = mathUtilsMin(2 * readAheadState->windowSize, READ_AHEAD_MAXIMUM_WINDOW_SIZE);
+		}
+	} else {
+		readAheadState->windowSize = 0;
+		readAheadState->nextBlockIndex = firstDataBlockIndex;
+	}
+	readAheadState->expectedOffset = mathUtilsMin(size, offset + bufferSize);
+
+	if (readAheadState->windowSize > 0) {
+		uint32_t lastDataBlockIndex = (readAheadState->expectedOffset - 1) / fileSystem->blockSize;
+		lastDataBlockIndex = mathUtilsMin(lastDataBlockIndex + readAheadState->windowSize, (size - 1) / fileSystem->blockSize);
+
+		uint32_t dataBlockIndex = mathUtilsMax(firstDataBlockIndex, readAheadState->nextBlockIndex);
+		/* Does it need to prefetch more blocks? */
+		if (dataBlockIndex <= lastDataBlockIndex) {
+			struct BlockDevice* blockDevice = fileSystem->blockDevice;
+			uint32_t log2DeviceBlocksPerFileSystemBlock = mathUtilsLog2ForPowerOf2(fileSystem->blockSize / blockDevice->blockSize);
+
+			uint64_t blockIds[READ_AHEAD_MAXIMUM_WINDOW_SIZE];
+			size_t blockIdCount = 0;
+			/* The indirection blocks (if any) are read through the cache while the data block ids are collected. */
+			while (dataBlockIndex <= lastDataBlockIndex && blockIdCount < READ_AHEAD_MAXIMUM_WINDOW_SIZE) {
+				uint32_t dataBlockId;
+				if (getInodeDataBlockId(fileSystem, iNode, dataBlockIndex, NULL, &dataBlockId) != SUCCESS) {
+					break;
+				}
+				if (dataBlockId != 0) {
+					blockIds[blockIdCount++] = ((uint64_t) dataBlockId) << log2DeviceBlocksPerFileSystemBlock;
+				}
+				dataBlockIndex++;
+			}
+			readAheadState->nextBlockIndex = dataBlockIndex;
+
+			blockCacheManagerPrefetch(blockDevice, blockIds, blockIdCount);
+		}
+	}
+}
+
+/*
+ * It reads or writes (when buffer is NULL, it writes zeros) the data blocks starting at the offset that are physically
+ * contiguous using a single reservation. Only the data blocks that already exist are considered.
+ */
+#define MAXIMUM_SEGMENTS_PER_TRANSFER 8
+
+static APIStatusCode transferDataBlockRun(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, off_t offset, size_t maximumCount,
+		void* buffer, bool write, size_t* count) {
+	struct BlockDevice* blockDevice = fileSystem->blockDevice;
+	uint32_t log2DeviceBlocksPerFileSystemBlock = mathUtilsLog2ForPowerOf2(fileSystem->blockSize / blockDevice->blockSize);
+	uint32_t dataBlockCount = mathUtilsCeilOfUint32Division(localGetSize(fileSystem, iNode), fileSystem->blockSize);
+	uint32_t maximumRunLength = mathUtilsMax(1, (MAXIMUM_SEGMENTS_PER_TRANSFER - 1) * PAGE_FRAME_SIZE / fileSystem->blockSize);
+
+	int intraBlockOffset = offset % fileSystem->blockSize;
+	uint32_t dataBlockIndex = offset / fileSystem->blockSize;
+	assert(dataBlockIndex < dataBlockCount);
+	uint32_t lastDataBlockIndex = (offset + maximumCount - 1) / fileSystem->blockSize;
+
+	uint32_t firstDataBlockId;
+	APIStatusCode result = getInodeDataBlockId(fileSystem, iNode, dataBlockIndex, NULL, &firstDataBlockId);
+	if (result != SUCCESS) {
+		return result;
+	}
+	assert(firstDataBlockId != 0);
+
+	uint32_t runLength = 1;
+	while (result == SUCCESS && dataBlockIndex + runLength <= lastDataBlockIndex && dataBlockIndex + runLength < dataBlockCount
+			&& runLength < maximumRunLength) {
+		uint32_t dataBlockId;
+		result = getInodeDataBlockId(fileSystem, iNode, dataBlockIndex + runLength, NULL, &dataBlockId);
+		if (result == SUCCESS && dataBlockId == firstDataBlockId + runLength) {
+			runLength++;
+		} else {
+			break;
+		}
+	}
+
+	if (result == SUCCESS) {
+		/* A partially written block must be read first. */
+		bool read = !write || intraBlockOffset != 0 || (offset + maximumCount) % fileSystem->blockSize != 0;
+
+		struct BlockCacheSegment segments[MAXIMUM_SEGMENTS_PER_TRANSFER];
+		size_t segmentCount;
+		result = blockCacheManagerReserveRange(blockDevice, ((uint64_t) firstDataBlockId) << log2DeviceBlocksPerFileSystemBlock,
+			runLength << log2DeviceBlocksPerFileSystemBlock, read, segments, MAXIMUM_SEGMENTS_PER_TRANSFER, &segmentCount);
+		assert(result != EIO); /* All I/O errors are considered fatal. Therefore, this code will never be executed. */
+
+		if (result == SUCCESS) {
+			*count = 0;
+			for (size_t i = 0; i < segmentCount && *count < maximumCount; i++) {
+				struct BlockCacheSegment* segment = &segments[i];
+				size_t segmentSize = segment->blockCount * blockDevice->blockSize;
+				void* data = segment->data;
+
+				/* The offset only affects the first file system block. */
+				size_t skippedSize = mathUtilsMin(segmentSize, intraBlockOffset);
+				intraBlockOffset -= skippedSize;
+				data += skippedSize;
+				segmentSize -= skippedSize;
+
+				size_t localCount = mathUtilsMin(segmentSize, maximumCount - *count);
+				if (!write) {
+					memcpy(buffer + *count, data, localCount);
+				} else if (buffer != NULL) {
+					memcpy(data, buffer + *count, localCount);
+				} else {
+					memset(data, 0, localCount);
+				}
+				*count += localCount;
+			}
+
+			blockCacheManagerReleaseRange(blockDevice, segments, segmentCount, write);
+		}
+	}
+
+	return result;
+}
+
 static APIStatusCode readNextLinkedDirectoryEntry(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode,
 		struct Ext2LinkedDirectoryEntry** linkedDirectoryEntry, int* offset, uint32_t* dataBlockId, bool* endOfDirectory) {
 	assert(S_ISDIR(iNode->i_mode));
@@ -409,17 +597,12 @@ static APIStatusCode getExt2VirtualFileSystemNodeByINodeIndex(struct Ext2FileSys
 	struct Ext2VirtualFileSystemNode* selectedNode = &node;
 
 	if (B_TREE_SUCCESS != bTreeSearch(&fileSystem->ext2VirtualFileSystemNodeByINodeIndex, &selectedNode)) {
-		if (doubleLinkedListSize(&fileSystem->availableExt2VirtualFileSystemNodesList) > 0) {
-			struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListRemoveFirst(&fileSystem->availableExt2VirtualFileSystemNodesList);
-
-			uint32_t address = ((uint32_t) doubleLinkedListElement) - offsetof(struct Ext2VirtualFileSystemNode, availableListElement);
-			selectedNode = (struct Ext2VirtualFileSystemNode*) address;
-			assert(&selectedNode->availableListElement == doubleLinkedListElement);
-			assert(selectedNode->virtualFileSystemNode.usageCount == 0);
-			memset(&selectedNode->virtualFileSystemNode, 0, sizeof(struct VirtualFileSystemNode));
+		if (fileSystem->ext2VirtualFileSystemNodeCache.usedObjectCount < fileSystem->maxSimultaneouslyOpenINodes
+				&& (selectedNode = slabAllocatorAcquire(&fileSystem->ext2VirtualFileSystemNodeCache)) != NULL) {
+			memset(selectedNode, 0, sizeof(struct Ext2VirtualFileSystemNode));
 			selectedNode->virtualFileSystemNode.operations = &fileSystem->operations;
+			selectedNode->fileSystem = fileSystem;
 			selectedNode->iNodeIndex = iNodeIndex;
-			selectedNode->isDirty = false;
 
 			result = readINode(fileSystem, iNodeIndex, &selectedNode->iNode);
 			if (result == SUCCESS) {
@@ -427,10 +610,12 @@ static APIStatusCode getExt2VirtualFileSystemNodeByINodeIndex(struct Ext2FileSys
 				if (B_TREE_SUCCESS != operationResult) {
 					assert(operationResult == B_TREE_NOT_ENOUGH_MEMORY);
 					result = ENOMEM;
-					doubleLinkedListInsertBeforeFirst(&fileSystem->availableExt2VirtualFileSystemNodesList, &selectedNode->availableListElement);
-					selectedNode = NULL;
 				}
 			}
+			if (result != SUCCESS) {
+				slabAllocatorRelease(&fileSystem->ext2VirtualFileSystemNodeCache, selectedNode);
+				selectedNode = NULL;
+			}
 
 		} else {
 			selectedNode = NULL;
@@ -534,35 +719,20 @@ static APIStatusCode contextAwareRead(struct Context* context, struct Ext2Virtua
 		uint32_t size = localGetSize(fileSystem, iNode);
 		*count = 0;
 
+		if (S_ISREG(iNode->i_mode)) {
+			readAhead(fileSystem, iNode, &openFileDescription->readAheadState, openFileDescription->offset, bufferSize);
+		}
+
 		while (result == SUCCESS && openFileDescription->offset < size && bufferSize > 0) {
-			int intraBlockOffset = openFileDescription->offset % fileSystem->blockSize;
-			uint32_t dataBlockIndex = openFileDescription->offset / fileSystem->blockSize;
-
-			int localCount = size - openFileDescription->offset;
-			localCount = mathUtilsMin(localCount, bufferSize);
-			localCount = mathUtilsMin(localCount, fileSystem->blockSize);
-			if (localCount + intraBlockOffset > fileSystem->blockSize) {
-				localCount -= localCount + intraBlockOffset - fileSystem->blockSize;
-			}
+			size_t localCount = mathUtilsMin(size - openFileDescription->offset, bufferSize);
 
-			bool releaseCachedBlock = false;
-			void* data;
-			uint32_t dataBlockId = 0;
 			if (S_ISREG(iNode->i_mode) || (S_ISLNK(iNode->i_mode) && size > EXT2_SYMBOLIC_LINK_SELF_CONTAINED_DATA_MAX_SIZE)) {
-				result = readInodeDataBlock(fileSystem, iNode, dataBlockIndex, &data, &dataBlockId);
-				if (result == SUCCESS) {
-					releaseCachedBlock = true;
-				}
-
+				result = transferDataBlockRun(fileSystem, iNode, openFileDescription->offset, localCount, buffer, false, &localCount);
 			} else {
-				data = iNode->i_block;
+				memcpy(buffer, ((void*) iNode->i_block) + openFileDescription->offset, localCount);
 			}
 
 			if (result == SUCCESS) {
-				memcpy(buffer, data + intraBlockOffset, localCount);
-				if (releaseCachedBlock) {
-					releaseCachedBlockReservation(fileSystem, dataBlockId, false);
-				}
 				openFileDescription->offset += localCount;
 				*count += localCount;
 				bufferSize -= localCount;
@@ -623,19 +793,13 @@ static APIStatusCode status(struct VirtualFileSystemNode* virtualFileSystemNode,
 	return SUCCESS;
 }
 
-static void* memoryAllocatorAcquire(int reservationId, size_t size) {
-	struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, reservationId);
-	if (doubleLinkedListElement != NULL) {
-		return (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-
-	} else {
-		return NULL;
-	}
+static void* memoryAllocatorAcquire(struct SlabCache* slabCache, size_t size) {
+	assert(size <= slabCache->objectSize);
+	return slabAllocatorAcquire(slabCache);
 }
 
-static void memoryAllocatorRelease(int reservationId, void* pointer) {
-	struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) pointer);
-	memoryManagerReleasePageFrame(doubleLinkedListElement, reservationId);
+static void memoryAllocatorRelease(struct SlabCache* slabCache, void* pointer) {
+	slabAllocatorRelease(slabCache, pointer);
 }
 
 static int compare(struct Ext2VirtualFileSystemNode** element1, struct Ext2VirtualFileSystemNode** element2) {
@@ -699,6 +863,33 @@ static size_t calculateMinimumLinkedDirectoryEntrySize(size_t nameLength) {
 	return size;
 }
 
+/*
+ * It returns the index of the first bit not set that is greater than or equal to firstBitIndex (or bitCount if there is none).
+ * As the bitmaps occupy entire blocks, they can be read 32 bits at a time (the bits are stored from the least significant one).
+ */
+static uint32_t findFirstZeroBit(uint32_t* bitmap, uint32_t firstBitIndex, uint32_t bitCount) {
+	for (uint32_t wordIndex = firstBitIndex / 32; wordIndex * 32 < bitCount; wordIndex++) {
+		uint32_t word = bitmap[wordIndex];
+		if (wordIndex == firstBitIndex / 32) {
+			/* The bits before the first one are considered set. */
+			word |= (1 << (firstBitIndex % 32)) - 1;
+		}
+		if (word != 0xFFFFFFFF) {
+			return mathUtilsMin(wordIndex * 32 + __builtin_ctz(~word), bitCount);
+		}
+	}
+
+	return bitCount;
+}
+
+static inline __attribute__((always_inline)) bool isBitSet(uint32_t* bitmap, uint32_t bitIndex) {
+	return (bitmap[bitIndex / 32] & (1 << (bitIndex % 32))) != 0;
+}
+
+static inline __attribute__((always_inline)) void setBit(uint32_t* bitmap, uint32_t bitIndex) {
+	bitmap[bitIndex / 32] |= (1 << (bitIndex % 32));
+}
+
 static APIStatusCode acquireINode(struct Ext2FileSystem* fileSystem, uint32_t* iNodeIndex, bool willBecomeDirectory) {
 	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
 
@@ -714,27 +905,22 @@ static APIStatusCode acquireINode(struct Ext2FileSystem* fileSystem, uint32_t* i
 		for (int j = 0; !found && result == SUCCESS && j < fileSystem->blockGroupDescriptorsPerBlock && i < fileSystem->blockGroupsCount; j++) {
 			struct Ext2BlockGroupDescriptor* blockGroupDescriptor = &blockGroupDescriptors[j];
 			if (blockGroupDescriptor->bg_free_inodes_count > 0) {
-				uint8_t* iNodeBitmap;
+				uint32_t* iNodeBitmap;
 				result = readAndReserveBlockById(fileSystem, blockGroupDescriptor->bg_inode_bitmap, (void**) &iNodeBitmap);
 				if (result == SUCCESS) {
-					for (uint32_t k = 0; k < superBlock->s_inodes_count; k++) {
-						uint8_t value = iNodeBitmap[k / 8];
-						bool used = (value & (1 << (k % 8))) != 0;
-						if (!used) {
-							found = true;
-							if (willBecomeDirectory) {
-								blockGroupDescriptor->bg_used_dirs_count++;
-							}
-							blockGroupDescriptor->bg_free_inodes_count--;
-							superBlock->s_free_inodes_count--;
-							value = value | (1 << (k % 8));
-							iNodeBitmap[k / 8] = value;
-							releaseCachedBlockReservation(fileSystem, blockGroupDescriptor->bg_inode_bitmap, true);
-							fileSystem->isSuperBlockOrBlockGroupsDirty = true;
-							*iNodeIndex = superBlock->s_inodes_per_group * i + k + 1;
-							break;
+					uint32_t k = findFirstZeroBit(iNodeBitmap, 0, superBlock->s_inodes_per_group);
+					if (k < superBlock->s_inodes_per_group) {
+						found = true;
+						if (willBecomeDirectory) {
+							blockGroupDescriptor->bg_used_dirs_count++;
 						}
+						blockGroupDescriptor->bg_free_inodes_count--;
+						superBlock->s_free_inodes_count--;
+						setBit(iNodeBitmap, k);
+						fileSystem->isSuperBlockOrBlockGroupsDirty = true;
+						*iNodeIndex = superBlock->s_inodes_per_group * i + k + 1;
 					}
+					releaseCachedBlockReservation(fileSystem, blockGroupDescriptor->bg_inode_bitmap, found);
 
 				} else {
 					break;
@@ -778,64 +964,102 @@ static void releaseINode(struct Ext2FileSystem* fileSystem, uint32_t iNodeIndex,
 	fileSystem->isSuperBlockOrBlockGroupsDirty = true;
 }
 
-static APIStatusCode acquireDataBlock(struct Ext2FileSystem* fileSystem, uint32_t* dataBlockId) {
+static uint32_t getBlockGroupBlockCount(struct Ext2FileSystem* fileSystem, uint32_t blockGroupIndex) {
 	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
 
-	APIStatusCode result = SUCCESS;
+	/* Is it the last one? */
+	if (blockGroupIndex + 1 == fileSystem->blockGroupsCount) {
+		return superBlock->s_blocks_count - superBlock->s_first_data_block - superBlock->s_blocks_per_group * blockGroupIndex;
+	} else {
+		return superBlock->s_blocks_per_group;
+	}
+}
 
-	bool found = false;
-	int i = 0;
-	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&fileSystem->blockGroupDescriptorsPageFrameList);
-	while (!found && result == SUCCESS && doubleLinkedListElement != NULL) {
-		struct Ext2BlockGroupDescriptor* blockGroupDescriptors = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-		doubleLinkedListElement = doubleLinkedListElement->next;
+static uint32_t calculateINodeBlockGroupFirstDataBlockId(struct Ext2FileSystem* fileSystem, uint32_t iNodeIndex) {
+	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
+	return ((iNodeIndex - 1) / superBlock->s_inodes_per_group) * superBlock->s_blocks_per_group + superBlock->s_first_data_block;
+}
 
-		for (int j = 0; !found && result == SUCCESS && j < fileSystem->blockGroupDescriptorsPerBlock && i < fileSystem->blockGroupsCount; j++) {
-			struct Ext2BlockGroupDescriptor* blockGroupDescriptor = &blockGroupDescriptors[j];
-			if (blockGroupDescriptor->bg_free_blocks_count > 0) { // TODO: Honor the minimum amount reserved to root user
-				uint8_t* blockBitmap;
-				result = readAndReserveBlockById(fileSystem, blockGroupDescriptor->bg_block_bitmap, (void**) &blockBitmap);
-				if (result == SUCCESS) {
-					uint32_t blockCount;
-					/* Is it the last one? */
-					if (i + 1 == fileSystem->blockGroupsCount) {
-						blockCount = superBlock->s_blocks_count % superBlock->s_blocks_per_group;
-					} else {
-						blockCount = superBlock->s_blocks_per_group;
-					}
+/*
+ * It acquires up to maximumCount contiguous blocks from the block group starting the search at firstLocalIndex (and
+ * then from its beginning).
+ */
+static APIStatusCode acquireDataBlocksFromBlockGroup(struct Ext2FileSystem* fileSystem, uint32_t blockGroupIndex, uint32_t firstLocalIndex,
+		uint32_t maximumCount, uint32_t* firstDataBlockId, uint32_t* count) {
+	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
+	struct Ext2BlockGroupDescriptor* blockGroupDescriptor = getBlockGroupDescriptor(fileSystem, blockGroupIndex);
 
-					for (uint32_t k = 0; k < blockCount; k++) {
-						uint8_t value = blockBitmap[k / 8];
-						bool used = (value & (1 << (k % 8))) != 0;
-						if (!used) {
-							found = true;
-							blockGroupDescriptor->bg_free_blocks_count--;
-							superBlock->s_free_blocks_count--;
-							value = value | (1 << (k % 8));
-							blockBitmap[k / 8] = value;
-							releaseCachedBlockReservation(fileSystem, blockGroupDescriptor->bg_block_bitmap, true);
-							fileSystem->isSuperBlockOrBlockGroupsDirty = true;
-							*dataBlockId = superBlock->s_blocks_per_group * i + k + superBlock->s_first_data_block;
-							break;
-						}
-					}
+	APIStatusCode result = SUCCESS;
+	*count = 0;
 
-				} else {
-					break;
+	if (blockGroupDescriptor->bg_free_blocks_count > 0) { // TODO: Honor the minimum amount reserved to root user
+		uint32_t* blockBitmap;
+		result = readAndReserveBlockById(fileSystem, blockGroupDescriptor->bg_block_bitmap, (void**) &blockBitmap);
+		if (result == SUCCESS) {
+			uint32_t blockCount = getBlockGroupBlockCount(fileSystem, blockGroupIndex);
+
+			uint32_t localIndex = findFirstZeroBit(blockBitmap, firstLocalIndex, blockCount);
+			if (localIndex == blockCount && firstLocalIndex > 0) {
+				localIndex = findFirstZeroBit(blockBitmap, 0, firstLocalIndex);
+				if (localIndex == firstLocalIndex) {
+					localIndex = blockCount;
 				}
 			}
 
-			i++;
+			if (localIndex < blockCount) {
+				while (*count < maximumCount && localIndex + *count < blockCount && !isBitSet(blockBitmap, localIndex + *count)) {
+					setBit(blockBitmap, localIndex + *count);
+					(*count)++;
+				}
+				assert(*count <= blockGroupDescriptor->bg_free_blocks_count);
+
+				blockGroupDescriptor->bg_free_blocks_count -= *count;
+				superBlock->s_free_blocks_count -= *count;
+				fileSystem->isSuperBlockOrBlockGroupsDirty = true;
+				*firstDataBlockId = superBlock->s_blocks_per_group * blockGroupIndex + localIndex + superBlock->s_first_data_block;
+			}
+
+			releaseCachedBlockReservation(fileSystem, blockGroupDescriptor->bg_block_bitmap, *count > 0);
 		}
 	}
 
-	if (!found && result == SUCCESS) {
+	return result;
+}
+
+/*
+ * The search starts at the goal (usually the block that follows the last one of the file) in order to keep the blocks
+ * of a file close to each other. Then, it continues on the next block groups.
+ */
+static APIStatusCode acquireDataBlocks(struct Ext2FileSystem* fileSystem, uint32_t goalDataBlockId, uint32_t maximumCount,
+		uint32_t* firstDataBlockId, uint32_t* count) {
+	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
+
+	if (goalDataBlockId < superBlock->s_first_data_block || goalDataBlockId >= superBlock->s_blocks_count) {
+		goalDataBlockId = superBlock->s_first_data_block;
+	}
+	uint32_t goalBlockGroupIndex = (goalDataBlockId - superBlock->s_first_data_block) / superBlock->s_blocks_per_group;
+	uint32_t goalLocalIndex = (goalDataBlockId - superBlock->s_first_data_block) % superBlock->s_blocks_per_group;
+
+	APIStatusCode result = SUCCESS;
+	*count = 0;
+
+	for (uint32_t i = 0; result == SUCCESS && *count == 0 && i < fileSystem->blockGroupsCount; i++) {
+		uint32_t blockGroupIndex = (goalBlockGroupIndex + i) % fileSystem->blockGroupsCount;
+		result = acquireDataBlocksFromBlockGroup(fileSystem, blockGroupIndex, i == 0 ? goalLocalIndex : 0, maximumCount, firstDataBlockId, count);
+	}
+
+	if (result == SUCCESS && *count == 0) {
 		result = ENOSPC;
 	}
 
 	return result;
 }
 
+static APIStatusCode acquireDataBlock(struct Ext2FileSystem* fileSystem, uint32_t goalDataBlockId, uint32_t* dataBlockId) {
+	uint32_t count;
+	return acquireDataBlocks(fileSystem, goalDataBlockId, 1, dataBlockId, &count);
+}
+
 /* If the following method always fails, it will be a fatal error. */
 static void releaseDataBlock(struct Ext2FileSystem* fileSystem, uint32_t dataBlockId) {
 	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
@@ -859,6 +1083,53 @@ static void releaseDataBlock(struct Ext2FileSystem* fileSystem, uint32_t dataBlo
 	fileSystem->isSuperBlockOrBlockGroupsDirty = true;
 }
 
+/*
+ * The regular files acquire some blocks ahead (they are marked as used but they are only in memory) while they grow.
+ * Therefore, files that are written at the same time do not interleave their blocks.
+ */
+#define PREALLOCATION_WINDOW_SIZE 8
+
+static void discardPreallocatedDataBlocks(struct Ext2FileSystem* fileSystem, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode) {
+	while (ext2VirtualFileSystemNode->preallocatedDataBlockCount > 0) {
+		ext2VirtualFileSystemNode->preallocatedDataBlockCount--;
+		releaseDataBlock(fileSystem, ext2VirtualFileSystemNode->firstPreallocatedDataBlockId + ext2VirtualFileSystemNode->preallocatedDataBlockCount);
+	}
+}
+
+static APIStatusCode acquireDataBlockForINode(struct Ext2FileSystem* fileSystem, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode, uint32_t* dataBlockId) {
+	struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
+
+	APIStatusCode result = SUCCESS;
+
+	if (ext2VirtualFileSystemNode->preallocatedDataBlockCount > 0) {
+		*dataBlockId = ext2VirtualFileSystemNode->firstPreallocatedDataBlockId++;
+		ext2VirtualFileSystemNode->preallocatedDataBlockCount--;
+
+	} else {
+		uint32_t goalDataBlockId;
+		uint32_t dataBlockCount = mathUtilsCeilOfUint32Division(localGetSize(fileSystem, iNode), fileSystem->blockSize);
+		if (dataBlockCount > 0 && getInodeDataBlockId(fileSystem, iNode, dataBlockCount - 1, NULL, &goalDataBlockId) == SUCCESS) {
+			goalDataBlockId++;
+		} else {
+			goalDataBlockId = calculateINodeBlockGroupFirstDataBlockId(fileSystem, ext2VirtualFileSystemNode->iNodeIndex);
+		}
+
+		if (S_ISREG(iNode->i_mode)) {
+			uint32_t count;
+			result = acquireDataBlocks(fileSystem, goalDataBlockId, 1 + PREALLOCATION_WINDOW_SIZE, dataBlockId, &count);
+			if (result == SUCCESS) {
+				ext2VirtualFileSystemNode->firstPreallocatedDataBlockId = *dataBlockId + 1;
+				ext2VirtualFileSystemNode->preallocatedDataBlockCount = count - 1;
+			}
+
+		} else {
+			result = acquireDataBlock(fileSystem, goalDataBlockId, dataBlockId);
+		}
+	}
+
+	return result;
+}
+
 static APIStatusCode appendSingleIndirectionDataBlock(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t* singleIndirectionDataBlockId, uint32_t localDataBlockIndex, uint32_t dataBlockId) {
 	uint32_t dataBlockIndexesPerBlock = fileSystem->dataBlockIndexesPerBlock;
 	assert(0 <= localDataBlockIndex && localDataBlockIndex < dataBlockIndexesPerBlock);
@@ -868,7 +1139,7 @@ static APIStatusCode appendSingleIndirectionDataBlock(struct Ext2FileSystem* fil
 	uint32_t metaDataBlockId = 0;
 	uint32_t* singleIndirectionDataBlockArray;
 	if (localDataBlockIndex == 0) {
-		result = acquireDataBlock(fileSystem, &metaDataBlockId);
+		result = acquireDataBlock(fileSystem, dataBlockId, &metaDataBlockId);
 		if (result == SUCCESS) {
 			assert(metaDataBlockId != 0);
 			*singleIndirectionDataBlockId = metaDataBlockId;
@@ -906,7 +1177,7 @@ static APIStatusCode appendDoubleIndirectionDataBlock(struct Ext2FileSystem* fil
 	uint32_t metaDataBlockId = 0;
 	uint32_t* doubleIndirectionDataBlockArray;
 	if (localDataBlockIndex == 0) {
-		result = acquireDataBlock(fileSystem, &metaDataBlockId);
+		result = acquireDataBlock(fileSystem, dataBlockId, &metaDataBlockId);
 		if (result == SUCCESS) {
 			assert(metaDataBlockId != 0);
 			*doubleIndirectionDataBlockId = metaDataBlockId;
@@ -942,7 +1213,7 @@ static APIStatusCode appendTripleIndirectionDataBlock(struct Ext2FileSystem* fil
 	uint32_t metaDataBlockId = 0;
 	uint32_t* tripleIndirectionDataBlockArray;
 	if (localDataBlockIndex == 0) {
-		result = acquireDataBlock(fileSystem, &metaDataBlockId);
+		result = acquireDataBlock(fileSystem, dataBlockId, &metaDataBlockId);
 		if (result == SUCCESS) {
 			assert(metaDataBlockId != 0);
 			*tripleIndirectionDataBlockId = metaDataBlockId;
@@ -999,6 +1270,15 @@ static APIStatusCode appendDataBlockToInode(struct Ext2FileSystem* fileSystem, s
 	}
 
 	if (result == SUCCESS) {
+		/* An extent that ends just before the appended data block may grow. */
+		for (int i = 0; i < EXT2_EXTENT_CACHE_SIZE; i++) {
+			struct Ext2Extent* extent = &ext2VirtualFileSystemNode->extentCache[i];
+			if (extent->length > 0 && extent->firstDataBlockIndex + extent->length == dataBlockIndex
+					&& extent->firstDataBlockId + extent->length == dataBlockId) {
+				extent->length++;
+				break;
+			}
+		}
 		ext2VirtualFileSystemNode->isDirty = true;
 	}
 	return result;
@@ -1096,6 +1376,13 @@ static APIStatusCode removeLastDataBlock(struct Ext2FileSystem* fileSystem, stru
 	assert(size > 0);
 	uint32_t dataBlockIndex = mathUtilsCeilOfUint32Division(size, fileSystem->blockSize) - 1;
 
+	/* The removed data block can not be part of an extent anymore. */
+	for (int i = 0; i < EXT2_EXTENT_CACHE_SIZE; i++) {
+		struct Ext2Extent* extent = &ext2VirtualFileSystemNode->extentCache[i];
+		if (dataBlockIndex - extent->firstDataBlockIndex < extent->length) {
+			extent->length = dataBlockIndex - extent->firstDataBlockIndex;
+		}
+	}
 
 	if (dataBlockIndex < EXT2_NO_INDIRECTION_DATA_BLOCKS_COUNT) {
 		uint32_t dataBlockId = iNode->i_block[dataBlockIndex];
@@ -1180,14 +1467,13 @@ static APIStatusCode doWrite(struct Ext2VirtualFileSystemNode* ext2VirtualFileSy
 
 	while (result == SUCCESS && ammountToWrite > 0) {
 		uint32_t appendedDataBlockId = 0;
-		uint32_t dataBlockIndex;
 
 		if (buffer == NULL) {
 		}
 
 		/* Do we need another block? */
 		if (size == 0 || localOffset / fileSystem->blockSize > (size - 1) / fileSystem->blockSize) {
-			result = acquireDataBlock(fileSystem, &appendedDataBlockId);
+			result = acquireDataBlockForINode(fileSystem, ext2VirtualFileSystemNode, &appendedDataBlockId);
 			if (result == SUCCESS) {
 				result = appendDataBlockToInode(fileSystem, ext2VirtualFileSystemNode, appendedDataBlockId);
 				if (result != SUCCESS) {
@@ -1202,32 +1488,31 @@ static APIStatusCode doWrite(struct Ext2VirtualFileSystemNode* ext2VirtualFileSy
 		}
 
 		if (result == SUCCESS) {
-			dataBlockIndex = localOffset / fileSystem->blockSize;
-
-			int localCount = fileSystem->blockSize - (localOffset % fileSystem->blockSize);
-			localCount = mathUtilsMin(localCount, ammountToWrite);
-			assert(localCount <= fileSystem->blockSize);
-			assert((localCount + localOffset - 1) / fileSystem->blockSize == dataBlockIndex);
-			assert((localOffset % fileSystem->blockSize) + localCount <= fileSystem->blockSize);
-
-			uint32_t dataBlockId;
-			void* data;
+			size_t localCount;
 			if (appendedDataBlockId != 0) {
+				localCount = fileSystem->blockSize - (localOffset % fileSystem->blockSize);
+				localCount = mathUtilsMin(localCount, ammountToWrite);
+				assert(localCount <= fileSystem->blockSize);
+				assert((localCount + localOffset - 1) / fileSystem->blockSize == localOffset / fileSystem->blockSize);
+				assert((localOffset % fileSystem->blockSize) + localCount <= fileSystem->blockSize);
+
+				void* data;
 				result = reserveBlockById(fileSystem, appendedDataBlockId, &data);
-				dataBlockId = appendedDataBlockId;
+				if (result == SUCCESS) {
+					if (buffer != NULL) {
+						memcpy(data + (localOffset % fileSystem->blockSize), buffer, localCount);
+					} else {
+						memset(data + (localOffset % fileSystem->blockSize), 0, localCount);
+					}
+					releaseCachedBlockReservation(fileSystem, appendedDataBlockId, true);
+				}
+
 			} else {
-				result = readInodeDataBlock(fileSystem, iNode, dataBlockIndex, &data, &dataBlockId);
+				/* The data blocks that already exist are overwritten together. */
+				result = transferDataBlockRun(fileSystem, iNode, localOffset, ammountToWrite, buffer, true, &localCount);
 			}
-			if (result == SUCCESS) {
-				assert(dataBlockId != 0);
-				assert(appendedDataBlockId == 0 || dataBlockId == appendedDataBlockId);
 
-				if (buffer != NULL) {
-					memcpy(data + (localOffset % fileSystem->blockSize), buffer, localCount);
-				} else {
-					memset(data + (localOffset % fileSystem->blockSize), 0, localCount);
-				}
-				releaseCachedBlockReservation(fileSystem, dataBlockId, true);
+			if (result == SUCCESS) {
 				if (localOffset + localCount > size) {
 					size = localOffset + localCount;
 					iNode->i_size = size;
@@ -1339,125 +1624,388 @@ static APIStatusCode write(struct Ext2VirtualFileSystemNode* ext2VirtualFileSyst
 	return contextAwareWrite(&context, ext2VirtualFileSystemNode, openFileDescription, buffer, bufferSize, count);
 }
 
-static APIStatusCode insertINodeIntoDirectory(struct Context* context, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode, uint32_t iNodeIndex,
-		const char* name, size_t nameLength, uint8_t fileType, struct Ext2LinkedDirectoryEntry** outputLinkedDirectoryEntry, uint32_t* outputDataBlockId) {
-	assert((outputLinkedDirectoryEntry == NULL && outputDataBlockId == NULL) || (outputLinkedDirectoryEntry != NULL && outputDataBlockId != NULL));
-	assert(nameLength <= FILE_NAME_MAX_LENGTH - 1);
-
-	APIStatusCode result = SUCCESS;
+/*
+ * Indexed directories (hashed B-tree). References:
+ * - https://www.kernel.org/doc/html/latest/filesystems/ext4/directory.html
+ * - Linux's "fs/ext4/hash.c" and "fs/ext4/namei.c"
+ */
+#define DIRECTORY_INDEX_MAXIMUM_INDIRECT_LEVELS 1
+#define DIRECTORY_INDEX_DOT_DOT_OFFSET 12
+#define DIRECTORY_INDEX_ROOT_INFO_OFFSET 24
+#define DIRECTORY_INDEX_NODE_ENTRIES_OFFSET 8
+#define DIRECTORY_INDEX_BLOCK_MASK 0x00FFFFFF
+#define DIRECTORY_INDEX_END_OF_FILE_HASH 0x7FFFFFFF
+
+struct DirectoryIndexPath {
+	uint32_t hash;
+	uint8_t hashVersion;
+	int levelCount;
+	int maximumLevelCount;
+	/* For each level, the data block index of the index node and the index of the selected entry. */
+	uint32_t dataBlockIndexes[DIRECTORY_INDEX_MAXIMUM_INDIRECT_LEVELS + 1];
+	uint32_t entryIndexes[DIRECTORY_INDEX_MAXIMUM_INDIRECT_LEVELS + 1];
+	uint32_t leafDataBlockIndex;
+};
 
-	struct Ext2FileSystem* fileSystem = context->fileSystem;
-	struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
-	uint32_t size = localGetSize(fileSystem, iNode);
-	size_t newLinkedDirectoryEntryMinimumSize = calculateMinimumLinkedDirectoryEntrySize(nameLength);
+struct DirectoryIndexMapEntry {
+	uint32_t hash;
+	uint16_t offset;
+	uint16_t size;
+};
 
-	uint32_t dataBlockId = 0;
-	off_t offset = 0;
-	void* data;
-	struct Ext2LinkedDirectoryEntry* newLinkedDirectoryEntry = NULL;
+static inline __attribute__((always_inline)) uint32_t rotateLeft(uint32_t value, int count) {
+	return (value << count) | (value >> (32 - count));
+}
 
-	while (offset < size) {
-		uint32_t dataBlockIndex = offset / fileSystem->blockSize;
-		result = readInodeDataBlock(fileSystem, iNode, dataBlockIndex, &data, &dataBlockId);
-		if (result == SUCCESS) {
-			struct Ext2LinkedDirectoryEntry* currentLinkedDirectoryEntry = data + (offset % fileSystem->blockSize);
+static inline __attribute__((always_inline)) uint32_t getHashCharacter(const char* name, size_t index, bool isUnsigned) {
+	if (isUnsigned) {
+		return (uint8_t) name[index];
+	} else {
+		return (int32_t) (int8_t) name[index];
+	}
+}
 
-			if (currentLinkedDirectoryEntry->inode == 0 && currentLinkedDirectoryEntry->rec_len >= newLinkedDirectoryEntryMinimumSize) {
-				newLinkedDirectoryEntry = currentLinkedDirectoryEntry;
+static uint32_t calculateLegacyHash(const char* name, size_t nameLength, bool isUnsigned) {
+	uint32_t hash0 = 0x12A3FE2D;
+	uint32_t hash1 = 0x37ABE8F9;
 
-			} else {
-				size_t currentLinkedDirectoryEntryMinimumSize = calculateMinimumLinkedDirectoryEntrySize(currentLinkedDirectoryEntry->name_len);
-				if (currentLinkedDirectoryEntryMinimumSize + newLinkedDirectoryEntryMinimumSize <= currentLinkedDirectoryEntry->rec_len) {
-					newLinkedDirectoryEntry = ((void*) currentLinkedDirectoryEntry) + currentLinkedDirectoryEntryMinimumSize;
-					newLinkedDirectoryEntry->rec_len = currentLinkedDirectoryEntry->rec_len - currentLinkedDirectoryEntryMinimumSize;
-					currentLinkedDirectoryEntry->rec_len = currentLinkedDirectoryEntryMinimumSize;
-					assert(data + (offset % fileSystem->blockSize) + currentLinkedDirectoryEntry->rec_len == newLinkedDirectoryEntry);
-				}
-			}
+	for (size_t i = 0; i < nameLength; i++) {
+		uint32_t hash = hash1 + (hash0 ^ (getHashCharacter(name, i, isUnsigned) * 7152373));
+		if ((hash & 0x80000000) != 0) {
+			hash -= 0x7FFFFFFF;
+		}
+		hash1 = hash0;
+		hash0 = hash;
+	}
 
-			if (newLinkedDirectoryEntry != NULL) {
-				break;
+	return hash0 << 1;
+}
 
-			} else {
-				releaseCachedBlockReservation(fileSystem, dataBlockId, false);
-				offset += currentLinkedDirectoryEntry->rec_len;
-			}
+static void convertNameToHashInput(const char* name, size_t nameLength, uint32_t* input, int inputLength, bool isUnsigned) {
+	uint32_t padding = nameLength | (nameLength << 8);
+	padding |= padding << 16;
 
-		} else {
-			break;
+	uint32_t value = padding;
+	size_t length = mathUtilsMin(nameLength, (size_t) inputLength * 4);
+	for (size_t i = 0; i < length; i++) {
+		value = getHashCharacter(name, i, isUnsigned) + (value << 8);
+		if (i % 4 == 3) {
+			*input++ = value;
+			value = padding;
+			inputLength--;
 		}
 	}
 
-	/* Do we need another data block? */
-	if (result == SUCCESS && newLinkedDirectoryEntry == NULL) {
-		assert(offset % fileSystem->blockSize == 0);
+	if (--inputLength >= 0) {
+		*input++ = value;
+	}
+	while (--inputLength >= 0) {
+		*input++ = padding;
+	}
+}
 
-		if (canIncreaseSize(localGetSize(fileSystem, iNode), fileSystem->blockSize)) {
-			result = acquireDataBlock(fileSystem, &dataBlockId);
-			if (result == SUCCESS) {
-				result = appendDataBlockToInode(fileSystem, ext2VirtualFileSystemNode, dataBlockId);
-				if (result == SUCCESS) {
-					iNode->i_size += fileSystem->blockSize;
-					result = reserveBlockById(fileSystem, dataBlockId, &data);
-					if (result == SUCCESS) {
-						assert(fileSystem->blockSize >= newLinkedDirectoryEntryMinimumSize);
-						newLinkedDirectoryEntry = data;
-						newLinkedDirectoryEntry->rec_len = fileSystem->blockSize;
+#define HALF_MD4_F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define HALF_MD4_G(x, y, z) (((x) & (y)) + (((x) ^ (y)) & (z)))
+#define HALF_MD4_H(x, y, z) ((x) ^ (y) ^ (z))
+#define HALF_MD4_ROUND(f, a, b, c, d, x, s) (a += f(b, c, d) + (x), a = rotateLeft(a, s))
+#define HALF_MD4_K1 0
+#define HALF_MD4_K2 0x5A827999
+#define HALF_MD4_K3 0x6ED9EBA1
 
-					} else {
-						removeLastDataBlock(fileSystem, ext2VirtualFileSystemNode);
-					}
-				}
+static void transformHalfMD4(uint32_t* buffer, uint32_t* input) {
+	uint32_t a = buffer[0];
+	uint32_t b = buffer[1];
+	uint32_t c = buffer[2];
+	uint32_t d = buffer[3];
 
-				if (result != SUCCESS) {
-					releaseDataBlock(fileSystem, dataBlockId);
-				}
-			}
+	HALF_MD4_ROUND(HALF_MD4_F, a, b, c, d, input[0] + HALF_MD4_K1, 3);
+	HALF_MD4_ROUND(HALF_MD4_F, d, a, b, c, input[1] + HALF_MD4_K1, 7);
+	HALF_MD4_ROUND(HALF_MD4_F, c, d, a, b, input[2] + HALF_MD4_K1, 11);
+	HALF_MD4_ROUND(HALF_MD4_F, b, c, d, a, input[3] + HALF_MD4_K1, 19);
+	HALF_MD4_ROUND(HALF_MD4_F, a, b, c, d, input[4] + HALF_MD4_K1, 3);
+	HALF_MD4_ROUND(HALF_MD4_F, d, a, b, c, input[5] + HALF_MD4_K1, 7);
+	HALF_MD4_ROUND(HALF_MD4_F, c, d, a, b, input[6] + HALF_MD4_K1, 11);
+	HALF_MD4_ROUND(HALF_MD4_F, b, c, d, a, input[7] + HALF_MD4_K1, 19);
 
-		} else {
-			result = EFBIG;
-		}
+	HALF_MD4_ROUND(HALF_MD4_G, a, b, c, d, input[1] + HALF_MD4_K2, 3);
+	HALF_MD4_ROUND(HALF_MD4_G, d, a, b, c, input[3] + HALF_MD4_K2, 5);
+	HALF_MD4_ROUND(HALF_MD4_G, c, d, a, b, input[5] + HALF_MD4_K2, 9);
+	HALF_MD4_ROUND(HALF_MD4_G, b, c, d, a, input[7] + HALF_MD4_K2, 13);
+	HALF_MD4_ROUND(HALF_MD4_G, a, b, c, d, input[0] + HALF_MD4_K2, 3);
+	HALF_MD4_ROUND(HALF_MD4_G, d, a, b, c, input[2] + HALF_MD4_K2, 5);
+	HALF_MD4_ROUND(HALF_MD4_G, c, d, a, b, input[4] + HALF_MD4_K2, 9);
+	HALF_MD4_ROUND(HALF_MD4_G, b, c, d, a, input[6] + HALF_MD4_K2, 13);
+
+	HALF_MD4_ROUND(HALF_MD4_H, a, b, c, d, input[3] + HALF_MD4_K3, 3);
+	HALF_MD4_ROUND(HALF_MD4_H, d, a, b, c, input[7] + HALF_MD4_K3, 9);
+	HALF_MD4_ROUND(HALF_MD4_H, c, d, a, b, input[2] + HALF_MD4_K3, 11);
+	HALF_MD4_ROUND(HALF_MD4_H, b, c, d, a, input[6] + HALF_MD4_K3, 15);
+	HALF_MD4_ROUND(HALF_MD4_H, a, b, c, d, input[1] + HALF_MD4_K3, 3);
+	HALF_MD4_ROUND(HALF_MD4_H, d, a, b, c, input[5] + HALF_MD4_K3, 9);
+	HALF_MD4_ROUND(HALF_MD4_H, c, d, a, b, input[0] + HALF_MD4_K3, 11);
+	HALF_MD4_ROUND(HALF_MD4_H, b, c, d, a, input[4] + HALF_MD4_K3, 15);
+
+	buffer[0] += a;
+	buffer[1] += b;
+	buffer[2] += c;
+	buffer[3] += d;
+}
+
+static void transformTEA(uint32_t* buffer, uint32_t* input) {
+	uint32_t sum = 0;
+	uint32_t b0 = buffer[0];
+	uint32_t b1 = buffer[1];
+
+	for (int i = 0; i < 16; i++) {
+		sum += 0x9E3779B9;
+		b0 += ((b1 << 4) + input[0]) ^ (b1 + sum) ^ ((b1 >> 5) + input[1]);
+		b1 += ((b0 << 4) + input[2]) ^ (b0 + sum) ^ ((b0 >> 5) + input[3]);
 	}
 
-	if (newLinkedDirectoryEntry != NULL) {
-		assert(result == SUCCESS);
+	buffer[0] += b0;
+	buffer[1] += b1;
+}
 
-		iNode->i_ctime = getUnixTime(context);
-		iNode->i_mtime = getUnixTime(context);
-		ext2VirtualFileSystemNode->isDirty = true;
+static uint32_t calculateDirectoryIndexHash(struct Ext2FileSystem* fileSystem, uint8_t hashVersion, const char* name, size_t nameLength) {
+	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
+	bool isUnsigned = (superBlock->s_flags & EXT2_FLAGS_UNSIGNED_HASH) != 0;
 
-		memcpy(&newLinkedDirectoryEntry->nameFirstCharacter, name, nameLength);
-		size_t unusedCharactersCount = newLinkedDirectoryEntry->rec_len - (sizeof(struct Ext2LinkedDirectoryEntry) - 1);
-		assert(unusedCharactersCount >= nameLength);
-		unusedCharactersCount -= nameLength;
-		if (unusedCharactersCount >= 0) {
-			/* Fill the remaining characters with zero. */
-			memset(&newLinkedDirectoryEntry->nameFirstCharacter + nameLength, 0, unusedCharactersCount);
+	uint32_t buffer[4] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476};
+	if (superBlock->s_hash_seed[0] != 0 || superBlock->s_hash_seed[1] != 0 || superBlock->s_hash_seed[2] != 0 || superBlock->s_hash_seed[3] != 0) {
+		memcpy(buffer, superBlock->s_hash_seed, sizeof(buffer));
+	}
+
+	uint32_t hash;
+	uint32_t input[8];
+	switch (hashVersion) {
+		case EXT2_HASH_HALF_MD4:
+			for (size_t i = 0; i < nameLength; i += 32) {
+				convertNameToHashInput(name + i, nameLength - i, input, 8, isUnsigned);
+				transformHalfMD4(buffer, input);
+			}
+			hash = buffer[1];
+			break;
+
+		case EXT2_HASH_TEA:
+			for (size_t i = 0; i < nameLength; i += 16) {
+				convertNameToHashInput(name + i, nameLength - i, input, 4, isUnsigned);
+				transformTEA(buffer, input);
+			}
+			hash = buffer[0];
+			break;
+
+		default:
+			assert(hashVersion == EXT2_HASH_LEGACY);
+			hash = calculateLegacyHash(name, nameLength, isUnsigned);
+			break;
+	}
+
+	/* The least significant bit is reserved to mark collisions. */
+	hash = hash & ~1;
+	if (hash == (DIRECTORY_INDEX_END_OF_FILE_HASH << 1)) {
+		hash = (DIRECTORY_INDEX_END_OF_FILE_HASH - 1) << 1;
+	}
+
+	return hash;
+}
+
+static bool isDotOrDotDot(const char* name, size_t nameLength) {
+	return (nameLength == 1 && name[0] == '.') || (nameLength == 2 && name[0] == '.' && name[1] == '.');
+}
+
+static bool isDirectoryIndexed(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode) {
+	return (fileSystem->superBlock.s_feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX) != 0 && (iNode->i_flags & EXT2_INDEX_FL) != 0;
+}
+
+static bool isDirectoryIndexRootValid(struct Ext2FileSystem* fileSystem, void* data) {
+	struct Ext2LinkedDirectoryEntry* dotLinkedDirectoryEntry = data;
+	struct Ext2LinkedDirectoryEntry* dotDotLinkedDirectoryEntry = data + DIRECTORY_INDEX_DOT_DOT_OFFSET;
+	struct Ext2DirectoryIndexRootInfo* rootInfo = data + DIRECTORY_INDEX_ROOT_INFO_OFFSET;
+
+	return dotLinkedDirectoryEntry->rec_len == DIRECTORY_INDEX_DOT_DOT_OFFSET
+		&& dotDotLinkedDirectoryEntry->rec_len == fileSystem->blockSize - DIRECTORY_INDEX_DOT_DOT_OFFSET
+		&& rootInfo->reserved_zero == 0
+		&& rootInfo->hash_version <= EXT2_HASH_TEA
+		&& rootInfo->info_length == sizeof(struct Ext2DirectoryIndexRootInfo)
+		&& rootInfo->indirect_levels <= DIRECTORY_INDEX_MAXIMUM_INDIRECT_LEVELS;
+}
+
+/* It returns NULL if the index node is not valid. */
+static struct Ext2DirectoryIndexEntry* getDirectoryIndexEntries(struct Ext2FileSystem* fileSystem, void* data, bool isRoot) {
+	size_t entriesOffset;
+	if (isRoot) {
+		struct Ext2DirectoryIndexRootInfo* rootInfo = data + DIRECTORY_INDEX_ROOT_INFO_OFFSET;
+		entriesOffset = DIRECTORY_INDEX_ROOT_INFO_OFFSET + rootInfo->info_length;
+
+	} else {
+		/* It is an empty linked directory entry for those who do not understand the index. */
+		struct Ext2LinkedDirectoryEntry* linkedDirectoryEntry = data;
+		if (linkedDirectoryEntry->inode != 0 || linkedDirectoryEntry->rec_len != fileSystem->blockSize) {
+			return NULL;
 		}
-		newLinkedDirectoryEntry->name_len = nameLength;
-		newLinkedDirectoryEntry->inode = iNodeIndex;
-		newLinkedDirectoryEntry->file_type = fileType;
+		entriesOffset = DIRECTORY_INDEX_NODE_ENTRIES_OFFSET;
+	}
 
-		if (outputDataBlockId != NULL) {
-			*outputDataBlockId = dataBlockId;
-			*outputLinkedDirectoryEntry = newLinkedDirectoryEntry;
+	struct Ext2DirectoryIndexEntry* entries = data + entriesOffset;
+	struct Ext2DirectoryIndexCountLimit* countLimit = (void*) entries;
+	if (countLimit->limit != (fileSystem->blockSize - entriesOffset) / sizeof(struct Ext2DirectoryIndexEntry)
+			|| countLimit->count == 0 || countLimit->count > countLimit->limit) {
+		return NULL;
+	}
 
-		} else {
-			releaseCachedBlockReservation(fileSystem, dataBlockId, true);
+	return entries;
+}
+
+static APIStatusCode readDirectoryIndexEntries(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, uint32_t dataBlockIndex, bool isRoot,
+		struct Ext2DirectoryIndexEntry** entries, uint32_t* dataBlockId) {
+	void* data;
+	APIStatusCode result = readInodeDataBlock(fileSystem, iNode, dataBlockIndex, &data, dataBlockId);
+	if (result == SUCCESS) {
+		*entries = getDirectoryIndexEntries(fileSystem, data, isRoot);
+		if (*entries == NULL) {
+			releaseCachedBlockReservation(fileSystem, *dataBlockId, false);
 		}
+	}
+	return result;
+}
 
-	} else {
-		assert(result != SUCCESS);
+/* It walks from the root to the leaf that may contain the name. */
+static APIStatusCode probeDirectoryIndex(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, const char* name, size_t nameLength,
+		struct DirectoryIndexPath* path, bool* isValid) {
+	uint32_t dataBlockCount = localGetSize(fileSystem, iNode) / fileSystem->blockSize;
+	uint32_t dataBlockIndex = 0;
+
+	APIStatusCode result = SUCCESS;
+
+	*isValid = false;
+	path->levelCount = 0;
+	path->maximumLevelCount = 1;
+
+	if (dataBlockCount > 1) {
+		void* data;
+		uint32_t dataBlockId;
+		result = readInodeDataBlock(fileSystem, iNode, 0, &data, &dataBlockId);
+		if (result == SUCCESS) {
+			if (isDirectoryIndexRootValid(fileSystem, data)) {
+				struct Ext2DirectoryIndexRootInfo* rootInfo = data + DIRECTORY_INDEX_ROOT_INFO_OFFSET;
+				path->hashVersion = rootInfo->hash_version;
+				path->maximumLevelCount = rootInfo->indirect_levels + 1;
+				path->hash = calculateDirectoryIndexHash(fileSystem, rootInfo->hash_version, name, nameLength);
+				*isValid = true;
+			}
+			releaseCachedBlockReservation(fileSystem, dataBlockId, false);
+		}
 	}
 
+	while (result == SUCCESS && *isValid && path->levelCount < path->maximumLevelCount) {
+		struct Ext2DirectoryIndexEntry* entries;
+		uint32_t dataBlockId;
+		result = readDirectoryIndexEntries(fileSystem, iNode, dataBlockIndex, path->levelCount == 0, &entries, &dataBlockId);
+		if (result == SUCCESS) {
+			if (entries != NULL) {
+				struct Ext2DirectoryIndexCountLimit* countLimit = (void*) entries;
+
+				/* The first entry does not have a hash as it covers everything that is before the second one. */
+				int low = 1;
+				int high = countLimit->count - 1;
+				while (low <= high) {
+					int middle = (low + high) / 2;
+					if (entries[middle].hash > path->hash) {
+						high = middle - 1;
+					} else {
+						low = middle + 1;
+					}
+				}
+
+				path->dataBlockIndexes[path->levelCount] = dataBlockIndex;
+				path->entryIndexes[path->levelCount] = low - 1;
+				path->levelCount++;
+				dataBlockIndex = entries[low - 1].block & DIRECTORY_INDEX_BLOCK_MASK;
+				*isValid = 0 < dataBlockIndex && dataBlockIndex < dataBlockCount;
+				releaseCachedBlockReservation(fileSystem, dataBlockId, false);
+
+			} else {
+				*isValid = false;
+			}
+		}
+	}
+	path->leafDataBlockIndex = dataBlockIndex;
+
 	return result;
 }
 
-static APIStatusCode readLinkedDirectoryEntry(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, const char* name, size_t nameLength,
-		struct Ext2LinkedDirectoryEntry** linkedDirectoryEntry, uint32_t* dataBlockId) {
-	assert(S_ISDIR(iNode->i_mode));
+/* As names with the same hash may be split among leaves, it moves to the next leaf if it continues the current hash. */
+static APIStatusCode advanceDirectoryIndexPath(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, struct DirectoryIndexPath* path, bool* advanced) {
+	uint32_t dataBlockCount = localGetSize(fileSystem, iNode) / fileSystem->blockSize;
+	uint32_t dataBlockIndex = 0;
 
-	int offset = 0;
+	APIStatusCode result = SUCCESS;
+	*advanced = false;
+
+	int level = path->levelCount - 1;
+	bool done = false;
+	while (result == SUCCESS && !done && level >= 0) {
+		struct Ext2DirectoryIndexEntry* entries;
+		uint32_t dataBlockId;
+		result = readDirectoryIndexEntries(fileSystem, iNode, path->dataBlockIndexes[level], level == 0, &entries, &dataBlockId);
+		if (result == SUCCESS) {
+			if (entries != NULL) {
+				struct Ext2DirectoryIndexCountLimit* countLimit = (void*) entries;
+				uint32_t entryIndex = path->entryIndexes[level] + 1;
+				if (entryIndex < countLimit->count) {
+					done = true;
+					if ((entries[entryIndex].hash & ~1) == path->hash) {
+						path->entryIndexes[level] = entryIndex;
+						dataBlockIndex = entries[entryIndex].block & DIRECTORY_INDEX_BLOCK_MASK;
+						*advanced = true;
+					}
+				} else {
+					level--;
+				}
+				releaseCachedBlockReservation(fileSystem, dataBlockId, false);
+
+			} else {
+				done = true;
+			}
+		}
+	}
+
+	/* Go down through the first entries. */
+	for (level = level + 1; result == SUCCESS && *advanced && level < path->levelCount; level++) {
+		if (0 < dataBlockIndex && dataBlockIndex < dataBlockCount) {
+			struct Ext2DirectoryIndexEntry* entries;
+			uint32_t dataBlockId;
+			result = readDirectoryIndexEntries(fileSystem, iNode, dataBlockIndex, false, &entries, &dataBlockId);
+			if (result == SUCCESS) {
+				if (entries != NULL) {
+					path->dataBlockIndexes[level] = dataBlockIndex;
+					path->entryIndexes[level] = 0;
+					dataBlockIndex = entries[0].block & DIRECTORY_INDEX_BLOCK_MASK;
+					releaseCachedBlockReservation(fileSystem, dataBlockId, false);
+				} else {
+					*advanced = false;
+				}
+			}
+
+		} else {
+			*advanced = false;
+		}
+	}
+
+	if (*advanced) {
+		if (0 < dataBlockIndex && dataBlockIndex < dataBlockCount) {
+			path->leafDataBlockIndex = dataBlockIndex;
+		} else {
+			*advanced = false;
+		}
+	}
+
+	return result;
+}
+
+/* It searches for the name among the linked directory entries that start inside [offset, endOffset). */
+static APIStatusCode searchLinkedDirectoryEntry(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, int offset, int endOffset,
+		const char* name, size_t nameLength, struct Ext2LinkedDirectoryEntry** linkedDirectoryEntry, uint32_t* dataBlockId) {
 	struct Ext2LinkedDirectoryEntry* localLinkedDirectoryEntry;
 	uint32_t localDataBlockId;
 
@@ -1467,7 +2015,7 @@ static APIStatusCode readLinkedDirectoryEntry(struct Ext2FileSystem* fileSystem,
 		bool endOfDirectory;
 		result = readNextLinkedDirectoryEntry(fileSystem, iNode, &localLinkedDirectoryEntry, &offset, &localDataBlockId, &endOfDirectory);
 		if (result == SUCCESS) {
-			if (!endOfDirectory) {
+			if (!endOfDirectory && offset - localLinkedDirectoryEntry->rec_len < endOffset) {
 				if (nameLength == localLinkedDirectoryEntry->name_len && strncmp(name, (char*) &localLinkedDirectoryEntry->nameFirstCharacter, nameLength) == 0) {
 					*dataBlockId = localDataBlockId;
 					*linkedDirectoryEntry = localLinkedDirectoryEntry;
@@ -1478,6 +2026,9 @@ static APIStatusCode readLinkedDirectoryEntry(struct Ext2FileSystem* fileSystem,
 				}
 
 			} else {
+				if (!endOfDirectory) {
+					releaseCachedBlockReservation(fileSystem, localDataBlockId, false);
+				}
 				result = ENOENT;
 				break;
 			}
@@ -1490,6 +2041,428 @@ static APIStatusCode readLinkedDirectoryEntry(struct Ext2FileSystem* fileSystem,
 	return result;
 }
 
+/* It tries to find room for a new linked directory entry inside the data block (an existing entry may be split). */
+static struct Ext2LinkedDirectoryEntry* findRoomInsideDataBlock(struct Ext2FileSystem* fileSystem, void* data, size_t newLinkedDirectoryEntryMinimumSize) {
+	size_t offset = 0;
+	while (offset < fileSystem->blockSize) {
+		struct Ext2LinkedDirectoryEntry* currentLinkedDirectoryEntry = data + offset;
+		assert(currentLinkedDirectoryEntry->rec_len != 0);
+
+		if (currentLinkedDirectoryEntry->inode == 0 && currentLinkedDirectoryEntry->rec_len >= newLinkedDirectoryEntryMinimumSize) {
+			return currentLinkedDirectoryEntry;
+
+		} else {
+			size_t currentLinkedDirectoryEntryMinimumSize = calculateMinimumLinkedDirectoryEntrySize(currentLinkedDirectoryEntry->name_len);
+			if (currentLinkedDirectoryEntryMinimumSize + newLinkedDirectoryEntryMinimumSize <= currentLinkedDirectoryEntry->rec_len) {
+				struct Ext2LinkedDirectoryEntry* newLinkedDirectoryEntry = ((void*) currentLinkedDirectoryEntry) + currentLinkedDirectoryEntryMinimumSize;
+				newLinkedDirectoryEntry->rec_len = currentLinkedDirectoryEntry->rec_len - currentLinkedDirectoryEntryMinimumSize;
+				currentLinkedDirectoryEntry->rec_len = currentLinkedDirectoryEntryMinimumSize;
+				return newLinkedDirectoryEntry;
+			}
+		}
+
+		offset += currentLinkedDirectoryEntry->rec_len;
+	}
+
+	return NULL;
+}
+
+static APIStatusCode appendDirectoryDataBlock(struct Ext2FileSystem* fileSystem, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode,
+		uint32_t* dataBlockId, void** data) {
+	struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
+
+	APIStatusCode result = SUCCESS;
+
+	if (canIncreaseSize(localGetSize(fileSystem, iNode), fileSystem->blockSize)) {
+		result = acquireDataBlockForINode(fileSystem, ext2VirtualFileSystemNode, dataBlockId);
+		if (result == SUCCESS) {
+			result = appendDataBlockToInode(fileSystem, ext2VirtualFileSystemNode, *dataBlockId);
+			if (result == SUCCESS) {
+				iNode->i_size += fileSystem->blockSize;
+				result = reserveBlockById(fileSystem, *dataBlockId, data);
+				if (result != SUCCESS) {
+					removeLastDataBlock(fileSystem, ext2VirtualFileSystemNode);
+				}
+			}
+
+			if (result != SUCCESS) {
+				releaseDataBlock(fileSystem, *dataBlockId);
+			}
+		}
+
+	} else {
+		result = EFBIG;
+	}
+
+	return result;
+}
+
+static void sortDirectoryIndexMap(struct DirectoryIndexMapEntry* map, int count, bool byHash) {
+	for (int i = 1; i < count; i++) {
+		struct DirectoryIndexMapEntry mapEntry = map[i];
+		int j = i - 1;
+		while (j >= 0 && (byHash ? map[j].hash > mapEntry.hash : map[j].offset > mapEntry.offset)) {
+			map[j + 1] = map[j];
+			j--;
+		}
+		map[j + 1] = mapEntry;
+	}
+}
+
+/* It writes the mapped entries one after another. The last one takes the remaining space of the data block. */
+static void packLinkedDirectoryEntries(struct Ext2FileSystem* fileSystem, void* destination, void* source, struct DirectoryIndexMapEntry* map, int count) {
+	size_t offset = 0;
+	struct Ext2LinkedDirectoryEntry* linkedDirectoryEntry = NULL;
+	for (int i = 0; i < count; i++) {
+		linkedDirectoryEntry = destination + offset;
+		memmove(linkedDirectoryEntry, source + map[i].offset, map[i].size);
+		linkedDirectoryEntry->rec_len = map[i].size;
+		offset += map[i].size;
+	}
+	assert(linkedDirectoryEntry != NULL);
+	linkedDirectoryEntry->rec_len += fileSystem->blockSize - offset;
+}
+
+/*
+ * It moves the entries with the greatest hashes of a full leaf into a new data block. If the index node has no room
+ * for another entry, it does nothing and the caller gives up the index.
+ */
+static APIStatusCode splitDirectoryIndexLeaf(struct Ext2FileSystem* fileSystem, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode,
+		struct DirectoryIndexPath* path, size_t newLinkedDirectoryEntryMinimumSize, struct Ext2LinkedDirectoryEntry** linkedDirectoryEntry,
+		uint32_t* dataBlockId) {
+	struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
+	int level = path->levelCount - 1;
+
+	*linkedDirectoryEntry = NULL;
+
+	struct Ext2DirectoryIndexEntry* entries;
+	uint32_t indexDataBlockId;
+	bool isFull = true;
+	APIStatusCode result = readDirectoryIndexEntries(fileSystem, iNode, path->dataBlockIndexes[level], level == 0, &entries, &indexDataBlockId);
+	if (result == SUCCESS && entries != NULL) {
+		struct Ext2DirectoryIndexCountLimit* countLimit = (void*) entries;
+		isFull = countLimit->count >= countLimit->limit;
+		releaseCachedBlockReservation(fileSystem, indexDataBlockId, false);
+	}
+
+	if (result == SUCCESS && !isFull) {
+		struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
+		if (doubleLinkedListElement != NULL) {
+			struct DirectoryIndexMapEntry* map = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+
+			void* data;
+			uint32_t leafDataBlockId;
+			result = readInodeDataBlock(fileSystem, iNode, path->leafDataBlockIndex, &data, &leafDataBlockId);
+			if (result == SUCCESS) {
+				int count = 0;
+				size_t usedSize = 0;
+				for (size_t offset = 0; offset < fileSystem->blockSize; ) {
+					struct Ext2LinkedDirectoryEntry* currentLinkedDirectoryEntry = data + offset;
+					if (currentLinkedDirectoryEntry->inode != 0) {
+						map[count].hash = calculateDirectoryIndexHash(fileSystem, path->hashVersion, &currentLinkedDirectoryEntry->nameFirstCharacter,
+							currentLinkedDirectoryEntry->name_len);
+						map[count].offset = offset;
+						map[count].size = calculateMinimumLinkedDirectoryEntrySize(currentLinkedDirectoryEntry->name_len);
+						usedSize += map[count].size;
+						count++;
+					}
+					offset += currentLinkedDirectoryEntry->rec_len;
+				}
+
+				void* newData;
+				uint32_t newDataBlockId;
+				uint32_t newDataBlockIndex = localGetSize(fileSystem, iNode) / fileSystem->blockSize;
+				if (count >= 2) {
+					result = appendDirectoryDataBlock(fileSystem, ext2VirtualFileSystemNode, &newDataBlockId, &newData);
+				}
+
+				if (count >= 2 && result == SUCCESS) {
+					sortDirectoryIndexMap(map, count, true);
+
+					/* Move the greatest hashes until half of the used space has been moved. */
+					int splitIndex = count;
+					size_t movedSize = 0;
+					while (splitIndex > 1 && movedSize < usedSize / 2) {
+						splitIndex--;
+						movedSize += map[splitIndex].size;
+					}
+					uint32_t splitHash = map[splitIndex].hash;
+					bool isContinued = splitHash == map[splitIndex - 1].hash;
+
+					packLinkedDirectoryEntries(fileSystem, newData, data, &map[splitIndex], count - splitIndex);
+					/* The order is preserved to allow the entries to be moved inside the same data block. */
+					sortDirectoryIndexMap(map, splitIndex, false);
+					packLinkedDirectoryEntries(fileSystem, data, data, map, splitIndex);
+
+					result = readDirectoryIndexEntries(fileSystem, iNode, path->dataBlockIndexes[level], level == 0, &entries, &indexDataBlockId);
+					if (result == SUCCESS && entries != NULL) {
+						struct Ext2DirectoryIndexCountLimit* countLimit = (void*) entries;
+						uint32_t entryIndex = path->entryIndexes[level] + 1;
+						memmove(&entries[entryIndex + 1], &entries[entryIndex], (countLimit->count - entryIndex) * sizeof(struct Ext2DirectoryIndexEntry));
+						entries[entryIndex].hash = splitHash | (isContinued ? 1 : 0);
+						entries[entryIndex].block = newDataBlockIndex;
+						countLimit->count++;
+						releaseCachedBlockReservation(fileSystem, indexDataBlockId, true);
+
+						bool useNewDataBlock = path->hash >= splitHash;
+						*linkedDirectoryEntry = findRoomInsideDataBlock(fileSystem, useNewDataBlock ? newData : data, newLinkedDirectoryEntryMinimumSize);
+						if (*linkedDirectoryEntry != NULL) {
+							*dataBlockId = useNewDataBlock ? newDataBlockId : leafDataBlockId;
+							releaseCachedBlockReservation(fileSystem, useNewDataBlock ? leafDataBlockId : newDataBlockId, true);
+						}
+
+					} else if (result == SUCCESS) {
+						/* The new data block is not referenced by the index. Therefore, the caller must give it up. */
+						assert(*linkedDirectoryEntry == NULL);
+					}
+
+					if (*linkedDirectoryEntry == NULL) {
+						releaseCachedBlockReservation(fileSystem, newDataBlockId, true);
+						releaseCachedBlockReservation(fileSystem, leafDataBlockId, true);
+					}
+
+				} else {
+					releaseCachedBlockReservation(fileSystem, leafDataBlockId, false);
+				}
+			}
+
+			memoryManagerReleasePageFrame(doubleLinkedListElement, -1);
+
+		} else {
+			result = ENOMEM;
+		}
+	}
+
+	return result;
+}
+
+/* It sets the entry to NULL if the index can not be used (the caller will fall back to the linear format). */
+static APIStatusCode insertIntoIndexedDirectory(struct Ext2FileSystem* fileSystem, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode,
+		const char* name, size_t nameLength, struct Ext2LinkedDirectoryEntry** linkedDirectoryEntry, uint32_t* dataBlockId) {
+	struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
+	size_t newLinkedDirectoryEntryMinimumSize = calculateMinimumLinkedDirectoryEntrySize(nameLength);
+
+	*linkedDirectoryEntry = NULL;
+
+	struct DirectoryIndexPath path;
+	bool isValid;
+	APIStatusCode result = probeDirectoryIndex(fileSystem, iNode, name, nameLength, &path, &isValid);
+	if (result == SUCCESS && isValid) {
+		void* data;
+		result = readInodeDataBlock(fileSystem, iNode, path.leafDataBlockIndex, &data, dataBlockId);
+		if (result == SUCCESS) {
+			*linkedDirectoryEntry = findRoomInsideDataBlock(fileSystem, data, newLinkedDirectoryEntryMinimumSize);
+			if (*linkedDirectoryEntry == NULL) {
+				releaseCachedBlockReservation(fileSystem, *dataBlockId, false);
+				result = splitDirectoryIndexLeaf(fileSystem, ext2VirtualFileSystemNode, &path, newLinkedDirectoryEntryMinimumSize,
+					linkedDirectoryEntry, dataBlockId);
+			}
+		}
+	}
+
+	return result;
+}
+
+static bool canIndexDirectory(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode) {
+	struct Ext2SuperBlock* superBlock = &fileSystem->superBlock;
+	return (superBlock->s_feature_compat & EXT2_FEATURE_COMPAT_DIR_INDEX) != 0 && superBlock->s_def_hash_version <= EXT2_HASH_TEA
+		&& (iNode->i_flags & EXT2_INDEX_FL) == 0 && localGetSize(fileSystem, iNode) == fileSystem->blockSize;
+}
+
+/*
+ * A directory becomes indexed when its first data block gets full: all entries but "." and ".." are moved into a
+ * new data block (the first leaf) and the first data block becomes the index root.
+ */
+static APIStatusCode convertToIndexedDirectory(struct Ext2FileSystem* fileSystem, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode) {
+	struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
+
+	void* data;
+	uint32_t dataBlockId;
+	APIStatusCode result = readInodeDataBlock(fileSystem, iNode, 0, &data, &dataBlockId);
+	if (result == SUCCESS) {
+		bool converted = false;
+
+		struct Ext2LinkedDirectoryEntry* dotLinkedDirectoryEntry = data;
+		struct Ext2LinkedDirectoryEntry* dotDotLinkedDirectoryEntry = data + DIRECTORY_INDEX_DOT_DOT_OFFSET;
+		if (dotLinkedDirectoryEntry->rec_len == DIRECTORY_INDEX_DOT_DOT_OFFSET
+				&& isDotOrDotDot(&dotLinkedDirectoryEntry->nameFirstCharacter, dotLinkedDirectoryEntry->name_len) && dotLinkedDirectoryEntry->name_len == 1
+				&& isDotOrDotDot(&dotDotLinkedDirectoryEntry->nameFirstCharacter, dotDotLinkedDirectoryEntry->name_len) && dotDotLinkedDirectoryEntry->name_len == 2) {
+			void* newData;
+			uint32_t newDataBlockId;
+			result = appendDirectoryDataBlock(fileSystem, ext2VirtualFileSystemNode, &newDataBlockId, &newData);
+			if (result == SUCCESS) {
+				/* Move the remaining entries. */
+				size_t newOffset = 0;
+				struct Ext2LinkedDirectoryEntry* lastLinkedDirectoryEntry = NULL;
+				for (size_t offset = DIRECTORY_INDEX_DOT_DOT_OFFSET + dotDotLinkedDirectoryEntry->rec_len; offset < fileSystem->blockSize; ) {
+					struct Ext2LinkedDirectoryEntry* currentLinkedDirectoryEntry = data + offset;
+					if (currentLinkedDirectoryEntry->inode != 0) {
+						size_t size = calculateMinimumLinkedDirectoryEntrySize(currentLinkedDirectoryEntry->name_len);
+						lastLinkedDirectoryEntry = newData + newOffset;
+						memcpy(lastLinkedDirectoryEntry, currentLinkedDirectoryEntry, size);
+						lastLinkedDirectoryEntry->rec_len = size;
+						newOffset += size;
+					}
+					offset += currentLinkedDirectoryEntry->rec_len;
+				}
+				if (lastLinkedDirectoryEntry == NULL) {
+					lastLinkedDirectoryEntry = newData;
+					memset(lastLinkedDirectoryEntry, 0, sizeof(struct Ext2LinkedDirectoryEntry));
+				}
+				lastLinkedDirectoryEntry->rec_len += fileSystem->blockSize - newOffset;
+				releaseCachedBlockReservation(fileSystem, newDataBlockId, true);
+
+				dotDotLinkedDirectoryEntry->rec_len = fileSystem->blockSize - DIRECTORY_INDEX_DOT_DOT_OFFSET;
+				memset(data + DIRECTORY_INDEX_ROOT_INFO_OFFSET, 0, fileSystem->blockSize - DIRECTORY_INDEX_ROOT_INFO_OFFSET);
+				struct Ext2DirectoryIndexRootInfo* rootInfo = data + DIRECTORY_INDEX_ROOT_INFO_OFFSET;
+				rootInfo->hash_version = fileSystem->superBlock.s_def_hash_version;
+				rootInfo->info_length = sizeof(struct Ext2DirectoryIndexRootInfo);
+				struct Ext2DirectoryIndexEntry* entries = data + DIRECTORY_INDEX_ROOT_INFO_OFFSET + sizeof(struct Ext2DirectoryIndexRootInfo);
+				struct Ext2DirectoryIndexCountLimit* countLimit = (void*) entries;
+				countLimit->limit = (fileSystem->blockSize - DIRECTORY_INDEX_ROOT_INFO_OFFSET - sizeof(struct Ext2DirectoryIndexRootInfo))
+					/ sizeof(struct Ext2DirectoryIndexEntry);
+				countLimit->count = 1;
+				entries[0].block = 1;
+
+				iNode->i_flags |= EXT2_INDEX_FL;
+				ext2VirtualFileSystemNode->isDirty = true;
+				converted = true;
+			}
+		}
+
+		releaseCachedBlockReservation(fileSystem, dataBlockId, converted);
+	}
+
+	return result;
+}
+
+static APIStatusCode insertINodeIntoDirectory(struct Context* context, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode, uint32_t iNodeIndex,
+		const char* name, size_t nameLength, uint8_t fileType, struct Ext2LinkedDirectoryEntry** outputLinkedDirectoryEntry, uint32_t* outputDataBlockId) {
+	assert((outputLinkedDirectoryEntry == NULL && outputDataBlockId == NULL) || (outputLinkedDirectoryEntry != NULL && outputDataBlockId != NULL));
+	assert(nameLength <= FILE_NAME_MAX_LENGTH - 1);
+
+	APIStatusCode result = SUCCESS;
+
+	struct Ext2FileSystem* fileSystem = context->fileSystem;
+	struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
+	size_t newLinkedDirectoryEntryMinimumSize = calculateMinimumLinkedDirectoryEntrySize(nameLength);
+
+	uint32_t dataBlockId = 0;
+	void* data;
+	struct Ext2LinkedDirectoryEntry* newLinkedDirectoryEntry = NULL;
+
+	if (isDirectoryIndexed(fileSystem, iNode)) {
+		result = insertIntoIndexedDirectory(fileSystem, ext2VirtualFileSystemNode, name, nameLength, &newLinkedDirectoryEntry, &dataBlockId);
+	}
+
+	if (result == SUCCESS && newLinkedDirectoryEntry == NULL) {
+		if ((iNode->i_flags & EXT2_INDEX_FL) != 0) {
+			/* The index can not be maintained. Therefore, it is given up as it would become stale. */
+			iNode->i_flags &= ~EXT2_INDEX_FL;
+			ext2VirtualFileSystemNode->isDirty = true;
+		}
+
+		uint32_t dataBlockCount = localGetSize(fileSystem, iNode) / fileSystem->blockSize;
+		for (uint32_t dataBlockIndex = 0; result == SUCCESS && newLinkedDirectoryEntry == NULL && dataBlockIndex < dataBlockCount; dataBlockIndex++) {
+			result = readInodeDataBlock(fileSystem, iNode, dataBlockIndex, &data, &dataBlockId);
+			if (result == SUCCESS) {
+				newLinkedDirectoryEntry = findRoomInsideDataBlock(fileSystem, data, newLinkedDirectoryEntryMinimumSize);
+				if (newLinkedDirectoryEntry == NULL) {
+					releaseCachedBlockReservation(fileSystem, dataBlockId, false);
+				}
+			}
+		}
+	}
+
+	/* Does the directory need a second data block? It is the moment to index it. */
+	if (result == SUCCESS && newLinkedDirectoryEntry == NULL && canIndexDirectory(fileSystem, iNode) && !isDotOrDotDot(name, nameLength)) {
+		result = convertToIndexedDirectory(fileSystem, ext2VirtualFileSystemNode);
+		if (result == SUCCESS && isDirectoryIndexed(fileSystem, iNode)) {
+			result = insertIntoIndexedDirectory(fileSystem, ext2VirtualFileSystemNode, name, nameLength, &newLinkedDirectoryEntry, &dataBlockId);
+			if (result == SUCCESS && newLinkedDirectoryEntry == NULL) {
+				iNode->i_flags &= ~EXT2_INDEX_FL;
+			}
+		}
+	}
+
+	/* Do we need another data block? */
+	if (result == SUCCESS && newLinkedDirectoryEntry == NULL) {
+		result = appendDirectoryDataBlock(fileSystem, ext2VirtualFileSystemNode, &dataBlockId, &data);
+		if (result == SUCCESS) {
+			assert(fileSystem->blockSize >= newLinkedDirectoryEntryMinimumSize);
+			newLinkedDirectoryEntry = data;
+			newLinkedDirectoryEntry->rec_len = fileSystem->blockSize;
+		}
+	}
+
+	if (newLinkedDirectoryEntry != NULL) {
+		assert(result == SUCCESS);
+
+		iNode->i_ctime = getUnixTime(context);
+		iNode->i_mtime = getUnixTime(context);
+		ext2VirtualFileSystemNode->isDirty = true;
+
+		memcpy(&newLinkedDirectoryEntry->nameFirstCharacter, name, nameLength);
+		size_t unusedCharactersCount = newLinkedDirectoryEntry->rec_len - (sizeof(struct Ext2LinkedDirectoryEntry) - 1);
+		assert(unusedCharactersCount >= nameLength);
+		unusedCharactersCount -= nameLength;
+		if (unusedCharactersCount >= 0) {
+			/* Fill the remaining characters with zero. */
+			memset(&newLinkedDirectoryEntry->nameFirstCharacter + nameLength, 0, unusedCharactersCount);
+		}
+		newLinkedDirectoryEntry->name_len = nameLength;
+		newLinkedDirectoryEntry->inode = iNodeIndex;
+		newLinkedDirectoryEntry->file_type = fileType;
+
+		if (outputDataBlockId != NULL) {
+			*outputDataBlockId = dataBlockId;
+			*outputLinkedDirectoryEntry = newLinkedDirectoryEntry;
+
+		} else {
+			releaseCachedBlockReservation(fileSystem, dataBlockId, true);
+		}
+
+	} else {
+		assert(result != SUCCESS);
+	}
+
+	return result;
+}
+
+static APIStatusCode readLinkedDirectoryEntry(struct Ext2FileSystem* fileSystem, struct Ext2INode* iNode, const char* name, size_t nameLength,
+		struct Ext2LinkedDirectoryEntry** linkedDirectoryEntry, uint32_t* dataBlockId) {
+	assert(S_ISDIR(iNode->i_mode));
+
+	APIStatusCode result = SUCCESS;
+	bool isValid = false;
+
+	/* The "." and ".." entries are not indexed (they are stored before the index root). */
+	if (isDirectoryIndexed(fileSystem, iNode) && !isDotOrDotDot(name, nameLength)) {
+		struct DirectoryIndexPath path;
+		result = probeDirectoryIndex(fileSystem, iNode, name, nameLength, &path, &isValid);
+		while (result == SUCCESS && isValid) {
+			result = searchLinkedDirectoryEntry(fileSystem, iNode, path.leafDataBlockIndex * fileSystem->blockSize,
+				(path.leafDataBlockIndex + 1) * fileSystem->blockSize, name, nameLength, linkedDirectoryEntry, dataBlockId);
+			if (result == SUCCESS) {
+				break;
+
+			} else if (result == ENOENT) {
+				bool advanced;
+				result = advanceDirectoryIndexPath(fileSystem, iNode, &path, &advanced);
+				if (result == SUCCESS && !advanced) {
+					result = ENOENT;
+				}
+			}
+		}
+	}
+
+	if (result == SUCCESS && !isValid) {
+		result = searchLinkedDirectoryEntry(fileSystem, iNode, 0, localGetSize(fileSystem, iNode), name, nameLength, linkedDirectoryEntry, dataBlockId);
+	}
+
+	return result;
+}
+
 static APIStatusCode contextAwareWalk(struct Context* context, struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode,
 		const char* pathSegment, bool createIfDoesNotExist, mode_t mode, struct VirtualFileSystemNode** nextVirtualFileSystemNode, bool* created) {
 	assert(ext2VirtualFileSystemNode != NULL);
@@ -1613,6 +2586,8 @@ static APIStatusCode contextAwareChangeFileSize(struct Context* context, struct
 		}
 
 	} else if (newSize < size) {
+		discardPreallocatedDataBlocks(fileSystem, ext2VirtualFileSystemNode);
+
 		uint32_t newDataBlockCount = mathUtilsCeilOfUint32Division(newSize, fileSystem->blockSize);
 		uint32_t currentDataBlockCount = mathUtilsCeilOfUint32Division(size, fileSystem->blockSize);
 
@@ -1649,7 +2624,7 @@ static APIStatusCode contextAwareCreateDirectory(struct Context* context, struct
 	result = acquireINode(fileSystem, &iNodeIndex, true);
 	if (result == SUCCESS) {
 		assert(iNodeIndex != 0);
-		result = acquireDataBlock(fileSystem, &dataBlockId);
+		result = acquireDataBlock(fileSystem, calculateINodeBlockGroupFirstDataBlockId(fileSystem, iNodeIndex), &dataBlockId);
 		if (result == SUCCESS) {
 			struct Ext2LinkedDirectoryEntry* linkedDirectoryEntry;
 			result = reserveBlockById(fileSystem, dataBlockId, (void**) &linkedDirectoryEntry);
@@ -1939,6 +2914,8 @@ static void contextAwareAfterNodeReservationRelease(struct Context* context, str
 		struct Ext2INode* iNode = &ext2VirtualFileSystemNode->iNode;
 		struct Ext2FileSystem* fileSystem = ext2VirtualFileSystemNode->fileSystem;
 
+		discardPreallocatedDataBlocks(fileSystem, ext2VirtualFileSystemNode);
+
 		APIStatusCode result = SUCCESS;
 		if (iNode->i_links_count == 0) {
 			if (!S_ISLNK(iNode->i_mode) || localGetSize(fileSystem, iNode) > EXT2_SYMBOLIC_LINK_SELF_CONTAINED_DATA_MAX_SIZE) {
@@ -1964,8 +2941,7 @@ static void contextAwareAfterNodeReservationRelease(struct Context* context, str
 
 		enum OperationResult operationResult = bTreeRemove(&fileSystem->ext2VirtualFileSystemNodeByINodeIndex, &ext2VirtualFileSystemNode);
 		assert(operationResult == B_TREE_SUCCESS);
-		assert(!doubleLinkedListContainsFoward(&fileSystem->availableExt2VirtualFileSystemNodesList, &ext2VirtualFileSystemNode->availableListElement));
-		doubleLinkedListInsertBeforeFirst(&fileSystem->availableExt2VirtualFileSystemNodesList, &ext2VirtualFileSystemNode->availableListElement);
+		slabAllocatorRelease(&fileSystem->ext2VirtualFileSystemNodeCache, ext2VirtualFileSystemNode);
 	}
 }
 
@@ -1991,7 +2967,7 @@ static APIStatusCode contextAwareCreateSymbolicLink(struct Context* context, str
 	if (result == SUCCESS) {
 		assert(iNodeIndex != 0);
 		if (targetPathLength > EXT2_SYMBOLIC_LINK_SELF_CONTAINED_DATA_MAX_SIZE) {
-			result = acquireDataBlock(fileSystem, &dataBlockId);
+			result = acquireDataBlock(fileSystem, calculateINodeBlockGroupFirstDataBlockId(fileSystem, iNodeIndex), &dataBlockId);
 			if (result == SUCCESS) {
 				result = reserveBlockById(fileSystem, dataBlockId, &data);
 			}
@@ -2207,6 +3183,9 @@ static APIStatusCode afterUnmount(struct Ext2FileSystem* fileSystem) {
 	rootVirtualFileSystemNode->virtualFileSystemNode.usageCount--;
 	afterNodeReservationRelease(rootVirtualFileSystemNode, NULL, NULL);
 	assert(bTreeSize(&fileSystem->ext2VirtualFileSystemNodeByINodeIndex) == 0);
+	bTreeClear(&fileSystem->ext2VirtualFileSystemNodeByINodeIndex);
+	slabAllocatorReleaseCache(&fileSystem->ext2VirtualFileSystemNodeByINodeIndexNodeCache);
+	slabAllocatorReleaseCache(&fileSystem->ext2VirtualFileSystemNodeCache);
 
 	if (fileSystem->isSuperBlockOrBlockGroupsDirty) {
 		result = writeSuperBlocksAndBlockGroupTables(fileSystem);
@@ -2234,6 +3213,19 @@ static struct Ext2FileSystem* getFileSystem(struct Ext2VirtualFileSystemNode* ex
 	return ext2VirtualFileSystemNode->fileSystem;
 }
 
+static uint32_t getIdentifier(struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode) {
+	return ext2VirtualFileSystemNode->iNodeIndex;
+}
+
+static APIStatusCode acquireNodeByIdentifier(struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode, uint32_t iNodeIndex,
+		struct VirtualFileSystemNode** virtualFileSystemNode) {
+	APIStatusCode result = getExt2VirtualFileSystemNodeByINodeIndex(ext2VirtualFileSystemNode->fileSystem, iNodeIndex, (struct Ext2VirtualFileSystemNode**) virtualFileSystemNode);
+	if (result == SUCCESS) {
+		(*virtualFileSystemNode)->usageCount++;
+	}
+	return result;
+}
+
 APIStatusCode ext2FileSystemInitialize(struct Ext2FileSystem* fileSystem, struct BlockDevice* blockDevice, uint32_t maxSimultaneouslyOpenINodes) {
 	struct VirtualFileSystemOperations* operations = &fileSystem->operations;
 	memset(operations, 0, sizeof(struct VirtualFileSystemOperations));
@@ -2258,6 +3250,8 @@ APIStatusCode ext2FileSystemInitialize(struct Ext2FileSystem* fileSystem, struct
 	operations->rename = (APIStatusCode (*)(struct VirtualFileSystemNode*, struct Process*, struct VirtualFileSystemNode*, const char*,
 			struct VirtualFileSystemNode*, struct VirtualFileSystemNode*, const char*)) &rename;
 	operations->getFileSystem = (struct FileSystem* (*)(struct VirtualFileSystemNode*)) &getFileSystem;
+	operations->getIdentifier = (uint32_t (*)(struct VirtualFileSystemNode*)) &getIdentifier;
+	operations->acquireNodeByIdentifier = (APIStatusCode (*)(struct VirtualFileSystemNode*, uint32_t, struct VirtualFileSystemNode**)) &acquireNodeByIdentifier;
 
 	fileSystem->blockDevice = blockDevice;
 	doubleLinkedListInitialize(&fileSystem->blockGroupDescriptorsPageFrameList);
@@ -2272,8 +3266,10 @@ APIStatusCode ext2FileSystemInitialize(struct Ext2FileSystem* fileSystem, struct
 		result = ENOMEM;
 
 	} else {
+		slabAllocatorInitializeCache(&fileSystem->ext2VirtualFileSystemNodeByINodeIndexNodeCache, "ext2_inode_b_tree_node", PAGE_FRAME_SIZE,
+				fileSystem->ext2VirtualFileSystemNodeByINodeIndexMemoryReservationId, NULL);
 		bTreeInitialize(&fileSystem->ext2VirtualFileSystemNodeByINodeIndex, PAGE_FRAME_SIZE, sizeof(void*),
-				(void*) fileSystem->ext2VirtualFileSystemNodeByINodeIndexMemoryReservationId,
+				&fileSystem->ext2VirtualFileSystemNodeByINodeIndexNodeCache,
 				(void* (*)(void*, size_t)) &memoryAllocatorAcquire,
 				(void (*)(void*, void*)) &memoryAllocatorRelease,
 				(int (*)(const void*, const void*)) &compare
@@ -2284,26 +3280,10 @@ APIStatusCode ext2FileSystemInitialize(struct Ext2FileSystem* fileSystem, struct
 		uint64_t blockId;
 		result = blockCacheManagerReadAndReserveByOffset(blockDevice, EXT2_SUPERBLOCK_OFFSET, sizeof(struct Ext2SuperBlock) / blockDevice->blockSize, &data, &blockId);
 
-		doubleLinkedListInitialize(&fileSystem->availableExt2VirtualFileSystemNodesList);
-		doubleLinkedListInitialize(&fileSystem->ext2VirtualFileSystemNodesPageFrameList);
-		while (result == SUCCESS && doubleLinkedListSize(&fileSystem->availableExt2VirtualFileSystemNodesList) < maxSimultaneouslyOpenINodes) {
-			uint32_t ext2VirtualFileSystemNodesPerPageFrame = PAGE_FRAME_SIZE / sizeof(struct Ext2VirtualFileSystemNode);
-			struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-			if (doubleLinkedListElement == NULL) {
-				result = ENOMEM;
-
-			} else {
-				doubleLinkedListInsertAfterLast(&fileSystem->ext2VirtualFileSystemNodesPageFrameList, doubleLinkedListElement);
-				struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNodes = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-				while (result == SUCCESS && ext2VirtualFileSystemNodesPerPageFrame > 0
-						&& doubleLinkedListSize(&fileSystem->availableExt2VirtualFileSystemNodesList) < maxSimultaneouslyOpenINodes) {
-					struct Ext2VirtualFileSystemNode* ext2VirtualFileSystemNode = &ext2VirtualFileSystemNodes[--ext2VirtualFileSystemNodesPerPageFrame];
-					memset(ext2VirtualFileSystemNode, 0, sizeof(struct Ext2VirtualFileSystemNode));
-					ext2VirtualFileSystemNode->fileSystem = fileSystem;
-					doubleLinkedListInsertBeforeFirst(&fileSystem->availableExt2VirtualFileSystemNodesList, &ext2VirtualFileSystemNode->availableListElement);
-				}
-			}
-		}
+		/* The nodes are only acquired when an inode is used (up to "maxSimultaneouslyOpenINodes" of them). */
+		fileSystem->maxSimultaneouslyOpenINodes = maxSimultaneouslyOpenINodes;
+		slabAllocatorInitializeCache(&fileSystem->ext2VirtualFileSystemNodeCache, "ext2_virtual_file_system_node",
+				sizeof(struct Ext2VirtualFileSystemNode), -1, NULL);
 
 		if (result == SUCCESS) {
 			memcpy(superBlock, data, sizeof(struct Ext2SuperBlock));
@@ -2356,12 +3336,8 @@ APIStatusCode ext2FileSystemInitialize(struct Ext2FileSystem* fileSystem, struct
 				memoryManagerReleasePageFrame(doubleLinkedListElement, -1);
 			}
 
-			while (doubleLinkedListSize(&fileSystem->ext2VirtualFileSystemNodesPageFrameList) > 0) {
-				struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListRemoveFirst(&fileSystem->ext2VirtualFileSystemNodesPageFrameList);
-				memoryManagerReleasePageFrame(doubleLinkedListElement, -1);
-			}
-
 			bTreeClear(&fileSystem->ext2VirtualFileSystemNodeByINodeIndex);
+			slabAllocatorReleaseCache(&fileSystem->ext2VirtualFileSystemNodeCache);
 		}
 	}
 
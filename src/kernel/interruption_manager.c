@@ -76,7 +76,7 @@ static void appendErrorCodeInformation(struct StringStreamWriter* stringStreamWr
 	}
 }
 
-static void defaultInterruptionHandler(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
+void interruptionManagerDefaultHandler(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
 	const int BUFFER_SIZE = 1024;
 	char buffer[BUFFER_SIZE];
 	struct StringStreamWriter stringStreamWriter;
@@ -200,7 +200,7 @@ void interruptionManagerInitialize(uint32_t interruptionVectorToHandleSystemCall
 	x86InitializeIDT(interruptionVectorToHandleSystemCall);
 
 	for (int interruptionVector = 0; interruptionVector < X86_INTERRUPT_VECTOR_COUNT; interruptionVector++) {
-		interruptionManagerRegisterInterruptionHandler(interruptionVector, defaultInterruptionHandler);
+		interruptionManagerRegisterInterruptionHandler(interruptionVector, interruptionManagerDefaultHandler);
 	}
 
 	interruptionManagerInterruptionVectorToHandleSystemCall = interruptionVectorToHandleSystemCall;
@@ -223,9 +223,13 @@ void interruptionManagerRegisterSystemCallHandler(void (*newSystemCallHandler)(s
 }
 
 void __attribute__ ((cdecl)) interruptionManagerHandler(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
-	/* As just after a signal deliver or just before process normal execution resume there is a call to handle all pending signals. */
+	/*
+	 * As just after a signal deliver or just before process normal execution resume there is a call to handle all pending signals.
+	 * However, the kernel may cause a page fault in the middle of a system call while it writes on the user space memory.
+	 */
 	struct Process* process = processManagerGetCurrentProcess();
-	assert(process == NULL || !process->mightHaveAnySignalToHandle);
+	assert(process == NULL || !process->mightHaveAnySignalToHandle
+		|| (processExecutionState2->interruptionVector == X86_PAGE_FAULT_INTERRUPT_VECTOR && x86GetSegmentSelectorRPL(processExecutionState1->cs) == 0));
 
 	struct InterruptionHandler* interruptionHandler = &registeredInterruptionHandlers[processExecutionState2->interruptionVector];
 	interruptionHandler->handler(errorCode, processExecutionState1, processExecutionState2);
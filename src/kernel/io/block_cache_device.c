@@ -0,0 +1,117 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <myos.h>
+
+#include "kernel/cmos.h"
+
+#include "kernel/file_system/devices_file_system.h"
+
+#include "kernel/io/block_cache_device.h"
+#include "kernel/io/block_cache_manager.h"
+#include "kernel/io/virtual_file_system_operations.h"
+#include "kernel/io/virtual_file_system_node.h"
+
+#include "kernel/process/process.h"
+
+/*
+ * It does not transfer any data. It only allows the block cache manager parameters to be read and changed at runtime.
+ */
+
+static struct VirtualFileSystemOperations blockCacheDeviceVirtualFileSystemOperations;
+static struct VirtualFileSystemNode blockCacheDeviceVirtualFileSystemNode;
+
+static APIStatusCode open(struct VirtualFileSystemNode* virtualFileSystemNode, struct Process* process, struct OpenFileDescription** openFileDescription, int flags) {
+	assert(virtualFileSystemNode == &blockCacheDeviceVirtualFileSystemNode);
+	return SUCCESS;
+}
+
+static mode_t getMode(struct VirtualFileSystemNode* virtualFileSystemNode) {
+	assert(virtualFileSystemNode == &blockCacheDeviceVirtualFileSystemNode);
+	return S_IFCHR | S_IRUSR | S_IWUSR;
+}
+
+static APIStatusCode status(struct VirtualFileSystemNode* virtualFileSystemNode, struct Process* process, struct OpenFileDescription* openFileDescription, struct stat* statInstance) {
+	assert(virtualFileSystemNode == &blockCacheDeviceVirtualFileSystemNode);
+
+	statInstance->st_size = 0;
+	statInstance->st_dev = BLOCK_CACHE_DEVICE_ID;
+	statInstance->st_ino = 1;
+	statInstance->st_atime = cmosGetInitializationTime();
+	statInstance->st_ctime = cmosGetInitializationTime();
+	statInstance->st_mtime = cmosGetInitializationTime();
+	statInstance->st_rdev = myosCalculateUniqueId(statInstance->st_dev, statInstance->st_ino);
+	statInstance->st_nlink = 1;
+
+	return SUCCESS;
+}
+
+static enum OpenFileDescriptionOffsetRepositionPolicy getOpenFileDescriptionOffsetRepositionPolicy(struct VirtualFileSystemNode* virtualFileSystemNode) {
+	assert(virtualFileSystemNode == &blockCacheDeviceVirtualFileSystemNode);
+	return REPOSITION_NOT_ALLOWED;
+}
+
+static off_t getSize(struct VirtualFileSystemNode* virtualFileSystemNode) {
+	assert(virtualFileSystemNode == &blockCacheDeviceVirtualFileSystemNode);
+	return 0;
+}
+
+static APIStatusCode manipulateDeviceParameters(struct VirtualFileSystemNode* virtualFileSystemNode, struct Process* currentProcess,
+		struct OpenFileDescription* openFileDescription, uint32_t* request) {
+	assert(virtualFileSystemNode == &blockCacheDeviceVirtualFileSystemNode);
+
+	APIStatusCode result = SUCCESS;
+
+	if (*request == BLOCK_CACHE_GET_WRITE_BACK_PARAMETERS || *request == BLOCK_CACHE_SET_WRITE_BACK_PARAMETERS) {
+		struct BlockCacheWriteBackParameters** parameters = ((void*) request) + sizeof(void*);
+		if (processIsValidSegmentAccess(currentProcess, (uint32_t) parameters, sizeof(void*))
+				&& processIsValidSegmentAccess(currentProcess, (uint32_t) *parameters, sizeof(struct BlockCacheWriteBackParameters))) {
+			if (*request == BLOCK_CACHE_GET_WRITE_BACK_PARAMETERS) {
+				blockCacheManagerGetWriteBackParameters(*parameters);
+			} else {
+				result = blockCacheManagerSetWriteBackParameters(*parameters);
+			}
+
+		} else {
+			result = EFAULT;
+		}
+
+	} else {
+		result = EINVAL;
+	}
+
+	return result;
+}
+
+void blockCacheDeviceInitialize(void) {
+	memset(&blockCacheDeviceVirtualFileSystemNode, 0, sizeof(struct VirtualFileSystemNode));
+	blockCacheDeviceVirtualFileSystemNode.operations = &blockCacheDeviceVirtualFileSystemOperations;
+
+	memset(&blockCacheDeviceVirtualFileSystemOperations, 0, sizeof(struct VirtualFileSystemOperations));
+	blockCacheDeviceVirtualFileSystemOperations.open = &open;
+	blockCacheDeviceVirtualFileSystemOperations.getMode = &getMode;
+	blockCacheDeviceVirtualFileSystemOperations.status = &status;
+	blockCacheDeviceVirtualFileSystemOperations.getOpenFileDescriptionOffsetRepositionPolicy = &getOpenFileDescriptionOffsetRepositionPolicy;
+	blockCacheDeviceVirtualFileSystemOperations.getSize = &getSize;
+	blockCacheDeviceVirtualFileSystemOperations.manipulateDeviceParameters = &manipulateDeviceParameters;
+
+	devicesFileSystemRegisterDevice(&blockCacheDeviceVirtualFileSystemNode, "block_cache");
+}
@@ -25,53 +25,117 @@
 #include "kernel/cmos.h"
 #include "kernel/error_handler.h"
 #include "kernel/log.h"
+#include "kernel/command_scheduler.h"
 #include "kernel/memory_manager.h"
+#include "kernel/pit.h"
+#include "kernel/slab_allocator.h"
 
 #include "kernel/io/block_cache_manager.h"
 
+#include "kernel/process/process_manager.h"
+
 #include "util/b_tree.h"
 #include "util/debug_utils.h"
 #include "util/double_linked_list.h"
 #include "util/math_utils.h"
 #include "util/string_stream_writer.h"
 
+/*
+ * The replacement policy is the "full version" of 2Q. A block that is not cached (nor remembered) goes to the A1in queue
+ * (FIFO). When it is evicted from there, its id is remembered by the A1out queue (a ghost queue that does not hold data).
+ * If the block is requested again while it is remembered, it goes to the Am queue (LRU). Therefore, a sequential scan only
+ * replaces blocks of A1in and the blocks that are frequently used (like the inode tables, bitmaps and directories) survive.
+ *
+ * References:
+ * - 2Q: A Low Overhead High Performance Buffer Management Replacement Algorithm (Theodore Johnson and Dennis Shasha)
+ */
+#define A1_IN_PERCENTAGE 25
+#define A1_OUT_PERCENTAGE 50
+
+/*
+ * The dirty blocks are periodically written back when they have been dirty for too long or when there are too many of
+ * them. Therefore, the processes rarely need to write someone else's blocks while evicting. The timer only wakes up the
+ * flusher (a kernel process): it writes back while holding the kernel lock, so it sleeps while the DMA transfers are in
+ * progress instead of polling with the interruptions disabled.
+ */
+#define WRITE_BACK_INTERVAL_IN_MILLISECONDS 1000
+#define WRITE_BACK_MAXIMUM_BLOCKS_PER_INTERVAL (4 * BLOCK_DEVICE_MAXIMUM_PAGE_FRAMES_PER_TRANSFER)
+#define DEFAULT_DIRTY_RATIO 10
+#define DEFAULT_DIRTY_EXPIRATION_IN_MILLISECONDS 5000
+
+/*
+ * The cache grows (acquiring new page frames) only while the free kernel memory is above the watermark. When the memory
+ * manager runs out of page frames, the clean and unreserved blocks are given back (the oldest ones of A1in first).
+ */
+#define FREE_PAGE_FRAMES_WATERMARK_PERCENTAGE 5
+#define MINIMUM_PAGE_FRAMES_TO_RECLAIM 32
+
+enum CachedBlockQueue {
+	NO_QUEUE, /* It does not hold any valid data. */
+	A1_IN_QUEUE,
+	AM_QUEUE
+};
+
 struct CachedBlock {
 	struct DoubleLinkedListElement listElement;
 	struct DoubleLinkedListElement dirtyListElement;
 	struct BlockDevice* blockDevice;
+	struct BlockDeviceRequest blockDeviceRequest;
 	uint64_t blockId;
 	void* data;
+	uint64_t dirtyUpTimeInMilliseconds; /* When it became dirty. */
 	uint16_t usageCount;
 	bool isDirty;
+	uint8_t queue;
 };
 
-static struct BTree cachedBlockByBlockId;
+struct RememberedBlock {
+	struct DoubleLinkedListElement listElement;
+	struct BlockDevice* blockDevice;
+	uint64_t blockId;
+};
 
-static struct DoubleLinkedList availablePositionsList;
-static struct DoubleLinkedList usedPositionsList; /* It is sorted by last access. */
+static struct BTree cachedBlockByBlockId;
+static struct BTree rememberedBlockByBlockId;
+static struct SlabCache cachedBlockByBlockIdNodeCache;
+static struct SlabCache rememberedBlockByBlockIdNodeCache;
+
+static struct DoubleLinkedList freePositionsList;
+static struct DoubleLinkedList a1InAvailablePositionsList; /* It is sorted by insertion (or last release). */
+static struct DoubleLinkedList amAvailablePositionsList; /* It is sorted by last release. */
+static struct DoubleLinkedList usedPositionsList;
 static struct DoubleLinkedList dirtyList;
 
-static void* memoryAllocatorAcquire(void *unused, size_t size) {
-	struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-	if (doubleLinkedListElement != NULL) {
-		return (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-
-	} else {
-		return NULL;
-	}
+static struct DoubleLinkedList a1OutList; /* It is sorted by eviction. */
+static struct DoubleLinkedList freeRememberedBlocksList;
+
+static int a1InBlockCount;
+static int a1InMaximumBlockCount;
+
+static uint32_t a1InHitCount;
+static uint32_t amHitCount;
+static uint32_t a1OutHitCount;
+static uint32_t missCount;
+
+static uint32_t maximumCachedBlockCount;
+static uint32_t freePageFramesWatermark;
+static uint32_t pageFrameCount;
+static uint32_t reclaimedPageFrameCount;
+static bool isBusy; /* It avoids reclaiming page frames while the cache itself is being changed. */
+static struct BlockCacheWriteBackParameters writeBackParameters;
+static uint32_t writeBackCount;
+static struct Process* flusherProcess;
+
+static void* memoryAllocatorAcquire(struct SlabCache* slabCache, size_t size) {
+	assert(size <= slabCache->objectSize);
+	return slabAllocatorAcquire(slabCache);
 }
 
-static void memoryAllocatorRelease(void* unused, void* pointer) {
-	struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) pointer);
-	memoryManagerReleasePageFrame(doubleLinkedListElement, -1);
+static void memoryAllocatorRelease(struct SlabCache* slabCache, void* pointer) {
+	slabAllocatorRelease(slabCache, pointer);
 }
 
-static int compare(struct CachedBlock** cachedBlock1, struct CachedBlock** cachedBlock2) {
-	dev_t deviceId1 = (*cachedBlock1)->blockDevice->id;
-	dev_t deviceId2 = (*cachedBlock2)->blockDevice->id;
-	uint64_t blockId1 = (*cachedBlock1)->blockId;
-	uint64_t blockId2 = (*cachedBlock2)->blockId;
-
+static int compareKeys(dev_t deviceId1, uint64_t blockId1, dev_t deviceId2, uint64_t blockId2) {
 	if (deviceId1 == deviceId2 && blockId1 == blockId2) {
 		return 0;
 
@@ -91,6 +155,93 @@ static int compare(struct CachedBlock** cachedBlock1, struct CachedBlock** cache
 	}
 }
 
+static int compare(struct CachedBlock** cachedBlock1, struct CachedBlock** cachedBlock2) {
+	return compareKeys((*cachedBlock1)->blockDevice->id, (*cachedBlock1)->blockId, (*cachedBlock2)->blockDevice->id, (*cachedBlock2)->blockId);
+}
+
+static int compareRememberedBlocks(struct RememberedBlock** rememberedBlock1, struct RememberedBlock** rememberedBlock2) {
+	return compareKeys((*rememberedBlock1)->blockDevice->id, (*rememberedBlock1)->blockId, (*rememberedBlock2)->blockDevice->id, (*rememberedBlock2)->blockId);
+}
+
+static struct DoubleLinkedList* getAvailablePositionsList(struct CachedBlock* cachedBlock) {
+	if (cachedBlock->queue == AM_QUEUE) {
+		return &amAvailablePositionsList;
+	} else {
+		assert(cachedBlock->queue == A1_IN_QUEUE);
+		return &a1InAvailablePositionsList;
+	}
+}
+
+static void rememberEvictedBlock(struct CachedBlock* cachedBlock) {
+	struct RememberedBlock* rememberedBlock;
+	if (doubleLinkedListSize(&freeRememberedBlocksList) > 0) {
+		rememberedBlock = (void*) doubleLinkedListRemoveFirst(&freeRememberedBlocksList);
+
+	} else {
+		/* The oldest one is forgotten. */
+		rememberedBlock = (void*) doubleLinkedListRemoveFirst(&a1OutList);
+		if (rememberedBlock == NULL) {
+			return;
+		}
+		enum OperationResult operationResult = bTreeRemove(&rememberedBlockByBlockId, &rememberedBlock);
+		assert(operationResult == B_TREE_SUCCESS);
+	}
+
+	rememberedBlock->blockDevice = cachedBlock->blockDevice;
+	rememberedBlock->blockId = cachedBlock->blockId;
+	if (bTreeInsert(&rememberedBlockByBlockId, &rememberedBlock) == B_TREE_SUCCESS) {
+		doubleLinkedListInsertAfterLast(&a1OutList, &rememberedBlock->listElement);
+	} else {
+		doubleLinkedListInsertAfterLast(&freeRememberedBlocksList, &rememberedBlock->listElement);
+	}
+}
+
+static bool forgetEvictedBlock(struct BlockDevice* blockDevice, uint64_t blockId) {
+	struct RememberedBlock rememberedBlock;
+	rememberedBlock.blockDevice = blockDevice;
+	rememberedBlock.blockId = blockId;
+
+	struct RememberedBlock* selectedRememberedBlock = &rememberedBlock;
+	if (bTreeRemove(&rememberedBlockByBlockId, &selectedRememberedBlock) == B_TREE_SUCCESS) {
+		assert(selectedRememberedBlock != &rememberedBlock);
+		doubleLinkedListRemove(&a1OutList, &selectedRememberedBlock->listElement);
+		doubleLinkedListInsertAfterLast(&freeRememberedBlocksList, &selectedRememberedBlock->listElement);
+		return true;
+
+	} else {
+		return false;
+	}
+}
+
+/*
+ * The free positions that already have a page frame are kept at the beginning of the list.
+ */
+static bool canUseFreePosition(void) {
+	if (doubleLinkedListSize(&freePositionsList) > 0) {
+		struct CachedBlock* cachedBlock = (void*) doubleLinkedListFirst(&freePositionsList);
+		return cachedBlock->data != NULL || memoryManagerGetKernelSpaceAvailablePageFrameCount() > freePageFramesWatermark;
+	} else {
+		return false;
+	}
+}
+
+static struct CachedBlock* selectPositionToReplace(void) {
+	if (canUseFreePosition()) {
+		return (void*) doubleLinkedListRemoveFirst(&freePositionsList);
+
+	} else if (doubleLinkedListSize(&a1InAvailablePositionsList) > 0
+			&& (a1InBlockCount > a1InMaximumBlockCount || doubleLinkedListSize(&amAvailablePositionsList) == 0)) {
+		return (void*) doubleLinkedListRemoveFirst(&a1InAvailablePositionsList);
+
+	} else if (doubleLinkedListSize(&amAvailablePositionsList) > 0) {
+		return (void*) doubleLinkedListRemoveFirst(&amAvailablePositionsList);
+
+	} else {
+		/* There is nothing to replace. Therefore, it tries to grow even below the watermark. */
+		return (void*) doubleLinkedListRemoveFirst(&freePositionsList);
+	}
+}
+
 static uint64_t calculateAdjustBlockIdAndOffset(struct BlockDevice* blockDevice, uint64_t blockId, uint32_t* offset) {
 	uint64_t adjustedBlockId;
 	/* Are there multiple blocks per page frame? */
@@ -115,6 +266,68 @@ static uint64_t calculateAdjustBlockIdAndOffset(struct BlockDevice* blockDevice,
 	return adjustedBlockId;
 }
 
+static void submitTransfer(struct BlockDevice* blockDevice, struct CachedBlock* cachedBlock, uint64_t blockId, bool write) {
+	struct BlockDeviceRequest* blockDeviceRequest = &cachedBlock->blockDeviceRequest;
+	blockDeviceRequest->firstBlockId = blockId;
+	blockDeviceRequest->pageFrame = cachedBlock->data;
+	blockDeviceRequest->write = write;
+	blockDeviceSubmitRequest(blockDevice, blockDeviceRequest);
+}
+
+static APIStatusCode evictBlock(struct CachedBlock* cachedBlock) {
+	APIStatusCode result = SUCCESS;
+
+	assert(cachedBlock->usageCount == 0);
+
+	if (cachedBlock->queue == A1_IN_QUEUE) {
+		a1InBlockCount--;
+		rememberEvictedBlock(cachedBlock);
+	}
+	cachedBlock->queue = NO_QUEUE;
+
+	enum OperationResult operationResult = bTreeRemove(&cachedBlockByBlockId, &cachedBlock);
+	if (operationResult == B_TREE_SUCCESS) {
+		assert(cachedBlock->data != NULL);
+
+		/* Do we need to write data back to the disk? */
+		if (cachedBlock->isDirty) {
+			cachedBlock->isDirty = false;
+			assert(doubleLinkedListContainsFoward(&dirtyList, &cachedBlock->dirtyListElement));
+			submitTransfer(cachedBlock->blockDevice, cachedBlock, cachedBlock->blockId, true);
+			if (!blockDeviceDispatchRequests(cachedBlock->blockDevice)) {
+				assert(false); /* All I/O errors are considered fatal. Therefore, this code will never be executed. */
+			}
+			doubleLinkedListRemove(&dirtyList, &cachedBlock->dirtyListElement);
+		}
+
+	} else if (cachedBlock->data == NULL) {
+		struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
+		if (doubleLinkedListElement != NULL) {
+			cachedBlock->data = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+			pageFrameCount++;
+		} else {
+			result = ENOMEM;
+		}
+	}
+	assert(!cachedBlock->isDirty);
+
+	return result;
+}
+
+/*
+ * It must be called after the block has been inserted into the tree. It returns true if the block was remembered by the A1out queue.
+ */
+static bool assignQueue(struct CachedBlock* cachedBlock) {
+	if (forgetEvictedBlock(cachedBlock->blockDevice, cachedBlock->blockId)) {
+		cachedBlock->queue = AM_QUEUE;
+		return true;
+	} else {
+		cachedBlock->queue = A1_IN_QUEUE;
+		a1InBlockCount++;
+		return false;
+	}
+}
+
 void blockCacheManageReleaseReservation(struct BlockDevice* blockDevice, uint64_t blockId, bool modified) {
 	uint32_t offset;
 	uint64_t adjustedBlockId = calculateAdjustBlockIdAndOffset(blockDevice, blockId, &offset);
@@ -132,7 +345,8 @@ void blockCacheManageReleaseReservation(struct BlockDevice* blockDevice, uint64_
 		assert(selectedCacheBlock->usageCount > 0);
 
 		if (!selectedCacheBlock->isDirty && modified) {
-			doubleLinkedListInsertAfterLast(&dirtyList, &selectedCacheBlock->dirtyListElement);
+			selectedCacheBlock->dirtyUpTimeInMilliseconds = pitGetUpTimeInMilliseconds();
+			doubleLinkedListInsertAfterLast(&dirtyList, &selectedCacheBlock->dirtyListElement); /* The list is sorted by the time the blocks became dirty. */
 		}
 		selectedCacheBlock->isDirty = selectedCacheBlock->isDirty || modified;
 		assert(!selectedCacheBlock->isDirty || doubleLinkedListContainsFoward(&dirtyList, &selectedCacheBlock->dirtyListElement));
@@ -140,7 +354,7 @@ void blockCacheManageReleaseReservation(struct BlockDevice* blockDevice, uint64_
 			assert(doubleLinkedListContainsBackward(&usedPositionsList, &selectedCacheBlock->listElement));
 			doubleLinkedListRemove(&usedPositionsList, &selectedCacheBlock->listElement);
 
-			doubleLinkedListInsertAfterLast(&availablePositionsList, &selectedCacheBlock->listElement); /* LRU block goes last */
+			doubleLinkedListInsertAfterLast(getAvailablePositionsList(selectedCacheBlock), &selectedCacheBlock->listElement); /* LRU block goes last */
 		}
 
 	} else {
@@ -155,14 +369,14 @@ APIStatusCode blockCacheManagerReadAndReserveByOffset(struct BlockDevice* blockD
 	return blockCacheManagerReadAndReserve(blockDevice, *firstBlockId, blockCount, data);
 }
 
-static APIStatusCode commonBlockReserve(struct BlockDevice* blockDevice, uint64_t firstBlockId, uint32_t blockCount, bool read, void** data) {
-	assert(blockCount * blockDevice->blockSize <= PAGE_FRAME_SIZE);
-
+/*
+ * If the page frame is not cached, its transfer is only submitted. The caller must dispatch the device requests before
+ * accessing the data.
+ */
+static APIStatusCode reservePageFrame(struct BlockDevice* blockDevice, uint64_t adjustedBlockId, bool read,
+		struct CachedBlock** reservedCachedBlock, bool* isTransferPending) {
 	APIStatusCode result = SUCCESS;
 
-	uint32_t offset;
-	uint64_t adjustedBlockId = calculateAdjustBlockIdAndOffset(blockDevice, firstBlockId, &offset);
-
 	struct CachedBlock cachedBlock;
 	cachedBlock.blockDevice = blockDevice;
 	cachedBlock.blockId = adjustedBlockId;
@@ -173,15 +387,21 @@ static APIStatusCode commonBlockReserve(struct BlockDevice* blockDevice, uint64_
 	if (operationResult == B_TREE_SUCCESS) {
 		assert(selectedCacheBlock != &cachedBlock);
 
+		if (selectedCacheBlock->queue == AM_QUEUE) {
+			amHitCount++;
+		} else {
+			a1InHitCount++;
+		}
+
 		if (selectedCacheBlock->usageCount == 0) {
-			assert(doubleLinkedListContainsBackward(&availablePositionsList, &selectedCacheBlock->listElement));
-			doubleLinkedListRemove(&availablePositionsList, &selectedCacheBlock->listElement);
+			struct DoubleLinkedList* availablePositionsList = getAvailablePositionsList(selectedCacheBlock);
+			assert(doubleLinkedListContainsBackward(availablePositionsList, &selectedCacheBlock->listElement));
+			doubleLinkedListRemove(availablePositionsList, &selectedCacheBlock->listElement);
 		} else {
 			assert(doubleLinkedListContainsBackward(&usedPositionsList, &selectedCacheBlock->listElement));
 			doubleLinkedListRemove(&usedPositionsList, &selectedCacheBlock->listElement);
 		}
 
-		*data = selectedCacheBlock->data + offset;
 		selectedCacheBlock->usageCount++;
 
 		doubleLinkedListInsertAfterLast(&usedPositionsList, &selectedCacheBlock->listElement); /* LRU block goes last */
@@ -189,76 +409,127 @@ static APIStatusCode commonBlockReserve(struct BlockDevice* blockDevice, uint64_
 	} else {
 		assert(operationResult == B_TREE_NOTHING_FOUND);
 
-		selectedCacheBlock = NULL;
-
 		/* Is there any available position? */
-		if (doubleLinkedListSize(&availablePositionsList) > 0) {
-			selectedCacheBlock = (void*) doubleLinkedListRemoveFirst(&availablePositionsList);
-			assert(selectedCacheBlock->usageCount == 0);
+		selectedCacheBlock = selectPositionToReplace();
+		if (selectedCacheBlock != NULL) {
+			result = evictBlock(selectedCacheBlock);
+		} else {
+			result = ENOMEM;
+		}
+
+		if (result == SUCCESS) {
+			selectedCacheBlock->blockDevice = blockDevice;
+			selectedCacheBlock->blockId = adjustedBlockId;
 
-			operationResult = bTreeRemove(&cachedBlockByBlockId, &selectedCacheBlock);
+			operationResult = bTreeInsert(&cachedBlockByBlockId, &selectedCacheBlock);
 			if (operationResult == B_TREE_SUCCESS) {
-				assert(selectedCacheBlock->data != NULL);
-
-				/* Do we need to write data back to the disk? */
-				if (selectedCacheBlock->isDirty) {
-					selectedCacheBlock->isDirty = false;
-					assert(doubleLinkedListContainsFoward(&dirtyList, &selectedCacheBlock->dirtyListElement));
-					blockDevice->writeBlocks(blockDevice, selectedCacheBlock->blockId, PAGE_FRAME_SIZE / blockDevice->blockSize, selectedCacheBlock->data);
-					doubleLinkedListRemove(&dirtyList, &selectedCacheBlock->dirtyListElement);
+				/* Read the data. */
+				if (read) {
+					assert(blockDevice->maximumBlocksPerRead >= PAGE_FRAME_SIZE / blockDevice->blockSize);
+					submitTransfer(blockDevice, selectedCacheBlock, adjustedBlockId, false);
+					*isTransferPending = true;
 				}
 
-			} else if (selectedCacheBlock->data == NULL) {
-				struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-				if (doubleLinkedListElement != NULL) {
-					selectedCacheBlock->data = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+				if (assignQueue(selectedCacheBlock)) {
+					a1OutHitCount++;
 				} else {
-					result = ENOMEM;
+					missCount++;
 				}
-			}
-			assert(!selectedCacheBlock->isDirty);
+				selectedCacheBlock->usageCount = 1;
+				selectedCacheBlock->isDirty = false;
+				doubleLinkedListInsertAfterLast(&usedPositionsList, &selectedCacheBlock->listElement);
 
-		} else {
-			result = ENOMEM;
+			} else {
+				assert(operationResult == B_TREE_NOT_ENOUGH_MEMORY);
+				result = ENOMEM;
+			}
 		}
 
-		if (result == SUCCESS) {
-			/* Read the data. */
-			if (read || PAGE_FRAME_SIZE > blockCount * blockDevice->blockSize) {
-				/*
-				 * If it is reading less blocks than a page frame can hold we, necessarily, need to read the data.
-				 * Otherwise, if later, a block that belongs to the same page frame is requested, the data will not be there and it will not be read as well (as there will be no cache miss).
-				 */
-				assert(blockDevice->maximumBlocksPerRead >= PAGE_FRAME_SIZE / blockDevice->blockSize);
-				if (!blockDevice->readBlocks(blockDevice, adjustedBlockId, PAGE_FRAME_SIZE / blockDevice->blockSize, selectedCacheBlock->data)) {
-					assert(false); /* All I/O errors are considered fatal. Therefore, this code will never be executed. */
-					result = EIO;
-				}
+		if (result != SUCCESS && selectedCacheBlock != NULL) {
+			if (selectedCacheBlock->data != NULL) {
+				doubleLinkedListInsertBeforeFirst(&freePositionsList, &selectedCacheBlock->listElement);
+			} else {
+				doubleLinkedListInsertAfterLast(&freePositionsList, &selectedCacheBlock->listElement);
 			}
+		}
+	}
 
-			if (result == SUCCESS) {
-				selectedCacheBlock->blockDevice = blockDevice;
-				selectedCacheBlock->blockId = adjustedBlockId;
+	*reservedCachedBlock = selectedCacheBlock;
 
-				operationResult = bTreeInsert(&cachedBlockByBlockId, &selectedCacheBlock);
-				if (operationResult == B_TREE_SUCCESS) {
-					selectedCacheBlock->usageCount = 1;
-					selectedCacheBlock->isDirty = false;
-					doubleLinkedListInsertAfterLast(&usedPositionsList, &selectedCacheBlock->listElement);
-					*data = selectedCacheBlock->data + offset;
+	return result;
+}
 
-				} else {
-					assert(operationResult == B_TREE_NOT_ENOUGH_MEMORY);
-					result = ENOMEM;
-				}
-			}
-		}
+/*
+ * It reserves the blocks page frame by page frame (each one becomes a segment). All the page frames that are not cached
+ * are read using a single dispatch. Therefore, the contiguous ones are transferred by a single device command. If it can
+ * not reserve the whole range (there are not enough segments or memory), it reserves only its beginning.
+ */
+APIStatusCode blockCacheManagerReserveRange(struct BlockDevice* blockDevice, uint64_t firstBlockId, uint32_t blockCount, bool read,
+		struct BlockCacheSegment* segments, size_t maximumSegmentCount, size_t* segmentCount) {
+	assert(blockCount > 0);
+	assert(maximumSegmentCount > 0);
 
-		if (result != SUCCESS && selectedCacheBlock != NULL) {
-			doubleLinkedListInsertBeforeFirst(&availablePositionsList, &selectedCacheBlock->listElement);
+	APIStatusCode result = SUCCESS;
+	bool wasBusy = isBusy;
+	isBusy = true;
+
+	uint32_t blocksPerPageFrame = mathUtilsMax(1, PAGE_FRAME_SIZE / blockDevice->blockSize);
+	bool isTransferPending = false;
+
+	*segmentCount = 0;
+	while (result == SUCCESS && blockCount > 0 && *segmentCount < maximumSegmentCount) {
+		uint32_t offset;
+		uint64_t adjustedBlockId = calculateAdjustBlockIdAndOffset(blockDevice, firstBlockId, &offset);
+		uint32_t segmentBlockCount = mathUtilsMin(blockCount, blocksPerPageFrame - offset / blockDevice->blockSize);
+
+		/*
+		 * If it is reserving less blocks than a page frame can hold we, necessarily, need to read the data.
+		 * Otherwise, if later, a block that belongs to the same page frame is requested, the data will not be there and it will not be read as well (as there will be no cache miss).
+		 */
+		struct CachedBlock* cachedBlock;
+		result = reservePageFrame(blockDevice, adjustedBlockId, read || segmentBlockCount < blocksPerPageFrame, &cachedBlock, &isTransferPending);
+		if (result == SUCCESS) {
+			struct BlockCacheSegment* segment = &segments[(*segmentCount)++];
+			segment->data = cachedBlock->data + offset;
+			segment->firstBlockId = firstBlockId;
+			segment->blockCount = segmentBlockCount;
+
+			firstBlockId += segmentBlockCount;
+			blockCount -= segmentBlockCount;
 		}
 	}
 
+	if (isTransferPending && !blockDeviceDispatchRequests(blockDevice)) {
+		assert(false); /* All I/O errors are considered fatal. Therefore, this code will never be executed. */
+		result = EIO;
+
+	} else if (*segmentCount > 0) {
+		result = SUCCESS;
+	}
+
+	isBusy = wasBusy;
+
+	return result;
+}
+
+void blockCacheManagerReleaseRange(struct BlockDevice* blockDevice, struct BlockCacheSegment* segments, size_t segmentCount, bool modified) {
+	for (size_t i = 0; i < segmentCount; i++) {
+		blockCacheManageReleaseReservation(blockDevice, segments[i].firstBlockId, modified);
+	}
+}
+
+static APIStatusCode commonBlockReserve(struct BlockDevice* blockDevice, uint64_t firstBlockId, uint32_t blockCount, bool read, void** data) {
+	assert(blockCount * blockDevice->blockSize <= PAGE_FRAME_SIZE);
+
+	struct BlockCacheSegment segment;
+	size_t segmentCount;
+	APIStatusCode result = blockCacheManagerReserveRange(blockDevice, firstBlockId, blockCount, read, &segment, 1, &segmentCount);
+	if (result == SUCCESS) {
+		assert(segmentCount == 1);
+		assert(segment.blockCount == blockCount);
+		*data = segment.data;
+	}
+
 	return result;
 }
 
@@ -270,39 +541,188 @@ APIStatusCode blockCacheManagerReadAndReserve(struct BlockDevice* blockDevice, u
 	return commonBlockReserve(blockDevice, firstBlockId, blockCount, true, data);
 }
 
+/*
+ * It reads (if they are not cached yet) the page frames that hold the informed blocks using a single dispatch. Therefore,
+ * consecutive blocks are transferred by a single device command. It is only a hint: it gives up (silently) when it would
+ * need to write a dirty block back or to evict a block from the Am queue. The prefetched blocks are not reserved and
+ * enter the A1in queue as any other block read for the first time.
+ */
+void blockCacheManagerPrefetch(struct BlockDevice* blockDevice, uint64_t* blockIds, size_t blockIdCount) {
+	struct DoubleLinkedList prefetchedBlocksList;
+	doubleLinkedListInitialize(&prefetchedBlocksList);
+
+	bool wasBusy = isBusy;
+	isBusy = true;
+
+	assert(blockDevice->maximumBlocksPerRead >= PAGE_FRAME_SIZE / blockDevice->blockSize);
+
+	for (size_t i = 0; i < blockIdCount; i++) {
+		uint32_t offset;
+		uint64_t adjustedBlockId = calculateAdjustBlockIdAndOffset(blockDevice, blockIds[i], &offset);
+
+		struct CachedBlock cachedBlock;
+		cachedBlock.blockDevice = blockDevice;
+		cachedBlock.blockId = adjustedBlockId;
+
+		struct CachedBlock* selectedCacheBlock = &cachedBlock;
+		if (bTreeSearch(&cachedBlockByBlockId, &selectedCacheBlock) == B_TREE_SUCCESS) {
+			/* It is already cached or it is about to be (more than one block per page frame). */
+			continue;
+		}
+
+		if (canUseFreePosition()) {
+			selectedCacheBlock = (void*) doubleLinkedListRemoveFirst(&freePositionsList);
+		} else if (doubleLinkedListSize(&a1InAvailablePositionsList) > 0
+				&& !((struct CachedBlock*) doubleLinkedListFirst(&a1InAvailablePositionsList))->isDirty) {
+			selectedCacheBlock = (void*) doubleLinkedListRemoveFirst(&a1InAvailablePositionsList);
+		} else {
+			break;
+		}
+
+		if (evictBlock(selectedCacheBlock) == SUCCESS) {
+			selectedCacheBlock->blockDevice = blockDevice;
+			selectedCacheBlock->blockId = adjustedBlockId;
+			if (bTreeInsert(&cachedBlockByBlockId, &selectedCacheBlock) == B_TREE_SUCCESS) {
+				submitTransfer(blockDevice, selectedCacheBlock, adjustedBlockId, false);
+				doubleLinkedListInsertAfterLast(&prefetchedBlocksList, &selectedCacheBlock->listElement);
+				continue;
+			}
+		}
+
+		if (selectedCacheBlock->data != NULL) {
+			doubleLinkedListInsertBeforeFirst(&freePositionsList, &selectedCacheBlock->listElement);
+		} else {
+			doubleLinkedListInsertAfterLast(&freePositionsList, &selectedCacheBlock->listElement);
+		}
+		break;
+	}
+
+	if (doubleLinkedListSize(&prefetchedBlocksList) > 0) {
+		if (!blockDeviceDispatchRequests(blockDevice)) {
+			assert(false); /* All I/O errors are considered fatal. Therefore, this code will never be executed. */
+		}
+
+		/* The blocks only become available after the data is there. */
+		struct CachedBlock* prefetchedBlock;
+		while ((prefetchedBlock = (void*) doubleLinkedListRemoveFirst(&prefetchedBlocksList)) != NULL) {
+			assignQueue(prefetchedBlock);
+			prefetchedBlock->usageCount = 0;
+			prefetchedBlock->isDirty = false;
+			doubleLinkedListInsertAfterLast(&a1InAvailablePositionsList, &prefetchedBlock->listElement);
+		}
+	}
+
+	isBusy = wasBusy;
+}
+
+static void reclaimPageFramesFromQueue(struct DoubleLinkedList* availablePositionsList, uint32_t pageFrameCountToReclaim, uint32_t* reclaimedCount) {
+	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(availablePositionsList);
+	while (doubleLinkedListElement != NULL && *reclaimedCount < pageFrameCountToReclaim) {
+		struct CachedBlock* cachedBlock = (void*) doubleLinkedListElement;
+		doubleLinkedListElement = doubleLinkedListElement->next;
+
+		/* Only the clean blocks are reclaimed as writing them back would require I/O. */
+		if (!cachedBlock->isDirty) {
+			assert(cachedBlock->usageCount == 0);
+			assert(cachedBlock->data != NULL);
+			doubleLinkedListRemove(availablePositionsList, &cachedBlock->listElement);
+
+			if (cachedBlock->queue == A1_IN_QUEUE) {
+				a1InBlockCount--;
+				rememberEvictedBlock(cachedBlock);
+			}
+			cachedBlock->queue = NO_QUEUE;
+
+			enum OperationResult operationResult = bTreeRemove(&cachedBlockByBlockId, &cachedBlock);
+			assert(operationResult == B_TREE_SUCCESS);
+
+			memoryManagerReleasePageFrame(memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) cachedBlock->data), -1);
+			cachedBlock->data = NULL;
+			pageFrameCount--;
+			doubleLinkedListInsertAfterLast(&freePositionsList, &cachedBlock->listElement);
+
+			(*reclaimedCount)++;
+		}
+	}
+}
+
+static uint32_t reclaimPageFrames(uint32_t pageFrameCountToReclaim) {
+	uint32_t reclaimedCount = 0;
+
+	if (!isBusy) {
+		isBusy = true;
+
+		pageFrameCountToReclaim = mathUtilsMax(pageFrameCountToReclaim, MINIMUM_PAGE_FRAMES_TO_RECLAIM);
+		reclaimPageFramesFromQueue(&a1InAvailablePositionsList, pageFrameCountToReclaim, &reclaimedCount);
+		reclaimPageFramesFromQueue(&amAvailablePositionsList, pageFrameCountToReclaim, &reclaimedCount);
+		reclaimedPageFrameCount += reclaimedCount;
+		logDebug("It has reclaimed %u page frames from the block cache", reclaimedCount);
+
+		isBusy = false;
+	}
+
+	return reclaimedCount;
+}
+
+static bool initializeElements(struct DoubleLinkedList* list, struct DoubleLinkedList* pageFrameList, size_t elementSize, uint32_t elementCount) {
+	while (doubleLinkedListSize(list) < elementCount) {
+		struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
+		if (doubleLinkedListElement == NULL) {
+			return false;
+
+		} else {
+			doubleLinkedListInsertAfterLast(pageFrameList, doubleLinkedListElement);
+			void* elements = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+			for (uint32_t i = 0; i < PAGE_FRAME_SIZE / elementSize && doubleLinkedListSize(list) < elementCount; i++) {
+				/* All elements start with their list element. */
+				struct DoubleLinkedListElement* element = elements + i * elementSize;
+				memset(element, 0, elementSize);
+				doubleLinkedListInsertAfterLast(list, element);
+			}
+		}
+	}
+
+	return true;
+}
+
 APIStatusCode blockCacheManagerInitialize(uint32_t maxPageFramesToCacheBlocks) {
 	APIStatusCode result = SUCCESS;
 
+	uint32_t maxRememberedBlocks = mathUtilsMax(1, maxPageFramesToCacheBlocks * A1_OUT_PERCENTAGE / 100);
+	a1InMaximumBlockCount = mathUtilsMax(1, maxPageFramesToCacheBlocks * A1_IN_PERCENTAGE / 100);
+	maximumCachedBlockCount = maxPageFramesToCacheBlocks;
+	freePageFramesWatermark = memoryManagerGetKernelSpaceAvailablePageFrameCount() * FREE_PAGE_FRAMES_WATERMARK_PERCENTAGE / 100;
+	writeBackParameters.dirtyRatio = DEFAULT_DIRTY_RATIO;
+	writeBackParameters.dirtyExpirationInMilliseconds = DEFAULT_DIRTY_EXPIRATION_IN_MILLISECONDS;
+
 	int worstCaseNodeCount = bTreeWorstCaseNodeCountToStore(PAGE_FRAME_SIZE, sizeof(void*), maxPageFramesToCacheBlocks);
+	int rememberedBlocksWorstCaseNodeCount = bTreeWorstCaseNodeCountToStore(PAGE_FRAME_SIZE, sizeof(void*), maxRememberedBlocks);
 	logDebug("It will reserve %d page frames in order to store cached blocks b-tree's meta data", worstCaseNodeCount);
+	logDebug("It will reserve %d page frames in order to store remembered blocks b-tree's meta data", rememberedBlocksWorstCaseNodeCount);
 	int reservationId = memoryManagerReserveMemoryOnKernelSpace(worstCaseNodeCount);
+	int rememberedBlocksReservationId = -1;
+	if (reservationId != -1) {
+		rememberedBlocksReservationId = memoryManagerReserveMemoryOnKernelSpace(rememberedBlocksWorstCaseNodeCount);
+	}
 
-	if (reservationId == -1) {
+	if (reservationId == -1 || rememberedBlocksReservationId == -1) {
 		result = ENOMEM;
 
 	} else {
-		doubleLinkedListInitialize(&availablePositionsList);
+		doubleLinkedListInitialize(&freePositionsList);
+		doubleLinkedListInitialize(&a1InAvailablePositionsList);
+		doubleLinkedListInitialize(&amAvailablePositionsList);
 		doubleLinkedListInitialize(&usedPositionsList);
 		doubleLinkedListInitialize(&dirtyList);
+		doubleLinkedListInitialize(&a1OutList);
+		doubleLinkedListInitialize(&freeRememberedBlocksList);
 
 		struct DoubleLinkedList pageFrameList;
 		doubleLinkedListInitialize(&pageFrameList);
 
-		while (doubleLinkedListSize(&availablePositionsList) < maxPageFramesToCacheBlocks) {
-			struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-			if (doubleLinkedListElement == NULL) {
-				result = ENOMEM;
-				break;
-
-			} else {
-				doubleLinkedListInsertAfterLast(&pageFrameList, doubleLinkedListElement);
-				struct CachedBlock* cachedBlocks = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-				for (uint32_t i = 0; i < PAGE_FRAME_SIZE / sizeof(struct CachedBlock) && doubleLinkedListSize(&availablePositionsList) < maxPageFramesToCacheBlocks; i++) {
-					struct CachedBlock* cachedBlock = &cachedBlocks[i];
-					memset(cachedBlock, 0, sizeof(struct CachedBlock));
-					doubleLinkedListInsertAfterLast(&availablePositionsList, &cachedBlock->listElement);
-				}
-			}
+		if (!initializeElements(&freePositionsList, &pageFrameList, sizeof(struct CachedBlock), maxPageFramesToCacheBlocks)
+				|| !initializeElements(&freeRememberedBlocksList, &pageFrameList, sizeof(struct RememberedBlock), maxRememberedBlocks)) {
+			result = ENOMEM;
 		}
 
 		if (result != SUCCESS) {
@@ -312,18 +732,39 @@ APIStatusCode blockCacheManagerInitialize(uint32_t maxPageFramesToCacheBlocks) {
 			}
 
 		} else {
+			slabAllocatorInitializeCache(&cachedBlockByBlockIdNodeCache, "cached_block_b_tree_node", PAGE_FRAME_SIZE, reservationId, NULL);
+			slabAllocatorInitializeCache(&rememberedBlockByBlockIdNodeCache, "remembered_block_b_tree_node", PAGE_FRAME_SIZE, rememberedBlocksReservationId, NULL);
+
 			bTreeInitialize(&cachedBlockByBlockId, PAGE_FRAME_SIZE, sizeof(void*),
-				(void*) reservationId,
+				&cachedBlockByBlockIdNodeCache,
 				(void* (*)(void*, size_t)) &memoryAllocatorAcquire,
 				(void (*)(void*, void*)) &memoryAllocatorRelease,
 				(int (*)(const void*, const void*)) &compare
 			);
+			bTreeInitialize(&rememberedBlockByBlockId, PAGE_FRAME_SIZE, sizeof(void*),
+				&rememberedBlockByBlockIdNodeCache,
+				(void* (*)(void*, size_t)) &memoryAllocatorAcquire,
+				(void (*)(void*, void*)) &memoryAllocatorRelease,
+				(int (*)(const void*, const void*)) &compareRememberedBlocks
+			);
+
+			memoryManagerRegisterPageFrameReclaimer(&reclaimPageFrames);
 		}
 	}
 
 	return result;
 }
 
+static uint32_t calculatePercentage(uint32_t value, uint32_t total) {
+	if (total == 0) {
+		return 0;
+	} else if (value <= UINT32_MAX / 100) {
+		return value * 100 / total;
+	} else {
+		return value / (total / 100);
+	}
+}
+
 APIStatusCode blockCacheManagerPrintDebugReport(void) {
 	APIStatusCode result = SUCCESS;
 
@@ -334,9 +775,25 @@ APIStatusCode blockCacheManagerPrintDebugReport(void) {
 		stringStreamWriterInitialize(&stringStreamWriter, buffer, PAGE_FRAME_SIZE);
 		streamWriterFormat(&stringStreamWriter.streamWriter, "\nBlock cache manager report:\n");
 		streamWriterFormat(&stringStreamWriter.streamWriter, "  cachedBlockByBlockId size: %d\n", bTreeSize(&cachedBlockByBlockId));
-		streamWriterFormat(&stringStreamWriter.streamWriter, "  availablePositionsList size: %d\n", doubleLinkedListSize(&availablePositionsList));
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  freePositionsList size: %d\n", doubleLinkedListSize(&freePositionsList));
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  a1InAvailablePositionsList size: %d\n", doubleLinkedListSize(&a1InAvailablePositionsList));
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  amAvailablePositionsList size: %d\n", doubleLinkedListSize(&amAvailablePositionsList));
 		streamWriterFormat(&stringStreamWriter.streamWriter, "  usedPositionsList size: %d\n", doubleLinkedListSize(&usedPositionsList));
 		streamWriterFormat(&stringStreamWriter.streamWriter, "  dirtyList size: %d\n", doubleLinkedListSize(&dirtyList));
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  page frames: %u (maximum %u, watermark %u) reclaimed=%u\n", pageFrameCount,
+			maximumCachedBlockCount, freePageFramesWatermark, reclaimedPageFrameCount);
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  write back: ratio=%u%% expiration=%ums written=%u\n", writeBackParameters.dirtyRatio,
+			writeBackParameters.dirtyExpirationInMilliseconds, writeBackCount);
+
+		uint32_t requestCount = a1InHitCount + amHitCount + a1OutHitCount + missCount;
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  requests: %u\n", requestCount);
+		streamWriterFormat(&stringStreamWriter.streamWriter, "    A1in: blocks=%d (maximum %d) hits=%u (%u%%)\n", a1InBlockCount, a1InMaximumBlockCount,
+			a1InHitCount, calculatePercentage(a1InHitCount, requestCount));
+		streamWriterFormat(&stringStreamWriter.streamWriter, "    Am: blocks=%d hits=%u (%u%%)\n", bTreeSize(&cachedBlockByBlockId) - a1InBlockCount,
+			amHitCount, calculatePercentage(amHitCount, requestCount));
+		streamWriterFormat(&stringStreamWriter.streamWriter, "    A1out: blocks=%d hits=%u (%u%%)\n", doubleLinkedListSize(&a1OutList),
+			a1OutHitCount, calculatePercentage(a1OutHitCount, requestCount));
+		streamWriterFormat(&stringStreamWriter.streamWriter, "    misses=%u (%u%%)\n", missCount, calculatePercentage(missCount, requestCount));
 		stringStreamWriterForceTerminationCharacter(&stringStreamWriter);
 
 		logDebug("%s", buffer);
@@ -358,29 +815,150 @@ static struct CachedBlock* getCachedBlockFromDirtyListElement(struct DoubleLinke
 	}
 }
 
+/*
+ * It must be called by the kernel lock owner when no cached block is being changed.
+ */
+static void writeBackExpiredDirtyBlocks(struct Process* currentProcess) {
+	assert(processManagerIsHoldingKernelLock(currentProcess));
+	assert(!isBusy);
+
+	isBusy = true;
+
+	uint64_t upTimeInMilliseconds = pitGetUpTimeInMilliseconds();
+	uint32_t maximumDirtyBlockCount = bTreeSize(&cachedBlockByBlockId) * writeBackParameters.dirtyRatio / 100;
+	int remainingBlockCount = WRITE_BACK_MAXIMUM_BLOCKS_PER_INTERVAL;
+
+	/*
+	 * As the list is sorted by the time the blocks became dirty, the oldest ones are selected first. They are submitted as
+	 * a batch per device. Therefore, the requests are sorted by block id and the contiguous ones are merged.
+	 */
+	while (remainingBlockCount > 0 && doubleLinkedListSize(&dirtyList) > 0) {
+		struct CachedBlock* cachedBlock = getCachedBlockFromDirtyListElement(doubleLinkedListFirst(&dirtyList));
+		if (doubleLinkedListSize(&dirtyList) <= maximumDirtyBlockCount
+				&& upTimeInMilliseconds - cachedBlock->dirtyUpTimeInMilliseconds < writeBackParameters.dirtyExpirationInMilliseconds) {
+			break;
+		}
+		struct BlockDevice* blockDevice = cachedBlock->blockDevice;
+
+		struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&dirtyList);
+		while (doubleLinkedListElement != NULL && remainingBlockCount > 0) {
+			cachedBlock = getCachedBlockFromDirtyListElement(doubleLinkedListElement);
+			if (doubleLinkedListSize(&dirtyList) <= maximumDirtyBlockCount
+					&& upTimeInMilliseconds - cachedBlock->dirtyUpTimeInMilliseconds < writeBackParameters.dirtyExpirationInMilliseconds) {
+				break;
+			}
+			doubleLinkedListElement = doubleLinkedListElement->next;
+
+			if (cachedBlock->blockDevice == blockDevice) {
+				assert(cachedBlock->isDirty);
+				assert(cachedBlock->data != NULL);
+				doubleLinkedListRemove(&dirtyList, &cachedBlock->dirtyListElement);
+				submitTransfer(blockDevice, cachedBlock, cachedBlock->blockId, true);
+				cachedBlock->isDirty = false;
+				remainingBlockCount--;
+				writeBackCount++;
+			}
+		}
+
+		if (!blockDeviceDispatchRequests(blockDevice)) {
+			errorHandlerFatalError("There was a fatal error while trying to write back cached blocks: %s", sys_errlist[EIO]);
+		}
+	}
+
+	isBusy = false;
+}
+
+static void wakeUpFlusherProcess(void* unused) {
+	/* It could still be writing back (sleeping while the DMA transfers are in progress or waiting for the kernel lock). */
+	if (flusherProcess->state == SUSPENDED_SLEEPING) {
+		processManagerChangeProcessState(processManagerGetCurrentProcess(), flusherProcess, RUNNABLE, 0);
+	}
+}
+
+static void __attribute__ ((cdecl)) runFlusherProcess(void* unused) {
+	struct Process* currentProcess = processManagerGetCurrentProcess();
+	assert(currentProcess == flusherProcess);
+
+	/* This function never returns. */
+	while (true) {
+		processManagerChangeProcessState(currentProcess, currentProcess, SUSPENDED_SLEEPING, 0);
+		processManagerScheduleProcessExecution();
+		assert(currentProcess->state == RUNNABLE);
+
+		processManagerAcquireKernelLock(currentProcess);
+		writeBackExpiredDirtyBlocks(currentProcess);
+		processManagerReleaseKernelLock(currentProcess);
+	}
+}
+
+APIStatusCode blockCacheManagerStartWriteBack(void) {
+	APIStatusCode result = processManagerCreateKernelProcess((void __attribute__ ((cdecl)) (*)(void*)) &runFlusherProcess, NULL, &flusherProcess);
+	if (result == SUCCESS) {
+		if (commandSchedulerSchedule(WRITE_BACK_INTERVAL_IN_MILLISECONDS, true, &wakeUpFlusherProcess, NULL) == NULL) {
+			result = ENOMEM;
+		}
+	}
+	return result;
+}
+
+void blockCacheManagerGetWriteBackParameters(struct BlockCacheWriteBackParameters* parameters) {
+	*parameters = writeBackParameters;
+}
+
+APIStatusCode blockCacheManagerSetWriteBackParameters(struct BlockCacheWriteBackParameters* parameters) {
+	if (parameters->dirtyRatio > 100) {
+		return EINVAL;
+	} else {
+		writeBackParameters = *parameters;
+		return SUCCESS;
+	}
+}
+
 void blockCacheManageFlush(void) {
 	int countOfBlocksToFlush = doubleLinkedListSize(&dirtyList);
 	time_t before = cmosGetUnixTime();
+	bool wasBusy = isBusy;
+	isBusy = true;
 
+	/* The dirty blocks are submitted as a batch per device. Therefore, they can be sorted and merged. */
 	while (doubleLinkedListSize(&dirtyList) > 0) {
-		struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListRemoveFirst(&dirtyList);
-		struct CachedBlock* cachedBlock = getCachedBlockFromDirtyListElement(doubleLinkedListElement);
-		struct BlockDevice* blockDevice = cachedBlock->blockDevice;
-		assert(cachedBlock->isDirty);
-		assert(cachedBlock->data != NULL);
-		if (!cachedBlock->blockDevice->writeBlocks(cachedBlock->blockDevice, cachedBlock->blockId, PAGE_FRAME_SIZE / blockDevice->blockSize, cachedBlock->data)) {
+		struct BlockDevice* blockDevice = getCachedBlockFromDirtyListElement(doubleLinkedListFirst(&dirtyList))->blockDevice;
+
+		struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&dirtyList);
+		while (doubleLinkedListElement != NULL) {
+			struct CachedBlock* cachedBlock = getCachedBlockFromDirtyListElement(doubleLinkedListElement);
+			doubleLinkedListElement = doubleLinkedListElement->next;
+
+			if (cachedBlock->blockDevice == blockDevice) {
+				assert(cachedBlock->isDirty);
+				assert(cachedBlock->data != NULL);
+				doubleLinkedListRemove(&dirtyList, &cachedBlock->dirtyListElement);
+				submitTransfer(blockDevice, cachedBlock, cachedBlock->blockId, true);
+				cachedBlock->isDirty = false;
+			}
+		}
+
+		if (!blockDeviceDispatchRequests(blockDevice)) {
 			errorHandlerFatalError("There was a fatal error while trying to flush cached blocks: %s", sys_errlist[EIO]);
 		}
-		cachedBlock->isDirty = false;
 	}
 
+	isBusy = wasBusy;
+
 	time_t after = cmosGetUnixTime();
 	logDebug("It took %d (%d - %d) to flush %d blocks", (after - before), after, before, countOfBlocksToFlush);
 
 #ifndef N_DEBUG
 	struct DoubleLinkedListElement* doubleLinkedListElement;
 
-	doubleLinkedListElement = doubleLinkedListFirst(&availablePositionsList);
+	doubleLinkedListElement = doubleLinkedListFirst(&a1InAvailablePositionsList);
+	while (doubleLinkedListElement != NULL) {
+		struct CachedBlock* cachedBlock = (void*) doubleLinkedListElement;
+		assert(!cachedBlock->isDirty);
+		doubleLinkedListElement = doubleLinkedListElement->next;
+	}
+
+	doubleLinkedListElement = doubleLinkedListFirst(&amAvailablePositionsList);
 	while (doubleLinkedListElement != NULL) {
 		struct CachedBlock* cachedBlock = (void*) doubleLinkedListElement;
 		assert(!cachedBlock->isDirty);
@@ -397,7 +975,22 @@ void blockCacheManageFlush(void) {
 
 }
 
+static void clearQueue(struct DoubleLinkedList* availablePositionsList) {
+	while (doubleLinkedListSize(availablePositionsList) > 0) {
+		struct CachedBlock* cachedBlock = (void*) doubleLinkedListRemoveFirst(availablePositionsList);
+		assert(!cachedBlock->isDirty);
+		cachedBlock->queue = NO_QUEUE;
+		doubleLinkedListInsertBeforeFirst(&freePositionsList, &cachedBlock->listElement);
+	}
+}
+
 void blockCacheManageClear(void) {
 	assert (doubleLinkedListSize(&usedPositionsList) == 0);
 	bTreeClear(&cachedBlockByBlockId);
+	clearQueue(&a1InAvailablePositionsList);
+	clearQueue(&amAvailablePositionsList);
+	a1InBlockCount = 0;
+
+	bTreeClear(&rememberedBlockByBlockId);
+	doubleLinkedListInsertListAfterLast(&freeRememberedBlocksList, &a1OutList);
 }
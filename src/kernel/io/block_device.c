@@ -0,0 +1,134 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kernel/memory_manager.h"
+
+#include "kernel/io/block_device.h"
+
+#include "util/double_linked_list.h"
+#include "util/math_utils.h"
+
+static struct BlockDeviceRequest* getBlockDeviceRequestFromListElement(struct DoubleLinkedListElement* listElement) {
+	if (listElement != NULL) {
+		uint32_t address = ((uint32_t) listElement) - offsetof(struct BlockDeviceRequest, listElement);
+		return (struct BlockDeviceRequest*) address;
+	} else {
+		return NULL;
+	}
+}
+
+static int compareRequests(struct DoubleLinkedListElement* listElement1, struct DoubleLinkedListElement* listElement2) {
+	uint64_t firstBlockId1 = getBlockDeviceRequestFromListElement(listElement1)->firstBlockId;
+	uint64_t firstBlockId2 = getBlockDeviceRequestFromListElement(listElement2)->firstBlockId;
+
+	if (firstBlockId1 < firstBlockId2) {
+		return -1;
+	} else if (firstBlockId1 > firstBlockId2) {
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+void blockDeviceInitializeRequestQueue(struct BlockDevice* blockDevice) {
+	struct BlockDeviceRequestQueue* blockDeviceRequestQueue = &blockDevice->requestQueue;
+	doubleLinkedListInitialize(&blockDeviceRequestQueue->pendingRequestsList);
+	blockDeviceRequestQueue->nextBlockId = 0;
+}
+
+void blockDeviceSubmitRequest(struct BlockDevice* blockDevice, struct BlockDeviceRequest* blockDeviceRequest) {
+	assert(blockDevice->blockSize <= PAGE_FRAME_SIZE);
+	assert(((uint32_t) blockDeviceRequest->firstBlockId) % (PAGE_FRAME_SIZE / blockDevice->blockSize) == 0); /* The 64-bit remainder would require the compiler runtime library. */
+	doubleLinkedListInsertAfterLast(&blockDevice->requestQueue.pendingRequestsList, &blockDeviceRequest->listElement);
+}
+
+static bool transfer(struct BlockDevice* blockDevice, uint64_t firstBlockId, size_t pageFrameCount, void** pageFrames, bool write) {
+	uint32_t blocksPerPageFrame = PAGE_FRAME_SIZE / blockDevice->blockSize;
+
+	if (blockDevice->transferPageFrames != NULL) {
+		return blockDevice->transferPageFrames(blockDevice, firstBlockId, pageFrameCount, pageFrames, write);
+
+	} else {
+		assert(pageFrameCount == 1);
+		if (write) {
+			return blockDevice->writeBlocks(blockDevice, firstBlockId, blocksPerPageFrame, pageFrames[0]);
+		} else {
+			return blockDevice->readBlocks(blockDevice, firstBlockId, blocksPerPageFrame, pageFrames[0]);
+		}
+	}
+}
+
+/*
+ * It transfers all pending requests using the C-LOOK policy: the requests are served in ascending order starting from
+ * where the last transfer ended; then, it jumps back to the lowest pending request. Adjacent requests in the same
+ * direction are merged into a single transfer.
+ */
+bool blockDeviceDispatchRequests(struct BlockDevice* blockDevice) {
+	struct BlockDeviceRequestQueue* blockDeviceRequestQueue = &blockDevice->requestQueue;
+	struct DoubleLinkedList* pendingRequestsList = &blockDeviceRequestQueue->pendingRequestsList;
+
+	uint32_t blocksPerPageFrame = PAGE_FRAME_SIZE / blockDevice->blockSize;
+	assert(blockDevice->maximumBlocksPerRead >= blocksPerPageFrame);
+	size_t maximumPageFramesPerTransfer = 1;
+	if (blockDevice->transferPageFrames != NULL) {
+		maximumPageFramesPerTransfer = mathUtilsMin(BLOCK_DEVICE_MAXIMUM_PAGE_FRAMES_PER_TRANSFER, blockDevice->maximumBlocksPerRead / blocksPerPageFrame);
+	}
+
+	doubleLinkedListSort(pendingRequestsList, &compareRequests);
+
+	/* The requests before the current position will be served after the others. */
+	struct DoubleLinkedList requestsToServeLaterList;
+	doubleLinkedListInitialize(&requestsToServeLaterList);
+	while (doubleLinkedListSize(pendingRequestsList) > 0
+			&& getBlockDeviceRequestFromListElement(doubleLinkedListFirst(pendingRequestsList))->firstBlockId < blockDeviceRequestQueue->nextBlockId) {
+		doubleLinkedListInsertAfterLast(&requestsToServeLaterList, doubleLinkedListRemoveFirst(pendingRequestsList));
+	}
+	doubleLinkedListInsertListAfterLast(pendingRequestsList, &requestsToServeLaterList);
+
+	bool success = true;
+	while (doubleLinkedListSize(pendingRequestsList) > 0) {
+		void* pageFrames[BLOCK_DEVICE_MAXIMUM_PAGE_FRAMES_PER_TRANSFER];
+		size_t pageFrameCount = 0;
+
+		struct BlockDeviceRequest* blockDeviceRequest = getBlockDeviceRequestFromListElement(doubleLinkedListRemoveFirst(pendingRequestsList));
+		uint64_t firstBlockId = blockDeviceRequest->firstBlockId;
+		bool write = blockDeviceRequest->write;
+		pageFrames[pageFrameCount++] = blockDeviceRequest->pageFrame;
+
+		while (pageFrameCount < maximumPageFramesPerTransfer && doubleLinkedListSize(pendingRequestsList) > 0) {
+			blockDeviceRequest = getBlockDeviceRequestFromListElement(doubleLinkedListFirst(pendingRequestsList));
+			if (blockDeviceRequest->write == write && blockDeviceRequest->firstBlockId == firstBlockId + pageFrameCount * blocksPerPageFrame) {
+				doubleLinkedListRemoveFirst(pendingRequestsList);
+				pageFrames[pageFrameCount++] = blockDeviceRequest->pageFrame;
+			} else {
+				break;
+			}
+		}
+
+		success = transfer(blockDevice, firstBlockId, pageFrameCount, pageFrames, write) && success;
+		blockDeviceRequestQueue->nextBlockId = firstBlockId + pageFrameCount * blocksPerPageFrame;
+	}
+
+	return success;
+}
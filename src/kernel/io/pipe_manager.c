@@ -23,6 +23,7 @@
 #include "kernel/cmos.h"
 #include "kernel/log.h"
 #include "kernel/memory_manager.h"
+#include "kernel/slab_allocator.h"
 #include "kernel/process/process_manager.h"
 
 #include "kernel/io/pipe_manager.h"
@@ -43,14 +44,13 @@ static int nextPipeId = 1;
 
 static struct VirtualFileSystemOperations pipeVirtualFileSystemOperations;
 
-static struct DoubleLinkedList availablePipeVirtualFileSystemNodesList;
+static struct SlabCache pipeVirtualFileSystemNodeCache;
+static struct SlabCache pipeBufferCache;
 
 struct PipeVirtualFileSystemNode {
 	struct VirtualFileSystemNode virtualFileSystemNode;
-	struct DoubleLinkedListElement* bufferPageFrameListElement;
 	void* buffer;
 	struct RingBuffer ringBuffer;
-	struct DoubleLinkedListElement listElement;
 	bool releasedReaderOpenFileDescription;
 	bool releasedWriterOpenFileDescription;
 	time_t st_atime;
@@ -59,15 +59,6 @@ struct PipeVirtualFileSystemNode {
 	int id;
 };
 
-static struct PipeVirtualFileSystemNode* getPipeVirtualFileSystemNodeFromListElement(struct DoubleLinkedListElement* listElement) {
-	if (listElement != NULL) {
-		uint32_t address = ((uint32_t) listElement) - offsetof(struct PipeVirtualFileSystemNode, listElement);
-		return (struct PipeVirtualFileSystemNode*) address;
-	} else {
-		return NULL;
-	}
-}
-
 static void afterNodeReservationRelease(struct VirtualFileSystemNode* virtualFileSystemNode, struct Process* currentProcess, struct OpenFileDescription* openFileDescription) {
 	assert(openFileDescription != NULL);
 
@@ -88,8 +79,8 @@ static void afterNodeReservationRelease(struct VirtualFileSystemNode* virtualFil
 
 	if (pipeVirtualFileSystemNode->releasedReaderOpenFileDescription && pipeVirtualFileSystemNode->releasedWriterOpenFileDescription) {
 		assert(pipeVirtualFileSystemNode->virtualFileSystemNode.usageCount == 0);
-		memoryManagerReleasePageFrame(pipeVirtualFileSystemNode->bufferPageFrameListElement, - 1);
-		doubleLinkedListInsertAfterLast(&availablePipeVirtualFileSystemNodesList, &pipeVirtualFileSystemNode->listElement);
+		slabAllocatorRelease(&pipeBufferCache, pipeVirtualFileSystemNode->buffer);
+		slabAllocatorRelease(&pipeVirtualFileSystemNodeCache, pipeVirtualFileSystemNode);
 	}
 }
 
@@ -234,15 +225,13 @@ APIStatusCode pipeManagerCreatePipe(struct Process* currentProcess, int* readFil
 	*readFileDescriptorIndex = -1;
 	*writeFileDescriptorIndex = -1;
 
-	if (doubleLinkedListSize(&availablePipeVirtualFileSystemNodesList) > 0) {
-		struct DoubleLinkedListElement* listElement = doubleLinkedListRemoveFirst(&availablePipeVirtualFileSystemNodesList);
-		pipeVirtualFileSystemNode = getPipeVirtualFileSystemNodeFromListElement(listElement);
+	pipeVirtualFileSystemNode = slabAllocatorAcquire(&pipeVirtualFileSystemNodeCache);
+	if (pipeVirtualFileSystemNode != NULL) {
 		memset(pipeVirtualFileSystemNode, 0, sizeof(struct PipeVirtualFileSystemNode));
-		pipeVirtualFileSystemNode->bufferPageFrameListElement = memoryManagerAcquirePageFrame(true, -1);
+		pipeVirtualFileSystemNode->buffer = slabAllocatorAcquire(&pipeBufferCache);
 		pipeVirtualFileSystemNode->virtualFileSystemNode.operations = &pipeVirtualFileSystemOperations;
 
-		if (pipeVirtualFileSystemNode->bufferPageFrameListElement != NULL) {
-			pipeVirtualFileSystemNode->buffer = (void*) memoryManagerGetPageFramePhysicalAddress(pipeVirtualFileSystemNode->bufferPageFrameListElement);
+		if (pipeVirtualFileSystemNode->buffer != NULL) {
 			ringBufferInitialize(&pipeVirtualFileSystemNode->ringBuffer, pipeVirtualFileSystemNode->buffer, PIPE_BUF);
 
 			readOpenFileDescription = virtualFileSystemManagerAcquireOpenFileDescription();
@@ -294,10 +283,10 @@ APIStatusCode pipeManagerCreatePipe(struct Process* currentProcess, int* readFil
 
 	if (result != SUCCESS) {
 		if (pipeVirtualFileSystemNode != NULL) {
-			if (pipeVirtualFileSystemNode->bufferPageFrameListElement != NULL) {
-				memoryManagerReleasePageFrame(pipeVirtualFileSystemNode->bufferPageFrameListElement, -1);
+			if (pipeVirtualFileSystemNode->buffer != NULL) {
+				slabAllocatorRelease(&pipeBufferCache, pipeVirtualFileSystemNode->buffer);
 			}
-			doubleLinkedListInsertAfterLast(&availablePipeVirtualFileSystemNodesList, &pipeVirtualFileSystemNode->listElement);
+			slabAllocatorRelease(&pipeVirtualFileSystemNodeCache, pipeVirtualFileSystemNode);
 		}
 
 		if (readOpenFileDescription != NULL) {
@@ -322,10 +311,6 @@ static mode_t getMode(struct VirtualFileSystemNode* virtualFileSystemNode) {
 }
 
 APIStatusCode pipeManagerInitialize(void) {
-	APIStatusCode result = SUCCESS;
-
-	doubleLinkedListInitialize(&availablePipeVirtualFileSystemNodesList);
-
 	memset(&pipeVirtualFileSystemOperations, 0, sizeof(struct VirtualFileSystemOperations));
 	pipeVirtualFileSystemOperations.afterNodeReservationRelease = &afterNodeReservationRelease;
 	pipeVirtualFileSystemOperations.read = &read;
@@ -333,17 +318,8 @@ APIStatusCode pipeManagerInitialize(void) {
 	pipeVirtualFileSystemOperations.status = &status;
 	pipeVirtualFileSystemOperations.getMode = &getMode;
 
-	struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-	if (doubleLinkedListElement == NULL) {
-		result = ENOMEM;
+	slabAllocatorInitializeCache(&pipeVirtualFileSystemNodeCache, "pipe_virtual_file_system_node", sizeof(struct PipeVirtualFileSystemNode), -1, NULL);
+	slabAllocatorInitializeCache(&pipeBufferCache, "pipe_buffer", PIPE_BUF, -1, NULL);
 
-	} else {
-		struct PipeVirtualFileSystemNode* pipeVirtualFileSystemNodes = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-		for (int i = 0; i < PAGE_FRAME_SIZE / sizeof(struct PipeVirtualFileSystemNode); i++) {
-			struct PipeVirtualFileSystemNode* pipeVirtualFileSystemNode = &pipeVirtualFileSystemNodes[i];
-			doubleLinkedListInsertAfterLast(&availablePipeVirtualFileSystemNodesList, &pipeVirtualFileSystemNode->listElement);
-		}
-	}
-
-	return result;
+	return SUCCESS;
 }
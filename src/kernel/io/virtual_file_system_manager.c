@@ -19,6 +19,7 @@
 
 #include <fcntl.h>
 #include <limits.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -27,6 +28,7 @@
 #include "kernel/api_status_code.h"
 #include "kernel/log.h"
 #include "kernel/memory_manager.h"
+#include "kernel/slab_allocator.h"
 #include "kernel/process/process.h"
 #include "kernel/io/open_file_description.h"
 #include "kernel/io/mounted_file_system.h"
@@ -37,12 +39,38 @@
 #include "util/string_stream_writer.h"
 #include "util/string_utils.h"
 
+/* The open file descriptions are acquired from a slab cache up to this limit (expressed in page frames). */
 #define OPEN_FILE_DESCRIPTIONS_PAGE_FRAME_COUNT 2
 
+/*
+ * The name cache maps (file system, parent identifier, name) into the child identifier. A child identifier equal to
+ * zero means that the name does not exist (negative entry). The identifiers are used instead of the nodes as the file
+ * systems recycle their nodes.
+ */
+#define NAME_CACHE_MAXIMUM_ENTRY_COUNT 256
+#define NAME_CACHE_BUCKET_COUNT 128
+#define NAME_CACHE_MAXIMUM_NAME_LENGTH 31
+
+struct NameCacheEntry {
+	struct DoubleLinkedListElement bucketListElement;
+	struct DoubleLinkedListElement lruListElement;
+	struct FileSystem* fileSystem;
+	uint32_t parentIdentifier;
+	uint32_t childIdentifier;
+	char name[NAME_CACHE_MAXIMUM_NAME_LENGTH + 1];
+};
+
 static struct DoubleLinkedList mountedFileSystemsList;
-static struct DoubleLinkedList availableOpenFileDescriptionsList;
+static struct SlabCache openFileDescriptionCache;
 static struct DoubleLinkedList usedOpenFileDescriptionsList;
 
+static struct DoubleLinkedList nameCacheBuckets[NAME_CACHE_BUCKET_COUNT];
+static struct DoubleLinkedList nameCacheLRUList;
+static struct SlabCache nameCacheEntryCache;
+static uint32_t nameCacheHitCount;
+static uint32_t nameCacheNegativeHitCount;
+static uint32_t nameCacheMissCount;
+
 uint32_t virtualFileSystemManagerGetOpenFileDescriptionCount(void) {
 	return (PAGE_FRAME_SIZE / sizeof(struct OpenFileDescription)) * OPEN_FILE_DESCRIPTIONS_PAGE_FRAME_COUNT;
 }
@@ -67,26 +95,17 @@ APIStatusCode virtualFileSystemManagerValidateAndGetOpenFileDescription(int file
 }
 
 APIStatusCode virtualFileSystemManagerInitialize(void) {
-	APIStatusCode result = SUCCESS;
-
 	doubleLinkedListInitialize(&mountedFileSystemsList);
-	doubleLinkedListInitialize(&availableOpenFileDescriptionsList);
 	doubleLinkedListInitialize(&usedOpenFileDescriptionsList);
+	slabAllocatorInitializeCache(&openFileDescriptionCache, "open_file_description", sizeof(struct OpenFileDescription), -1, NULL);
 
-	for (int i = 0; i < OPEN_FILE_DESCRIPTIONS_PAGE_FRAME_COUNT; i++) {
-		struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-		if (doubleLinkedListElement == NULL) {
-			result = ENOMEM;
-		} else {
-			struct OpenFileDescription *openFileDescriptions = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-
-			for (int j = 0; j < PAGE_FRAME_SIZE / sizeof(struct OpenFileDescription); j++) {
-				doubleLinkedListInsertAfterLast(&availableOpenFileDescriptionsList, &openFileDescriptions[j].doubleLinkedListElement);
-			}
-		}
+	doubleLinkedListInitialize(&nameCacheLRUList);
+	for (int i = 0; i < NAME_CACHE_BUCKET_COUNT; i++) {
+		doubleLinkedListInitialize(&nameCacheBuckets[i]);
 	}
+	slabAllocatorInitializeCache(&nameCacheEntryCache, "name_cache_entry", sizeof(struct NameCacheEntry), -1, NULL);
 
-	return result;
+	return SUCCESS;
 }
 
 static int compare(struct MountedFileSystem* mountedFileSystem1, struct MountedFileSystem* mountedFileSystem2) {
@@ -164,11 +183,166 @@ APIStatusCode virtualFileSystemManagerCloseAllOpenFileDescriptions(void) {
 	return result;
 }
 
+static struct NameCacheEntry* getNameCacheEntryFromLRUListElement(struct DoubleLinkedListElement* doubleLinkedListElement) {
+	return (struct NameCacheEntry*) (((uint32_t) doubleLinkedListElement) - offsetof(struct NameCacheEntry, lruListElement));
+}
+
+static bool isNameCacheable(struct VirtualFileSystemNode* virtualFileSystemNode, const char* name) {
+	struct VirtualFileSystemOperations* operations = virtualFileSystemNode->operations;
+	return name != NULL && operations->getIdentifier != NULL && operations->acquireNodeByIdentifier != NULL && operations->getFileSystem != NULL
+			&& strlen(name) <= NAME_CACHE_MAXIMUM_NAME_LENGTH;
+}
+
+static struct DoubleLinkedList* getNameCacheBucket(struct FileSystem* fileSystem, uint32_t parentIdentifier, const char* name) {
+	/* FNV-1a */
+	uint32_t hash = 2166136261;
+	while (*name != '\0') {
+		hash = (hash ^ (uint8_t) *name) * 16777619;
+		name++;
+	}
+	hash = (hash ^ parentIdentifier) * 16777619;
+	hash = (hash ^ (uint32_t) fileSystem) * 16777619;
+
+	return &nameCacheBuckets[hash % NAME_CACHE_BUCKET_COUNT];
+}
+
+static struct NameCacheEntry* searchNameCacheEntry(struct FileSystem* fileSystem, uint32_t parentIdentifier, const char* name) {
+	struct DoubleLinkedList* bucket = getNameCacheBucket(fileSystem, parentIdentifier, name);
+
+	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(bucket);
+	while (doubleLinkedListElement != NULL) {
+		struct NameCacheEntry* nameCacheEntry = (void*) doubleLinkedListElement;
+		if (nameCacheEntry->fileSystem == fileSystem && nameCacheEntry->parentIdentifier == parentIdentifier && strcmp(nameCacheEntry->name, name) == 0) {
+			return nameCacheEntry;
+		}
+		doubleLinkedListElement = doubleLinkedListElement->next;
+	}
+
+	return NULL;
+}
+
+static void releaseNameCacheEntry(struct NameCacheEntry* nameCacheEntry) {
+	doubleLinkedListRemove(getNameCacheBucket(nameCacheEntry->fileSystem, nameCacheEntry->parentIdentifier, nameCacheEntry->name),
+		&nameCacheEntry->bucketListElement);
+	doubleLinkedListRemove(&nameCacheLRUList, &nameCacheEntry->lruListElement);
+	slabAllocatorRelease(&nameCacheEntryCache, nameCacheEntry);
+}
+
+static void insertNameCacheEntry(struct FileSystem* fileSystem, uint32_t parentIdentifier, const char* name, uint32_t childIdentifier) {
+	struct NameCacheEntry* nameCacheEntry = searchNameCacheEntry(fileSystem, parentIdentifier, name);
+	if (nameCacheEntry != NULL) {
+		releaseNameCacheEntry(nameCacheEntry);
+	}
+
+	if (doubleLinkedListSize(&nameCacheLRUList) >= NAME_CACHE_MAXIMUM_ENTRY_COUNT) {
+		/* Evict the least recently used one. */
+		releaseNameCacheEntry(getNameCacheEntryFromLRUListElement(doubleLinkedListFirst(&nameCacheLRUList)));
+	}
+
+	nameCacheEntry = slabAllocatorAcquire(&nameCacheEntryCache);
+	if (nameCacheEntry == NULL && doubleLinkedListSize(&nameCacheLRUList) > 0) {
+		releaseNameCacheEntry(getNameCacheEntryFromLRUListElement(doubleLinkedListFirst(&nameCacheLRUList)));
+		nameCacheEntry = slabAllocatorAcquire(&nameCacheEntryCache);
+	}
+	if (nameCacheEntry == NULL) {
+		return;
+	}
+	nameCacheEntry->fileSystem = fileSystem;
+	nameCacheEntry->parentIdentifier = parentIdentifier;
+	nameCacheEntry->childIdentifier = childIdentifier;
+	strcpy(nameCacheEntry->name, name);
+	doubleLinkedListInsertBeforeFirst(getNameCacheBucket(fileSystem, parentIdentifier, name), &nameCacheEntry->bucketListElement);
+	doubleLinkedListInsertAfterLast(&nameCacheLRUList, &nameCacheEntry->lruListElement);
+}
+
+static void invalidateNameCacheEntries(struct FileSystem* fileSystem, bool allIdentifiers, uint32_t identifier) {
+	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&nameCacheLRUList);
+	while (doubleLinkedListElement != NULL) {
+		struct NameCacheEntry* nameCacheEntry = getNameCacheEntryFromLRUListElement(doubleLinkedListElement);
+		doubleLinkedListElement = doubleLinkedListElement->next;
+
+		if (nameCacheEntry->fileSystem == fileSystem
+				&& (allIdentifiers || nameCacheEntry->parentIdentifier == identifier || nameCacheEntry->childIdentifier == identifier)) {
+			releaseNameCacheEntry(nameCacheEntry);
+		}
+	}
+}
+
+void virtualFileSystemManagerInvalidateName(struct VirtualFileSystemNode* parentVirtualFileSystemNode, const char* name) {
+	if (isNameCacheable(parentVirtualFileSystemNode, name)) {
+		struct VirtualFileSystemOperations* operations = parentVirtualFileSystemNode->operations;
+		struct NameCacheEntry* nameCacheEntry = searchNameCacheEntry(operations->getFileSystem(parentVirtualFileSystemNode),
+			operations->getIdentifier(parentVirtualFileSystemNode), name);
+		if (nameCacheEntry != NULL) {
+			releaseNameCacheEntry(nameCacheEntry);
+		}
+	}
+}
+
+/* It must be called before a directory is released as its identifier may be reused. */
+void virtualFileSystemManagerInvalidateDirectory(struct VirtualFileSystemNode* virtualFileSystemNode) {
+	struct VirtualFileSystemOperations* operations = virtualFileSystemNode->operations;
+	if (operations->getIdentifier != NULL && operations->getFileSystem != NULL) {
+		invalidateNameCacheEntries(operations->getFileSystem(virtualFileSystemNode), false, operations->getIdentifier(virtualFileSystemNode));
+	}
+}
+
+APIStatusCode virtualFileSystemManagerWalk(struct VirtualFileSystemNode* virtualFileSystemNode, struct Process* process, const char* name,
+		bool createIfDoesNotExist, mode_t mode, struct VirtualFileSystemNode** nextVirtualFileSystemNode, bool* created) {
+	struct VirtualFileSystemOperations* operations = virtualFileSystemNode->operations;
+	assert(operations->walk != NULL);
+
+	APIStatusCode result;
+
+	if (isNameCacheable(virtualFileSystemNode, name)) {
+		struct FileSystem* fileSystem = operations->getFileSystem(virtualFileSystemNode);
+		uint32_t parentIdentifier = operations->getIdentifier(virtualFileSystemNode);
+
+		struct NameCacheEntry* nameCacheEntry = searchNameCacheEntry(fileSystem, parentIdentifier, name);
+		/* A negative entry can not be used if the name will be created. */
+		if (nameCacheEntry != NULL && (nameCacheEntry->childIdentifier != 0 || !createIfDoesNotExist)) {
+			doubleLinkedListRemove(&nameCacheLRUList, &nameCacheEntry->lruListElement);
+			doubleLinkedListInsertAfterLast(&nameCacheLRUList, &nameCacheEntry->lruListElement);
+			if (created != NULL) {
+				*created = false;
+			}
+
+			if (nameCacheEntry->childIdentifier != 0) {
+				nameCacheHitCount++;
+				result = operations->acquireNodeByIdentifier(virtualFileSystemNode, nameCacheEntry->childIdentifier, nextVirtualFileSystemNode);
+				if (result != SUCCESS) {
+					*nextVirtualFileSystemNode = NULL;
+				}
+
+			} else {
+				nameCacheNegativeHitCount++;
+				*nextVirtualFileSystemNode = NULL;
+				result = ENOENT;
+			}
+
+		} else {
+			nameCacheMissCount++;
+			result = operations->walk(virtualFileSystemNode, process, name, createIfDoesNotExist, mode, nextVirtualFileSystemNode, created);
+			if (result == SUCCESS && *nextVirtualFileSystemNode != NULL) {
+				insertNameCacheEntry(fileSystem, parentIdentifier, name, operations->getIdentifier(*nextVirtualFileSystemNode));
+			} else if (result == ENOENT) {
+				insertNameCacheEntry(fileSystem, parentIdentifier, name, 0);
+			}
+		}
+
+	} else {
+		result = operations->walk(virtualFileSystemNode, process, name, createIfDoesNotExist, mode, nextVirtualFileSystemNode, created);
+	}
+
+	return result;
+}
+
 APIStatusCode virtualFileSystemManagerUnmountAllFileSystems(void) {
 	APIStatusCode result = SUCCESS;
 	while (doubleLinkedListSize(&mountedFileSystemsList) > 0) {
 		struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListRemoveFirst(&mountedFileSystemsList);
 		struct MountedFileSystem* mountedFileSystem = (void*) doubleLinkedListElement;
+		invalidateNameCacheEntries(mountedFileSystem->fileSystem, true, 0);
 		if (mountedFileSystem->fileSystem->afterUnmount != NULL) {
 			result = apiStatusCodeRetainFirstFailure(result, mountedFileSystem->fileSystem->afterUnmount(mountedFileSystem->fileSystem));
 		}
@@ -232,7 +406,7 @@ APIStatusCode virtualFileSystemManagerResolvePath(struct Process* process, struc
 					previousVirtualFileSystemNode = nextVirtualFileSystemNode;
 					operations = nextVirtualFileSystemNode->operations;
 					if (operations->walk != NULL) {
-						result = operations->walk(nextVirtualFileSystemNode, process, segment,
+						result = virtualFileSystemManagerWalk(nextVirtualFileSystemNode, process, segment,
 								segmentIndex + 1 >= pathUtilsContext->segmentCount && createIfDoesNotExist, mode,
 								&nextVirtualFileSystemNode, &created);
 						assert(nextVirtualFileSystemNode == NULL || nextVirtualFileSystemNode->usageCount > 0);
@@ -309,18 +483,18 @@ APIStatusCode virtualFileSystemManagerResolvePath(struct Process* process, struc
 
 void virtualFileSystemManagerReleaseOpenFileDescription(struct OpenFileDescription* openFileDescription) {
 	struct DoubleLinkedListElement* doubleLinkedListElement = (struct DoubleLinkedListElement*) openFileDescription;
-	assert(!doubleLinkedListContainsFoward(&availableOpenFileDescriptionsList, doubleLinkedListElement));
 	assert(doubleLinkedListContainsFoward(&usedOpenFileDescriptionsList, doubleLinkedListElement));
 	doubleLinkedListRemove(&usedOpenFileDescriptionsList, doubleLinkedListElement);
-	doubleLinkedListInsertAfterLast(&availableOpenFileDescriptionsList, doubleLinkedListElement);
+	slabAllocatorRelease(&openFileDescriptionCache, openFileDescription);
 }
 
 struct OpenFileDescription* virtualFileSystemManagerAcquireOpenFileDescription(void) {
-	if (doubleLinkedListSize(&availableOpenFileDescriptionsList) > 0) {
-		struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListRemoveFirst(&availableOpenFileDescriptionsList);
-		struct OpenFileDescription* openFileDescription = (struct OpenFileDescription*) doubleLinkedListElement;
-		memset(openFileDescription, 0, sizeof(struct OpenFileDescription));
-		doubleLinkedListInsertAfterLast(&usedOpenFileDescriptionsList, doubleLinkedListElement);
+	if (doubleLinkedListSize(&usedOpenFileDescriptionsList) < virtualFileSystemManagerGetOpenFileDescriptionCount()) {
+		struct OpenFileDescription* openFileDescription = slabAllocatorAcquire(&openFileDescriptionCache);
+		if (openFileDescription != NULL) {
+			memset(openFileDescription, 0, sizeof(struct OpenFileDescription));
+			doubleLinkedListInsertAfterLast(&usedOpenFileDescriptionsList, &openFileDescription->doubleLinkedListElement);
+		}
 		return openFileDescription;
 
 	} else {
@@ -371,8 +545,12 @@ APIStatusCode virtualFileSystemManagerPrintDebugReport(void) {
 
 	stringStreamWriterInitialize(&stringStreamWriter, buffer, bufferSize);
 	streamWriterFormat(&stringStreamWriter.streamWriter, "Virtual file system manager report:\n");
-	streamWriterFormat(&stringStreamWriter.streamWriter, "  availableOpenFileDescriptionsList=%d\n", doubleLinkedListSize(&availableOpenFileDescriptionsList));
+	streamWriterFormat(&stringStreamWriter.streamWriter, "  openFileDescriptionCount=%u\n", virtualFileSystemManagerGetOpenFileDescriptionCount());
 	streamWriterFormat(&stringStreamWriter.streamWriter, "  usedOpenFileDescriptionsList=%d\n", doubleLinkedListSize(&usedOpenFileDescriptionsList));
+	streamWriterFormat(&stringStreamWriter.streamWriter, "  nameCacheLRUList=%d\n", doubleLinkedListSize(&nameCacheLRUList));
+	streamWriterFormat(&stringStreamWriter.streamWriter, "  nameCacheHitCount=%u\n", nameCacheHitCount);
+	streamWriterFormat(&stringStreamWriter.streamWriter, "  nameCacheNegativeHitCount=%u\n", nameCacheNegativeHitCount);
+	streamWriterFormat(&stringStreamWriter.streamWriter, "  nameCacheMissCount=%u\n", nameCacheMissCount);
 	stringStreamWriterForceTerminationCharacter(&stringStreamWriter);
 	logDebug("%s", buffer);
 
@@ -34,7 +34,7 @@ void kernelLifeCycleReboot(void) {
 	/* This function can never return as the kernel will not be in a valid state after it starts. */
 	logInfo("The reboot command has been issued!");
 
-	pitStopTickGenerator();
+	pitStopTimer();
 
 	virtualFileSystemManagerCloseAllOpenFileDescriptions();
 	virtualFileSystemManagerUnmountAllFileSystems();
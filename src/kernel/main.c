@@ -26,6 +26,7 @@
 
 #include "kernel/ata.h"
 #include "kernel/busy_waiting_manager.h"
+#include "kernel/clock_manager.h"
 #include "kernel/command_scheduler.h"
 #include "kernel/cmos.h"
 #include "kernel/error_handler.h"
@@ -38,9 +39,11 @@
 #include "kernel/pic.h"
 #include "kernel/pit.h"
 #include "kernel/session_manager.h"
+#include "kernel/shared_data_manager.h"
 #include "kernel/speaker_manager.h"
 #include "kernel/system_calls.h"
 #include "kernel/system_call_manager.h"
+#include "kernel/process/executable_image_cache.h"
 #include "kernel/process/process_manager.h"
 #include "kernel/tty.h"
 #include "kernel/x86.h"
@@ -48,6 +51,7 @@
 #include "kernel/file_system/devices_file_system.h"
 #include "kernel/file_system/ext2_file_system.h"
 
+#include "kernel/io/block_cache_device.h"
 #include "kernel/io/block_cache_manager.h"
 #include "kernel/io/block_device.h"
 #include "kernel/io/null_device.h"
@@ -58,6 +62,9 @@
 #include "kernel/process/process_group_manager.h"
 #include "kernel/process/init_process_creator.h"
 
+#include "kernel/services/io_services.h"
+#include "kernel/services/process_services.h"
+
 #include "util/command_line_utils.h"
 #include "util/math_utils.h"
 #include "util/scanner.h"
@@ -67,6 +74,8 @@
 #define SLAVE_FIRST_INTERRUPTION_VECTOR 40 /* Slave: from 40 to 47 (inclusive). */
 #define PIT_INTERRUPTION_VECTOR 32 /* IRQ0. */
 #define KEYBOARD_INTERRUPTION_VECTOR 33 /* IRQ1. */
+#define PRIMARY_IDE_CHANNEL_INTERRUPTION_VECTOR 46 /* IRQ14. */
+#define SECONDARY_IDE_CHANNEL_INTERRUPTION_VECTOR 47 /* IRQ15. */
 
 static const char* DEVICE_FILE_SYSTEM_MOUNT_POINT = "/dev/";
 static const char* ROOT_FILE_SYSTEM_MOUNT_POINT = "/";
@@ -287,7 +296,11 @@ void __attribute__ ((cdecl)) MyOSMain(uint32_t eax, struct multiboot_info* multi
 	memoryManagerInitialize(multiboot_info->mem_upper);
 
 	APIStatusCode result;
-	uint32_t maxPageFramesToCacheBlocks = (memoryManagerGetKernelSpaceAvailablePageFrameCount() * 33) / 100; /* It uses 33% of kernel memory to cache blocks. */
+	/*
+	 * It may use up to 75% of kernel memory to cache blocks. The page frames are only acquired while there is free memory
+	 * and they are given back when the memory runs out.
+	 */
+	uint32_t maxPageFramesToCacheBlocks = (memoryManagerGetKernelSpaceAvailablePageFrameCount() * 75) / 100;
 	const int MIN_REQUIRED_PAGE_FRAMES_TO_CACHE_BLOCKS = 32;
 	if (maxPageFramesToCacheBlocks >= MIN_REQUIRED_PAGE_FRAMES_TO_CACHE_BLOCKS) {
 		result = blockCacheManagerInitialize(maxPageFramesToCacheBlocks);
@@ -312,8 +325,12 @@ void __attribute__ ((cdecl)) MyOSMain(uint32_t eax, struct multiboot_info* multi
 	picEnableIRQs(IRQ0);
 
 	/* It requires PIC and PIT in order to initialize properly. */
+	clockManagerInitialize();
 	busyWaitingManagerInitialize();
 
+	ioServicesInitialize();
+	processServicesInitialize();
+
 	if ((result = virtualFileSystemManagerInitialize()) != SUCCESS) {
 		errorHandlerFatalError("The virtual file system manager could not be initialized: %s", sys_errlist[result]);
 	}
@@ -322,7 +339,9 @@ void __attribute__ ((cdecl)) MyOSMain(uint32_t eax, struct multiboot_info* multi
 		errorHandlerFatalError("The device file system could not be initialized: %s", sys_errlist[result]);
 	}
 
-	ataInitialize();
+	ataInitialize(PRIMARY_IDE_CHANNEL_INTERRUPTION_VECTOR, SECONDARY_IDE_CHANNEL_INTERRUPTION_VECTOR);
+	logDebug("Enabling IRQ14 and IRQ15");
+	picEnableIRQs(IRQ14 | IRQ15);
 
 	/* Mount some file systems. */
 	if ((result = mountRootFileSystem(commandLineOptions.root)) != SUCCESS) {
@@ -334,12 +353,21 @@ void __attribute__ ((cdecl)) MyOSMain(uint32_t eax, struct multiboot_info* multi
 
 	nullDeviceInitialize();
 	zeroDeviceInitialize();
+	blockCacheDeviceInitialize();
 	ttyRegisterDevices();
 
+	if ((result = sharedDataManagerInitialize()) != SUCCESS) {
+		errorHandlerFatalError("Could not initialize the shared data manager: %s", sys_errlist[result]);
+	}
+
 	if ((result = processManagerInitialize()) != SUCCESS) {
 		errorHandlerFatalError("Could not initialize the process manager: %s", sys_errlist[result]);
 	}
 
+	if ((result = executableImageCacheInitialize()) != SUCCESS) {
+		errorHandlerFatalError("Could not initialize the executable image cache: %s", sys_errlist[result]);
+	}
+
 	if ((result = sessionManagerInitialize()) != SUCCESS) {
 		errorHandlerFatalError("Could not initialize the session manager: %s", sys_errlist[result]);
 	}
@@ -367,7 +395,7 @@ void __attribute__ ((cdecl)) MyOSMain(uint32_t eax, struct multiboot_info* multi
 	//logDebug("Testing the speaker.\n\n");
 	//speakerManagerPlaySound1();
 
-	pitStartTickGenerator(100); /* Every 10 millisecond approximately. */
+	pitStartTimer();
 
 	keyboardInitializeHardware();
 
@@ -380,6 +408,10 @@ void __attribute__ ((cdecl)) MyOSMain(uint32_t eax, struct multiboot_info* multi
 
 	keyboardSetIsIgnoringInput(false);
 
+	if ((result = blockCacheManagerStartWriteBack()) != SUCCESS) {
+		errorHandlerFatalError("Could not start the block cache write back: %s", sys_errlist[result]);
+	}
+
 	/* This call never returns. */
 	processManagerStartScheduling();
 	assert(false);
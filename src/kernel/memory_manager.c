@@ -33,13 +33,29 @@ static uint32_t systemPageTablesCount;
 
 extern uint32_t FIRST_PAGE_FRAME_ADDRESS;
 
+/*
+ * The available page frames are managed by a buddy system: a free block of order N has 2^N physically contiguous page
+ * frames and its first page frame number is a multiple of 2^N. Only the first page frame of a free block is inserted
+ * into the list of its order.
+ */
+struct PageFrameZone {
+	uint32_t firstPageFrameIndex;
+	uint32_t firstInvalidPageFrameIndex;
+	uint32_t availablePageFrameCount;
+	struct DoubleLinkedList freeBlocksLists[PAGE_FRAME_MAX_ORDER + 1];
+};
+
+#define NOT_A_FREE_BLOCK 0xFF
+
 static struct DoubleLinkedListElement* pageFrameListElements;
+static uint16_t* pageFrameReferenceCounts; /* A page frame may be shared by many processes (copy-on-write). */
+static uint8_t* pageFrameFreeBlockOrders; /* The order of the free block that starts at the page frame (if any). */
 static uint32_t firstFrameAddress;
 static uint32_t firstInvalidPageFrameAddress;
 static uint32_t firstUserSpacePageFrameIndex;
 static int availablePageFramesCount;
-static struct DoubleLinkedList kernelSpaceAvailablePageFrameList;
-static struct DoubleLinkedList userSpaceAvailablePageFrameList;
+static struct PageFrameZone kernelSpaceZone;
+static struct PageFrameZone userSpaceZone;
 
 #define RESERVATION_ENTRIES_ARRAY_LENGTH 64
 static int reservedPageFrameCount = 0;
@@ -47,6 +63,8 @@ static int availableReservationEntries[RESERVATION_ENTRIES_ARRAY_LENGTH];
 static int totalReservationEntries[RESERVATION_ENTRIES_ARRAY_LENGTH];
 static int reservationEntryCount = 0;
 
+static uint32_t (*pageFrameReclaimer)(uint32_t pageFrameCount) = NULL;
+
 /*
  * Memory layout:
  *
@@ -66,7 +84,7 @@ static int reservationEntryCount = 0;
  */
 
 int memoryManagerReserveMemoryOnKernelSpace(uint32_t pageFrameCount) {
-	if (doubleLinkedListSize(&kernelSpaceAvailablePageFrameList) >= reservedPageFrameCount + pageFrameCount
+	if (kernelSpaceZone.availablePageFrameCount >= reservedPageFrameCount + pageFrameCount
 			&& reservationEntryCount + 1 < RESERVATION_ENTRIES_ARRAY_LENGTH) {
 		availableReservationEntries[reservationEntryCount] = pageFrameCount;
 		totalReservationEntries[reservationEntryCount] = pageFrameCount;
@@ -77,12 +95,17 @@ int memoryManagerReserveMemoryOnKernelSpace(uint32_t pageFrameCount) {
 	}
 }
 
+void memoryManagerRegisterPageFrameReclaimer(uint32_t (*reclaimer)(uint32_t pageFrameCount)) {
+	assert(pageFrameReclaimer == NULL);
+	pageFrameReclaimer = reclaimer;
+}
+
 uint32_t memoryManagerGetUserSpaceAvailablePageFrameCount(void) {
-	return doubleLinkedListSize(&userSpaceAvailablePageFrameList);
+	return userSpaceZone.availablePageFrameCount;
 }
 
 uint32_t memoryManagerGetKernelSpaceAvailablePageFrameCount(void) {
-	return doubleLinkedListSize(&kernelSpaceAvailablePageFrameList);
+	return kernelSpaceZone.availablePageFrameCount;
 }
 
 static uint32_t calculatePageFrameListElementIndex(struct DoubleLinkedListElement* pageFrameListElement) {
@@ -92,6 +115,90 @@ static uint32_t calculatePageFrameListElementIndex(struct DoubleLinkedListElemen
 	return index;
 }
 
+static struct PageFrameZone* getPageFrameZone(uint32_t index) {
+	return index >= firstUserSpacePageFrameIndex ? &userSpaceZone : &kernelSpaceZone;
+}
+
+static void insertFreeBlock(struct PageFrameZone* zone, uint32_t index, uint32_t order) {
+	pageFrameFreeBlockOrders[index] = order;
+	doubleLinkedListInsertBeforeFirst(&zone->freeBlocksLists[order], &pageFrameListElements[index]);
+}
+
+/* It returns the block to the zone merging it with its buddy (and the buddy of the merged block and so on) while possible. */
+static void releaseBlock(struct PageFrameZone* zone, uint32_t index, uint32_t order) {
+	assert(zone->firstPageFrameIndex <= index && index + (1 << order) <= zone->firstInvalidPageFrameIndex);
+	zone->availablePageFrameCount += 1 << order;
+
+	uint32_t firstPageFrameNumber = firstFrameAddress / PAGE_FRAME_SIZE;
+	while (order < PAGE_FRAME_MAX_ORDER) {
+		uint32_t buddyPageFrameNumber = (firstPageFrameNumber + index) ^ (1 << order);
+		if (buddyPageFrameNumber < firstPageFrameNumber) {
+			break;
+		}
+		uint32_t buddyIndex = buddyPageFrameNumber - firstPageFrameNumber;
+		if (buddyIndex < zone->firstPageFrameIndex || buddyIndex + (1 << order) > zone->firstInvalidPageFrameIndex
+				|| pageFrameFreeBlockOrders[buddyIndex] != order) {
+			break;
+		}
+
+		doubleLinkedListRemove(&zone->freeBlocksLists[order], &pageFrameListElements[buddyIndex]);
+		pageFrameFreeBlockOrders[buddyIndex] = NOT_A_FREE_BLOCK;
+		index = mathUtilsMin(index, buddyIndex);
+		order++;
+	}
+
+	insertFreeBlock(zone, index, order);
+}
+
+/*
+ * It returns the index of the first page frame of the block or -1 if there is no block large enough. Most requests are
+ * for a single page frame and they are served straight from the order 0 list while it is not empty.
+ */
+static int acquireBlock(struct PageFrameZone* zone, uint32_t order) {
+	uint32_t currentOrder = order;
+	while (currentOrder <= PAGE_FRAME_MAX_ORDER && doubleLinkedListSize(&zone->freeBlocksLists[currentOrder]) == 0) {
+		currentOrder++;
+	}
+	if (currentOrder > PAGE_FRAME_MAX_ORDER) {
+		return -1;
+	}
+
+	struct DoubleLinkedListElement* pageFrameListElement = doubleLinkedListRemoveFirst(&zone->freeBlocksLists[currentOrder]);
+	uint32_t index = calculatePageFrameListElementIndex(pageFrameListElement);
+	assert(pageFrameFreeBlockOrders[index] == currentOrder);
+	pageFrameFreeBlockOrders[index] = NOT_A_FREE_BLOCK;
+
+	/* The upper halves that are not needed become free blocks of lower orders. */
+	while (currentOrder > order) {
+		currentOrder--;
+		insertFreeBlock(zone, index + (1 << currentOrder), currentOrder);
+	}
+
+	zone->availablePageFrameCount -= 1 << order;
+	return index;
+}
+
+static void initializePageFrameZone(struct PageFrameZone* zone, uint32_t firstPageFrameIndex, uint32_t firstInvalidPageFrameIndex) {
+	zone->firstPageFrameIndex = firstPageFrameIndex;
+	zone->firstInvalidPageFrameIndex = firstInvalidPageFrameIndex;
+	zone->availablePageFrameCount = 0;
+	for (int order = 0; order <= PAGE_FRAME_MAX_ORDER; order++) {
+		doubleLinkedListInitialize(&zone->freeBlocksLists[order]);
+	}
+
+	/* It splits the zone in the largest aligned blocks possible. */
+	uint32_t firstPageFrameNumber = firstFrameAddress / PAGE_FRAME_SIZE;
+	uint32_t index = firstPageFrameIndex;
+	while (index < firstInvalidPageFrameIndex) {
+		uint32_t order = PAGE_FRAME_MAX_ORDER;
+		while ((firstPageFrameNumber + index) % (1 << order) != 0 || index + (1 << order) > firstInvalidPageFrameIndex) {
+			order--;
+		}
+		releaseBlock(zone, index, order);
+		index += 1 << order;
+	}
+}
+
 void memoryManagerInitialize(uint32_t multibootAmountOfUpperMemory) {
 	/* Calculate the memory limits. */
 	firstInvalidPageFrameAddress = FIRST_AVAILABLE_PAGE_FRAME_ADDRESS + multibootAmountOfUpperMemory * 1024;
@@ -129,11 +236,14 @@ void memoryManagerInitialize(uint32_t multibootAmountOfUpperMemory) {
 		systemPageTables[i] = systemPageTableEntry;
 	}
 
-	/* Request some page frames that will be used to store the list elements. */
+	/* Request some page frames that will be used to store the list elements, the reference counts and the free block orders. */
 	availablePageFramesCount = (firstInvalidPageFrameAddress - firstFrameAddress) / PAGE_FRAME_SIZE;
-	uint32_t pageFramesToStoreListElements = mathUtilsCeilOfUint32Division(availablePageFramesCount * sizeof(struct DoubleLinkedListElement), PAGE_FRAME_SIZE);
+	uint32_t pageFramesToStoreListElements = mathUtilsCeilOfUint32Division(availablePageFramesCount
+		* (sizeof(struct DoubleLinkedListElement) + sizeof(uint16_t) + sizeof(uint8_t)), PAGE_FRAME_SIZE);
 	availablePageFramesCount -= pageFramesToStoreListElements;
 	pageFrameListElements = (struct DoubleLinkedListElement*) firstFrameAddress;
+	pageFrameReferenceCounts = (uint16_t*) (pageFrameListElements + availablePageFramesCount);
+	pageFrameFreeBlockOrders = (uint8_t*) (pageFrameReferenceCounts + availablePageFramesCount);
 	firstFrameAddress += pageFramesToStoreListElements * PAGE_FRAME_SIZE;
 	if (firstFrameAddress >= firstInvalidPageFrameAddress) {
 		logDebug("There is no enough memory to proceed");
@@ -150,19 +260,14 @@ void memoryManagerInitialize(uint32_t multibootAmountOfUpperMemory) {
 
 	assert(firstUserSpacePageFrameIndex >= availablePageFramesCount
 		|| firstUserSpacePageFramePhysicalAddress == (uint32_t) memoryManagerGetPageFramePhysicalAddress(&pageFrameListElements[firstUserSpacePageFrameIndex]));
-	doubleLinkedListInitialize(&kernelSpaceAvailablePageFrameList);
-	doubleLinkedListInitialize(&userSpaceAvailablePageFrameList);
-	for (int i = availablePageFramesCount - 1; i >= 0; i--) {
-		if (i >= firstUserSpacePageFrameIndex) {
-			doubleLinkedListInsertAfterLast(&userSpaceAvailablePageFrameList, &pageFrameListElements[i]);
-			assert(firstUserSpacePageFramePhysicalAddress <= (uint32_t) memoryManagerGetPageFramePhysicalAddress(&pageFrameListElements[i]));
-		} else {
-			doubleLinkedListInsertAfterLast(&kernelSpaceAvailablePageFrameList, &pageFrameListElements[i]);
-			assert(firstUserSpacePageFramePhysicalAddress > (uint32_t) memoryManagerGetPageFramePhysicalAddress(&pageFrameListElements[i]));
-		}
+	for (int i = 0; i < availablePageFramesCount; i++) {
+		pageFrameReferenceCounts[i] = 0;
+		pageFrameFreeBlockOrders[i] = NOT_A_FREE_BLOCK;
 	}
-	assert(availablePageFramesCount == doubleLinkedListSize(&kernelSpaceAvailablePageFrameList)
-		+ doubleLinkedListSize(&userSpaceAvailablePageFrameList));
+	uint32_t firstInvalidKernelSpacePageFrameIndex = mathUtilsMin(firstUserSpacePageFrameIndex, availablePageFramesCount);
+	initializePageFrameZone(&kernelSpaceZone, 0, firstInvalidKernelSpacePageFrameIndex);
+	initializePageFrameZone(&userSpaceZone, firstInvalidKernelSpacePageFrameIndex, availablePageFramesCount);
+	assert(availablePageFramesCount == kernelSpaceZone.availablePageFrameCount + userSpaceZone.availablePageFrameCount);
 	assert(firstFrameAddress == (uint32_t) memoryManagerGetPageFramePhysicalAddress(&pageFrameListElements[0]));
 	assert(firstInvalidPageFrameAddress - PAGE_FRAME_SIZE == (uint32_t) memoryManagerGetPageFramePhysicalAddress(&pageFrameListElements[availablePageFramesCount - 1]));
 
@@ -193,8 +298,8 @@ void memoryManagerInitialize(uint32_t multibootAmountOfUpperMemory) {
 		firstUserSpacePageFrameIndex,
 		firstUserSpacePageFramePhysicalAddress,
 		availablePageFramesCount,
-		doubleLinkedListSize(&kernelSpaceAvailablePageFrameList),
-		doubleLinkedListSize(&userSpaceAvailablePageFrameList));
+		kernelSpaceZone.availablePageFrameCount,
+		userSpaceZone.availablePageFrameCount);
 }
 
 uint32_t memoryManagerGetSystemPageTablesCount(void) {
@@ -234,6 +339,16 @@ void memoryManagerRemovePageMapping(uint32_t* pageDirectory, uint32_t virtualAdd
 	pageTable[pageTableIndex] = PAGE_ENTRY_NOT_PRESENT;
 }
 
+uint32_t* memoryManagerGetPageTableEntry(uint32_t* pageDirectory, uint32_t virtualAddress) {
+	uint32_t pageDirectoryEntry = pageDirectory[virtualAddress >> 22];
+	if (pageDirectoryEntry & PAGE_ENTRY_PRESENT) {
+		uint32_t* pageTable = (uint32_t*) (pageDirectoryEntry & 0xFFFFF000);
+		return &pageTable[(virtualAddress >> 12) & 0x3FF];
+	} else {
+		return NULL;
+	}
+}
+
 bool memoryManagerConfigureMapping(struct DoubleLinkedListElement** newPageFrame, uint32_t* pageDirectory, uint32_t virtualAddress,
 		uint32_t physicalAddress, uint32_t flags) {
 	assert((flags & PAGE_ENTRY_SIZE_4_MBYTES) == 0);
@@ -280,10 +395,15 @@ bool memoryManagerConfigureMapping(struct DoubleLinkedListElement** newPageFrame
 struct DoubleLinkedListElement* memoryManagerAcquirePageFrame(bool kernelSpace, int reservationId) {
 	assert(reservationId < 0 || kernelSpace);
 
-	struct DoubleLinkedList* list = NULL;
+	struct PageFrameZone* zone = NULL;
 	if (kernelSpace) {
-		if (doubleLinkedListSize(&kernelSpaceAvailablePageFrameList) > 0 && (reservationId < 0 || availableReservationEntries[reservationId] > 0)) {
-			list = &kernelSpaceAvailablePageFrameList;
+		if (kernelSpaceZone.availablePageFrameCount == 0 && pageFrameReclaimer != NULL) {
+			/* Before giving up, it asks for some of the page frames that are only being used as a cache. */
+			pageFrameReclaimer(1);
+		}
+
+		if (kernelSpaceZone.availablePageFrameCount > 0 && (reservationId < 0 || availableReservationEntries[reservationId] > 0)) {
+			zone = &kernelSpaceZone;
 			if (reservationId >= 0) {
 				availableReservationEntries[reservationId]--;
 				reservedPageFrameCount--;
@@ -291,18 +411,53 @@ struct DoubleLinkedListElement* memoryManagerAcquirePageFrame(bool kernelSpace,
 		}
 
 	} else {
-		if (doubleLinkedListSize(&userSpaceAvailablePageFrameList) > 0) {
-			list = &userSpaceAvailablePageFrameList;
+		if (userSpaceZone.availablePageFrameCount > 0) {
+			zone = &userSpaceZone;
 
 		} else {
 			return memoryManagerAcquirePageFrame(true, -1);
 		}
 	}
 
-	if (list != NULL) {
-		struct DoubleLinkedListElement* pageFrameListElement = doubleLinkedListRemoveFirst(list);
-		assert((calculatePageFrameListElementIndex(pageFrameListElement) >= firstUserSpacePageFrameIndex) ^ kernelSpace);
-		return pageFrameListElement;
+	if (zone != NULL) {
+		int index = acquireBlock(zone, 0);
+		assert(index >= 0);
+		assert((index >= firstUserSpacePageFrameIndex) ^ kernelSpace);
+		assert(pageFrameReferenceCounts[index] == 0);
+		pageFrameReferenceCounts[index] = 1;
+		return &pageFrameListElements[index];
+
+	} else {
+		return NULL;
+	}
+}
+
+struct DoubleLinkedListElement* memoryManagerAcquirePageFrames(bool kernelSpace, uint32_t order) {
+	assert(order <= PAGE_FRAME_MAX_ORDER);
+
+	if (order == 0) {
+		return memoryManagerAcquirePageFrame(kernelSpace, -1);
+	}
+
+	int index = -1;
+	if (!kernelSpace) {
+		index = acquireBlock(&userSpaceZone, order);
+	}
+	if (index < 0) {
+		index = acquireBlock(&kernelSpaceZone, order);
+		if (index < 0 && pageFrameReclaimer != NULL) {
+			/* The reclaimed page frames might be merged into a block large enough. */
+			pageFrameReclaimer(1 << order);
+			index = acquireBlock(&kernelSpaceZone, order);
+		}
+	}
+
+	if (index >= 0) {
+		for (uint32_t i = 0; i < (1 << order); i++) {
+			assert(pageFrameReferenceCounts[index + i] == 0);
+			pageFrameReferenceCounts[index + i] = 1;
+		}
+		return &pageFrameListElements[index];
 
 	} else {
 		return NULL;
@@ -312,12 +467,17 @@ struct DoubleLinkedListElement* memoryManagerAcquirePageFrame(bool kernelSpace,
 void memoryManagerReleasePageFrame(struct DoubleLinkedListElement* pageFrameListElement, int reservationId) {
 	uint32_t index = calculatePageFrameListElementIndex(pageFrameListElement);
 
-	struct DoubleLinkedList* list = NULL;
+	assert(pageFrameReferenceCounts[index] > 0);
+	pageFrameReferenceCounts[index]--;
+	if (pageFrameReferenceCounts[index] > 0) {
+		/* Someone else is still using it. */
+		assert(reservationId == -1);
+		return;
+	}
+
 	if (index >= firstUserSpacePageFrameIndex) {
 		assert(reservationId == -1);
-		list = &userSpaceAvailablePageFrameList;
 	} else {
-		list = &kernelSpaceAvailablePageFrameList;
 		if (reservationId >= 0) {
 			assert(availableReservationEntries[reservationId] <= totalReservationEntries[reservationId]);
 			if (availableReservationEntries[reservationId] < totalReservationEntries[reservationId]) {
@@ -327,7 +487,31 @@ void memoryManagerReleasePageFrame(struct DoubleLinkedListElement* pageFrameList
 		}
 	}
 
-	doubleLinkedListInsertBeforeFirst(list, pageFrameListElement);
+	releaseBlock(getPageFrameZone(index), index, 0);
+}
+
+void memoryManagerReleasePageFrames(struct DoubleLinkedListElement* pageFrameListElement, uint32_t order) {
+	assert(order <= PAGE_FRAME_MAX_ORDER);
+
+	uint32_t index = calculatePageFrameListElementIndex(pageFrameListElement);
+	assert((firstFrameAddress / PAGE_FRAME_SIZE + index) % (1 << order) == 0);
+	for (uint32_t i = 0; i < (1 << order); i++) {
+		/* The page frames of a block can not be shared. */
+		assert(pageFrameReferenceCounts[index + i] == 1);
+		pageFrameReferenceCounts[index + i] = 0;
+	}
+
+	releaseBlock(getPageFrameZone(index), index, order);
+}
+
+void memoryManagerSharePageFrame(struct DoubleLinkedListElement* pageFrameListElement) {
+	uint32_t index = calculatePageFrameListElementIndex(pageFrameListElement);
+	assert(0 < pageFrameReferenceCounts[index] && pageFrameReferenceCounts[index] < UINT16_MAX);
+	pageFrameReferenceCounts[index]++;
+}
+
+uint32_t memoryManagerGetPageFrameReferenceCount(struct DoubleLinkedListElement* pageFrameListElement) {
+	return pageFrameReferenceCounts[calculatePageFrameListElementIndex(pageFrameListElement)];
 }
 
 uint32_t memoryManagerGetPageFramePhysicalAddress(struct DoubleLinkedListElement* pageFrameListElement) {
@@ -346,15 +530,38 @@ struct DoubleLinkedListElement* memoryManagerGetPageFrameDoubleLinkedListElement
 		return pageFrameListElements + index;
 }
 
+static void appendPageFrameZoneInformation(struct StringStreamWriter* stringStreamWriter, const char* name, struct PageFrameZone* zone) {
+	uint32_t largestFreeBlockPageFrameCount = 0;
+	streamWriterFormat(&stringStreamWriter->streamWriter, "  %s:\n", name);
+	streamWriterFormat(&stringStreamWriter->streamWriter, "    availablePageFrameCount=%u\n", zone->availablePageFrameCount);
+	streamWriterFormat(&stringStreamWriter->streamWriter, "    free blocks per order:");
+	for (int order = 0; order <= PAGE_FRAME_MAX_ORDER; order++) {
+		int freeBlockCount = doubleLinkedListSize(&zone->freeBlocksLists[order]);
+		streamWriterFormat(&stringStreamWriter->streamWriter, " %d", freeBlockCount);
+		if (freeBlockCount > 0) {
+			largestFreeBlockPageFrameCount = 1 << order;
+		}
+	}
+	streamWriterFormat(&stringStreamWriter->streamWriter, "\n");
+
+	/* How much of the available memory can not be used by the largest allocation possible (0 means no fragmentation at all). */
+	uint32_t fragmentation = 0;
+	if (zone->availablePageFrameCount > 0) {
+		fragmentation = 100 - (largestFreeBlockPageFrameCount * 100) / zone->availablePageFrameCount;
+	}
+	streamWriterFormat(&stringStreamWriter->streamWriter, "    largestFreeBlockPageFrameCount=%u\n", largestFreeBlockPageFrameCount);
+	streamWriterFormat(&stringStreamWriter->streamWriter, "    fragmentation=%u%%\n", fragmentation);
+}
+
 APIStatusCode memoryManagerPrintDebugReport(void) {
-	int bufferSize = 512;
+	int bufferSize = 1024;
 	char buffer[bufferSize];
 	struct StringStreamWriter stringStreamWriter;
 
 	stringStreamWriterInitialize(&stringStreamWriter, buffer, bufferSize);
 	streamWriterFormat(&stringStreamWriter.streamWriter, "Memory manager report:\n");
-	streamWriterFormat(&stringStreamWriter.streamWriter, "  userSpaceAvailablePageFrameCount=%d\n", memoryManagerGetUserSpaceAvailablePageFrameCount());
-	streamWriterFormat(&stringStreamWriter.streamWriter, "  kernelSpaceAvailablePageFrameCount=%d\n", memoryManagerGetKernelSpaceAvailablePageFrameCount());
+	appendPageFrameZoneInformation(&stringStreamWriter, "userSpace", &userSpaceZone);
+	appendPageFrameZoneInformation(&stringStreamWriter, "kernelSpace", &kernelSpaceZone);
 	stringStreamWriterForceTerminationCharacter(&stringStreamWriter);
 
 	logDebug("%s", buffer);
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kernel/log.h"
+#include "kernel/pci.h"
+#include "kernel/x86.h"
+
+/*
+ * References:
+ * - PCI Local Bus Specification (Revision 3.0)
+ * - https://wiki.osdev.org/PCI
+ */
+
+#define CONFIGURATION_ADDRESS_PORT 0xCF8
+#define CONFIGURATION_DATA_PORT 0xCFC
+
+#define BUS_COUNT 256
+#define DEVICES_PER_BUS 32
+#define FUNCTIONS_PER_DEVICE 8
+
+#define INVALID_VENDOR_ID 0xFFFF
+#define HEADER_TYPE_MULTI_FUNCTION_MASK 0x80
+
+/*
+ * It uses the "Configuration Mechanism #1".
+ */
+static void selectConfigurationRegister(uint8_t bus, uint8_t device, uint8_t function, uint8_t registerOffset) {
+	assert(device < DEVICES_PER_BUS);
+	assert(function < FUNCTIONS_PER_DEVICE);
+	assert(registerOffset % sizeof(uint32_t) == 0);
+
+	uint32_t address = 0x80000000 | (((uint32_t) bus) << 16) | (((uint32_t) device) << 11) | (((uint32_t) function) << 8) | registerOffset;
+	x86OutputDoubleWordToPort(CONFIGURATION_ADDRESS_PORT, address);
+}
+
+static uint32_t readConfigurationDoubleWord(uint8_t bus, uint8_t device, uint8_t function, uint8_t registerOffset) {
+	selectConfigurationRegister(bus, device, function, registerOffset);
+	return x86InputDoubleWordFromPort(CONFIGURATION_DATA_PORT);
+}
+
+uint32_t pciReadConfigurationDoubleWord(struct PCIFunction* pciFunction, uint8_t registerOffset) {
+	return readConfigurationDoubleWord(pciFunction->bus, pciFunction->device, pciFunction->function, registerOffset);
+}
+
+void pciWriteConfigurationDoubleWord(struct PCIFunction* pciFunction, uint8_t registerOffset, uint32_t value) {
+	selectConfigurationRegister(pciFunction->bus, pciFunction->device, pciFunction->function, registerOffset);
+	x86OutputDoubleWordToPort(CONFIGURATION_DATA_PORT, value);
+}
+
+static bool matchFunction(uint8_t bus, uint8_t device, uint8_t function, uint8_t classCode, uint8_t subclass, struct PCIFunction* pciFunction) {
+	uint32_t vendorIdAndDeviceId = readConfigurationDoubleWord(bus, device, function, PCI_VENDOR_ID_AND_DEVICE_ID_REGISTER);
+	uint32_t classCodeRegister = readConfigurationDoubleWord(bus, device, function, PCI_CLASS_CODE_REGISTER);
+
+	if ((classCodeRegister >> 24) == classCode && ((classCodeRegister >> 16) & 0xFF) == subclass) {
+		pciFunction->bus = bus;
+		pciFunction->device = device;
+		pciFunction->function = function;
+		pciFunction->vendorId = vendorIdAndDeviceId & 0xFFFF;
+		pciFunction->deviceId = vendorIdAndDeviceId >> 16;
+		pciFunction->classCode = classCode;
+		pciFunction->subclass = subclass;
+		pciFunction->programmingInterface = (classCodeRegister >> 8) & 0xFF;
+
+		logDebug("PCI function found at %d:%d.%d (vendorId=%.4X deviceId=%.4X classCode=%.2X subclass=%.2X programmingInterface=%.2X)",
+			bus, device, function, pciFunction->vendorId, pciFunction->deviceId, classCode, subclass, pciFunction->programmingInterface);
+		return true;
+
+	} else {
+		return false;
+	}
+}
+
+/*
+ * It performs a brute-force scan as there is no need to be fast and it does not depend on how the bridges were configured.
+ */
+bool pciFindFunctionByClass(uint8_t classCode, uint8_t subclass, struct PCIFunction* pciFunction) {
+	for (uint32_t bus = 0; bus < BUS_COUNT; bus++) {
+		for (uint8_t device = 0; device < DEVICES_PER_BUS; device++) {
+			uint32_t vendorIdAndDeviceId = readConfigurationDoubleWord(bus, device, 0, PCI_VENDOR_ID_AND_DEVICE_ID_REGISTER);
+			if ((vendorIdAndDeviceId & 0xFFFF) != INVALID_VENDOR_ID) {
+				uint8_t headerType = (readConfigurationDoubleWord(bus, device, 0, PCI_HEADER_TYPE_REGISTER) >> 16) & 0xFF;
+				uint8_t functionCount = (headerType & HEADER_TYPE_MULTI_FUNCTION_MASK) ? FUNCTIONS_PER_DEVICE : 1;
+
+				for (uint8_t function = 0; function < functionCount; function++) {
+					if (function == 0 || (readConfigurationDoubleWord(bus, device, function, PCI_VENDOR_ID_AND_DEVICE_ID_REGISTER) & 0xFFFF) != INVALID_VENDOR_ID) {
+						if (matchFunction(bus, device, function, classCode, subclass, pciFunction)) {
+							return true;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
@@ -76,22 +76,12 @@ static void handleIRQ7(uint32_t errorCode, struct ProcessExecutionState1* proces
 	interruptionManagerRegisterCommandToRunAfterInterruptionHandler(PRIORITY_LOWEST, (void(*)(void*)) &issueEndOfIRQ7, NULL);
 }
 
-static void issueEndOfIRQ15(void) {
-	picIssueEndOfInterrupt(IRQ15, true);
-}
-
-static void handleIRQ15(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
-	assert(picIsSpuriousIRQ(IRQ15));
-	logDebug("An spurious IRQ just happened (IRQ15)");
-	interruptionManagerRegisterCommandToRunAfterInterruptionHandler(PRIORITY_LOWEST, (void(*)(void*)) &issueEndOfIRQ15, NULL);
-}
-
 void picInitialize(uint8_t newMasterFirstInterruptionVector, uint8_t newSlaveFirstInterruptionVector) {
 	masterFirstInterruptionVector = newMasterFirstInterruptionVector;
 	slaveFirstInterruptionVector = newSlaveFirstInterruptionVector;
 
 	interruptionManagerRegisterInterruptionHandler(masterFirstInterruptionVector + 7, &handleIRQ7);
-	interruptionManagerRegisterInterruptionHandler(slaveFirstInterruptionVector + 7, &handleIRQ15);
+	/* IRQ15 is used by the secondary IDE channel: its handler also checks for spurious IRQs (see "ataInitialize"). */
 }
 
 void picInitializeHardware(void) {
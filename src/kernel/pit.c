@@ -22,6 +22,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "kernel/clock_manager.h"
 #include "kernel/command_scheduler.h"
 #include "kernel/interruption_manager.h"
 #include "kernel/log.h"
@@ -29,6 +30,8 @@
 #include "kernel/pic.h"
 #include "kernel/x86.h"
 
+#include "util/math_utils.h"
+
 /*
  * References:
  * - 82C54 CHMOS Programable Internal Timer
@@ -45,14 +48,20 @@
 #define PIT_MODE_2_RATE_GENERATOR 0x4
 #define PIT_MODE_3_SQUARE_WAVE_MODE 0x6
 
+/* The counter decrements at 1193182 Hz: "(nanoseconds * PIT_COUNTS_PER_NANOSECOND_MULTIPLIER) >> 32" is the count. */
+#define PIT_COUNTS_PER_NANOSECOND_MULTIPLIER 5124678
+#define PIT_MAXIMUM_TIMER_DELAY_IN_NANOSECONDS 54900000 /* It must fit in the 16-bit counter. */
+
 /*
  * Begin of data related with counter 0.
  */
-static uint64_t tickCount;
-static uint32_t millisecondsBetweenTicks;
+static uint64_t tickCount; /* A tick is each interruption of the one-shot timer. */
 static uint8_t pitInterruptionVector;
 
 static bool counter0IsEnabled;
+static bool timerIsStarted = false;
+static bool timerIsArmed = false;
+static uint64_t timerDeadlineInNanoseconds;
 struct CommandToRunOnTick {
 	void (*command)(uint64_t, uint64_t);
 };
@@ -89,6 +98,8 @@ static void handlePITIRQ(uint32_t errorCode, struct ProcessExecutionState1* proc
 	if (counter0IsEnabled) {
 		if (chronometerCallback == NULL) {
 			tickCount++;
+			/* The commands arm the timer again if they need (nothing else is pending otherwise). */
+			timerIsArmed = false;
 
 			interruptionManagerRegisterCommandToRunAfterInterruptionHandler(PRIORITY_LOWEST, (void(*)(void*)) &issueEndOfPITIRQ, NULL);
 			indexOfNextTickCommandToRun = 0;
@@ -119,7 +130,6 @@ static void pitConfigureCounter(uint8_t counter, uint32_t frequencyOrCount, uint
 	} else {
 		value = 1193182 / frequencyOrCount;
 		assert(frequencyOrCount <= 1000);
-		millisecondsBetweenTicks = 1000 / frequencyOrCount;
 	}
 	assert((value & 0xFFFF0000) >> 16 == 0);
 
@@ -170,21 +180,59 @@ void pitStartChronometer(uint32_t count, void (*newChronometerCallback)()) {
 	pitConfigureCounter(0, count, PIT_MODE_0_TERMINAL_COUNT);
 }
 
-void pitStartTickGenerator(uint32_t frequency) {
-	pitConfigureCounter(0, frequency, PIT_MODE_2_RATE_GENERATOR);
+/**
+ * The counter 0 is used as a one-shot timer: it is only armed for the nearest deadline requested through "pitArmTimer". Therefore,
+ * the processor is not interrupted periodically while it is idle.
+ */
+void pitStartTimer(void) {
+	assert(chronometerCallback == NULL);
+	timerIsStarted = true;
+	/* The first tick allows the commands to arm the timer for what they have been waiting for. */
+	pitArmTimer(clockManagerGetUpTimeInNanoseconds());
 }
 
-void pitStopTickGenerator() {
+void pitStopTimer(void) {
+	timerIsStarted = false;
+	timerIsArmed = false;
 	pitConfigureCounter(0, 1, PIT_MODE_0_TERMINAL_COUNT);
 	counter0IsEnabled = false;
 }
 
+/**
+ * The timer interrupts at (or just after) the requested up time unless it has already been armed for an earlier one. As the
+ * counter has only 16 bits, a distant deadline causes an earlier tick and the command must arm the timer again.
+ */
+void pitArmTimer(uint64_t upTimeInNanoseconds) {
+	if (!timerIsStarted || (timerIsArmed && timerDeadlineInNanoseconds <= upTimeInNanoseconds)) {
+		return;
+	}
+
+	bool areInterruptionsEnabled = (x86GetEflags() & EFLAGS_INTERRUPT_ENABLE_FLAG_MASK) != 0;
+	x86Cli();
+
+	uint64_t currentUpTimeInNanoseconds = clockManagerGetUpTimeInNanoseconds();
+	uint64_t delayInNanoseconds = 0;
+	if (upTimeInNanoseconds > currentUpTimeInNanoseconds) {
+		delayInNanoseconds = mathUtilsMin(upTimeInNanoseconds - currentUpTimeInNanoseconds, PIT_MAXIMUM_TIMER_DELAY_IN_NANOSECONDS);
+	}
+	/* The count is rounded up as the interruption must not happen before the deadline. */
+	uint32_t count = (uint32_t) mathUtilsMultiplyAndShiftRight(delayInNanoseconds, PIT_COUNTS_PER_NANOSECOND_MULTIPLIER, 32) + 1;
+
+	timerIsArmed = true;
+	timerDeadlineInNanoseconds = currentUpTimeInNanoseconds + delayInNanoseconds;
+	pitConfigureCounter(0, count, PIT_MODE_0_TERMINAL_COUNT);
+
+	if (areInterruptionsEnabled) {
+		x86Sti();
+	}
+}
+
 void pitConfigureSpeakerCounter(uint32_t frequency) {
 	pitConfigureCounter(2, frequency, PIT_MODE_3_SQUARE_WAVE_MODE);
 }
 
 uint64_t pitGetUpTimeInMilliseconds(void) {
-	return tickCount * millisecondsBetweenTicks;
+	return mathUtilsDivideUint64ByUint32(clockManagerGetUpTimeInNanoseconds(), 1000000, NULL);
 }
 
 bool pitRegisterCommandToRunOnTick(void (*command)(uint64_t, uint64_t)) {
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "kernel/log.h"
+#include "kernel/memory_manager.h"
+
+#include "kernel/io/virtual_file_system_manager.h"
+
+#include "kernel/process/executable_image_cache.h"
+#include "kernel/process/process.h"
+
+#include "util/math_utils.h"
+#include "util/string_stream_writer.h"
+
+/* Images not used by any process are kept (so the next execution does not need to read the file again) up to this limit. */
+#define MAX_UNUSED_EXECUTABLE_IMAGES 8
+
+_Static_assert(EXECUTABLE_MAX_SIZE / PAGE_FRAME_SIZE * sizeof(uint32_t) <= PAGE_FRAME_SIZE,
+	"The page frames array of an executable image must fit inside a page frame.");
+
+/* The most recently used images are at the beginning. */
+static struct DoubleLinkedList executableImagesList;
+static struct DoubleLinkedList availableExecutableImagesList;
+static uint32_t unusedExecutableImageCount;
+
+static void releaseExecutableImage(struct Process* process, struct ExecutableImage* executableImage) {
+	assert(executableImage->usageCount == 0);
+
+	uint32_t pageCount = mathUtilsCeilOfUint32Division(executableImage->size, PAGE_FRAME_SIZE);
+	for (uint32_t i = 0; i < pageCount; i++) {
+		uint32_t physicalAddress = executableImage->pageFrames[i];
+		if (physicalAddress != 0) {
+			memoryManagerReleasePageFrame(memoryManagerGetPageFrameDoubleLinkedListElement(physicalAddress), -1);
+		}
+	}
+	memoryManagerReleasePageFrame(memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) executableImage->pageFrames), -1);
+
+	virtualFileSystemManagerCloseOpenFileDescription(process, executableImage->openFileDescription);
+
+	if (executableImage->isValid) {
+		assert(unusedExecutableImageCount > 0);
+		unusedExecutableImageCount--;
+	}
+	doubleLinkedListRemove(&executableImagesList, &executableImage->doubleLinkedListElement);
+	memset(executableImage, 0, sizeof(struct ExecutableImage));
+	doubleLinkedListInsertAfterLast(&availableExecutableImagesList, &executableImage->doubleLinkedListElement);
+}
+
+static bool releaseLeastRecentlyUsedUnusedExecutableImage(struct Process* process) {
+	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListLast(&executableImagesList);
+	while (doubleLinkedListElement != NULL) {
+		struct ExecutableImage* executableImage = (void*) doubleLinkedListElement;
+		if (executableImage->usageCount == 0) {
+			releaseExecutableImage(process, executableImage);
+			return true;
+		}
+		doubleLinkedListElement = doubleLinkedListElement->previous;
+	}
+
+	return false;
+}
+
+static void invalidateExecutableImage(struct Process* process, struct ExecutableImage* executableImage) {
+	if (executableImage->isValid) {
+		logDebug("Invalidating the executable image of inode %u from device %u", executableImage->iNodeNumber, executableImage->deviceId);
+		if (executableImage->usageCount == 0) {
+			releaseExecutableImage(process, executableImage);
+
+		} else {
+			/* It will be released when the last process stops using it. */
+			executableImage->isValid = false;
+		}
+	}
+}
+
+APIStatusCode executableImageCacheInitialize(void) {
+	doubleLinkedListInitialize(&executableImagesList);
+	doubleLinkedListInitialize(&availableExecutableImagesList);
+	unusedExecutableImageCount = 0;
+
+	struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
+	if (doubleLinkedListElement == NULL) {
+		return ENOMEM;
+
+	} else {
+		struct ExecutableImage* executableImages = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+		memset(executableImages, 0, PAGE_FRAME_SIZE);
+		for (int i = 0; i < PAGE_FRAME_SIZE / sizeof(struct ExecutableImage); i++) {
+			doubleLinkedListInsertAfterLast(&availableExecutableImagesList, &executableImages[i].doubleLinkedListElement);
+		}
+		return SUCCESS;
+	}
+}
+
+APIStatusCode executableImageCacheAcquire(struct Process* process, struct OpenFileDescription* openFileDescription,
+		struct stat* statInstance, struct ExecutableImage** executableImage) {
+	assert(0 < statInstance->st_size && statInstance->st_size <= EXECUTABLE_MAX_SIZE);
+
+	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&executableImagesList);
+	while (doubleLinkedListElement != NULL) {
+		struct ExecutableImage* currentExecutableImage = (void*) doubleLinkedListElement;
+		doubleLinkedListElement = doubleLinkedListElement->next;
+
+		if (currentExecutableImage->isValid && currentExecutableImage->deviceId == statInstance->st_dev
+				&& currentExecutableImage->iNodeNumber == statInstance->st_ino) {
+			if (currentExecutableImage->modificationTime == statInstance->st_mtime && currentExecutableImage->size == (size_t) statInstance->st_size) {
+				if (currentExecutableImage->usageCount == 0) {
+					assert(unusedExecutableImageCount > 0);
+					unusedExecutableImageCount--;
+				}
+				currentExecutableImage->usageCount++;
+				doubleLinkedListRemove(&executableImagesList, &currentExecutableImage->doubleLinkedListElement);
+				doubleLinkedListInsertBeforeFirst(&executableImagesList, &currentExecutableImage->doubleLinkedListElement);
+				*executableImage = currentExecutableImage;
+				return SUCCESS;
+
+			} else {
+				/* The file has changed since the image was created. */
+				invalidateExecutableImage(process, currentExecutableImage);
+			}
+		}
+	}
+
+	if (doubleLinkedListSize(&availableExecutableImagesList) == 0 && !releaseLeastRecentlyUsedUnusedExecutableImage(process)) {
+		return ENOMEM;
+	}
+
+	/* A page frame is enough to store the addresses of all page frames of the largest executable. */
+	doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
+	if (doubleLinkedListElement == NULL) {
+		return ENOMEM;
+	}
+
+	struct ExecutableImage* newExecutableImage = (void*) doubleLinkedListRemoveFirst(&availableExecutableImagesList);
+	newExecutableImage->pageFrames = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+	memset(newExecutableImage->pageFrames, 0, PAGE_FRAME_SIZE);
+	newExecutableImage->openFileDescription = openFileDescription;
+	openFileDescription->usageCount++;
+	newExecutableImage->deviceId = statInstance->st_dev;
+	newExecutableImage->iNodeNumber = statInstance->st_ino;
+	newExecutableImage->modificationTime = statInstance->st_mtime;
+	newExecutableImage->size = statInstance->st_size;
+	newExecutableImage->usageCount = 1;
+	newExecutableImage->isValid = true;
+	doubleLinkedListInsertBeforeFirst(&executableImagesList, &newExecutableImage->doubleLinkedListElement);
+
+	*executableImage = newExecutableImage;
+	return SUCCESS;
+}
+
+void executableImageCacheReserve(struct ExecutableImage* executableImage) {
+	assert(executableImage->usageCount > 0);
+	executableImage->usageCount++;
+}
+
+void executableImageCacheRelease(struct Process* process, struct ExecutableImage* executableImage) {
+	assert(executableImage->usageCount > 0);
+	executableImage->usageCount--;
+
+	if (executableImage->usageCount == 0) {
+		if (executableImage->isValid) {
+			unusedExecutableImageCount++;
+			if (unusedExecutableImageCount > MAX_UNUSED_EXECUTABLE_IMAGES) {
+				bool result = releaseLeastRecentlyUsedUnusedExecutableImage(process);
+				assert(result);
+			}
+
+		} else {
+			releaseExecutableImage(process, executableImage);
+		}
+	}
+}
+
+uint32_t executableImageCacheGetPageFrame(struct ExecutableImage* executableImage, uint32_t pageIndex) {
+	assert(pageIndex < mathUtilsCeilOfUint32Division(executableImage->size, PAGE_FRAME_SIZE));
+	return executableImage->pageFrames[pageIndex];
+}
+
+void executableImageCacheSetPageFrame(struct ExecutableImage* executableImage, uint32_t pageIndex, uint32_t physicalAddress) {
+	assert(pageIndex < mathUtilsCeilOfUint32Division(executableImage->size, PAGE_FRAME_SIZE));
+	assert(executableImage->pageFrames[pageIndex] == 0);
+
+	/* The image keeps its own reference to the page frame. */
+	memoryManagerSharePageFrame(memoryManagerGetPageFrameDoubleLinkedListElement(physicalAddress));
+	executableImage->pageFrames[pageIndex] = physicalAddress;
+}
+
+/*
+ * It must be called before a file is modified. The processes executing it read their code segment pages from the file on
+ * demand, so a file being executed can not be modified (ETXTBSY).
+ */
+APIStatusCode executableImageCacheInvalidate(struct Process* process, struct VirtualFileSystemNode* virtualFileSystemNode) {
+	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&executableImagesList);
+	while (doubleLinkedListElement != NULL) {
+		struct ExecutableImage* executableImage = (void*) doubleLinkedListElement;
+		doubleLinkedListElement = doubleLinkedListElement->next;
+
+		if (executableImage->openFileDescription->virtualFileSystemNode == virtualFileSystemNode && executableImage->usageCount > 0) {
+			return ETXTBSY;
+		}
+	}
+
+	doubleLinkedListElement = doubleLinkedListFirst(&executableImagesList);
+	while (doubleLinkedListElement != NULL) {
+		struct ExecutableImage* executableImage = (void*) doubleLinkedListElement;
+		doubleLinkedListElement = doubleLinkedListElement->next;
+
+		if (executableImage->openFileDescription->virtualFileSystemNode == virtualFileSystemNode) {
+			invalidateExecutableImage(process, executableImage);
+		}
+	}
+
+	return SUCCESS;
+}
+
+APIStatusCode executableImageCachePrintDebugReport(void) {
+	int bufferSize = 512;
+	char buffer[bufferSize];
+	struct StringStreamWriter stringStreamWriter;
+
+	logDebug("Executable image cache report:\n");
+
+	struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&executableImagesList);
+	while (doubleLinkedListElement != NULL) {
+		struct ExecutableImage* executableImage = (void*) doubleLinkedListElement;
+		doubleLinkedListElement = doubleLinkedListElement->next;
+
+		uint32_t pageCount = mathUtilsCeilOfUint32Division(executableImage->size, PAGE_FRAME_SIZE);
+		uint32_t loadedPageCount = 0;
+		for (uint32_t i = 0; i < pageCount; i++) {
+			if (executableImage->pageFrames[i] != 0) {
+				loadedPageCount++;
+			}
+		}
+
+		stringStreamWriterInitialize(&stringStreamWriter, buffer, bufferSize);
+		streamWriterFormat(&stringStreamWriter.streamWriter, "ExecutableImage (device %u, inode %u)\n", executableImage->deviceId,
+			executableImage->iNodeNumber);
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  usageCount: %u\n", executableImage->usageCount);
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  isValid: %d\n", executableImage->isValid);
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  loaded pages: %u of %u\n", loadedPageCount, pageCount);
+		stringStreamWriterForceTerminationCharacter(&stringStreamWriter);
+
+		logDebug("%s", buffer);
+	}
+
+	return SUCCESS;
+}
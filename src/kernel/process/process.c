@@ -20,6 +20,7 @@
 #include <string.h>
 
 #include "kernel/process/process.h"
+#include "kernel/process/process_manager.h"
 
 bool processIsProcessGroupLeader(struct Process* process) {
 	struct ProcessGroup* processGroup = process->processGroup;
@@ -110,12 +111,19 @@ bool processIsValidSegmentAccess(struct Process* process, uint32_t firstAddress,
 			|| isValidSegmentAccess(firstAddress, lastAddress, &processMemorySegmentsLimits.data)
 			|| isValidSegmentAccess(firstAddress, lastAddress, &processMemorySegmentsLimits.stack));
 
+	/*
+	 * The segment pages are only backed by page frames after the first access. It is done now as a page fault can not use
+	 * the file system (or reclaim block cache page frames) while the kernel is using it.
+	 */
+	if (result && processManagerIsHoldingKernelLock(process)) {
+		result = processManagerPopulateSegmentPages(process, firstAddress, lastAddress);
+	}
+
 	return result;
 }
 
-static void calculateProcessMemorySegmentLimits(struct ProcessMemorySegmentLimits* processMemorySegmentLimits, struct DoubleLinkedList* dataSegmentPageFramesList,
+static void calculateProcessMemorySegmentLimits(struct ProcessMemorySegmentLimits* processMemorySegmentLimits, uint32_t pageFrameCount,
 		uint32_t segmentFirstOrLastAddress, bool isFirstAddress) {
-	int pageFrameCount = doubleLinkedListSize(dataSegmentPageFramesList);
 	if (pageFrameCount > 0) {
 		processMemorySegmentLimits->isEmpty = false;
 		uint32_t firstAddress;
@@ -144,9 +152,9 @@ APIStatusCode processGetProcessMemorySegmentsLimits(struct Process* process, str
 		bool verifyUserAddress) {
 	APIStatusCode result = SUCCESS;
 	if (!verifyUserAddress || processIsValidSegmentAccess(process, (uint32_t) processMemorySegmentsLimits, sizeof(struct ProcessMemorySegmentsLimits))) {
-		calculateProcessMemorySegmentLimits(&processMemorySegmentsLimits->code, &process->codeSegmentPageFramesList, CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true);
-		calculateProcessMemorySegmentLimits(&processMemorySegmentsLimits->data, &process->dataSegmentPageFramesList, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true);
-		calculateProcessMemorySegmentLimits(&processMemorySegmentsLimits->stack, &process->stackSegmentPageFramesList, STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER, false);
+		calculateProcessMemorySegmentLimits(&processMemorySegmentsLimits->code, process->codeSegmentPageCount, CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true);
+		calculateProcessMemorySegmentLimits(&processMemorySegmentsLimits->data, process->dataSegmentPageCount, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true);
+		calculateProcessMemorySegmentLimits(&processMemorySegmentsLimits->stack, process->stackSegmentPageCount, STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER, false);
 
 	} else {
 		result = EFAULT;
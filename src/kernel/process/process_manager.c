@@ -25,7 +25,10 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#include <myos.h>
+
 #include "kernel/assembly_globals.h"
+#include "kernel/clock_manager.h"
 #include "kernel/command_scheduler.h"
 #include "kernel/error_handler.h"
 #include "kernel/interruption_manager.h"
@@ -35,12 +38,14 @@
 #include "kernel/system_call_manager.h"
 #include "kernel/pit.h"
 #include "kernel/session_manager.h"
+#include "kernel/shared_data_manager.h"
 #include "kernel/tty.h"
 #include "kernel/x86.h"
 
 #include "kernel/io/open_file_description.h"
 #include "kernel/io/virtual_file_system_manager.h"
 
+#include "kernel/process/executable_image_cache.h"
 #include "kernel/process/process.h"
 #include "kernel/process/process_group.h"
 #include "kernel/process/process_group_manager.h"
@@ -63,28 +68,55 @@ const char* PROCESS_STATE_NAMES[] = {
 	"SUSPENDED_WAITING_WRITE",
 	"SUSPENDED_WAITING_IO_EVENT",
 	"STOPPED",
-	"WAITING_EXIT_STATUS_COLLECTION"
+	"WAITING_EXIT_STATUS_COLLECTION",
+	"SUSPENDED_WAITING_BLOCK_IO",
+	"SUSPENDED_WAITING_KERNEL_LOCK"
 };
 
-#define TICKS_PER_SCHEDULER_ITERATION_PER_PROCESS 3 /* Each tick represents 10 ms approximately. */
+/*
+ * The scheduler keeps a list of runnable processes per level. A process that uses its whole quantum is moved to the next
+ * (lower priority) level, which has a longer quantum. A process that waited for a TTY, a pipe or any other I/O event goes
+ * back to the level its nice value starts at.
+ */
+#define SCHEDULER_LEVEL_COUNT 8
+#define SCHEDULER_TICK_IN_NANOSECONDS 10000000
+#define SCHEDULER_QUANTUM_IN_TICKS(level) (2 + (level)) /* Each tick represents 10 ms. */
+#define SCHEDULER_BOOST_PERIOD_IN_TICKS 100 /* Every process goes back to its first level periodically (it avoids starvation). */
 
 extern uint8_t INITIALIZATION_STACK_TOP[];
 
 static struct X86TaskState systemX86TaskState;
 static uint32_t __attribute__((aligned(PAGE_FRAME_SIZE))) systemX86TaskPageDirectory[PAGE_DIRECTORY_LENGTH];
 static uint64_t systemX86TaskTSSSegmentDescriptor;
+static uint32_t systemKernelStackPointer; /* Saved while a process executes. */
 
-static volatile uint32_t schedulerIterationId = 1;
+static uint32_t ticksCountSinceLastSchedulerBoost = 0;
+/*
+ * The timer also interrupts at the command scheduler deadlines. Therefore, the scheduler ticks are counted by the elapsed
+ * time. The timer is only armed for them while there is a runnable process.
+ */
+static uint64_t nextSchedulerTickUpTimeInNanoseconds = 0;
 static volatile int nextProcessId = INIT_PROCESS_ID;
 
 static struct FixedCapacitySortedArray allProcessesArray;
-static struct DoubleLinkedList runnableProcessesList;
+static struct DoubleLinkedList runnableProcessesLists[SCHEDULER_LEVEL_COUNT];
+static uint32_t nonEmptyRunnableProcessesListsBitmap = 0;
+_Static_assert(SCHEDULER_LEVEL_COUNT <= 32, "The bitmap must have a bit per scheduler level.");
 
 static struct Process* volatile currentProcess = NULL; /* It is a volatile pointer to a non-volatile memory area. */
 static struct Process* initProcess = NULL;
+static pid_t lastProcessIdThatUsedFPU = 0;
 
 static struct FixedCapacitySortedArray possibleOrphanedProcessGroupsArray;
 
+/*
+ * As a process can be suspended while waiting for a block device, the kernel lock guarantees that only one process at a time
+ * executes a system call (the file systems and the block cache manager were written assuming that). A process releases it
+ * when it suspends itself for any other reason and acquires it again before resuming the system call execution.
+ */
+static struct Process* kernelLockOwner = NULL;
+static struct DoubleLinkedList kernelLockWaitingProcessList;
+
 static bool isValidProcessStateChange(enum ProcessState currentState, enum ProcessState newState) {
 	switch (currentState) {
 		case ABSENT:
@@ -96,6 +128,8 @@ static bool isValidProcessStateChange(enum ProcessState currentState, enum Proce
 		case SUSPENDED_WAITING_WRITE:
 		case SUSPENDED_WAITING_CHILD:
 		case SUSPENDED_SLEEPING:
+		case SUSPENDED_WAITING_BLOCK_IO:
+		case SUSPENDED_WAITING_KERNEL_LOCK:
 			return newState == RUNNABLE;
 		case STOPPED:
 			return newState == RUNNABLE;
@@ -104,6 +138,81 @@ static bool isValidProcessStateChange(enum ProcessState currentState, enum Proce
 	}
 }
 
+static enum ResumedProcessExecutionSituation doScheduleProcessExecution(uint64_t tickCount, uint64_t upTimeInMilliseconds, bool incrementTicksCountOnSchedulerLevel);
+
+__attribute__ ((cdecl)) void processStart();
+__attribute__ ((cdecl)) void contextSwitch(uint32_t* currentStackPointer, uint32_t newStackPointer, uint32_t newPageDirectory);
+
+static uint32_t calculateFirstSchedulerLevel(int niceValue) {
+	assert(-NZERO <= niceValue && niceValue < NZERO);
+	return (niceValue + NZERO) * SCHEDULER_LEVEL_COUNT / (2 * NZERO);
+}
+
+static void insertIntoRunnableProcessesList(struct Process* process) {
+	struct DoubleLinkedList* list = &runnableProcessesLists[process->schedulerLevel];
+	assert(!doubleLinkedListContainsFoward(list, &process->runnableProcessListElement));
+	doubleLinkedListInsertAfterLast(list, &process->runnableProcessListElement);
+	nonEmptyRunnableProcessesListsBitmap |= 1 << process->schedulerLevel;
+}
+
+static void removeFromRunnableProcessesList(struct Process* process) {
+	struct DoubleLinkedList* list = &runnableProcessesLists[process->schedulerLevel];
+	assert(doubleLinkedListContainsFoward(list, &process->runnableProcessListElement));
+	doubleLinkedListRemove(list, &process->runnableProcessListElement);
+	if (doubleLinkedListSize(list) == 0) {
+		nonEmptyRunnableProcessesListsBitmap &= ~(1 << process->schedulerLevel);
+	}
+}
+
+static void changeSchedulerLevel(struct Process* process, uint32_t schedulerLevel) {
+	assert(schedulerLevel < SCHEDULER_LEVEL_COUNT);
+	if (process->state == RUNNABLE) {
+		removeFromRunnableProcessesList(process);
+		process->schedulerLevel = schedulerLevel;
+		insertIntoRunnableProcessesList(process);
+	} else {
+		process->schedulerLevel = schedulerLevel;
+	}
+	process->ticksCountOnSchedulerLevel = 0;
+}
+
+static struct Process* getHighestPriorityRunnableProcess(void) {
+	if (nonEmptyRunnableProcessesListsBitmap != 0) {
+		int schedulerLevel = __builtin_ctz(nonEmptyRunnableProcessesListsBitmap);
+		return processGetProcessFromRunnableProcessListElement(doubleLinkedListFirst(&runnableProcessesLists[schedulerLevel]));
+	} else {
+		return NULL;
+	}
+}
+
+static void boostRunnableProcesses(void) {
+	for (int schedulerLevel = 0; schedulerLevel < SCHEDULER_LEVEL_COUNT; schedulerLevel++) {
+		struct DoubleLinkedListElement* listElement = doubleLinkedListFirst(&runnableProcessesLists[schedulerLevel]);
+		while (listElement != NULL) {
+			struct Process* process = processGetProcessFromRunnableProcessListElement(listElement);
+			listElement = listElement->next;
+			uint32_t firstSchedulerLevel = calculateFirstSchedulerLevel(process->niceValue);
+			if (process->schedulerLevel > firstSchedulerLevel) {
+				changeSchedulerLevel(process, firstSchedulerLevel);
+			}
+		}
+	}
+}
+
+static void handOverKernelLock(void) {
+	struct DoubleLinkedListElement* listElement = doubleLinkedListFirst(&kernelLockWaitingProcessList);
+	if (listElement != NULL) {
+		struct Process* process = processGetProcessFromIOProcessListElement(listElement);
+		assert(process->state == SUSPENDED_WAITING_KERNEL_LOCK);
+		processRemoveFromWaitingIOProcessList(process);
+		kernelLockOwner = process;
+		processManagerChangeProcessState(currentProcess, process, RUNNABLE, 0);
+
+	} else {
+		kernelLockOwner = NULL;
+	}
+}
+
 void processManagerChangeProcessState(struct Process* currentProcess, struct Process* targetProcess, enum ProcessState newState, int sourceSignalId) {
 	assert(targetProcess->state != WAITING_EXIT_STATUS_COLLECTION);
 	if (!isValidProcessStateChange(targetProcess->state, newState)) {
@@ -115,18 +224,67 @@ void processManagerChangeProcessState(struct Process* currentProcess, struct Pro
 
 	if (newState == RUNNABLE) {
 		if (targetProcess->state != RUNNABLE) {
-			assert(!doubleLinkedListContainsFoward(&runnableProcessesList, &targetProcess->runnableProcessListElement));
-			doubleLinkedListInsertAfterLast(&runnableProcessesList, &targetProcess->runnableProcessListElement);
+			if (processManagerGetCurrentProcess() == NULL) {
+				/* The idle task would only be interrupted at the next command scheduler deadline otherwise. */
+				pitArmTimer(clockManagerGetUpTimeInNanoseconds());
+			}
+			if (targetProcess->state == SUSPENDED_WAITING_READ || targetProcess->state == SUSPENDED_WAITING_WRITE
+					|| targetProcess->state == SUSPENDED_WAITING_IO_EVENT) {
+				/* It is probably interactive. */
+				targetProcess->schedulerLevel = calculateFirstSchedulerLevel(targetProcess->niceValue);
+				targetProcess->ticksCountOnSchedulerLevel = 0;
+			}
+			insertIntoRunnableProcessesList(targetProcess);
 			targetProcess->state = RUNNABLE;
 		}
 
 	} else {
 		if (targetProcess->state == RUNNABLE) {
-			assert(doubleLinkedListContainsFoward(&runnableProcessesList, &targetProcess->runnableProcessListElement));
-			doubleLinkedListRemove(&runnableProcessesList, &targetProcess->runnableProcessListElement);
+			removeFromRunnableProcessesList(targetProcess);
 		}
 		targetProcess->state = newState;
 	}
+
+	if (targetProcess == kernelLockOwner && newState != RUNNABLE && newState != SUSPENDED_WAITING_BLOCK_IO && newState != WAITING_EXIT_STATUS_COLLECTION) {
+		handOverKernelLock();
+	}
+}
+
+/*
+ * The wait can not be interrupted by a signal: the lock is also acquired again in the middle of a system call (after the
+ * process has been suspended for another reason), where the system call could not be abandoned. The wait is bounded by the
+ * system call the owner is executing and the signals are handled as soon as the waiter's system call completes.
+ */
+void processManagerAcquireKernelLock(struct Process* currentProcess) {
+	assert(currentProcess->state == RUNNABLE);
+
+	currentProcess->mustHoldKernelLock = true;
+	while (kernelLockOwner != NULL && kernelLockOwner != currentProcess) {
+		processServicesSuspendToWaitForIO(currentProcess, &kernelLockWaitingProcessList, SUSPENDED_WAITING_KERNEL_LOCK);
+		/* The lock is handed over before the process becomes runnable again. */
+		doScheduleProcessExecution(0, 0, false);
+	}
+	kernelLockOwner = currentProcess;
+}
+
+void processManagerReleaseKernelLock(struct Process* currentProcess) {
+	currentProcess->mustHoldKernelLock = false;
+	if (kernelLockOwner == currentProcess) {
+		handOverKernelLock();
+	}
+}
+
+bool processManagerIsHoldingKernelLock(struct Process* process) {
+	return process != NULL && kernelLockOwner == process;
+}
+
+bool processManagerIsKernelLockFree(void) {
+	return kernelLockOwner == NULL;
+}
+
+void processManagerChangeNiceValue(struct Process* process, int niceValue) {
+	process->niceValue = mathUtilsClampInt32(niceValue, -NZERO, NZERO - 1);
+	changeSchedulerLevel(process, calculateFirstSchedulerLevel(process->niceValue));
 }
 
 static void initializeSystemEntriesOfPageDirectory(uint32_t* pageDirectory, uint32_t systemPageTableCount) {
@@ -212,12 +370,33 @@ static void releasePageFrameList(struct DoubleLinkedList* doubleLinkedList) {
 	}
 }
 
+/* It releases (or stops sharing) the page frames mapped on a segment and removes their mappings. */
+static void releaseSegmentPageFrames(uint32_t* pageDirectory, uint32_t firstVirtualAddress, uint32_t firstPageIndex, uint32_t pageCount,
+		bool addressGrowsUpward, bool invalidateTLBEntries) {
+	for (uint32_t i = firstPageIndex; i < pageCount; i++) {
+		uint32_t virtualAddress = addressGrowsUpward ? firstVirtualAddress + i * PAGE_FRAME_SIZE : firstVirtualAddress - i * PAGE_FRAME_SIZE;
+		uint32_t* pageTableEntry = memoryManagerGetPageTableEntry(pageDirectory, virtualAddress);
+		if (pageTableEntry != NULL && (*pageTableEntry & PAGE_ENTRY_PRESENT)) {
+			memoryManagerReleasePageFrame(memoryManagerGetPageFrameDoubleLinkedListElement(*pageTableEntry & 0xFFFFF000), -1);
+			*pageTableEntry = PAGE_ENTRY_NOT_PRESENT;
+			if (invalidateTLBEntries) {
+				x86InvalidateTLBEntry(virtualAddress);
+			}
+		}
+	}
+}
+
 static void closeAllFileDescriptors(struct Process*  process) {
 	for (int i = 0; i < MAX_FILE_DESCRIPTORS_PER_PROCESS; i++) {
 		struct FileDescriptor* fileDescriptor = &process->fileDescriptors[i];
 		virtualFileSystemManagerCloseOpenFileDescription(process, fileDescriptor->openFileDescription);
 		process->fileDescriptors[i].openFileDescription = NULL;
 	}
+
+	if (process->executableImage != NULL) {
+		executableImageCacheRelease(process, process->executableImage);
+		process->executableImage = NULL;
+	}
 }
 
 void processManagerReleaseProcessResources(struct Process* process) {
@@ -246,9 +425,10 @@ void processManagerReleaseProcessResources(struct Process* process) {
 
 	fixedCapacitySortedArrayRemove(&allProcessesArray, &process->id);
 
-	releasePageFrameList(&process->codeSegmentPageFramesList);
-	releasePageFrameList(&process->stackSegmentPageFramesList);
-	releasePageFrameList(&process->dataSegmentPageFramesList);
+	uint32_t* pageDirectory = (uint32_t*) process->pageDirectory;
+	releaseSegmentPageFrames(pageDirectory, CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, 0, process->codeSegmentPageCount, true, false);
+	releaseSegmentPageFrames(pageDirectory, STACK_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, 0, process->stackSegmentPageCount, false, false);
+	releaseSegmentPageFrames(pageDirectory, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, 0, process->dataSegmentPageCount, true, false);
 
 	releasePageFrameList(&process->pagingPageFramesList);
 
@@ -287,6 +467,9 @@ void processManagerTerminate(struct Process* currentProcess, int exitStatus, int
 	assert(currentProcess->waitingIOProcessList == NULL);
 	assert(processCountIOEventsBeingMonitored(currentProcess) == 0);
 
+	/* Closing the file descriptors might require a file system. */
+	processManagerAcquireKernelLock(currentProcess);
+
 	currentProcess->exitStatus = exitStatus;
 
 	struct Session* currentProcessSession = processGetSession(currentProcess);
@@ -342,90 +525,96 @@ void processManagerTerminate(struct Process* currentProcess, int exitStatus, int
 			}
 		}
 	}
+
+	processManagerReleaseKernelLock(currentProcess);
 }
 
-static void doX86TaskSwitch(struct Process* newCurrentProcess) {
+static void doContextSwitch(struct Process* newCurrentProcess) {
+	struct Process* oldCurrentProcess = currentProcess;
 	currentProcess = newCurrentProcess;
 
+	uint32_t* oldKernelStackPointer = oldCurrentProcess == NULL ? &systemKernelStackPointer : &oldCurrentProcess->kernelStackPointer;
+	uint32_t newKernelStackPointer;
+	uint32_t newPageDirectory;
 	if (newCurrentProcess == NULL) {
-		x86WriteOnGDT(TASK_STATE_SEGMENT_DESCRIPTOR_INDEX, systemX86TaskTSSSegmentDescriptor);
+		newKernelStackPointer = systemKernelStackPointer;
+		newPageDirectory = systemX86TaskState.cr3;
+		sharedDataManagerSetCurrentProcess(0, 0);
+
 	} else {
-		x86WriteOnGDT(TASK_STATE_SEGMENT_DESCRIPTOR_INDEX, newCurrentProcess->tssSegmentDescriptor);
-	}
+		newKernelStackPointer = newCurrentProcess->kernelStackPointer;
+		newPageDirectory = newCurrentProcess->pageDirectory;
+		sharedDataManagerSetCurrentProcess(newCurrentProcess->id, newCurrentProcess->parentProcess != NULL ? newCurrentProcess->parentProcess->id : 0);
+
+		if (oldCurrentProcess == NULL) {
+			/* The timer might not be armed as the processor was idle. */
+			uint64_t upTimeInNanoseconds = clockManagerGetUpTimeInNanoseconds();
+			if (nextSchedulerTickUpTimeInNanoseconds <= upTimeInNanoseconds) {
+				nextSchedulerTickUpTimeInNanoseconds = upTimeInNanoseconds + SCHEDULER_TICK_IN_NANOSECONDS;
+			}
+			pitArmTimer(nextSchedulerTickUpTimeInNanoseconds);
+		}
 
-	uint64_t taskSegmentSelector = ((uint64_t) x86SegmentSelector(TASK_STATE_SEGMENT_DESCRIPTOR_INDEX, false, 0)) << 32;
+		/* The only TSS is used by the processor to find the kernel stack when an interruption happens on user mode. */
+		systemX86TaskState.esp0 = (uint32_t) (newCurrentProcess->systemStack + PAGE_FRAME_SIZE);
+
+		/*
+		 * The FPU state is switched lazily: the first FPU instruction executed by a process that does not own the FPU raises
+		 * a "device not available" exception.
+		 */
+		if (newCurrentProcess->id == lastProcessIdThatUsedFPU) {
+			x86ClearTaskSwitchedFlag();
+		} else {
+			x86SetTaskSwitchedFlag();
+		}
+	}
 
 	/*
-	 * When the processor executes a task switch, its current state will be saved on the task that is being executed.
-	 * There will be always one because we have started one during kernel initialization. However, the process state
-	 * will be stored on kernel stack associated with the current task (before the switch). Therefore, when it schedules the
-	 * process again, the kernel execution will be resumed just after the "ljmp" instruction.
+	 * The current kernel execution state is saved on its kernel stack. Therefore, when it schedules the process again, the
+	 * kernel execution will be resumed just after the "contextSwitch" call.
 	 */
-	__asm__ __volatile__("ljmp *%0"
-		:
-		: "m"(*&taskSegmentSelector)
-		: "cc", "memory");
+	contextSwitch(oldKernelStackPointer, newKernelStackPointer, newPageDirectory);
 }
 
 /**
- * Implements a round-robin scheduling policy.
+ * Implements a multilevel feedback queue scheduling policy. The selected process is always the first one of the highest
+ * priority non empty level.
  */
-static enum ResumedProcessExecutionSituation doScheduleProcessExecution(uint64_t tickCount, uint64_t upTimeInMilliseconds, bool incrementTicksCountSinceSchedulerIterationBegin) {
+static enum ResumedProcessExecutionSituation doScheduleProcessExecution(uint64_t tickCount, uint64_t upTimeInMilliseconds, bool incrementTicksCountOnSchedulerLevel) {
 	bool done = false;
 	enum ResumedProcessExecutionSituation resumedProcessExecutionSituation;
 
 	do {
 		bool doTaskSwitch = false;
-		struct Process* process = NULL; /* only for iterations */
 		struct Process* newCurrentProcessCandidate = NULL; /* While the decision has not been concluded yet. */
 		struct Process* newCurrentProcess = NULL;
 
-		newCurrentProcessCandidate = NULL;
-
-		if (currentProcess != NULL && currentProcess->state != RUNNABLE) {
-			if (doubleLinkedListSize(&runnableProcessesList) > 0) {
-				process = processGetProcessFromRunnableProcessListElement(doubleLinkedListFirst(&runnableProcessesList));
+		if (incrementTicksCountOnSchedulerLevel) {
+			if (currentProcess != NULL && currentProcess->state == RUNNABLE) {
+				currentProcess->ticksCountOnSchedulerLevel++;
+				if (currentProcess->ticksCountOnSchedulerLevel >= SCHEDULER_QUANTUM_IN_TICKS(currentProcess->schedulerLevel)) {
+					/* It goes to the end of the next level (or of the same one if it is already on the last). */
+					changeSchedulerLevel(currentProcess, mathUtilsMin(currentProcess->schedulerLevel + 1, SCHEDULER_LEVEL_COUNT - 1));
+				}
 			}
-		} else {
-			process = currentProcess;
-		}
-
-		while (process != NULL) {
-			if (process->idOfLastKnownSchedulerIteration != schedulerIterationId) {
-				assert(process->idOfLastKnownSchedulerIteration < schedulerIterationId);
-				process->ticksCountSinceSchedulerIterationBegin = 1;
-				process->idOfLastKnownSchedulerIteration = schedulerIterationId;
-				newCurrentProcessCandidate = process;
-				break;
 
-			} else {
-				if (incrementTicksCountSinceSchedulerIterationBegin) {
-					if (process->ticksCountSinceSchedulerIterationBegin + 1 <= TICKS_PER_SCHEDULER_ITERATION_PER_PROCESS) {
-						process->ticksCountSinceSchedulerIterationBegin++;
-						newCurrentProcessCandidate = process;
-						break;
-					}
-				} else {
-					newCurrentProcessCandidate = process;
-					break;
-				}
+			ticksCountSinceLastSchedulerBoost++;
+			if (ticksCountSinceLastSchedulerBoost >= SCHEDULER_BOOST_PERIOD_IN_TICKS) {
+				ticksCountSinceLastSchedulerBoost = 0;
+				boostRunnableProcesses();
 			}
 
-			process = processGetProcessFromRunnableProcessListElement(process->runnableProcessListElement.next);
+			/* The count must be incremented only once. */
+			incrementTicksCountOnSchedulerLevel = false;
 		}
 
-		if (newCurrentProcessCandidate == NULL && doubleLinkedListSize(&runnableProcessesList) > 0) {
-			schedulerIterationId++;
-			newCurrentProcessCandidate = processGetProcessFromRunnableProcessListElement(doubleLinkedListFirst(&runnableProcessesList));
-			newCurrentProcessCandidate->ticksCountSinceSchedulerIterationBegin = 1;
-			newCurrentProcessCandidate->idOfLastKnownSchedulerIteration = schedulerIterationId;
-		}
+		newCurrentProcessCandidate = getHighestPriorityRunnableProcess();
 
 		newCurrentProcess = NULL;
 		doTaskSwitch = false;
 		if (newCurrentProcessCandidate != NULL) {
 			assert(newCurrentProcessCandidate->state == RUNNABLE);
-			assert(newCurrentProcessCandidate->ticksCountSinceSchedulerIterationBegin <= TICKS_PER_SCHEDULER_ITERATION_PER_PROCESS);
+			assert(newCurrentProcessCandidate->ticksCountOnSchedulerLevel < SCHEDULER_QUANTUM_IN_TICKS(newCurrentProcessCandidate->schedulerLevel));
 
 			newCurrentProcess = newCurrentProcessCandidate;
 			if (newCurrentProcessCandidate != currentProcess) {
@@ -437,14 +626,10 @@ static enum ResumedProcessExecutionSituation doScheduleProcessExecution(uint64_t
 			doTaskSwitch = true;
 		}
 
-		if (newCurrentProcessCandidate != NULL) {
-			process = processGetProcessFromRunnableProcessListElement(newCurrentProcessCandidate->runnableProcessListElement.next);
-		}
-
 		done = true;
 		resumedProcessExecutionSituation = NORMAL_EXECUTION_RESUMED;
 		if (doTaskSwitch) {
-			doX86TaskSwitch(newCurrentProcess);
+			doContextSwitch(newCurrentProcess);
 
 			if (currentProcess != NULL) {
 				assert(currentProcess->state == RUNNABLE);
@@ -452,7 +637,11 @@ static enum ResumedProcessExecutionSituation doScheduleProcessExecution(uint64_t
 				processRemoveFromWaitingIOProcessList(currentProcess);
 				processStopMonitoringIOEvents(currentProcess);
 
-				while (currentProcess->mightHaveAnySignalToHandle && done) {
+				/*
+				 * The kernel lock owner is in the middle of a system call. Its signals will be handled after
+				 * it releases the lock.
+				 */
+				while (currentProcess->mightHaveAnySignalToHandle && done && kernelLockOwner != currentProcess) {
 					int signalIdToNotifyAbout;
 					switch (signalServicesCalculateSignalToHandle(currentProcess, &signalIdToNotifyAbout)) {
 						case CONTINUE_PROCESS_EXECUTION_THEN_USER_CALLBACK:
@@ -484,14 +673,25 @@ static enum ResumedProcessExecutionSituation doScheduleProcessExecution(uint64_t
 }
 
 enum ResumedProcessExecutionSituation processManagerScheduleProcessExecution(void) {
-	return doScheduleProcessExecution(0, 0, false);
+	enum ResumedProcessExecutionSituation resumedProcessExecutionSituation = doScheduleProcessExecution(0, 0, false);
+	if (currentProcess != NULL && currentProcess->mustHoldKernelLock && kernelLockOwner != currentProcess) {
+		processManagerAcquireKernelLock(currentProcess);
+	}
+	return resumedProcessExecutionSituation;
 }
 
 static void scheduleProcessExecutionAfterInterruptionHandler(uint64_t tickCount, uint64_t upTimeInMilliseconds) {
-	doScheduleProcessExecution(0, 0, true);
-}
+	uint64_t upTimeInNanoseconds = clockManagerGetUpTimeInNanoseconds();
+	bool isSchedulerTick = upTimeInNanoseconds >= nextSchedulerTickUpTimeInNanoseconds;
+	if (isSchedulerTick) {
+		nextSchedulerTickUpTimeInNanoseconds = upTimeInNanoseconds + SCHEDULER_TICK_IN_NANOSECONDS;
+	}
+	if (nonEmptyRunnableProcessesListsBitmap != 0) {
+		pitArmTimer(nextSchedulerTickUpTimeInNanoseconds);
+	}
 
-__attribute__ ((cdecl)) void processStart();
+	doScheduleProcessExecution(0, 0, isSchedulerTick);
+}
 
 static struct Process* doCreateProcess(__attribute__ ((cdecl)) void (*initializationCallback)(void*), void* argument) {
 	if (fixedCapacitySortedArrayRemaining(&allProcessesArray) > 0) {
@@ -503,14 +703,11 @@ static struct Process* doCreateProcess(__attribute__ ((cdecl)) void (*initializa
 		memset(process, 0, sizeof(struct Process));
 
 		doubleLinkedListInitialize(&process->pagingPageFramesList);
-		doubleLinkedListInitialize(&process->codeSegmentPageFramesList);
-		doubleLinkedListInitialize(&process->dataSegmentPageFramesList);
-		doubleLinkedListInitialize(&process->stackSegmentPageFramesList);
 		doubleLinkedListInitialize(&process->childrenProcessList);
 		process->state = RUNNABLE;
 		process->id = nextProcessId++;
-		process->idOfLastKnownSchedulerIteration = schedulerIterationId;
-		process->ticksCountSinceSchedulerIterationBegin = TICKS_PER_SCHEDULER_ITERATION_PER_PROCESS; /* It will be scheduled only on next iteration. */
+		process->niceValue = 0;
+		process->schedulerLevel = calculateFirstSchedulerLevel(process->niceValue);
 		sigemptyset(&process->blockedSignalsSet);
 
 		struct DoubleLinkedListElement* currentWorkingDirectoryPageFrameListElement = memoryManagerAcquirePageFrame(true, -1);
@@ -533,6 +730,16 @@ static struct Process* doCreateProcess(__attribute__ ((cdecl)) void (*initializa
 			return NULL;
 		}
 		doubleLinkedListInsertAfterLast(&process->pagingPageFramesList, pageDirectoryPageFrame);
+		initializeSystemEntriesOfPageDirectory((uint32_t*) memoryManagerGetPageFramePhysicalAddress(pageDirectoryPageFrame), SYSTEM_PAGE_TABLES_COUNT);
+
+		struct DoubleLinkedListElement* sharedDataPageTablePageFrame;
+		if (!memoryManagerConfigureMapping(&sharedDataPageTablePageFrame, (uint32_t*) memoryManagerGetPageFramePhysicalAddress(pageDirectoryPageFrame),
+				MYOS_SHARED_DATA_PAGE_VIRTUAL_ADDRESS, sharedDataManagerGetPagePhysicalAddress(),
+				PAGE_ENTRY_PRESENT | PAGE_ENTRY_READ_ONLY | PAGE_ENTRY_USER | PAGE_ENTRY_CACHE_ENABLED | PAGE_ENTRY_SIZE_4_KBYTES | PAGE_ENTRY_LOCAL)) {
+			processManagerReleaseProcessResources(process);
+			return NULL;
+		}
+		doubleLinkedListInsertAfterLast(&process->pagingPageFramesList, sharedDataPageTablePageFrame);
 
 		uint16_t codeSegmentSelector = x86SegmentSelector(USER_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX, false, 3);
 		uint16_t dataSegmentSelector = x86SegmentSelector(USER_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX, false, 3);
@@ -570,22 +777,19 @@ static struct Process* doCreateProcess(__attribute__ ((cdecl)) void (*initializa
 		systemStack[--esp0] = (uint32_t) argument;
 		systemStack[--esp0] = (uint32_t) initializationCallback;
 
-		process->tssSegmentDescriptor = x86SegmentDescriptor((uint32_t) &process->x86TaskState, sizeof(struct X86TaskState) - 1,
-			SEGMENT_DESCRIPTOR_PRESENT | SEGMENT_DESCRIPTOR_DPL_0 | SEGMENT_DESCRIPTOR_GRANULARITY_1_BYTE | SEGMENT_DESCRIPTOR_TYPE_32_BIT_TSS_AVAILABLE | SEGMENT_DESCRIPTOR_32_BIT);
-
-		codeSegmentSelector = x86SegmentSelector(SYSTEM_KERNEL_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX, false, 0);
-		dataSegmentSelector = x86SegmentSelector(SYSTEM_KERNEL_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX, false, 0);
-		eflags = EFLAGS_RESERVED;
-
 		/*
-		 * The task first instruction will be "processStart".
+		 * The process first instruction will be "processStart" as it is the return address of the first "contextSwitch"
+		 * call that switches to it.
 		 */
-		esp0 = (uint32_t) (process->systemStack + esp0 * sizeof(uint32_t));
-		struct X86TaskState* x86TaskState = &process->x86TaskState;
-		initializeX86TaskState(x86TaskState, codeSegmentSelector, dataSegmentSelector,
-			memoryManagerGetPageFramePhysicalAddress(pageDirectoryPageFrame),
-			(uint32_t) (process->systemStack + PAGE_FRAME_SIZE),
-			(uint32_t) &processStart, esp0, eflags);
+		systemStack[--esp0] = (uint32_t) &processStart;
+		systemStack[--esp0] = EFLAGS_RESERVED; /* EFLAGS */
+		systemStack[--esp0] = 0; /* EBP */
+		systemStack[--esp0] = 0; /* EBX */
+		systemStack[--esp0] = 0; /* ESI */
+		systemStack[--esp0] = 0; /* EDI */
+
+		process->kernelStackPointer = (uint32_t) (process->systemStack + esp0 * sizeof(uint32_t));
+		process->pageDirectory = memoryManagerGetPageFramePhysicalAddress(pageDirectoryPageFrame);
 
 		return process;
 
@@ -594,76 +798,134 @@ static struct Process* doCreateProcess(__attribute__ ((cdecl)) void (*initializa
 	}
 }
 
-static bool configureListMapping(struct DoubleLinkedList* pageFramesList, struct DoubleLinkedList* pagingPageFramesList, uint32_t* pageDirectory, uint32_t virtualAddress, bool addressGrowsUpward , uint32_t flags) {
-	struct DoubleLinkedListElement* pageFrame = doubleLinkedListFirst(pageFramesList);
-	while (pageFrame != NULL) {
-		struct DoubleLinkedListElement* newPageFrame;
-		uint32_t physicalAddress = memoryManagerGetPageFramePhysicalAddress(pageFrame);
-		if (!memoryManagerConfigureMapping(&newPageFrame, pageDirectory, virtualAddress, physicalAddress, flags)) {
-			return false;
-		}
-		if (newPageFrame != NULL) {
-			doubleLinkedListInsertAfterLast(pagingPageFramesList, newPageFrame);
-		}
+static void copyPageFrame(struct DoubleLinkedListElement* destinationPageFrame, struct DoubleLinkedListElement* sourcePageFrame) {
+	/* Before doing it, it needs a 1 to 1 paging mapping as the user space page frames are not mapped on the kernel space. */
+	uint32_t oldCR3 = x86GetCR3();
+	assert(oldCR3 != (uint32_t) systemX86TaskPageDirectory);
+	x86SetCR3((uint32_t) systemX86TaskPageDirectory);
+	memcpy((void*) memoryManagerGetPageFramePhysicalAddress(destinationPageFrame), (void*) memoryManagerGetPageFramePhysicalAddress(sourcePageFrame), PAGE_FRAME_SIZE);
+	x86SetCR3(oldCR3);
+}
 
-		pageFrame = pageFrame->next;
-		if (addressGrowsUpward) {
-			virtualAddress += PAGE_FRAME_SIZE;
-		} else {
-			virtualAddress -= PAGE_FRAME_SIZE;
+/*
+ * The child receives a copy of each user space page table. The page frames are shared and the writable ones become
+ * read only (on both processes) until one of them writes on it (see "handlePageFault").
+ */
+static bool shareUserSpacePageTables(struct Process* parentProcess, struct Process* childProcess) {
+	uint32_t* parentPageDirectory = (uint32_t*) parentProcess->pageDirectory;
+	uint32_t* childPageDirectory = (uint32_t*) childProcess->pageDirectory;
+
+	bool result = true;
+	for (int i = SYSTEM_PAGE_TABLES_COUNT; i < PAGE_DIRECTORY_LENGTH; i++) {
+		uint32_t pageDirectoryEntry = parentPageDirectory[i];
+		/* The shared data page has already been mapped when the child process was created. */
+		if ((pageDirectoryEntry & PAGE_ENTRY_PRESENT) && i != (MYOS_SHARED_DATA_PAGE_VIRTUAL_ADDRESS >> 22)) {
+			struct DoubleLinkedListElement* pageTablePageFrame = memoryManagerAcquirePageFrame(true, -1);
+			if (pageTablePageFrame == NULL) {
+				result = false;
+				break;
+			}
+			doubleLinkedListInsertAfterLast(&childProcess->pagingPageFramesList, pageTablePageFrame);
+
+			uint32_t* parentPageTable = (uint32_t*) (pageDirectoryEntry & 0xFFFFF000);
+			uint32_t* childPageTable = (uint32_t*) memoryManagerGetPageFramePhysicalAddress(pageTablePageFrame);
+			for (int j = 0; j < PAGE_TABLE_LENGTH; j++) {
+				uint32_t pageTableEntry = parentPageTable[j];
+				if (pageTableEntry & PAGE_ENTRY_PRESENT) {
+					if (pageTableEntry & PAGE_ENTRY_READ_WRITE) {
+						pageTableEntry = (pageTableEntry & ~PAGE_ENTRY_READ_WRITE) | PAGE_ENTRY_COPY_ON_WRITE;
+						parentPageTable[j] = pageTableEntry;
+					}
+					memoryManagerSharePageFrame(memoryManagerGetPageFrameDoubleLinkedListElement(pageTableEntry & 0xFFFFF000));
+				}
+				childPageTable[j] = pageTableEntry;
+			}
+
+			/* Only a complete page table is visible. */
+			childPageDirectory[i] = ((uint32_t) childPageTable) | (pageDirectoryEntry & 0xFFF);
 		}
 	}
 
-	return true;
-}
-
-static bool configureProcessMapping(struct Process* process) {
-	struct X86TaskState* x86TaskState = &process->x86TaskState;
+	/* The parent must not use any stale writable TLB entry. */
+	if (x86GetCR3() == (uint32_t) parentPageDirectory) {
+		x86SetCR3((uint32_t) parentPageDirectory);
+	}
 
-	/* It maps each virtual address to its corresponding physical address. */
-	uint32_t* pageDirectory = (uint32_t*) x86TaskState->cr3;
-	initializeSystemEntriesOfPageDirectory(pageDirectory, SYSTEM_PAGE_TABLES_COUNT);
+	return result;
+}
 
-	uint32_t flags = PAGE_ENTRY_PRESENT | PAGE_ENTRY_READ_WRITE | PAGE_ENTRY_USER | PAGE_ENTRY_CACHE_ENABLED |
-			PAGE_ENTRY_SIZE_4_KBYTES | PAGE_ENTRY_LOCAL;
+/*
+ * It maps a code segment page. If the executable image does not have it yet, it is read from the executable file (the bytes
+ * after its end are zeroed). The page frame is shared with the image and, therefore, it is mapped as copy-on-write.
+ */
+static bool fillCodeSegmentPage(struct Process* process, uint32_t virtualAddress) {
+	assert(virtualAddress % PAGE_FRAME_SIZE == 0);
+	assert(processManagerIsHoldingKernelLock(process));
 
-	/* Code segment: */
-	if (!configureListMapping(&process->codeSegmentPageFramesList, &process->pagingPageFramesList, pageDirectory, CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true, flags)) {
+	struct ExecutableImage* executableImage = process->executableImage;
+	if (executableImage == NULL) {
 		return false;
 	}
 
-	/* Stack segment: */
-	if (!configureListMapping(&process->stackSegmentPageFramesList, &process->pagingPageFramesList, pageDirectory, STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER - (STACK_SEGMENT_FIRST_INVALID_VIRTUAL_ADDRESS_AFTER % PAGE_FRAME_SIZE), false, flags)) {
-		return false;
+	uint32_t offset = virtualAddress - CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS;
+	uint32_t pageIndex = offset / PAGE_FRAME_SIZE;
+	uint32_t cachedPhysicalAddress = executableImageCacheGetPageFrame(executableImage, pageIndex);
+
+	struct DoubleLinkedListElement* pageFrame;
+	if (cachedPhysicalAddress != 0) {
+		pageFrame = memoryManagerGetPageFrameDoubleLinkedListElement(cachedPhysicalAddress);
+		memoryManagerSharePageFrame(pageFrame);
+	} else {
+		pageFrame = memoryManagerAcquirePageFrame(false, -1);
+		if (pageFrame == NULL) {
+			return false;
+		}
 	}
 
-	/* Data segment: */
-	if (!configureListMapping(&process->dataSegmentPageFramesList, &process->pagingPageFramesList, pageDirectory, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true, flags)) {
+	/* It is mapped before the read as the page frame might not be accessible otherwise. */
+	uint32_t* pageDirectory = (uint32_t*) process->pageDirectory;
+	uint32_t physicalAddress = memoryManagerGetPageFramePhysicalAddress(pageFrame);
+	uint32_t flags = PAGE_ENTRY_PRESENT | PAGE_ENTRY_READ_WRITE | PAGE_ENTRY_USER | PAGE_ENTRY_CACHE_ENABLED |
+			PAGE_ENTRY_SIZE_4_KBYTES | PAGE_ENTRY_LOCAL;
+	struct DoubleLinkedListElement* newPageFrame;
+	if (!memoryManagerConfigureMapping(&newPageFrame, pageDirectory, virtualAddress, physicalAddress, flags)) {
+		memoryManagerReleasePageFrame(pageFrame, -1);
 		return false;
 	}
+	if (newPageFrame != NULL) {
+		doubleLinkedListInsertAfterLast(&process->pagingPageFramesList, newPageFrame);
+	}
+	x86InvalidateTLBEntry(virtualAddress);
 
-	return true;
-}
+	APIStatusCode result = SUCCESS;
+	if (cachedPhysicalAddress == 0) {
+		/* As the kernel lock is held, no one else uses the offset meanwhile. */
+		struct OpenFileDescription* openFileDescription = executableImage->openFileDescription;
+		struct VirtualFileSystemNode* virtualFileSystemNode = openFileDescription->virtualFileSystemNode;
+		size_t count = 0;
+		openFileDescription->offset = offset;
+		result = virtualFileSystemNode->operations->read(virtualFileSystemNode, process, openFileDescription, (void*) virtualAddress,
+			mathUtilsMin(PAGE_FRAME_SIZE, executableImage->size - offset), &count);
 
-static bool copyPageFrameList(struct DoubleLinkedList* sourceDoubleLinkedList, struct DoubleLinkedList* destinationDoubleLinkedList) {
-	struct DoubleLinkedListElement* pageFrame = doubleLinkedListFirst(sourceDoubleLinkedList);
-	while (pageFrame != NULL) {
-		struct DoubleLinkedListElement* newPageFrame = memoryManagerAcquirePageFrame(false, -1);
-		if (newPageFrame == NULL) {
-			return false;
+		if (result == SUCCESS) {
+			memset((void*) (virtualAddress + count), 0, PAGE_FRAME_SIZE - count);
+			executableImageCacheSetPageFrame(executableImage, pageIndex, physicalAddress);
 		}
-		doubleLinkedListInsertAfterLast(destinationDoubleLinkedList, newPageFrame);
+	}
 
-		void* destination = (void*) memoryManagerGetPageFramePhysicalAddress(newPageFrame);
-		void* source = (void*) memoryManagerGetPageFramePhysicalAddress(pageFrame);
-		memcpy(destination, source, PAGE_FRAME_SIZE);
+	uint32_t* pageTableEntry = memoryManagerGetPageTableEntry(pageDirectory, virtualAddress);
+	if (result == SUCCESS) {
+		/* The page table entry is only downgraded now as the page table might have been created with the same flags. */
+		*pageTableEntry = (*pageTableEntry & ~PAGE_ENTRY_READ_WRITE) | PAGE_ENTRY_COPY_ON_WRITE;
+		x86InvalidateTLBEntry(virtualAddress);
 
-		pageFrame = pageFrame->next;
+	} else {
+		memoryManagerRemovePageMapping(pageDirectory, virtualAddress, physicalAddress);
+		memoryManagerReleasePageFrame(pageFrame, -1);
+		x86InvalidateTLBEntry(virtualAddress);
 	}
 
-	assert(doubleLinkedListSize(sourceDoubleLinkedList) == doubleLinkedListSize(destinationDoubleLinkedList));
-
-	return true;
+	return result == SUCCESS;
 }
 
 APIStatusCode processManagerForkProcess(struct Process* parentProcess, struct Process** childProcess) {
@@ -680,31 +942,11 @@ APIStatusCode processManagerForkProcess(struct Process* parentProcess, struct Pr
 
 	assert(process->parentProcess == NULL);
 
-	{
-		APIStatusCode result = SUCCESS;
-		/* It copies each page frame. */
-		/* Before doing it, it needs a 1 to 1 paging mapping. It is not efficient and it needs to be improved. */
-		uint32_t oldCR3 = x86GetCR3();
-		assert(oldCR3 != (uint32_t) systemX86TaskPageDirectory);
-		x86SetCR3((uint32_t) systemX86TaskPageDirectory);
-		if (result == SUCCESS && !copyPageFrameList(&parentProcess->codeSegmentPageFramesList, &process->codeSegmentPageFramesList)) {
-			result = ENOMEM;
-		}
-		if (result == SUCCESS && !copyPageFrameList(&parentProcess->dataSegmentPageFramesList, &process->dataSegmentPageFramesList)) {
-			result = ENOMEM;
-		}
-		if (result == SUCCESS && !copyPageFrameList(&parentProcess->stackSegmentPageFramesList, &process->stackSegmentPageFramesList)) {
-			result = ENOMEM;
-		}
-		x86SetCR3(oldCR3);
-
-		if (result != SUCCESS) {
-			processManagerReleaseProcessResources(process);
-			return result;
-		}
-	}
-
-	if (!configureProcessMapping(process)) {
+	/* The child releases the shared page frames (if any) as any other process. */
+	process->codeSegmentPageCount = parentProcess->codeSegmentPageCount;
+	process->dataSegmentPageCount = parentProcess->dataSegmentPageCount;
+	process->stackSegmentPageCount = parentProcess->stackSegmentPageCount;
+	if (!shareUserSpacePageTables(parentProcess, process)) {
 		processManagerReleaseProcessResources(process);
 		return ENOMEM;
 	}
@@ -727,6 +969,11 @@ APIStatusCode processManagerForkProcess(struct Process* parentProcess, struct Pr
 
 	process->fileModeCreationMask = parentProcess->fileModeCreationMask;
 
+	process->executableImage = parentProcess->executableImage;
+	if (process->executableImage != NULL) {
+		executableImageCacheReserve(process->executableImage);
+	}
+
 	for (int i = 0; i < MAX_FILE_DESCRIPTORS_PER_PROCESS; i++) {
 		struct FileDescriptor* fileDescriptor = &parentProcess->fileDescriptors[i];
 		struct OpenFileDescription* openFileDescription = fileDescriptor->openFileDescription;
@@ -738,7 +985,9 @@ APIStatusCode processManagerForkProcess(struct Process* parentProcess, struct Pr
 		}
 	}
 
-	doubleLinkedListInsertAfterLast(&runnableProcessesList, &process->runnableProcessListElement);
+	process->niceValue = parentProcess->niceValue;
+	process->schedulerLevel = parentProcess->schedulerLevel;
+	insertIntoRunnableProcessesList(process);
 	bool result = fixedCapacitySortedArrayInsert(&allProcessesArray, &process);
 	assert(result == true);
 	doubleLinkedListInsertAfterLast(&parentProcess->childrenProcessList, &process->childrenProcessListElement);
@@ -765,109 +1014,19 @@ APIStatusCode processManagerForkProcess(struct Process* parentProcess, struct Pr
 	return SUCCESS;
 }
 
-static bool changeSegmentSize(struct DoubleLinkedList* segmentPageFramesList, struct DoubleLinkedList* pagingPageFramesList, size_t size,
-		uint32_t* pageDirectory, uint32_t firstVirtualAddress) {
-	struct DoubleLinkedList newSegmentPageFramesList;
-	doubleLinkedListInitialize(&newSegmentPageFramesList);
-	struct DoubleLinkedList newPagingPageFramesList;
-	doubleLinkedListInitialize(&newPagingPageFramesList);
-
-	bool result = true;
-	uint32_t pageFramesCount = mathUtilsCeilOfUint32Division(size, PAGE_FRAME_SIZE);
-	if (pageFramesCount > doubleLinkedListSize(segmentPageFramesList)) {
-		/* First, it allocates the necessary page frames. */
-		for (int i = doubleLinkedListSize(segmentPageFramesList); i < pageFramesCount; i++) {
-			struct DoubleLinkedListElement* pageFrame = memoryManagerAcquirePageFrame(false, -1);
-			if (pageFrame == NULL) {
-				result = false;
-				break;
-			}
-			doubleLinkedListInsertAfterLast(&newSegmentPageFramesList, pageFrame);
-		}
-
-		if (result) {
-			/* There was enough memory.  */
-
-			uint32_t flags = PAGE_ENTRY_PRESENT | PAGE_ENTRY_READ_WRITE | PAGE_ENTRY_USER | PAGE_ENTRY_CACHE_ENABLED |
-							PAGE_ENTRY_SIZE_4_KBYTES | PAGE_ENTRY_LOCAL;
-
-			uint32_t virtualAddress = firstVirtualAddress + doubleLinkedListSize(segmentPageFramesList) * PAGE_FRAME_SIZE;
-			struct DoubleLinkedListElement* pageFrame = doubleLinkedListFirst(&newSegmentPageFramesList);
-			while (pageFrame != NULL) {
-				struct DoubleLinkedListElement* newPageFrame;
-				uint32_t physicalAddress = memoryManagerGetPageFramePhysicalAddress(pageFrame);
-				if (memoryManagerConfigureMapping(&newPageFrame, pageDirectory, virtualAddress, physicalAddress, flags)) {
-					if (newPageFrame != NULL) {
-						doubleLinkedListInsertAfterLast(&newPagingPageFramesList, newPageFrame);
-					}
-
-				} else {
-					result = false;
-					break;
-				}
-
-				virtualAddress += PAGE_FRAME_SIZE;
-				pageFrame = pageFrame->next;
-			}
-
-			if (result) {
-				/* Invalidate the necessary TLB entries. */
-				virtualAddress = firstVirtualAddress + doubleLinkedListSize(segmentPageFramesList) * PAGE_FRAME_SIZE;
-				pageFrame = doubleLinkedListFirst(&newSegmentPageFramesList);
-				while (pageFrame != NULL) {
-					x86InvalidateTLBEntry(virtualAddress);
-					virtualAddress += PAGE_FRAME_SIZE;
-					pageFrame = pageFrame->next;
-				}
-
-			} else {
-				/* There was not enough memory.  */
-
-				/* Undo all memory mappings. */
-				virtualAddress = firstVirtualAddress + doubleLinkedListSize(segmentPageFramesList) * PAGE_FRAME_SIZE;
-				pageFrame = doubleLinkedListFirst(&newSegmentPageFramesList);
-				while (pageFrame != NULL) {
-					memoryManagerRemovePageMapping(pageDirectory, virtualAddress, memoryManagerGetPageFramePhysicalAddress(pageFrame));
-					virtualAddress += PAGE_FRAME_SIZE;
-					pageFrame = pageFrame->next;
-				}
-
-				pageFrame = doubleLinkedListFirst(&newPagingPageFramesList);
-				while (pageFrame != NULL) {
-					uint32_t physicalAddress = memoryManagerGetPageFramePhysicalAddress(pageFrame);
-					memoryManagerRemovePageTableMapping(pageDirectory, physicalAddress);
-					pageFrame = pageFrame->next;
-				}
-			}
-		}
-
-		if (result) {
-			doubleLinkedListInsertListAfterLast(segmentPageFramesList, &newSegmentPageFramesList);
-			doubleLinkedListInsertListAfterLast(pagingPageFramesList, &newPagingPageFramesList);
-
-		} else {
-			releasePageFrameList(&newSegmentPageFramesList);
-			releasePageFrameList(&newPagingPageFramesList);
-		}
-
-	} else {
-		/* It should release memory. */
-
-		uint32_t virtualAddress = firstVirtualAddress + doubleLinkedListSize(segmentPageFramesList) * PAGE_FRAME_SIZE;
-		while (pageFramesCount < doubleLinkedListSize(segmentPageFramesList)) {
-			virtualAddress -= PAGE_FRAME_SIZE;
-			assert(firstVirtualAddress <= virtualAddress);
-
-			struct DoubleLinkedListElement* pageFrame = doubleLinkedListRemoveLast(segmentPageFramesList);
-			memoryManagerRemovePageMapping(pageDirectory, virtualAddress, memoryManagerGetPageFramePhysicalAddress(pageFrame));
-			memoryManagerReleasePageFrame(pageFrame, -1);
-			x86InvalidateTLBEntry(virtualAddress);
-		}
+/*
+ * Only the virtual address range is reserved when a segment grows. Its page frames are acquired (and zeroed) on the first
+ * access (see "fillZeroedPage").
+ */
+static void changeSegmentSize(uint32_t* segmentPageCount, size_t size, uint32_t* pageDirectory, uint32_t firstVirtualAddress,
+		bool addressGrowsUpward) {
+	uint32_t pageCount = mathUtilsCeilOfUint32Division(size, PAGE_FRAME_SIZE);
+	if (pageCount < *segmentPageCount) {
+		releaseSegmentPageFrames(pageDirectory, firstVirtualAddress, pageCount, *segmentPageCount, addressGrowsUpward, true);
 
 		// TODO: We are not releasing the page frames used to store page tables.
 	}
-
-	return result;
+	*segmentPageCount = pageCount;
 }
 
 APIStatusCode processManagerCreateInitProcess( __attribute__ ((cdecl)) void (*initializationCallback)(void*), void* argument) {
@@ -886,21 +1045,11 @@ APIStatusCode processManagerCreateInitProcess( __attribute__ ((cdecl)) void (*in
 		strcpy(process->currentWorkingDirectory, "/");
 		process->currentWorkingDirectoryLength = 1;
 
-		for (int i = 0; i < STACK_PAGE_FRAME_COUNT; i++) {
-			struct DoubleLinkedListElement* stackPageFrame = memoryManagerAcquirePageFrame(false, -1);
-			if (stackPageFrame == NULL) {
-				result = ENOMEM;
-				break;
-			}
-			doubleLinkedListInsertAfterLast(&process->stackSegmentPageFramesList, stackPageFrame);
-		}
+		changeSegmentSize(&process->stackSegmentPageCount, STACK_SEGMENT_PAGE_COUNT * PAGE_FRAME_SIZE, (uint32_t*) process->pageDirectory,
+				STACK_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, false);
 
 		if (result == SUCCESS) {
-			if (!configureProcessMapping(process)) {
-				result = ENOMEM;
-			}
-
-			doubleLinkedListInsertAfterLast(&runnableProcessesList, &process->runnableProcessListElement);
+			insertIntoRunnableProcessesList(process);
 			bool insertionResult = fixedCapacitySortedArrayInsert(&allProcessesArray, &process);
 			assert(insertionResult);
 
@@ -915,8 +1064,29 @@ APIStatusCode processManagerCreateInitProcess( __attribute__ ((cdecl)) void (*in
 	return result;
 }
 
+/*
+ * A kernel process only executes kernel code (the entry point must never return) and it is not visible to the user
+ * processes: it is not on the processes array, it has no parent nor process group. Therefore, it never receives signals.
+ */
+APIStatusCode processManagerCreateKernelProcess(__attribute__ ((cdecl)) void (*entryPoint)(void*), void* argument, struct Process** kernelProcess) {
+	struct Process* process = doCreateProcess(entryPoint, argument);
+	if (process == NULL) {
+		return ENOMEM;
+	}
+
+	strcpy(process->currentWorkingDirectory, "/");
+	process->currentWorkingDirectoryLength = 1;
+
+	insertIntoRunnableProcessesList(process);
+	*kernelProcess = process;
+
+	return SUCCESS;
+}
+
 void processManagerStartScheduling(void) {
 	pitRegisterCommandToRunOnTick(&scheduleProcessExecutionAfterInterruptionHandler);
+	/* The first tick schedules the first process. */
+	pitArmTimer(clockManagerGetUpTimeInNanoseconds());
 
 	currentProcess = NULL;
 
@@ -955,7 +1125,6 @@ static const pid_t* processGroupIdExtractor(const struct ProcessGroup** processG
 	return &(*processGroup)->id;
 }
 
-static pid_t lastProcessIdThatUsedFPU = 0;
 static void handleFirstFPUInstructionAfterSchedule(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
 	struct Process* process = currentProcess;
 	assert(process != NULL);
@@ -979,6 +1148,139 @@ static void handleFirstFPUInstructionAfterSchedule(uint32_t errorCode, struct Pr
 	}
 }
 
+static bool resolveCopyOnWrite(struct Process* process, uint32_t errorCode, uint32_t virtualAddress) {
+	if ((errorCode & PAGE_FAULT_EXCEPTION_PAGE_LEVEL_PROTECTION_VIOLATION) == 0 || (errorCode & PAGE_FAULT_EXCEPTION_WRITE) == 0
+			|| virtualAddress < CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS) {
+		return false;
+	}
+
+	virtualAddress -= virtualAddress % PAGE_FRAME_SIZE;
+	uint32_t* pageTableEntry = memoryManagerGetPageTableEntry((uint32_t*) process->pageDirectory, virtualAddress);
+	if (pageTableEntry == NULL || (*pageTableEntry & PAGE_ENTRY_PRESENT) == 0 || (*pageTableEntry & PAGE_ENTRY_COPY_ON_WRITE) == 0) {
+		return false;
+	}
+
+	struct DoubleLinkedListElement* pageFrame = memoryManagerGetPageFrameDoubleLinkedListElement(*pageTableEntry & 0xFFFFF000);
+	if (memoryManagerGetPageFrameReferenceCount(pageFrame) > 1) {
+		struct DoubleLinkedListElement* newPageFrame = memoryManagerAcquirePageFrame(false, -1);
+		if (newPageFrame == NULL) {
+			return false;
+		}
+		copyPageFrame(newPageFrame, pageFrame);
+		memoryManagerReleasePageFrame(pageFrame, -1);
+		*pageTableEntry = memoryManagerGetPageFramePhysicalAddress(newPageFrame) | (*pageTableEntry & 0xFFF);
+	}
+	/* Otherwise, all other processes have already stopped sharing it. */
+
+	*pageTableEntry = (*pageTableEntry & ~PAGE_ENTRY_COPY_ON_WRITE) | PAGE_ENTRY_READ_WRITE;
+	x86InvalidateTLBEntry(virtualAddress);
+
+	return true;
+}
+
+/* The data and stack segment pages are backed by a zeroed page frame on their first access. */
+static bool fillZeroedPage(struct Process* process, uint32_t virtualAddress) {
+	assert(virtualAddress % PAGE_FRAME_SIZE == 0);
+
+	struct DoubleLinkedListElement* pageFrame = memoryManagerAcquirePageFrame(false, -1);
+	if (pageFrame == NULL) {
+		return false;
+	}
+
+	uint32_t* pageDirectory = (uint32_t*) process->pageDirectory;
+	uint32_t flags = PAGE_ENTRY_PRESENT | PAGE_ENTRY_READ_WRITE | PAGE_ENTRY_USER | PAGE_ENTRY_CACHE_ENABLED |
+			PAGE_ENTRY_SIZE_4_KBYTES | PAGE_ENTRY_LOCAL;
+	struct DoubleLinkedListElement* newPageFrame;
+	if (!memoryManagerConfigureMapping(&newPageFrame, pageDirectory, virtualAddress, memoryManagerGetPageFramePhysicalAddress(pageFrame), flags)) {
+		memoryManagerReleasePageFrame(pageFrame, -1);
+		return false;
+	}
+	if (newPageFrame != NULL) {
+		doubleLinkedListInsertAfterLast(&process->pagingPageFramesList, newPageFrame);
+	}
+	x86InvalidateTLBEntry(virtualAddress);
+
+	/* The page frame might still contain data from another process. */
+	memset((void*) virtualAddress, 0, PAGE_FRAME_SIZE);
+
+	return true;
+}
+
+static bool isCodeSegmentPage(struct Process* process, uint32_t virtualAddress) {
+	return CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS <= virtualAddress
+			&& virtualAddress < CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS + process->codeSegmentPageCount * PAGE_FRAME_SIZE;
+}
+
+static bool isDataOrStackSegmentPage(struct Process* process, uint32_t virtualAddress) {
+	bool isDataSegmentPage = DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS <= virtualAddress
+			&& virtualAddress < DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS + process->dataSegmentPageCount * PAGE_FRAME_SIZE;
+	bool isStackSegmentPage = process->stackSegmentPageCount > 0
+			&& STACK_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS - (process->stackSegmentPageCount - 1) * PAGE_FRAME_SIZE <= virtualAddress;
+	return isDataSegmentPage || isStackSegmentPage;
+}
+
+static bool fillSegmentPage(struct Process* process, uint32_t virtualAddress) {
+	if (isCodeSegmentPage(process, virtualAddress)) {
+		return fillCodeSegmentPage(process, virtualAddress);
+	} else if (isDataOrStackSegmentPage(process, virtualAddress)) {
+		return fillZeroedPage(process, virtualAddress);
+	} else {
+		return false;
+	}
+}
+
+static bool resolveNonPresentPage(struct Process* process, uint32_t errorCode, uint32_t virtualAddress,
+		struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
+	virtualAddress -= virtualAddress % PAGE_FRAME_SIZE;
+	if ((errorCode & PAGE_FAULT_EXCEPTION_PAGE_LEVEL_PROTECTION_VIOLATION) != 0
+			|| (!isCodeSegmentPage(process, virtualAddress) && !isDataOrStackSegmentPage(process, virtualAddress))) {
+		return false;
+	}
+
+	/*
+	 * Acquiring a page frame (it might reclaim block cache ones) and reading a code page (it requires the file system) need the
+	 * kernel lock. If the kernel is already holding it, the access must not be in the middle of a file system operation
+	 * (see "processIsValidSegmentAccess"). The kernel also accesses the user space without holding it (e.g., while preparing
+	 * the stack to call a signal handler).
+	 */
+	bool isUserModeAccess = x86GetSegmentSelectorRPL(processExecutionState1->cs) == 3;
+	bool mustReleaseKernelLock = false;
+	if (!processManagerIsHoldingKernelLock(process)) {
+		if (isUserModeAccess) {
+			process->processExecutionState1 = processExecutionState1;
+			process->processExecutionState2 = processExecutionState2;
+		}
+		processManagerAcquireKernelLock(process);
+		mustReleaseKernelLock = true;
+	}
+
+	bool result = fillSegmentPage(process, virtualAddress);
+
+	if (mustReleaseKernelLock) {
+		processManagerReleaseKernelLock(process);
+
+		/* The signals generated while it was holding the kernel lock are handled now (as after a system call). */
+		if (result && isUserModeAccess && process->mightHaveAnySignalToHandle) {
+			signalServicesHandlePendingSignals(process);
+		}
+	}
+
+	return result;
+}
+
+/*
+ * The kernel also writes directly on the user space memory (as the write protection is enabled, it is also handled here).
+ */
+static void handlePageFault(uint32_t errorCode, struct ProcessExecutionState1* processExecutionState1, struct ProcessExecutionState2* processExecutionState2) {
+	uint32_t virtualAddress = x86GetCR2();
+	struct Process* process = currentProcess;
+
+	if (process == NULL || (!resolveCopyOnWrite(process, errorCode, virtualAddress)
+			&& !resolveNonPresentPage(process, errorCode, virtualAddress, processExecutionState1, processExecutionState2))) {
+		interruptionManagerDefaultHandler(errorCode, processExecutionState1, processExecutionState2);
+	}
+}
+
 APIStatusCode processManagerInitialize(void) {
 	APIStatusCode result = SUCCESS;
 
@@ -1003,7 +1305,10 @@ APIStatusCode processManagerInitialize(void) {
 					(void*) memoryManagerGetPageFramePhysicalAddress(allProcessesArrayPageFrame),
 					PAGE_FRAME_SIZE, 	(int (*)(const void*, const void*)) &processIdComparator,
 					(const void* (*)(const void*)) &processIdExtractor);
-			doubleLinkedListInitialize(&runnableProcessesList);
+			for (int i = 0; i < SCHEDULER_LEVEL_COUNT; i++) {
+				doubleLinkedListInitialize(&runnableProcessesLists[i]);
+			}
+			doubleLinkedListInitialize(&kernelLockWaitingProcessList);
 
 			uint16_t codeSegmentSelector = x86SegmentSelector(SYSTEM_KERNEL_LINEAR_CODE_SEGMENT_DESCRIPTOR_INDEX, false, 0);
 			uint16_t dataSegmentSelector = x86SegmentSelector(SYSTEM_KERNEL_LINEAR_DATA_SEGMENT_DESCRIPTOR_INDEX, false, 0);
@@ -1023,11 +1328,25 @@ APIStatusCode processManagerInitialize(void) {
 				: "a"(segmentSelector)
 				: "memory");
 
+			/*
+			 * The fast system call entry finds the kernel stack of the current process on the "esp0" field of the TSS.
+			 * The user space standard library only uses it when the processor supports it (it also checks CPUID).
+			 */
+			if (x86IsSysenterSupported()) {
+				x86SetMSR(X86_SYSENTER_CS_MSR, codeSegmentSelector);
+				x86SetMSR(X86_SYSENTER_ESP_MSR, (uint32_t) &systemX86TaskState.esp0);
+				x86SetMSR(X86_SYSENTER_EIP_MSR, (uint32_t) &sysenterEntryPoint);
+				logDebug("The SYSENTER instruction is supported and has been configured");
+			}
+
 			/* It now enables the paging and the cache. */
 			__asm__ __volatile__(
 				"mov %%eax, %%cr3;"
 				"mov %%cr0, %%eax;"
-				"or $0x80000000, %%eax;" /* Paging (bit 31 of CR0) <- true */
+				"or $0x80010000, %%eax;" /*
+													* Paging (bit 31 of CR0) <- true
+													* Write Protect (bit 16 of CR0) <- true (the kernel must respect the copy-on-write pages)
+													*/
 				"and $0x9FFFFFFF, %%eax;" /*
 													* Cache Disable (bit 30 of CR0) <- false
 													* Not Write-through (bit 29 of CR0) <- false
@@ -1038,6 +1357,7 @@ APIStatusCode processManagerInitialize(void) {
 				 : "cc", "memory");
 
 			interruptionManagerRegisterInterruptionHandler(X86_DEVICE_NOT_AVAILABLE_NO_MATH_COPROCESSOR, &handleFirstFPUInstructionAfterSchedule);
+			interruptionManagerRegisterInterruptionHandler(X86_PAGE_FAULT_INTERRUPT_VECTOR, &handlePageFault);
 
 		} else {
 			result = ENOMEM;
@@ -1063,12 +1383,17 @@ __attribute__ ((cdecl)) struct Process* processManagerGetCurrentProcess(void) {
 APIStatusCode processManagerChangeDataSegmentSize(struct Process* process, int increment) {
 	APIStatusCode result = SUCCESS;
 
-	uint32_t* pageDirectory = (uint32_t*) process->x86TaskState.cr3;
-	size_t currentSize = doubleLinkedListSize(&process->dataSegmentPageFramesList) * PAGE_FRAME_SIZE;
+	uint32_t* pageDirectory = (uint32_t*) process->pageDirectory;
+	size_t currentSize = process->dataSegmentPageCount * PAGE_FRAME_SIZE;
 	if (increment > 0) {
-		if (!changeSegmentSize(&process->dataSegmentPageFramesList, &process->pagingPageFramesList, currentSize + increment,
-				pageDirectory, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS)) {
+		/*
+		 * The page frames are only acquired when they are accessed (see "fillZeroedPage"). Therefore, the lack of memory is
+		 * only reported then: the acquisition also falls back to the kernel space and to the page frames used by the block cache.
+		 */
+		if (currentSize + increment > DATA_SEGMENT_MAX_SIZE) {
 			result = ENOMEM;
+		} else {
+			changeSegmentSize(&process->dataSegmentPageCount, currentSize + increment, pageDirectory, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true);
 		}
 
 	} else if (increment < 0) {
@@ -1078,24 +1403,45 @@ APIStatusCode processManagerChangeDataSegmentSize(struct Process* process, int i
 		} else {
 			size = 0;
 		}
-		changeSegmentSize(&process->dataSegmentPageFramesList, &process->pagingPageFramesList, size, pageDirectory, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS);
-		assert(mathUtilsCeilOfUint32Division(size, PAGE_FRAME_SIZE) == doubleLinkedListSize(&process->dataSegmentPageFramesList));
+		changeSegmentSize(&process->dataSegmentPageCount, size, pageDirectory, DATA_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, true);
+		assert(mathUtilsCeilOfUint32Division(size, PAGE_FRAME_SIZE) == process->dataSegmentPageCount);
 	}
 
 	return result;
 }
 
-APIStatusCode processManagerChangeCodeSegmentSize(struct Process* process, size_t executableSize, bool allowShrinkingIfNecessary) {
-	APIStatusCode result = SUCCESS;
+void processManagerMapExecutable(struct Process* process, struct ExecutableImage* executableImage) {
+	size_t executableSize = executableImage->size;
+	assert(executableSize <= EXECUTABLE_MAX_SIZE);
 
-	if (allowShrinkingIfNecessary || executableSize >= doubleLinkedListSize(&process->codeSegmentPageFramesList) * PAGE_FRAME_SIZE) {
-		uint32_t* pageDirectory = (uint32_t*) process->x86TaskState.cr3;
-		if (!changeSegmentSize(&process->codeSegmentPageFramesList, &process->pagingPageFramesList, executableSize, pageDirectory, CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS)) {
-			result = ENOMEM;
+	/* The current code segment is discarded. The new one will be read on demand (see "fillCodeSegmentPage"). */
+	uint32_t* pageDirectory = (uint32_t*) process->pageDirectory;
+	releaseSegmentPageFrames(pageDirectory, CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, 0, process->codeSegmentPageCount, true, true);
+	process->codeSegmentPageCount = mathUtilsCeilOfUint32Division(executableSize, PAGE_FRAME_SIZE);
+
+	if (process->executableImage != NULL) {
+		executableImageCacheRelease(process, process->executableImage);
+	}
+	process->executableImage = executableImage;
+}
+
+bool processManagerPopulateSegmentPages(struct Process* process, uint32_t firstAddress, uint32_t lastAddress) {
+	assert(processManagerIsHoldingKernelLock(process));
+	assert(firstAddress <= lastAddress);
+
+	firstAddress -= firstAddress % PAGE_FRAME_SIZE;
+	uint32_t pageCount = (lastAddress - firstAddress) / PAGE_FRAME_SIZE + 1;
+
+	uint32_t* pageDirectory = (uint32_t*) process->pageDirectory;
+	for (uint32_t i = 0; i < pageCount; i++) {
+		uint32_t virtualAddress = firstAddress + i * PAGE_FRAME_SIZE;
+		uint32_t* pageTableEntry = memoryManagerGetPageTableEntry(pageDirectory, virtualAddress);
+		if ((pageTableEntry == NULL || (*pageTableEntry & PAGE_ENTRY_PRESENT) == 0) && !fillSegmentPage(process, virtualAddress)) {
+			return false;
 		}
 	}
 
-	return result;
+	return true;
 }
 
 struct Process* processManagerGetProcessById(pid_t id) {
@@ -1108,12 +1454,12 @@ struct Process* processManagerGetProcessById(pid_t id) {
 }
 
 static void appendSegmentInformation(struct StringStreamWriter* stringStreamWriter, const char* segmentName, struct ProcessMemorySegmentLimits* processMemorySegmentLimits,
-		struct DoubleLinkedList* segmentPageFramesList) {
+		uint32_t segmentPageCount) {
 	streamWriterFormat(&stringStreamWriter->streamWriter, "    %s:\n", segmentName);
-	streamWriterFormat(&stringStreamWriter->streamWriter, "      segmentPageFramesList: %d\n", doubleLinkedListSize(segmentPageFramesList));
+	streamWriterFormat(&stringStreamWriter->streamWriter, "      segmentPageCount: %d\n", segmentPageCount);
 	if (!processMemorySegmentLimits->isEmpty) {
 		streamWriterFormat(&stringStreamWriter->streamWriter, "      limits: from %X to %X (exclusive)\n", processMemorySegmentLimits->firstAddress, processMemorySegmentLimits->lastAddress);
-		streamWriterFormat(&stringStreamWriter->streamWriter, "      size (KB): %u\n", doubleLinkedListSize(segmentPageFramesList) * PAGE_FRAME_SIZE / 1024);
+		streamWriterFormat(&stringStreamWriter->streamWriter, "      size (KB): %u\n", segmentPageCount * PAGE_FRAME_SIZE / 1024);
 	}
 }
 
@@ -1139,6 +1485,9 @@ APIStatusCode processManagerPrintDebugReport(void) {
 		streamWriterFormat(&stringStreamWriter.streamWriter, " processGroup: %d", process->processGroup->id);
 		streamWriterFormat(&stringStreamWriter.streamWriter, " controllingTTYId: %d\n", session->controllingTTYId);
 
+		streamWriterFormat(&stringStreamWriter.streamWriter, "  nice: %d", process->niceValue);
+		streamWriterFormat(&stringStreamWriter.streamWriter, " scheduler level: %u\n", process->schedulerLevel);
+
 		streamWriterFormat(&stringStreamWriter.streamWriter, "  blocked signal set: %llX", process->blockedSignalsSet);
 
 		uint64_t pendingSignals = 0;
@@ -1159,9 +1508,9 @@ APIStatusCode processManagerPrintDebugReport(void) {
 		}
 		streamWriterFormat(&stringStreamWriter.streamWriter, "\n");
 		streamWriterFormat(&stringStreamWriter.streamWriter, "  segments:\n");
-		appendSegmentInformation(&stringStreamWriter, "code", &processMemorySegmentsLimits.code, &process->codeSegmentPageFramesList);
-		appendSegmentInformation(&stringStreamWriter, "data", &processMemorySegmentsLimits.data, &process->dataSegmentPageFramesList);
-		appendSegmentInformation(&stringStreamWriter, "stack", &processMemorySegmentsLimits.stack, &process->stackSegmentPageFramesList);
+		appendSegmentInformation(&stringStreamWriter, "code", &processMemorySegmentsLimits.code, process->codeSegmentPageCount);
+		appendSegmentInformation(&stringStreamWriter, "data", &processMemorySegmentsLimits.data, process->dataSegmentPageCount);
+		appendSegmentInformation(&stringStreamWriter, "stack", &processMemorySegmentsLimits.stack, process->stackSegmentPageCount);
 		stringStreamWriterForceTerminationCharacter(&stringStreamWriter);
 
 		logDebug("%s", buffer);
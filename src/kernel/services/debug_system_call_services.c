@@ -20,9 +20,11 @@
 #include <string.h>
 
 #include "kernel/memory_manager.h"
+#include "kernel/process/executable_image_cache.h"
 #include "kernel/process/process_group_manager.h"
 #include "kernel/process/process_manager.h"
 #include "kernel/session_manager.h"
+#include "kernel/slab_allocator.h"
 #include "kernel/tty.h"
 
 #include "kernel/io/block_cache_manager.h"
@@ -49,6 +51,10 @@ APIStatusCode debugSystemCallServicesLogKernelModuleDebugReport(struct Process*
 			result = virtualFileSystemManagerPrintDebugReport();
 		} else if (strcmp("tty", kernelModuleName) == 0) {
 			result = ttyPrintDebugReport();
+		} else if (strcmp("executable_image_cache", kernelModuleName) == 0) {
+			result = executableImageCachePrintDebugReport();
+		} else if (strcmp("slab_allocator", kernelModuleName) == 0) {
+			result = slabAllocatorPrintDebugReport();
 		}
 
 	} else {
@@ -30,6 +30,8 @@
 #include "kernel/command_scheduler.h"
 #include "kernel/log.h"
 #include "kernel/memory_manager.h"
+#include "kernel/slab_allocator.h"
+#include "kernel/process/executable_image_cache.h"
 #include "kernel/process/process_manager.h"
 
 #include "kernel/io/open_file_description.h"
@@ -38,17 +40,23 @@
 #include "kernel/services/io_services.h"
 #include "kernel/services/process_services.h"
 
+#include "util/math_utils.h"
 #include "util/path_utils.h"
 
+static struct SlabCache pathUtilsContextCache;
+
+void ioServicesInitialize(void) {
+	slabAllocatorInitializeCache(&pathUtilsContextCache, "path_utils_context", sizeof(struct PathUtilsContext), -1, NULL);
+}
+
 static APIStatusCode parsePath(struct Process* process, bool verifyUserAddress,
 		const char* path, bool includeLastPathSegment, bool isPathNormalized, struct PathUtilsContext** pathUtilsContext) {
 	APIStatusCode result = SUCCESS;
 
 	struct PathUtilsContext* localPathUtilsContext = *pathUtilsContext;
 	if (localPathUtilsContext == NULL) {
-		struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-		if (doubleLinkedListElement != NULL) {
-			localPathUtilsContext = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+		localPathUtilsContext = slabAllocatorAcquire(&pathUtilsContextCache);
+		if (localPathUtilsContext != NULL) {
 			*pathUtilsContext = localPathUtilsContext;
 		} else {
 			result = ENOMEM;
@@ -69,8 +77,7 @@ static APIStatusCode parsePath(struct Process* process, bool verifyUserAddress,
 
 static void releasePathUtilsContext(struct PathUtilsContext** pathUtilsContext) {
 	if (*pathUtilsContext != NULL) {
-		struct DoubleLinkedListElement* doubleLinkedListElement = memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) *pathUtilsContext);
-		memoryManagerReleasePageFrame(doubleLinkedListElement, -1);
+		slabAllocatorRelease(&pathUtilsContextCache, *pathUtilsContext);
 		*pathUtilsContext = NULL;
 	}
 }
@@ -81,7 +88,7 @@ static APIStatusCode retrieveChild(struct VirtualFileSystemNode* parentVirtualFi
 
 	struct VirtualFileSystemOperations* operations = parentVirtualFileSystemNode->operations;
 	if (operations->walk != NULL) {
-		result = operations->walk(parentVirtualFileSystemNode, process, childName, false, 0, childVirtualFileSystemNode, NULL);
+		result = virtualFileSystemManagerWalk(parentVirtualFileSystemNode, process, childName, false, 0, childVirtualFileSystemNode, NULL);
 		if (result == ENOENT) {
 			result = SUCCESS;
 		}
@@ -188,7 +195,13 @@ APIStatusCode ioServicesOpen(struct Process* process, bool verifyUserAddress, co
 						if ((flags & O_DIRECTORY) && !S_ISDIR(mode)) {
 							result = ENOTDIR;
 						} else {
-							result = operations->open(virtualFileSystemNode, process, &openFileDescription, flags);
+							/* A file being executed can not be opened for writing. */
+							if ((flags & O_WRONLY) != 0 || (flags & O_RDWR) != 0) {
+								result = executableImageCacheInvalidate(process, virtualFileSystemNode);
+							}
+							if (result == SUCCESS) {
+								result = operations->open(virtualFileSystemNode, process, &openFileDescription, flags);
+							}
 							if (result == SUCCESS && (flags & O_TRUNC) != 0 && operations->changeFileSize != NULL) {
 								result = operations->changeFileSize(virtualFileSystemNode, process, openFileDescription, 0);
 							}
@@ -254,6 +267,8 @@ APIStatusCode ioServicesReleaseDirectory(struct Process* process, const char* di
 						if (childVirtualFileSystemNode != NULL) {
 							if (S_ISDIR(operations->getMode(childVirtualFileSystemNode))) {
 								if (childVirtualFileSystemNode->usageCount == 1) {
+									virtualFileSystemManagerInvalidateName(parentVirtualFileSystemNode, pathUtilsContext->lastSegment);
+									virtualFileSystemManagerInvalidateDirectory(childVirtualFileSystemNode);
 									result = operations->releaseDirectory(parentVirtualFileSystemNode, process, childVirtualFileSystemNode);
 								} else {
 									result = EBUSY;
@@ -307,6 +322,7 @@ APIStatusCode ioServicesReleaseName(struct Process* process, const char* namePat
 					result = ENOTDIR;
 
 				} else {
+					virtualFileSystemManagerInvalidateName(virtualFileSystemNode, pathUtilsContext->lastSegment);
 					result = operations->releaseName(virtualFileSystemNode, process, pathUtilsContext->lastSegment);
 				}
 
@@ -354,6 +370,7 @@ APIStatusCode ioServicesCreateDirectory(struct Process* process, const char* new
 							virtualFileSystemManagerReleaseNodeReservation(process, childVirtualFileSystemNode, NULL);
 							result = EEXIST;
 						} else {
+							virtualFileSystemManagerInvalidateName(virtualFileSystemNode, pathUtilsContext->lastSegment);
 							result = operations->createDirectory(virtualFileSystemNode, process, pathUtilsContext->lastSegment, mode);
 						}
 					}
@@ -501,7 +518,11 @@ APIStatusCode ioServicesWrite(struct Process* process, int fileDescriptorIndex,
 						restoreOffset = true;
 					}
 				}
-				result = operations->write(virtualFileSystemNode, process, openFileDescription, buffer, bufferSize, count);
+				/* The executable images of a file can not be used after it is written. */
+				result = executableImageCacheInvalidate(process, virtualFileSystemNode);
+				if (result == SUCCESS) {
+					result = operations->write(virtualFileSystemNode, process, openFileDescription, buffer, bufferSize, count);
+				}
 				if (restoreOffset) {
 					openFileDescription->offset = offset;
 				}
@@ -578,6 +599,7 @@ APIStatusCode ioServicesCreateName(struct Process* process, const char* targetPa
 						virtualFileSystemManagerReleaseNodeReservation(process, childVirtualFileSystemNode, NULL);
 						result = EEXIST;
 					} else {
+						virtualFileSystemManagerInvalidateName(parentVirtualFileSystemNode, pathUtilsContext->lastSegment);
 						result = operations->createName(parentVirtualFileSystemNode, process, targetVirtualFileSystemNode, pathUtilsContext->lastSegment);
 					}
 				}
@@ -611,7 +633,10 @@ APIStatusCode ioServicesChangeFileSize(struct Process* process, int fileDescript
 				result = EPERM;
 
 			} else {
-				result = operations->changeFileSize(virtualFileSystemNode, process, openFileDescription, newSize);
+				result = executableImageCacheInvalidate(process, virtualFileSystemNode);
+				if (result == SUCCESS) {
+					result = operations->changeFileSize(virtualFileSystemNode, process, openFileDescription, newSize);
+				}
 			}
 
 		} else {
@@ -655,6 +680,7 @@ APIStatusCode ioServicesCreateSymbolicLink(struct Process* process, const char*
 									virtualFileSystemManagerReleaseNodeReservation(process, childVirtualFileSystemNode, NULL);
 									result = EEXIST;
 								} else {
+									virtualFileSystemManagerInvalidateName(virtualFileSystemNode, pathUtilsContext->lastSegment);
 									result = operations->createSymbolicLink(virtualFileSystemNode, process, pathUtilsContext->lastSegment, targetPath, targetPathLength);
 								}
 							}
@@ -1007,7 +1033,7 @@ APIStatusCode ioServicesMonitorIOEvents(struct Process* currentProcess, struct p
 
 								} else if (timeout > 0) {
 									if (currentProcess->ioEventMonitoringCommandSchedulerId != NULL) {
-										timeout = commandSchedulerCancel(currentProcess->ioEventMonitoringCommandSchedulerId);
+										timeout = (int) mathUtilsDivideUint64ByUint32(commandSchedulerCancel(currentProcess->ioEventMonitoringCommandSchedulerId), 1000000, NULL);
 										currentProcess->ioEventMonitoringCommandSchedulerId = NULL;
 
 										if (timeout == 0) {
@@ -1231,6 +1257,14 @@ APIStatusCode ioServicesRename(struct Process* currentProcess, const char* oldPa
 			operations = targetVirtualFileSystemNode->operations;
 			if (operations->rename != NULL) {
 				if (targetVirtualFileSystemNode != toBeReplacedVirtualFileSystemNode) {
+					virtualFileSystemManagerInvalidateName(parentOfTargetVirtualFileSystemNode, oldName);
+					virtualFileSystemManagerInvalidateName(parentOfToBeReplacedVirtualFileSystemNode, newName);
+					/* A directory will have a new parent. */
+					virtualFileSystemManagerInvalidateName(targetVirtualFileSystemNode, "..");
+					if (toBeReplacedVirtualFileSystemNode != NULL && S_ISDIR(toBeReplacedNodeMode)) {
+						virtualFileSystemManagerInvalidateDirectory(toBeReplacedVirtualFileSystemNode);
+					}
+
 					if (toBeReplacedVirtualFileSystemNode == NULL) {
 						/* There will be no replacement. */
 
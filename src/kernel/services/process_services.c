@@ -21,6 +21,7 @@
 #include <fcntl.h>
 #include <string.h>
 
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 
@@ -28,9 +29,11 @@
 #include "kernel/log.h"
 #include "kernel/memory_manager.h"
 #include "kernel/session_manager.h"
+#include "kernel/slab_allocator.h"
 
 #include "kernel/io/open_file_description.h"
 
+#include "kernel/process/executable_image_cache.h"
 #include "kernel/process/process_group.h"
 #include "kernel/process/process_group_manager.h"
 #include "kernel/process/process_manager.h"
@@ -41,6 +44,7 @@
 
 #include "standard_library_implementation/file_descriptor_offset_reposition_constants.h"
 
+#include "util/math_utils.h"
 #include "util/string_stream_writer.h"
 
 void processServicesSuspendToWaitForIO(struct Process* currentProcess, struct DoubleLinkedList* list, enum ProcessState newState) {
@@ -57,7 +61,8 @@ void processServicesSuspendToWaitForIO(struct Process* currentProcess, struct Do
 		assert(processCountIOEventsBeingMonitored(currentProcess) > 0);
 	}
 
-	assert(newState == SUSPENDED_WAITING_READ || newState == SUSPENDED_WAITING_WRITE || newState == SUSPENDED_WAITING_IO_EVENT);
+	assert(newState == SUSPENDED_WAITING_READ || newState == SUSPENDED_WAITING_WRITE || newState == SUSPENDED_WAITING_IO_EVENT || newState == SUSPENDED_WAITING_BLOCK_IO
+		|| newState == SUSPENDED_WAITING_KERNEL_LOCK);
 	processManagerChangeProcessState(currentProcess, currentProcess, newState, 0);
 }
 
@@ -68,8 +73,17 @@ enum ExecutableFormat {
 	EXECUTABLE_FORMAT_UNKNOWN
 };
 
+#define EXECUTE_EXECUTABLE_CONTEXT_BUFFER_COUNT 4
+
+static struct SlabCache executeExecutableContextBufferCache;
+
+void processServicesInitialize(void) {
+	slabAllocatorInitializeCache(&executeExecutableContextBufferCache, "execute_executable_context_buffer", PAGE_FRAME_SIZE, -1, NULL);
+}
+
 struct ExecuteExecutableContext {
-	struct DoubleLinkedList pageFramesToReleaseList;
+	void* buffersToRelease[EXECUTE_EXECUTABLE_CONTEXT_BUFFER_COUNT];
+	int buffersToReleaseCount;
 
 	void* executableFirstBytesBuffer;
 	size_t executableFirstBytesCount;
@@ -114,45 +128,28 @@ static APIStatusCode initializeExecuteExecutableContext(struct ExecuteExecutable
 	APIStatusCode result = SUCCESS;
 
 	memset(executeExecutableContext, 0, sizeof(struct ExecuteExecutableContext));
-	doubleLinkedListInitialize(&executeExecutableContext->pageFramesToReleaseList);
 
-	struct DoubleLinkedListElement* doubleLinkedListElement;
-	doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-	if (doubleLinkedListElement != NULL) {
-		executeExecutableContext->executableFirstBytesBuffer = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-		doubleLinkedListInsertAfterLast(&executeExecutableContext->pageFramesToReleaseList, doubleLinkedListElement);
-	} else {
-		result = ENOMEM;
+	void* buffers[EXECUTE_EXECUTABLE_CONTEXT_BUFFER_COUNT];
+	for (int i = 0; i < EXECUTE_EXECUTABLE_CONTEXT_BUFFER_COUNT; i++) {
+		buffers[i] = slabAllocatorAcquire(&executeExecutableContextBufferCache);
+		if (buffers[i] != NULL) {
+			executeExecutableContext->buffersToRelease[executeExecutableContext->buffersToReleaseCount++] = buffers[i];
+		} else {
+			result = ENOMEM;
+		}
 	}
 
-	doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-	if (doubleLinkedListElement != NULL) {
-		executeExecutableContext->scriptInterpreterPath = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
+	if (result == SUCCESS) {
+		executeExecutableContext->executableFirstBytesBuffer = buffers[0];
+
+		executeExecutableContext->scriptInterpreterPath = buffers[1];
 		executeExecutableContext->arguments = (void*) executeExecutableContext->scriptInterpreterPath + PATH_MAX_LENGTH;
 		executeExecutableContext->environmentParameters = (void*) executeExecutableContext->arguments + sizeof(char*) * MAX_ARGUMENTS;
 		assert((void*) executeExecutableContext->scriptInterpreterPath + PAGE_FRAME_SIZE ==
 				(void*) executeExecutableContext->environmentParameters + sizeof(char*) * MAX_ENVIRONMENT_PARAMETERS);
-		doubleLinkedListInsertAfterLast(&executeExecutableContext->pageFramesToReleaseList, doubleLinkedListElement);
-	} else {
-		result = ENOMEM;
-	}
 
-	doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-	if (doubleLinkedListElement != NULL) {
-		char* buffer = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-		stringStreamWriterInitialize(&executeExecutableContext->argumentsWriter, buffer, PAGE_FRAME_SIZE);
-		doubleLinkedListInsertAfterLast(&executeExecutableContext->pageFramesToReleaseList, doubleLinkedListElement);
-	} else {
-		result = ENOMEM;
-	}
-
-	doubleLinkedListElement = memoryManagerAcquirePageFrame(true, -1);
-	if (doubleLinkedListElement != NULL) {
-		char* buffer = (void*) memoryManagerGetPageFramePhysicalAddress(doubleLinkedListElement);
-		stringStreamWriterInitialize(&executeExecutableContext->environmentParametersWriter, buffer, PAGE_FRAME_SIZE);
-		doubleLinkedListInsertAfterLast(&executeExecutableContext->pageFramesToReleaseList, doubleLinkedListElement);
-	} else {
-		result = ENOMEM;
+		stringStreamWriterInitialize(&executeExecutableContext->argumentsWriter, buffers[2], PAGE_FRAME_SIZE);
+		stringStreamWriterInitialize(&executeExecutableContext->environmentParametersWriter, buffers[3], PAGE_FRAME_SIZE);
 	}
 
 	executeExecutableContext->process = process;
@@ -274,11 +271,8 @@ static APIStatusCode prepareScriptExecution(struct ExecuteExecutableContext* exe
 }
 
 static void realeaseExecuteExecutableContext(struct ExecuteExecutableContext* executeExecutableContext) {
-	struct DoubleLinkedListElement* element = doubleLinkedListFirst(&executeExecutableContext->pageFramesToReleaseList);
-	while (element != NULL) {
-		struct DoubleLinkedListElement* next = element->next;
-		memoryManagerReleasePageFrame(element, -1);
-		element = next;
+	for (int i = 0; i < executeExecutableContext->buffersToReleaseCount; i++) {
+		slabAllocatorRelease(&executeExecutableContextBufferCache, executeExecutableContext->buffersToRelease[i]);
 	}
 }
 
@@ -358,35 +352,28 @@ APIStatusCode processServicesExecuteExecutable(struct Process* currentProcess, b
 								if (S_ISREG(statInstance.st_mode)) {
 									if (executableSize == 0 || executableSize > EXECUTABLE_MAX_SIZE) {
 										result = ENOEXEC;
-									} else {
-										result = processManagerChangeCodeSegmentSize(currentProcess, executableSize, false);
 									}
 
 								} else {
 									result = EACCES;
 								}
 
+								/*
+								 * The program is not copied now. Its pages will be read on demand (or taken from the executable image
+								 * if other processes have already read them).
+								 */
+								struct ExecutableImage* executableImage;
 								if (result == SUCCESS) {
-									off_t newOffset;
-									result = ioServicesRepositionOpenFileDescriptionOffset(currentProcess, fileDescriptorIndex, 0, SEEK_SET, &newOffset);
-
-									if (result == SUCCESS) {
-										/* It copies the program properly. */
-										size_t count = 0;
-										result = ioServicesRead(currentProcess, fileDescriptorIndex, false, (void*) CODE_SEGMENT_FIRST_PAGE_VIRTUAL_ADDRESS, executableSize, &count);
-										assert(result != SUCCESS || count == executableSize);
-
-										/* It releases the data segment entirely as it already copied the "argv" and "envp". */
-										if (result == SUCCESS) {
-											processManagerChangeDataSegmentSize(currentProcess, -doubleLinkedListSize(&currentProcess->dataSegmentPageFramesList) * PAGE_FRAME_SIZE);
-											assert(doubleLinkedListSize(&currentProcess->dataSegmentPageFramesList) == 0);
-										}
-									}
+									struct OpenFileDescription* openFileDescription = currentProcess->fileDescriptors[fileDescriptorIndex].openFileDescription;
+									result = executableImageCacheAcquire(currentProcess, openFileDescription, &statInstance, &executableImage);
 								}
 
 								if (result == SUCCESS) {
-									result = processManagerChangeCodeSegmentSize(currentProcess, executableSize, true);
-									assert(result == SUCCESS); /* Because if there is something to do it would be a segment reduction. */
+									processManagerMapExecutable(currentProcess, executableImage);
+
+									/* It releases the data segment entirely as it already copied the "argv" and "envp". */
+									processManagerChangeDataSegmentSize(currentProcess, -currentProcess->dataSegmentPageCount * PAGE_FRAME_SIZE);
+									assert(currentProcess->dataSegmentPageCount == 0);
 								}
 							}
 							stop = true;
@@ -840,13 +827,17 @@ APIStatusCode processServicesSetProcessGroup(struct Process* currentProcess, pid
 	return result;
 }
 
-void processServicesSleep(struct Process* currentProcess, int milliseconds) {
-	struct ProcessExecutionState2* processExecutionState2 = currentProcess->processExecutionState2;
+APIStatusCode processServicesSleep(struct Process* currentProcess, uint64_t nanoseconds, uint64_t* remainingNanoseconds) {
 	assert(currentProcess->state == RUNNABLE);
 	assert(currentProcess->sleepCommandSchedulerId == NULL);
 
-	currentProcess->sleepCommandSchedulerId  = commandSchedulerSchedule(processExecutionState2->ebx, false, (void (*)(void*)) &resumeProcessExecutionAfterSleep, currentProcess);
+	currentProcess->sleepCommandSchedulerId  = commandSchedulerScheduleInNanoseconds(nanoseconds, false, (void (*)(void*)) &resumeProcessExecutionAfterSleep, currentProcess);
+	if (currentProcess->sleepCommandSchedulerId == NULL) {
+		return ENOMEM;
+	}
 
+	APIStatusCode result = SUCCESS;
+	*remainingNanoseconds = 0;
 	bool done = false;
 
 	do {
@@ -855,18 +846,20 @@ void processServicesSleep(struct Process* currentProcess, int milliseconds) {
 
 		assert(currentProcess->state == RUNNABLE);
 		if (currentProcess->sleepCommandSchedulerId == NULL) {
-			processExecutionState2->eax = 0;
 			done = true;
 
 		} else if (resumedProcessExecutionSituation == WILL_CALL_SIGNAL_HANDLER) {
-			processExecutionState2->eax = (uint32_t) (commandSchedulerCancel(currentProcess->sleepCommandSchedulerId) >> 10); /* As we can not divide by 1000. */
+			*remainingNanoseconds = commandSchedulerCancel(currentProcess->sleepCommandSchedulerId);
 			currentProcess->sleepCommandSchedulerId = NULL;
+			result = EINTR;
 			done = true;
 		}
 
 	} while (!done);
 
 	assert(currentProcess->sleepCommandSchedulerId == NULL);
+
+	return result;
 }
 
 void processServicesWakeUpProcesses(struct Process* currentProcess, struct DoubleLinkedList* processList, enum ProcessState processState) {
@@ -883,3 +876,59 @@ void processServicesWakeUpProcesses(struct Process* currentProcess, struct Doubl
 		}
 	}
 }
+
+/*
+ * It calls the function for each process selected by "which" and "who" (see "getpriority" and "setpriority"). As there
+ * are no users, "PRIO_USER" is not supported.
+ */
+static APIStatusCode forEachPriorityTargetProcess(struct Process* currentProcess, int which, id_t who,
+		void (*processTargetProcess)(struct Process*, int*), int* argument) {
+	APIStatusCode result = SUCCESS;
+
+	if (which == PRIO_PROCESS) {
+		struct Process* targetProcess = who == 0 ? currentProcess : processManagerGetProcessById(who);
+		if (targetProcess != NULL) {
+			processTargetProcess(targetProcess, argument);
+		} else {
+			result = ESRCH;
+		}
+
+	} else if (which == PRIO_PGRP) {
+		struct ProcessGroup* processGroup = processGroupManagerGetAndReserveProcessGroupById(who == 0 ? currentProcess->processGroup->id : who);
+		if (processGroup != NULL && doubleLinkedListSize(&processGroup->processesList) > 0) {
+			struct DoubleLinkedListElement* listElement = doubleLinkedListFirst(&processGroup->processesList);
+			while (listElement != NULL) {
+				processTargetProcess(processGetProcessFromProcessGroupListElement(listElement), argument);
+				listElement = listElement->next;
+			}
+		} else {
+			result = ESRCH;
+		}
+		if (processGroup != NULL) {
+			processGroupManagerReleaseReservation(processGroup);
+		}
+
+	} else {
+		result = EINVAL;
+	}
+
+	return result;
+}
+
+static void retrieveNiceValue(struct Process* process, int* niceValue) {
+	/* The highest priority among the selected processes. */
+	*niceValue = mathUtilsMin(*niceValue, process->niceValue);
+}
+
+static void changeNiceValue(struct Process* process, int* niceValue) {
+	processManagerChangeNiceValue(process, *niceValue);
+}
+
+APIStatusCode processServicesGetPriority(struct Process* currentProcess, int which, id_t who, int* niceValue) {
+	*niceValue = NZERO;
+	return forEachPriorityTargetProcess(currentProcess, which, who, &retrieveNiceValue, niceValue);
+}
+
+APIStatusCode processServicesSetPriority(struct Process* currentProcess, int which, id_t who, int niceValue) {
+	return forEachPriorityTargetProcess(currentProcess, which, who, &changeNiceValue, &niceValue);
+}
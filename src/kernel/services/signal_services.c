@@ -396,8 +396,12 @@ static APIStatusCode doGenerateSignal(struct Process* senderProcess, struct Proc
 					 * The signals are marked as pending, but not delivered until the process is continued.
 					 *
 					 * https://www.gnu.org/software/libc/manual/html_node/Job-Control-Signals.html
+					 *
+					 * A process waiting for a block device (or for the kernel lock) can not be interrupted. The signal will be
+					 * handled after its system call completes.
 					 */
-					if (receiverProcess->state != STOPPED || (signalId == SIGCONT || signalId == SIGKILL)) {
+					if (receiverProcess->state != SUSPENDED_WAITING_BLOCK_IO && receiverProcess->state != SUSPENDED_WAITING_KERNEL_LOCK
+							&& (receiverProcess->state != STOPPED || (signalId == SIGCONT || signalId == SIGKILL))) {
 						processManagerChangeProcessState(senderProcess, receiverProcess, RUNNABLE, signalId);
 					}
 				}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <assert.h>
+#include <string.h>
+
+#include <myos.h>
+
+#include "kernel/clock_manager.h"
+#include "kernel/log.h"
+#include "kernel/memory_manager.h"
+#include "kernel/shared_data_manager.h"
+
+/*
+ * The kernel writes on the page through its own (identity) mapping. The processes map it as read-only (see
+ * "MYOS_SHARED_DATA_PAGE_VIRTUAL_ADDRESS").
+ */
+static volatile struct MyosSharedData* sharedData = NULL;
+
+APIStatusCode sharedDataManagerInitialize(void) {
+	struct DoubleLinkedListElement* pageFrame = memoryManagerAcquirePageFrame(true, -1);
+	if (pageFrame == NULL) {
+		return ENOMEM;
+	}
+	_Static_assert(sizeof(struct MyosSharedData) <= PAGE_FRAME_SIZE, "The shared data must fit in a page.");
+
+	sharedData = (void*) memoryManagerGetPageFramePhysicalAddress(pageFrame);
+	memset((void*) sharedData, 0, PAGE_FRAME_SIZE);
+	/* The processes calculate the time by themselves from these parameters. */
+	sharedData->clockParameters = *clockManagerGetParameters();
+
+	logDebug("The shared data page is at %p", sharedData);
+
+	return SUCCESS;
+}
+
+uint32_t sharedDataManagerGetPagePhysicalAddress(void) {
+	assert(sharedData != NULL);
+	return (uint32_t) sharedData;
+}
+
+void sharedDataManagerSetCurrentProcess(pid_t processId, pid_t parentProcessId) {
+	sharedData->currentProcessId = processId;
+	sharedData->currentParentProcessId = parentProcessId;
+}
+
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "kernel/log.h"
+#include "kernel/memory_manager.h"
+#include "kernel/slab_allocator.h"
+
+#include "util/math_utils.h"
+#include "util/string_stream_writer.h"
+
+/* Empty slabs kept by each cache (so a cache that grows and shrinks repeatedly does not keep acquiring page frames). */
+#define MAX_EMPTY_SLABS_PER_CACHE 1
+
+struct Slab {
+	struct DoubleLinkedListElement listElement;
+	uint32_t usedObjectCount;
+	/* A stack with the indexes of the free objects. They are kept outside the objects to preserve their constructed state. */
+	uint16_t freeObjectIndexes[];
+};
+
+static struct DoubleLinkedList slabCachesList;
+static bool isSlabCachesListInitialized = false;
+
+static uint32_t calculateFirstObjectOffset(uint32_t objectsPerSlab) {
+	uint32_t offset = sizeof(struct Slab) + objectsPerSlab * sizeof(uint16_t);
+	if (offset % sizeof(uint64_t) != 0) {
+		offset += sizeof(uint64_t) - offset % sizeof(uint64_t);
+	}
+	return offset;
+}
+
+void slabAllocatorInitializeCache(struct SlabCache* slabCache, const char* name, size_t objectSize, int reservationId,
+		void (*constructor)(void*)) {
+	assert(0 < objectSize && objectSize <= PAGE_FRAME_SIZE);
+
+	memset(slabCache, 0, sizeof(struct SlabCache));
+	slabCache->name = name;
+	if (objectSize % sizeof(uint32_t) != 0) {
+		objectSize += sizeof(uint32_t) - objectSize % sizeof(uint32_t);
+	}
+	slabCache->objectSize = objectSize;
+	slabCache->reservationId = reservationId;
+	slabCache->constructor = constructor;
+
+	uint32_t objectsPerSlab = (PAGE_FRAME_SIZE - sizeof(struct Slab)) / (objectSize + sizeof(uint16_t));
+	while (objectsPerSlab > 0 && calculateFirstObjectOffset(objectsPerSlab) + objectsPerSlab * objectSize > PAGE_FRAME_SIZE) {
+		objectsPerSlab--;
+	}
+	if (objectsPerSlab < 2) {
+		/* A slab header would not save any memory. */
+		slabCache->isLarge = true;
+		slabCache->objectsPerSlab = 1;
+		slabCache->firstObjectOffset = 0;
+	} else {
+		assert(objectsPerSlab <= UINT16_MAX);
+		slabCache->isLarge = false;
+		slabCache->objectsPerSlab = objectsPerSlab;
+		slabCache->firstObjectOffset = calculateFirstObjectOffset(objectsPerSlab);
+	}
+
+	doubleLinkedListInitialize(&slabCache->partialSlabsList);
+	doubleLinkedListInitialize(&slabCache->fullSlabsList);
+	doubleLinkedListInitialize(&slabCache->emptySlabsList);
+
+	if (!isSlabCachesListInitialized) {
+		doubleLinkedListInitialize(&slabCachesList);
+		isSlabCachesListInitialized = true;
+	}
+	doubleLinkedListInsertAfterLast(&slabCachesList, &slabCache->slabCacheListElement);
+}
+
+void slabAllocatorReleaseCache(struct SlabCache* slabCache) {
+	assert(slabCache->usedObjectCount == 0);
+	assert(doubleLinkedListSize(&slabCache->partialSlabsList) == 0 && doubleLinkedListSize(&slabCache->fullSlabsList) == 0);
+
+	while (doubleLinkedListSize(&slabCache->emptySlabsList) > 0) {
+		struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListRemoveFirst(&slabCache->emptySlabsList);
+		if (!slabCache->isLarge) {
+			doubleLinkedListElement = memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) doubleLinkedListElement);
+		}
+		memoryManagerReleasePageFrame(doubleLinkedListElement, slabCache->reservationId);
+		slabCache->slabCount--;
+	}
+	assert(slabCache->slabCount == 0);
+
+	doubleLinkedListRemove(&slabCachesList, &slabCache->slabCacheListElement);
+}
+
+static void* acquireLargeObject(struct SlabCache* slabCache) {
+	struct DoubleLinkedListElement* pageFrame;
+	if (doubleLinkedListSize(&slabCache->emptySlabsList) > 0) {
+		pageFrame = doubleLinkedListRemoveFirst(&slabCache->emptySlabsList);
+
+	} else {
+		pageFrame = memoryManagerAcquirePageFrame(true, slabCache->reservationId);
+		if (pageFrame == NULL) {
+			return NULL;
+		}
+		slabCache->slabCount++;
+		if (slabCache->constructor != NULL) {
+			slabCache->constructor((void*) memoryManagerGetPageFramePhysicalAddress(pageFrame));
+		}
+	}
+
+	slabCache->usedObjectCount++;
+	return (void*) memoryManagerGetPageFramePhysicalAddress(pageFrame);
+}
+
+static void releaseLargeObject(struct SlabCache* slabCache, void* object) {
+	assert((uint32_t) object % PAGE_FRAME_SIZE == 0);
+	struct DoubleLinkedListElement* pageFrame = memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) object);
+
+	slabCache->usedObjectCount--;
+	if (doubleLinkedListSize(&slabCache->emptySlabsList) < MAX_EMPTY_SLABS_PER_CACHE) {
+		doubleLinkedListInsertBeforeFirst(&slabCache->emptySlabsList, pageFrame);
+	} else {
+		memoryManagerReleasePageFrame(pageFrame, slabCache->reservationId);
+		slabCache->slabCount--;
+	}
+}
+
+static struct Slab* createSlab(struct SlabCache* slabCache) {
+	struct DoubleLinkedListElement* pageFrame = memoryManagerAcquirePageFrame(true, slabCache->reservationId);
+	if (pageFrame == NULL) {
+		return NULL;
+	}
+
+	struct Slab* slab = (void*) memoryManagerGetPageFramePhysicalAddress(pageFrame);
+	slab->usedObjectCount = 0;
+	for (uint32_t i = 0; i < slabCache->objectsPerSlab; i++) {
+		/* The objects with lower indexes are handed out first. */
+		slab->freeObjectIndexes[i] = slabCache->objectsPerSlab - 1 - i;
+		if (slabCache->constructor != NULL) {
+			slabCache->constructor((void*) slab + slabCache->firstObjectOffset + i * slabCache->objectSize);
+		}
+	}
+	slabCache->slabCount++;
+
+	return slab;
+}
+
+void* slabAllocatorAcquire(struct SlabCache* slabCache) {
+	if (slabCache->isLarge) {
+		return acquireLargeObject(slabCache);
+	}
+
+	struct Slab* slab;
+	if (doubleLinkedListSize(&slabCache->partialSlabsList) > 0) {
+		slab = (void*) doubleLinkedListFirst(&slabCache->partialSlabsList);
+
+	} else if (doubleLinkedListSize(&slabCache->emptySlabsList) > 0) {
+		slab = (void*) doubleLinkedListRemoveFirst(&slabCache->emptySlabsList);
+		doubleLinkedListInsertBeforeFirst(&slabCache->partialSlabsList, &slab->listElement);
+
+	} else {
+		slab = createSlab(slabCache);
+		if (slab == NULL) {
+			return NULL;
+		}
+		doubleLinkedListInsertBeforeFirst(&slabCache->partialSlabsList, &slab->listElement);
+	}
+
+	assert(slab->usedObjectCount < slabCache->objectsPerSlab);
+	uint32_t freeObjectCount = slabCache->objectsPerSlab - slab->usedObjectCount;
+	uint16_t objectIndex = slab->freeObjectIndexes[freeObjectCount - 1];
+	slab->usedObjectCount++;
+	slabCache->usedObjectCount++;
+
+	if (slab->usedObjectCount == slabCache->objectsPerSlab) {
+		doubleLinkedListRemove(&slabCache->partialSlabsList, &slab->listElement);
+		doubleLinkedListInsertBeforeFirst(&slabCache->fullSlabsList, &slab->listElement);
+	}
+
+	return (void*) slab + slabCache->firstObjectOffset + objectIndex * slabCache->objectSize;
+}
+
+void slabAllocatorRelease(struct SlabCache* slabCache, void* object) {
+	assert(slabCache->usedObjectCount > 0);
+
+	if (slabCache->isLarge) {
+		releaseLargeObject(slabCache, object);
+		return;
+	}
+
+	struct Slab* slab = (void*) ((uint32_t) object - (uint32_t) object % PAGE_FRAME_SIZE);
+	uint32_t objectOffset = (uint32_t) object - (uint32_t) slab - slabCache->firstObjectOffset;
+	assert(objectOffset % slabCache->objectSize == 0);
+	assert(slab->usedObjectCount > 0);
+
+	uint32_t freeObjectCount = slabCache->objectsPerSlab - slab->usedObjectCount;
+	slab->freeObjectIndexes[freeObjectCount] = objectOffset / slabCache->objectSize;
+	slab->usedObjectCount--;
+	slabCache->usedObjectCount--;
+
+	if (slab->usedObjectCount + 1 == slabCache->objectsPerSlab) {
+		doubleLinkedListRemove(&slabCache->fullSlabsList, &slab->listElement);
+		doubleLinkedListInsertBeforeFirst(&slabCache->partialSlabsList, &slab->listElement);
+	}
+
+	if (slab->usedObjectCount == 0) {
+		doubleLinkedListRemove(&slabCache->partialSlabsList, &slab->listElement);
+		if (doubleLinkedListSize(&slabCache->emptySlabsList) < MAX_EMPTY_SLABS_PER_CACHE) {
+			doubleLinkedListInsertBeforeFirst(&slabCache->emptySlabsList, &slab->listElement);
+		} else {
+			memoryManagerReleasePageFrame(memoryManagerGetPageFrameDoubleLinkedListElement((uint32_t) slab), slabCache->reservationId);
+			slabCache->slabCount--;
+		}
+	}
+}
+
+APIStatusCode slabAllocatorPrintDebugReport(void) {
+	int bufferSize = 512;
+	char buffer[bufferSize];
+	struct StringStreamWriter stringStreamWriter;
+
+	logDebug("Slab allocator report:\n");
+
+	if (isSlabCachesListInitialized) {
+		struct DoubleLinkedListElement* doubleLinkedListElement = doubleLinkedListFirst(&slabCachesList);
+		while (doubleLinkedListElement != NULL) {
+			struct SlabCache* slabCache = (void*) doubleLinkedListElement;
+			doubleLinkedListElement = doubleLinkedListElement->next;
+
+			stringStreamWriterInitialize(&stringStreamWriter, buffer, bufferSize);
+			streamWriterFormat(&stringStreamWriter.streamWriter, "SlabCache %s\n", slabCache->name);
+			streamWriterFormat(&stringStreamWriter.streamWriter, "  objectSize: %u\n", slabCache->objectSize);
+			streamWriterFormat(&stringStreamWriter.streamWriter, "  objectsPerSlab: %u\n", slabCache->objectsPerSlab);
+			streamWriterFormat(&stringStreamWriter.streamWriter, "  slabCount: %u\n", slabCache->slabCount);
+			streamWriterFormat(&stringStreamWriter.streamWriter, "  usedObjectCount: %u\n", slabCache->usedObjectCount);
+			stringStreamWriterForceTerminationCharacter(&stringStreamWriter);
+
+			logDebug("%s", buffer);
+		}
+	}
+
+	return SUCCESS;
+}
@@ -27,7 +27,7 @@
 #include "standard_library_implementation/file_descriptor_offset_reposition_constants.h"
 
 #include "kernel/busy_waiting_manager.h"
-#include "kernel/cmos.h"
+#include "kernel/clock_manager.h"
 #include "kernel/command_scheduler.h"
 #include "kernel/kernel_life_cycle.h"
 #include "kernel/interruption_manager.h"
@@ -273,6 +273,16 @@ static void doSetProcessGroup(struct Process* currentProcess) {
 	processExecutionState2->eax = processServicesSetProcessGroup(currentProcess, processExecutionState2->ebx, processExecutionState2->ecx);
 }
 
+static void doGetPriority(struct Process* currentProcess) {
+	struct ProcessExecutionState2* processExecutionState2 = currentProcess->processExecutionState2;
+	processExecutionState2->eax = processServicesGetPriority(currentProcess, processExecutionState2->ebx, processExecutionState2->ecx, (int*) &processExecutionState2->ebx);
+}
+
+static void doSetPriority(struct Process* currentProcess) {
+	struct ProcessExecutionState2* processExecutionState2 = currentProcess->processExecutionState2;
+	processExecutionState2->eax = processServicesSetPriority(currentProcess, processExecutionState2->ebx, processExecutionState2->ecx, processExecutionState2->edx);
+}
+
 static void doCreatePipe(struct Process* currentProcess) {
 	struct ProcessExecutionState2* processExecutionState2 = currentProcess->processExecutionState2;
 	processExecutionState2->eax = pipeManagerCreatePipe(currentProcess, (int*) &processExecutionState2->ebx, (int*) &processExecutionState2->ecx);
@@ -290,7 +300,11 @@ static void doGetProcessMemorySegmentsLimits(struct Process* currentProcess) {
 
 static void doSleep(struct Process* currentProcess) {
 	struct ProcessExecutionState2* processExecutionState2 = currentProcess->processExecutionState2;
-	processServicesSleep(currentProcess, processExecutionState2->ebx);
+	uint64_t nanoseconds = (((uint64_t) processExecutionState2->ecx) << 32) | processExecutionState2->ebx;
+	uint64_t remainingNanoseconds;
+	processExecutionState2->eax = processServicesSleep(currentProcess, nanoseconds, &remainingNanoseconds);
+	processExecutionState2->ebx = (uint32_t) remainingNanoseconds;
+	processExecutionState2->ecx = (uint32_t) (remainingNanoseconds >> 32);
 }
 
 static void doSetFileModeCreationMask(struct Process* currentProcess) {
@@ -329,6 +343,8 @@ static void systemCallHandler(struct ProcessExecutionState1* processExecutionSta
 	currentProcess->processExecutionState1 = processExecutionState1;
 	currentProcess->processExecutionState2 = processExecutionState2;
 
+	processManagerAcquireKernelLock(currentProcess);
+
 	int systemCallId = processExecutionState2->eax;
 	switch (systemCallId) {
 		case SYSTEM_CALL_WAIT:
@@ -392,11 +408,8 @@ static void systemCallHandler(struct ProcessExecutionState1* processExecutionSta
 
 		case SYSTEM_CALL_GET_UNIX_TIME:
 			{
-				/*
-				 * There are better ways to implement this system call.
-				 * However, there are things with higher priority to be implemented before.
-				 */
-				processExecutionState2->eax = cmosGetUnixTime();
+				/* The processes usually read it from the shared data page (see "time"). */
+				processExecutionState2->eax = clockManagerGetUnixTime();
 			}
 			break;
 
@@ -501,6 +514,14 @@ static void systemCallHandler(struct ProcessExecutionState1* processExecutionSta
 			doCreatePipe(currentProcess);
 			break;
 
+		case SYSTEM_CALL_GET_PRIORITY:
+			doGetPriority(currentProcess);
+			break;
+
+		case SYSTEM_CALL_SET_PRIORITY:
+			doSetPriority(currentProcess);
+			break;
+
 		case SYSTEM_CALL_MONITOR_IO_EVENTS:
 			doMonitorIOEvents(currentProcess);
 			break;
@@ -564,6 +585,13 @@ static void systemCallHandler(struct ProcessExecutionState1* processExecutionSta
 			signalServicesGenerateSignal(currentProcess, currentProcess->id, SIGSYS, false, NULL);
 			break;
 	}
+
+	processManagerReleaseKernelLock(currentProcess);
+
+	/* The signals generated while it was holding the kernel lock are handled now. */
+	if (currentProcess->mightHaveAnySignalToHandle) {
+		signalServicesHandlePendingSignals(currentProcess);
+	}
 }
 
 void systemCallManagerInitialize(void) {
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <errno.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "test/integration_test.h"
+
+static void handleSignal(int signalId) {
+}
+
+/* The checks must not depend on "assert" as they also need to run when it is disabled. */
+static void check(bool condition) {
+	if (!condition) {
+		exit(EXIT_FAILURE);
+	}
+}
+
+static int64_t toNanoseconds(struct timespec* timespecInstance) {
+	return ((int64_t) timespecInstance->tv_sec) * 1000000000 + timespecInstance->tv_nsec;
+}
+
+static int64_t getMonotonicTimeInNanoseconds(void) {
+	struct timespec timespecInstance;
+	check(clock_gettime(CLOCK_MONOTONIC, &timespecInstance) == 0);
+	check(timespecInstance.tv_nsec >= 0 && timespecInstance.tv_nsec < 1000000000);
+	return toNanoseconds(&timespecInstance);
+}
+
+static void testClocks(void) {
+	struct timespec timespecInstance;
+	check(clock_gettime(-1, &timespecInstance) == -1 && errno == EINVAL);
+
+	int64_t previous = getMonotonicTimeInNanoseconds();
+	for (int i = 0; i < 1000; i++) {
+		int64_t current = getMonotonicTimeInNanoseconds();
+		check(current >= previous);
+		previous = current;
+	}
+
+	time_t before = time(NULL);
+	check(clock_gettime(CLOCK_REALTIME, &timespecInstance) == 0);
+	struct timeval timevalInstance;
+	check(gettimeofday(&timevalInstance, NULL) == 0);
+	time_t after = time(NULL);
+	check(before <= timespecInstance.tv_sec && timespecInstance.tv_sec <= after);
+	check(timespecInstance.tv_sec <= timevalInstance.tv_sec && timevalInstance.tv_sec <= after);
+	check(timevalInstance.tv_usec >= 0 && timevalInstance.tv_usec < 1000000);
+}
+
+static void testSleep(void) {
+	struct timespec requestedTime = { .tv_sec = 0, .tv_nsec = 1000000000 };
+	check(nanosleep(&requestedTime, NULL) == -1 && errno == EINVAL);
+	requestedTime.tv_nsec = -1;
+	check(nanosleep(&requestedTime, NULL) == -1 && errno == EINVAL);
+
+	/* It never sleeps less than requested. */
+	int64_t before = getMonotonicTimeInNanoseconds();
+	requestedTime.tv_nsec = 50000000;
+	check(nanosleep(&requestedTime, NULL) == 0);
+	int64_t elapsed = getMonotonicTimeInNanoseconds() - before;
+	check(elapsed >= 50000000 && elapsed < 1000000000);
+
+	before = getMonotonicTimeInNanoseconds();
+	check(usleep(25000) == 0);
+	elapsed = getMonotonicTimeInNanoseconds() - before;
+	check(elapsed >= 25000000 && elapsed < 1000000000);
+}
+
+/* A signal interrupts the sleep and the time left is returned. */
+static void testInterruptedSleep(void) {
+	check(signal(SIGUSR1, &handleSignal) != SIG_ERR);
+
+	pid_t parentProcessId = getpid();
+	pid_t childProcessId = fork();
+	if (childProcessId == 0) {
+		check(usleep(100000) == 0);
+		check(kill(parentProcessId, SIGUSR1) == 0);
+		exit(EXIT_SUCCESS);
+	}
+	check(childProcessId > 0);
+
+	struct timespec requestedTime = { .tv_sec = 10, .tv_nsec = 0 };
+	struct timespec remainingTime;
+	check(nanosleep(&requestedTime, &remainingTime) == -1 && errno == EINTR);
+	check(remainingTime.tv_nsec >= 0 && remainingTime.tv_nsec < 1000000000);
+	check(toNanoseconds(&remainingTime) > 0 && toNanoseconds(&remainingTime) < toNanoseconds(&requestedTime));
+
+	int status;
+	check(waitpid(childProcessId, &status, 0) == childProcessId);
+	check(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+int main(int argc, char** argv) {
+	integrationTestConfigureCommonSignalHandlers();
+
+	testClocks();
+	testSleep();
+	testInterruptedSleep();
+
+	integrationTestRegisterSuccessfulCompletion(argv[0]);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "test/integration_test.h"
+
+#define EXECUTABLE_PATH INTEGRATION_TEST_EXECUTABLES_PATH "executable_sleep"
+
+int main(int argc, char** argv) {
+	integrationTestConfigureCommonSignalHandlers();
+
+	pid_t childProcessId = fork();
+	if (childProcessId == 0) {
+		char* childArgv[2];
+		char buffer[64];
+		sprintf(buffer, "%d", 3);
+		childArgv[0] = buffer;
+		childArgv[1] = NULL;
+
+		execvp(EXECUTABLE_PATH, childArgv);
+		assert(false);
+		exit(EXIT_FAILURE);
+	}
+	assert(childProcessId > 0);
+
+	/* Gives the child process time to execute the file. */
+	sleep(1);
+
+	/* The file being executed can be read but not modified. */
+	int fileDescriptorIndex = open(EXECUTABLE_PATH, O_RDONLY);
+	assert(fileDescriptorIndex >= 0);
+	assert(close(fileDescriptorIndex) == 0);
+
+	assert(open(EXECUTABLE_PATH, O_WRONLY) == -1);
+	assert(errno == ETXTBSY);
+	assert(open(EXECUTABLE_PATH, O_RDWR | O_TRUNC) == -1);
+	assert(errno == ETXTBSY);
+
+	int status;
+	assert(waitpid(childProcessId, &status, 0) == childProcessId);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+
+	/* No process is executing it anymore. */
+	fileDescriptorIndex = open(EXECUTABLE_PATH, O_WRONLY);
+	assert(fileDescriptorIndex >= 0);
+	assert(close(fileDescriptorIndex) == 0);
+
+	integrationTestRegisterSuccessfulCompletion(argv[0]);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "test/integration_test.h"
+
+int main(int argc, char** argv) {
+	integrationTestConfigureCommonSignalHandlers();
+
+	assert(getpriority(PRIO_PROCESS, 0) == 0);
+	assert(getpriority(PRIO_PROCESS, getpid()) == 0);
+
+	assert(nice(5) == 5);
+	assert(getpriority(PRIO_PROCESS, 0) == 5);
+
+	/* The nice value is clamped. */
+	assert(nice(2 * NZERO) == NZERO - 1);
+	assert(setpriority(PRIO_PROCESS, 0, -2 * NZERO) == 0);
+	assert(getpriority(PRIO_PROCESS, 0) == -NZERO);
+
+	/* As it is a valid nice value, -1 does not indicate an error. */
+	assert(setpriority(PRIO_PROCESS, 0, -1) == 0);
+	errno = 0;
+	assert(getpriority(PRIO_PROCESS, 0) == -1);
+	assert(errno == 0);
+
+	assert(getpriority(PRIO_USER, 0) == -1);
+	assert(errno == EINVAL);
+	assert(setpriority(PRIO_PROCESS, INT_MAX, 0) == -1);
+	assert(errno == ESRCH);
+
+	/* The child inherits the nice value. */
+	assert(setpriority(PRIO_PROCESS, 0, 3) == 0);
+	pid_t childProcessId = fork();
+	if (childProcessId == 0) {
+		assert(getpriority(PRIO_PROCESS, 0) == 3);
+		exit(EXIT_SUCCESS);
+	}
+	assert(childProcessId > 0);
+
+	int status;
+	assert(waitpid(childProcessId, &status, 0) == childProcessId);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+
+	/* It changes all processes of its process group (a new one to not affect the test suite). */
+	assert(setpgid(0, 0) == 0);
+	assert(setpriority(PRIO_PGRP, 0, 7) == 0);
+	assert(getpriority(PRIO_PGRP, 0) == 7);
+	assert(getpriority(PRIO_PROCESS, 0) == 7);
+
+	integrationTestRegisterSuccessfulCompletion(argv[0]);
+	return EXIT_SUCCESS;
+}
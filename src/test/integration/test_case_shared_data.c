@@ -0,0 +1,81 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/wait.h>
+
+#include <myos.h>
+
+#include "kernel/system_calls.h"
+
+#include "test/integration_test.h"
+
+static uint32_t callSystemCall(uint32_t systemCallId) {
+	uint32_t result;
+	__asm__ __volatile__(
+		SYSTEM_CALL_INSTRUCTION ";"
+		: "=a"(result)
+		: "a"(systemCallId)
+		: "memory");
+	return result;
+}
+
+/* The values read from the shared data page must be the same returned by the system calls. */
+static void testProcessIds(void) {
+	assert(getpid() == (pid_t) callSystemCall(SYSTEM_CALL_GET_PROCESS_ID));
+	assert(getppid() == (pid_t) callSystemCall(SYSTEM_CALL_GET_PARENT_PROCESS_ID));
+}
+
+int main(int argc, char** argv) {
+	integrationTestConfigureCommonSignalHandlers();
+
+	testProcessIds();
+
+	/* The page is updated on every context switch. */
+	pid_t parentProcessId = getpid();
+	pid_t childProcessId = fork();
+	if (childProcessId == 0) {
+		assert(getppid() == parentProcessId);
+		testProcessIds();
+		exit(EXIT_SUCCESS);
+	}
+	assert(childProcessId > 0);
+
+	int status;
+	assert(waitpid(childProcessId, &status, 0) == childProcessId);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+	assert(getpid() == parentProcessId);
+	testProcessIds();
+
+	time_t unixTime = time(NULL);
+	time_t systemCallUnixTime = (time_t) callSystemCall(SYSTEM_CALL_GET_UNIX_TIME);
+	assert(systemCallUnixTime - unixTime >= 0 && systemCallUnixTime - unixTime <= 1);
+
+	/* The clock parameters are set before the first process is created. */
+	const volatile struct MyosSharedData* sharedData = myosGetSharedData();
+	assert(sharedData->clockParameters.nanosecondsPerCycleMultiplier != 0);
+	assert(sharedData->clockParameters.unixTimeAtBoot <= unixTime);
+
+	integrationTestRegisterSuccessfulCompletion(argv[0]);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <assert.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/wait.h>
+
+#include <myos.h>
+
+#include "kernel/system_calls.h"
+
+#include "test/integration_test.h"
+
+extern void (*systemCallEntryPoint)(void);
+void systemCallUsingInterruption(void);
+void systemCallUsingSysenter(void);
+extern uint32_t systemCallSysexitReturnCount;
+
+static volatile sig_atomic_t handledSignalId = 0;
+
+static void handleSignal(int signalId) {
+	handledSignalId = signalId;
+}
+
+/* Only EAX is changed by this system call: the other registers must be preserved by both stubs. */
+static void testGetProcessId(void (*stub)(void)) {
+	uint32_t eax = SYSTEM_CALL_GET_PROCESS_ID;
+	uint32_t ebx = 0x11111111;
+	uint32_t ecx = 0x22222222;
+	uint32_t edx = 0x33333333;
+	uint32_t esi = 0x44444444;
+	uint32_t edi = 0x55555555;
+	__asm__ __volatile__(
+		"call *%6;"
+		: "+a"(eax), "+b"(ebx), "+c"(ecx), "+d"(edx), "+S"(esi), "+D"(edi)
+		: "m"(stub)
+		: "memory");
+
+	assert(eax == getpid());
+	assert(ebx == 0x11111111);
+	assert(ecx == 0x22222222);
+	assert(edx == 0x33333333);
+	assert(esi == 0x44444444);
+	assert(edi == 0x55555555);
+}
+
+int main(int argc, char** argv) {
+	integrationTestConfigureCommonSignalHandlers();
+
+	bool isSysenterSupported = x86IsSysenterSupported();
+	uint32_t sysexitReturnCount = systemCallSysexitReturnCount;
+	if (isSysenterSupported) {
+		assert(systemCallEntryPoint == &systemCallUsingSysenter);
+		testGetProcessId(&systemCallUsingSysenter);
+		/* The kernel must have returned through SYSEXIT. */
+		assert(systemCallSysexitReturnCount == sysexitReturnCount + 1);
+		sysexitReturnCount = systemCallSysexitReturnCount;
+	} else {
+		assert(systemCallEntryPoint == &systemCallUsingInterruption);
+	}
+	testGetProcessId(&systemCallUsingInterruption);
+	assert(systemCallSysexitReturnCount == sysexitReturnCount);
+
+	/* A system call that returns values on EBX and ECX. */
+	int pipeFileDescriptorIndexes[2];
+	assert(pipe(pipeFileDescriptorIndexes) == 0);
+	char c = 'x';
+	assert(write(pipeFileDescriptorIndexes[1], &c, 1) == 1);
+	c = '\0';
+	assert(read(pipeFileDescriptorIndexes[0], &c, 1) == 1);
+	assert(c == 'x');
+	assert(close(pipeFileDescriptorIndexes[0]) == 0);
+	assert(close(pipeFileDescriptorIndexes[1]) == 0);
+
+	/* The signal handler is called when the system call returns (the kernel cannot return through SYSEXIT). */
+	assert(signal(SIGUSR1, &handleSignal) != SIG_ERR);
+	assert(kill(getpid(), SIGUSR1) == 0);
+	assert(handledSignalId == SIGUSR1);
+	testGetProcessId(systemCallEntryPoint);
+
+	/* The child process returns from "fork" through "iret". */
+	sysexitReturnCount = systemCallSysexitReturnCount;
+	pid_t childProcessId = fork();
+	if (childProcessId == 0) {
+		assert(systemCallSysexitReturnCount == sysexitReturnCount);
+		testGetProcessId(systemCallEntryPoint);
+		exit(EXIT_SUCCESS);
+	}
+	assert(childProcessId > 0);
+	assert(systemCallSysexitReturnCount == sysexitReturnCount + (isSysenterSupported ? 1 : 0));
+
+	int status;
+	assert(waitpid(childProcessId, &status, 0) == childProcessId);
+	assert(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+
+	integrationTestRegisterSuccessfulCompletion(argv[0]);
+	return EXIT_SUCCESS;
+}
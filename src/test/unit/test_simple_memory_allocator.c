@@ -483,6 +483,51 @@ static void test6(void) {
 	free(dataSegmentBegin);
 }
 
+static void test7(void) {
+	dataSegmentBegin = malloc(DATA_SEGMENT_SIZE);
+	currentDataSegmentEnd = dataSegmentBegin;
+	dataSegmentEnd = dataSegmentBegin +  DATA_SEGMENT_SIZE;
+
+	simpleMemoryAllocatorInitialize(&fakeSbrk);
+
+	size_t lengthPointer1 = 10;
+	void* pointer1 = simpleMemoryAllocatorAcquire(lengthPointer1 * sizeof(int));
+	assert(pointer1 != NULL);
+	writeContent(1, pointer1, lengthPointer1);
+
+	size_t lengthPointer2 = 4 * 1024 * 1024;
+	void* pointer2 = simpleMemoryAllocatorAcquire(lengthPointer2 * sizeof(int));
+	assert(pointer2 != NULL);
+	assert(simpleMemoryAllocatorIsInternalStateValid());
+	writeContent(2, pointer2, lengthPointer2);
+	assert(currentDataSegmentEnd - dataSegmentBegin > lengthPointer2 * sizeof(int));
+
+	/* The memory at the end of the data segment must be given back. */
+	simpleMemoryAllocatorRelease(pointer2);
+	assert(simpleMemoryAllocatorIsInternalStateValid());
+	assert(currentDataSegmentEnd - dataSegmentBegin < lengthPointer2 * sizeof(int));
+	assert(isContentValid(1, pointer1, lengthPointer1));
+
+	/* The chunk at the end of the data segment must be enlarged in place. */
+	lengthPointer2 = 1000;
+	pointer2 = simpleMemoryAllocatorAcquire(lengthPointer2 * sizeof(int));
+	assert(pointer2 != NULL);
+	writeContent(2, pointer2, lengthPointer2);
+	lengthPointer2 = 2 * 1024 * 1024;
+	void* newPointer2 = simpleMemoryAllocatorResize(pointer2, lengthPointer2 * sizeof(int));
+	assert(newPointer2 == pointer2);
+	assert(simpleMemoryAllocatorIsInternalStateValid());
+	assert(isContentValid(2, pointer2, 1000));
+	writeContent(2, pointer2, lengthPointer2);
+
+	simpleMemoryAllocatorRelease(pointer2);
+	assert(simpleMemoryAllocatorIsInternalStateValid());
+	simpleMemoryAllocatorRelease(pointer1);
+	assert(simpleMemoryAllocatorIsInternalStateValid());
+
+	free(dataSegmentBegin);
+}
+
 int main(int argc, char** argv) {
 	test1();
 	test2();
@@ -490,5 +535,6 @@ int main(int argc, char** argv) {
 	test4();
 	test5();
 	test6();
+	test7();
 	return 0;
 }
@@ -0,0 +1,65 @@
+; Copyright 2022 Luis Henrique O. Rios
+;
+; This file is part of MyOS.
+;
+; MyOS is free software: you can redistribute it and/or modify
+; it under the terms of the GNU General Public License as published by
+; the Free Software Foundation, either version 3 of the License, or
+; (at your option) any later version.
+;
+; MyOS is distributed in the hope that it will be useful,
+; but WITHOUT ANY WARRANTY; without even the implied warranty of
+; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+; GNU General Public License for more details.
+;
+; You should have received a copy of the GNU General Public License
+; along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+
+BITS 32
+
+; The system call wrappers call the stub pointed by "systemCallEntryPoint" with the system call arguments already on the
+; registers. It starts pointing to the one that uses the "int" instruction and "myosStandardLibraryInitialize" replaces it
+; when the processor supports SYSENTER.
+
+global systemCallEntryPoint
+global systemCallUsingInterruption
+global systemCallUsingSysenter
+global systemCallSysexitReturnCount
+
+section .data
+
+systemCallEntryPoint:
+	dd systemCallUsingInterruption
+
+; How many times the kernel resumed the execution at "afterSysexit" (used by the tests to tell the return paths apart).
+systemCallSysexitReturnCount:
+	dd 0
+
+section .text
+
+systemCallUsingInterruption:
+	int 200 ; INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL
+	ret
+
+; The kernel needs the stack pointer (EBP) and the address to resume the execution (ESI). SYSEXIT overwrites ECX and EDX,
+; so the kernel passes their values on ESI and EBP and resumes the execution at "afterSysexit" (the kernel assumes that the
+; "jmp short" instruction has 2 bytes). When the kernel returns through "iret", all registers have been restored.
+systemCallUsingSysenter:
+	push ebp
+	push esi
+	mov ebp, esp
+	mov esi, afterSysenter
+	sysenter
+
+afterSysenter:
+	jmp short restoreRegisters
+
+afterSysexit:
+	mov ecx, esi
+	mov edx, ebp
+	inc dword [systemCallSysexitReturnCount]
+
+restoreRegisters:
+	pop esi
+	pop ebp
+	ret
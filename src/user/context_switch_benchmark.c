@@ -0,0 +1,113 @@
+/*
+ * Copyright 2022 Luis Henrique O. Rios
+ *
+ * This file is part of MyOS.
+ *
+ * MyOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * MyOS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with MyOS. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+ * It measures the context switch latency: two processes exchange a byte through a pair of pipes (ping-pong) and each
+ * round trip requires at least two context switches. The time stamp counter is used as the time source.
+ *
+ * Usage: context_switch_benchmark [round trip count]
+ */
+
+#include <myos.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/wait.h>
+
+#include "util/math_utils.h"
+
+#define DEFAULT_ROUND_TRIP_COUNT 10000
+
+static bool exchangeBytes(int readFileDescriptor, int writeFileDescriptor, int roundTripCount, bool startWriting) {
+	char c = 'c';
+	for (int i = 0; i < roundTripCount; i++) {
+		ssize_t firstResult;
+		ssize_t secondResult;
+		if (startWriting) {
+			firstResult = write(writeFileDescriptor, &c, 1);
+			secondResult = read(readFileDescriptor, &c, 1);
+		} else {
+			firstResult = read(readFileDescriptor, &c, 1);
+			secondResult = write(writeFileDescriptor, &c, 1);
+		}
+		if (firstResult != 1 || secondResult != 1) {
+			perror("exchangeBytes");
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	int roundTripCount = DEFAULT_ROUND_TRIP_COUNT;
+	if (argc >= 2) {
+		roundTripCount = atoi(argv[1]);
+		if (roundTripCount <= 0) {
+			fprintf(stderr, "Invalid round trip count: %s\n", argv[1]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	int parentToChildPipe[2];
+	int childToParentPipe[2];
+	if (pipe(parentToChildPipe) == -1 || pipe(childToParentPipe) == -1) {
+		perror("pipe");
+		return EXIT_FAILURE;
+	}
+
+	pid_t pid = fork();
+	if (pid == -1) {
+		perror("fork");
+		return EXIT_FAILURE;
+
+	} else if (pid == 0) {
+		close(parentToChildPipe[1]);
+		close(childToParentPipe[0]);
+		bool success = exchangeBytes(parentToChildPipe[0], childToParentPipe[1], roundTripCount, false);
+		return success ? EXIT_SUCCESS : EXIT_FAILURE;
+
+	} else {
+		close(parentToChildPipe[0]);
+		close(childToParentPipe[1]);
+
+		time_t begin = time(NULL);
+		uint64_t beginTimeStampCount = x86GetTimeStampCount();
+		bool success = exchangeBytes(childToParentPipe[0], parentToChildPipe[1], roundTripCount, true);
+		uint64_t elapsedTimeStampCount = x86GetTimeStampCount() - beginTimeStampCount;
+		time_t end = time(NULL);
+
+		int status;
+		pid_t waitResult = waitpid(pid, &status, 0);
+		if (!success || waitResult != pid || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+			fprintf(stderr, "The byte exchange failed\n");
+			return EXIT_FAILURE;
+		}
+
+		uint32_t cyclesPerRoundTrip = (uint32_t) mathUtilsDivideUint64ByUint32(elapsedTimeStampCount, roundTripCount, NULL);
+		printf("round trips: %d\n", roundTripCount);
+		printf("elapsed time: %ld s\n", (long) (end - begin));
+		printf("cycles per round trip: %lu\n", (unsigned long) cyclesPerRoundTrip);
+		printf("cycles per context switch: %lu\n", (unsigned long) (cyclesPerRoundTrip / 2));
+
+		return EXIT_SUCCESS;
+	}
+}
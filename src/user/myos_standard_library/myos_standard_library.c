@@ -23,12 +23,9 @@
 
 #include "kernel/system_calls.h"
 
-#define STR(x) #x
-#define XSTR(x) STR(x)
-
 void myosInvalidSystemCall(void) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_INEXISTENT)
 		: "memory");
@@ -37,7 +34,7 @@ void myosInvalidSystemCall(void) {
 void myosSystemAssert(bool value) {
 	if (!value) {
 		__asm__ __volatile__(
-			"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+			SYSTEM_CALL_INSTRUCTION ";"
 			:
 			: "a"(SYSTEM_CALL_ASSERT_FALSE)
 			: "memory");
@@ -46,7 +43,7 @@ void myosSystemAssert(bool value) {
 
 void myosSystemBusyWait(void) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_BUSY_WAIT)
 		: "memory");
@@ -54,7 +51,7 @@ void myosSystemBusyWait(void) {
 
 void myosForceKernelSIGSEGV(void) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_FORCE_KERNEL_SIGSEGV)
 		: "memory");
@@ -62,7 +59,7 @@ void myosForceKernelSIGSEGV(void) {
 
 void myosForceKernelSIGILL(void) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_FORCE_KERNEL_SIGILL)
 		: "memory");
@@ -71,7 +68,7 @@ void myosForceKernelSIGILL(void) {
 int myosLogKernelModuleDebugReport(const char* moduleName) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_LOG_KERNEL_MODULE_DEBUG_REPORT), "b"(moduleName)
 		: "memory");
@@ -86,7 +83,7 @@ int myosLogKernelModuleDebugReport(const char* moduleName) {
 
 void myosFlushAndClearCache(void) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_CACHE_FLUSH_AND_CLEAR)
 		: "memory");
@@ -94,7 +91,7 @@ void myosFlushAndClearCache(void) {
 
 void myosFlushCache(void) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_CACHE_FLUSH)
 		: "memory");
@@ -102,7 +99,7 @@ void myosFlushCache(void) {
 
 void myosReboot(void) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_REBOOT)
 		: "memory");
@@ -111,7 +108,7 @@ void myosReboot(void) {
 int myosGetProcessMemorySegmentsLimits(struct ProcessMemorySegmentsLimits* processMemorySegmentsLimits) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_GET_PROCESS_MEMORY_SEGMENTS_LIMITS), "b"(processMemorySegmentsLimits)
 		: "memory");
@@ -127,7 +124,7 @@ pid_t myosForkAndGenerateSignal(int signalId) {
 	int result;
 	pid_t processId;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(processId)
 		: "a"(SYSTEM_CALL_FORK), "b"(signalId)
 		: "memory");
@@ -54,14 +54,12 @@
 #include "user/util/wildcard_pattern_matcher.h"
 
 #include "util/formatter.h"
+#include "util/math_utils.h"
 #include "util/path_utils.h"
 #include "util/scanner.h"
 #include "util/string_stream_writer.h"
 #include "util/string_utils.h"
 
-#define STR(x) #x
-#define XSTR(x) STR(x)
-
 int errno;
 
 static void (*atExitCallbacks[ATEXIT_MAX])();
@@ -130,7 +128,7 @@ void* sbrk(int increment) {
 	int result;
 	void* sbrkResult;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(sbrkResult)
 		: "a"(SYSTEM_CALL_CHANGE_DATA_SEGMENT_SIZE), "b"(increment)
 		: "memory");
@@ -143,23 +141,13 @@ void* sbrk(int increment) {
 }
 
 pid_t getpid(void) {
-	pid_t result;
-	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
-		: "=a"(result)
-		: "a"(SYSTEM_CALL_GET_PROCESS_ID)
-		: "memory");
-	return result;
+	/* The kernel keeps it updated on the shared data page. */
+	return myosGetSharedData()->currentProcessId;
 }
 
 pid_t getppid(void) {
-	pid_t result;
-	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
-		: "=a"(result)
-		: "a"(SYSTEM_CALL_GET_PARENT_PROCESS_ID)
-		: "memory");
-	return result;
+	/* The kernel keeps it updated on the shared data page. */
+	return myosGetSharedData()->currentParentProcessId;
 }
 
 pid_t fork(void) {
@@ -178,20 +166,56 @@ void __attribute__ ((cdecl)) exit(int exitStatus) {
 
 void _exit(int exitStatus) {
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		:
 		: "a"(SYSTEM_CALL_EXIT), "b"(exitStatus)
 		: "memory");
 }
 
-unsigned int sleep(unsigned int seconds) {
-	unsigned int result;
+int nanosleep(const struct timespec* requestedTime, struct timespec* remainingTime) {
+	if (requestedTime->tv_sec < 0 || requestedTime->tv_nsec < 0 || requestedTime->tv_nsec >= 1000000000) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* The duration is passed on EBX (lower 32 bits) and ECX (upper 32 bits). The time left is returned the same way. */
+	uint64_t nanoseconds = ((uint64_t) requestedTime->tv_sec) * 1000000000 + (uint64_t) requestedTime->tv_nsec;
+	int result;
+	uint32_t remainingNanosecondsLower;
+	uint32_t remainingNanosecondsUpper;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
-		: "=a"(result)
-		: "a"(SYSTEM_CALL_SLEEP), "b"(seconds * 1000)
+		SYSTEM_CALL_INSTRUCTION ";"
+		: "=a"(result), "=b"(remainingNanosecondsLower), "=c"(remainingNanosecondsUpper)
+		: "a"(SYSTEM_CALL_SLEEP), "b"((uint32_t) nanoseconds), "c"((uint32_t) (nanoseconds >> 32))
 		: "memory");
-	return result;
+	if (result) {
+		if (result == EINTR && remainingTime != NULL) {
+			uint32_t remainingNanoseconds;
+			remainingTime->tv_sec = (time_t) mathUtilsDivideUint64ByUint32(
+				(((uint64_t) remainingNanosecondsUpper) << 32) | remainingNanosecondsLower, 1000000000, &remainingNanoseconds);
+			remainingTime->tv_nsec = remainingNanoseconds;
+		}
+		errno = result;
+		return -1;
+	} else {
+		return 0;
+	}
+}
+
+unsigned int sleep(unsigned int seconds) {
+	struct timespec requestedTime = { .tv_sec = seconds, .tv_nsec = 0 };
+	struct timespec remainingTime;
+	if (nanosleep(&requestedTime, &remainingTime) == -1 && errno == EINTR) {
+		/* The time left is rounded to the nearest second. */
+		return remainingTime.tv_sec + (remainingTime.tv_nsec >= 500000000 ? 1 : 0);
+	} else {
+		return 0;
+	}
+}
+
+int usleep(useconds_t microseconds) {
+	struct timespec requestedTime = { .tv_sec = microseconds / 1000000, .tv_nsec = (microseconds % 1000000) * 1000 };
+	return nanosleep(&requestedTime, NULL);
 }
 
 int open(const char* path, int flags, ...) {
@@ -208,7 +232,7 @@ int open(const char* path, int flags, ...) {
 	}
 
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(fileDescriptorIndex)
 		: "a"(SYSTEM_CALL_OPEN), "b"(path), "c"(flags), "d"(mode)
 		: "memory");
@@ -223,7 +247,7 @@ int open(const char* path, int flags, ...) {
 int close(int fileDescriptorIndex) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CLOSE), "b"(fileDescriptorIndex)
 		: "memory");
@@ -238,7 +262,7 @@ int close(int fileDescriptorIndex) {
 ssize_t read(int fileDescriptorIndex, void* buffer, size_t count) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(count)
 		: "a"(SYSTEM_CALL_READ), "b"(fileDescriptorIndex), "c"(buffer), "d"(count)
 		: "memory");
@@ -253,7 +277,7 @@ ssize_t read(int fileDescriptorIndex, void* buffer, size_t count) {
 ssize_t write(int fileDescriptorIndex, const void* buffer, size_t count) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(count)
 		: "a"(SYSTEM_CALL_WRITE), "b"(fileDescriptorIndex), "c"(buffer), "d"(count)
 		: "memory");
@@ -275,7 +299,7 @@ pid_t waitpid(pid_t scope, int* status, int options) {
 	pid_t childProcessId;
 
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(internalExitStatus), "=c"(childProcessId)
 		: "a"(SYSTEM_CALL_WAIT), "b"(scope), "c"(options)
 		: "memory");
@@ -293,7 +317,13 @@ pid_t waitpid(pid_t scope, int* status, int options) {
 char* program_invocation_name;
 char* program_invocation_short_name;
 void stdlibInitialize(char**);
+extern void (*systemCallEntryPoint)(void);
+void systemCallUsingSysenter(void);
 void __attribute__ ((cdecl)) myosStandardLibraryInitialize(int argc, char** argv, char** environmentParameters) {
+	if (x86IsSysenterSupported()) {
+		systemCallEntryPoint = &systemCallUsingSysenter;
+	}
+
 	stdlibInitialize(environmentParameters);
 
 	if (argc > 0 && argv != NULL && argv[0] != NULL) {
@@ -337,7 +367,7 @@ struct dirent* readdir(DIR* directory) {
 	int result;
 	bool endOfDirectory;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(endOfDirectory)
 		: "a"(SYSTEM_CALL_READ_DIRECTORY_ENTRY), "b"(directory->fileDescriptorIndex), "c"(&sharedDirentInstance)
 		: "memory");
@@ -376,20 +406,39 @@ int dirfd(DIR* directory) {
 void rewinddir(DIR* directory) {
 	if (directory != NULL) {
 		__asm__ __volatile__(
-			"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+			SYSTEM_CALL_INSTRUCTION ";"
 			:
 			: "a"(SYSTEM_CALL_REPOSITION_OPEN_FILE_DESCRIPTION_OFFSET), "b"(directory->fileDescriptorIndex), "c"(0), "d"(SEEK_SET)
 			: "memory");
 	}
 }
 
+int clock_gettime(clockid_t clockId, struct timespec* timespecInstance) {
+	if (clockId != CLOCK_REALTIME && clockId != CLOCK_MONOTONIC) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* The kernel publishes the time stamp counter calibration on the shared data page. Therefore, no system call is needed. */
+	const volatile struct MyosClockParameters* clockParameters = &myosGetSharedData()->clockParameters;
+	uint64_t upTimeInNanoseconds = mathUtilsMultiplyAndShiftRight(x86GetTimeStampCount() - clockParameters->timeStampCountAtBoot,
+		clockParameters->nanosecondsPerCycleMultiplier, clockParameters->nanosecondsPerCycleShift);
+
+	uint32_t nanoseconds;
+	time_t seconds = (time_t) mathUtilsDivideUint64ByUint32(upTimeInNanoseconds, 1000000000, &nanoseconds);
+	if (clockId == CLOCK_REALTIME) {
+		seconds += clockParameters->unixTimeAtBoot;
+	}
+	timespecInstance->tv_sec = seconds;
+	timespecInstance->tv_nsec = nanoseconds;
+
+	return 0;
+}
+
 time_t time(time_t* timeInstance) {
-	time_t result;
-	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
-		: "=a"(result)
-		: "a"(SYSTEM_CALL_GET_UNIX_TIME)
-		: "memory");
+	struct timespec timespecInstance;
+	clock_gettime(CLOCK_REALTIME, &timespecInstance);
+	time_t result = timespecInstance.tv_sec;
 	if (timeInstance != NULL) {
 		*timeInstance = result;
 	}
@@ -399,7 +448,7 @@ time_t time(time_t* timeInstance) {
 int fstat(int fileDescriptorIndex, struct stat* statInstance) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_STATUS), "b"(fileDescriptorIndex), "c"(statInstance)
 		: "memory");
@@ -458,7 +507,7 @@ int execv(const char* executablePath, char *const argv[]) {
 int execve(const char* executablePath, char* const argv[], char* const envp[]) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_EXECUTE_EXECUTABLE), "b"(executablePath), "c"(argv), "d"(envp)
 		: "memory");
@@ -524,7 +573,7 @@ off_t lseek(int fileDescriptorIndex, off_t offset, int whence) {
 	int result;
 	off_t resultingOffset;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(resultingOffset)
 		: "a"(SYSTEM_CALL_REPOSITION_OPEN_FILE_DESCRIPTION_OFFSET), "b"(fileDescriptorIndex), "c"(offset), "d"(whence)
 		: "memory");
@@ -540,7 +589,7 @@ void beforeCallSignalAction(int signalId, struct sigaction* act);
 int sigaction(int signalId, const struct sigaction *act, struct sigaction *oldact) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CHANGE_SIGNAL_ACTION), "b"(&beforeCallSignalAction), "c"(signalId), "d"(act), "D"(oldact)
 		: "memory");
@@ -555,7 +604,7 @@ int sigaction(int signalId, const struct sigaction *act, struct sigaction *oldac
 int kill(pid_t processId, int signalId) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_GENERATE_SIGNAL), "b"(processId), "c"(signalId)
 		: "memory");
@@ -584,7 +633,7 @@ void __attribute__ ((cdecl)) callSignalAction(int signalId, struct sigaction* ac
 int __attribute__ ((cdecl)) sigprocmask(int how, const sigset_t *set, sigset_t *oldset) {
 	int result;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CHANGE_SIGNALS_BLOCKAGE), "b"(how), "c"(set), "d"(oldset)
 		: "memory");
@@ -668,7 +717,7 @@ char* getcwd(char* buffer, size_t bufferSize) {
 
 		if (result == 0) {
 		__asm__ __volatile__(
-			"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+			SYSTEM_CALL_INSTRUCTION ";"
 			: "=a"(result)
 			: "a"(SYSTEM_CALL_GET_CURRENT_WORKING_DIRECTORY), "b"(buffer), "c"(bufferSize)
 			: "memory");
@@ -686,7 +735,7 @@ char* getcwd(char* buffer, size_t bufferSize) {
 int chdir(const char* path) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_SET_CURRENT_WORKING_DIRECTORY), "b"(path)
 		: "memory");
@@ -743,7 +792,7 @@ int truncate(const char* path, off_t newSize) {
 int ftruncate(int fileDescriptorIndex, off_t newSize) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CHANGE_FILE_SIZE), "b"(fileDescriptorIndex), "c"(newSize)
 		: "memory");
@@ -759,7 +808,7 @@ int ftruncate(int fileDescriptorIndex, off_t newSize) {
 int mkdir(const char* newDirectoryPath, mode_t mode) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CREATE_DIRECTORY), "b"(newDirectoryPath), "c"(mode)
 		: "memory");
@@ -779,7 +828,7 @@ int mknod(const char* path, mode_t mode, dev_t device) {
 int link(const char* targetPath, const char* namePathToCreate) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CREATE_NAME), "b"(targetPath), "c"(namePathToCreate)
 		: "memory");
@@ -795,7 +844,7 @@ int link(const char* targetPath, const char* namePathToCreate) {
 int unlink(const char* namePathToRelease) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_RELEASE_NAME), "b"(namePathToRelease)
 		: "memory");
@@ -811,7 +860,7 @@ int unlink(const char* namePathToRelease) {
 int rmdir(const char* directoryPathToRelease) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_RELEASE_DIRECTORY), "b"(directoryPathToRelease)
 		: "memory");
@@ -827,7 +876,7 @@ int rmdir(const char* directoryPathToRelease) {
 int symlink(const char* targetPath, const char* symbolicLinkPathToCreate) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CREATE_SYMBOLIC_LINK), "b"(targetPath), "c"(symbolicLinkPathToCreate)
 		: "memory");
@@ -843,7 +892,7 @@ int symlink(const char* targetPath, const char* symbolicLinkPathToCreate) {
 int ioctl(int fileDescriptorIndex, unsigned long request, ...) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_CHANGE_DEVICE_PARAMETERS), "b"(fileDescriptorIndex), "c"(&request)
 		: "memory");
@@ -859,7 +908,7 @@ int ioctl(int fileDescriptorIndex, unsigned long request, ...) {
 static int doSingleIntegerArgumentFcntl(int systemCallId, int fileDescriptorIndex, int command, int* argument) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(systemCallId), "b"(fileDescriptorIndex), "c"(&command)
 		: "memory");
@@ -929,7 +978,7 @@ int atexit(void (*callback)(void)) {
 static int commonDuplicateFileDescriptor(int existentFileDescriptorIndex, int minimumFileDescriptorIndex, int newFileDescriptorIndex, int flags) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_DUPLICATE_FILE_DESCRIPTOR), "b"(existentFileDescriptorIndex), "c"(minimumFileDescriptorIndex),
 		  	  "d"(&newFileDescriptorIndex), "D"(flags)
@@ -982,7 +1031,7 @@ int fcntl(int fileDescriptorIndex, int command, ...) {
 			{
 				int result = 0;
 				__asm__ __volatile__(
-					"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+					SYSTEM_CALL_INSTRUCTION ";"
 					: "=a"(result)
 					: "a"(systemCallId), "b"(fileDescriptorIndex), "c"(&command)
 					: "memory");
@@ -1000,7 +1049,7 @@ int fcntl(int fileDescriptorIndex, int command, ...) {
 int rename(const char* oldPath, const char* newPath) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result)
 		: "a"(SYSTEM_CALL_RENAME), "b"(oldPath), "c"(newPath)
 		: "memory");
@@ -1016,7 +1065,7 @@ pid_t setsid(void) {
 	int result = 0;
 	pid_t sessionId = -1;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(sessionId)
 		: "a"(SYSTEM_CALL_CREATE_SESSION_AND_PROCESS_GROUP)
 		: "memory");
@@ -1032,7 +1081,7 @@ pid_t getsid(pid_t processId) {
 	int result = 0;
 	pid_t sessionId = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(sessionId)
 		: "a"(SYSTEM_CALL_GET_SESSION_ID), "b"(processId)
 		: "memory");
@@ -1048,7 +1097,7 @@ pid_t getpgid(pid_t processId) {
 	int result = 0;
 	pid_t processGroupId = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(processGroupId)
 		: "a"(SYSTEM_CALL_GET_PROCESS_GROUP_ID), "b"(processId)
 		: "memory");
@@ -1067,7 +1116,7 @@ pid_t getpgrp(void) {
 int setpgid(pid_t processId, pid_t processGroupId) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(processGroupId)
 		: "a"(SYSTEM_CALL_SET_PROCESS_GROUP), "b"(processId), "c"(processGroupId)
 		: "memory");
@@ -1083,6 +1132,50 @@ int setpgrp(void) {
 	return setpgid(0, 0);
 }
 
+int getpriority(int which, id_t who) {
+	int result = 0;
+	int niceValue = 0;
+	__asm__ __volatile__(
+		SYSTEM_CALL_INSTRUCTION ";"
+		: "=a"(result), "=b"(niceValue)
+		: "a"(SYSTEM_CALL_GET_PRIORITY), "b"(which), "c"(who)
+		: "memory");
+	if (result) {
+		errno = result;
+		return -1;
+	} else {
+		return niceValue;
+	}
+}
+
+int setpriority(int which, id_t who, int niceValue) {
+	int result = 0;
+	__asm__ __volatile__(
+		SYSTEM_CALL_INSTRUCTION ";"
+		: "=a"(result)
+		: "a"(SYSTEM_CALL_SET_PRIORITY), "b"(which), "c"(who), "d"(niceValue)
+		: "memory");
+	if (result) {
+		errno = result;
+		return -1;
+	} else {
+		return 0;
+	}
+}
+
+int nice(int increment) {
+	/* As -1 is a valid nice value, "errno" is the only way to detect an error. */
+	errno = 0;
+	int niceValue = getpriority(PRIO_PROCESS, 0);
+	if (niceValue == -1 && errno != 0) {
+		return -1;
+	}
+	if (setpriority(PRIO_PROCESS, 0, niceValue + increment) == -1) {
+		return -1;
+	}
+	return getpriority(PRIO_PROCESS, 0);
+}
+
 pid_t tcgetsid(int fileDescriptorIndex) {
 	pid_t sessionId;
 	if (ioctl(fileDescriptorIndex, TIOCGSID, &sessionId) == -1) {
@@ -1158,7 +1251,7 @@ long pathconf(const char* path, int name) {
 int pipe(int pipeFileDescriptorIndexes[2]) {
 	int result = 0;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(pipeFileDescriptorIndexes[0]), "=c"(pipeFileDescriptorIndexes[1])
 		: "a"(SYSTEM_CALL_CREATE_PIPE)
 		: "memory");
@@ -1200,6 +1293,10 @@ int getrlimit(int resource, struct rlimit* rlimitInstance) {
 			rlimitInstance->rlim_cur = DATA_SEGMENT_MAX_SIZE;
 			rlimitInstance->rlim_max = DATA_SEGMENT_MAX_SIZE;
 		break;
+		case RLIMIT_STACK:
+			rlimitInstance->rlim_cur = STACK_SEGMENT_MAX_SIZE;
+			rlimitInstance->rlim_max = STACK_SEGMENT_MAX_SIZE;
+		break;
 
 
 	}
@@ -1299,12 +1396,11 @@ sighandler_t signal(int signalId, sighandler_t handler) {
 int gettimeofday(struct timeval* tv, struct timezone* tz) {
 	int result = 0;
 	if (tv != NULL) {
-		time_t timeResult = time(NULL);
-		if (timeResult != -1) {
-			tv->tv_sec = timeResult;
-			tv->tv_usec = 0;
-		} else {
-			result = -1;
+		struct timespec timespecInstance;
+		result = clock_gettime(CLOCK_REALTIME, &timespecInstance);
+		if (result == 0) {
+			tv->tv_sec = timespecInstance.tv_sec;
+			tv->tv_usec = timespecInstance.tv_nsec / 1000;
 		}
 	}
 	if (tz != NULL) {
@@ -1318,7 +1414,7 @@ int poll(struct pollfd* ioEventMonitoringContexts, nfds_t ioEventMonitoringConte
 	int result;
 	int triggeredEventsCount;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(result), "=b"(triggeredEventsCount)
 		: "a"(SYSTEM_CALL_MONITOR_IO_EVENTS), "b"(ioEventMonitoringContexts), "c"(ioEventMonitoringContextCount), "d"(timeout)
 		: "memory");
@@ -1425,7 +1521,7 @@ void endpwent(void) {
 mode_t umask(mode_t mask) {
 	mode_t previousMask;
 	__asm__ __volatile__(
-		"int $" XSTR(INTERRUPTION_VECTOR_TO_HANDLE_SYSTEM_CALL) ";"
+		SYSTEM_CALL_INSTRUCTION ";"
 		: "=a"(previousMask)
 		: "a"(SYSTEM_CALL_SET_FILE_MODE_CREATION_MASK), "b"(mask)
 		: "memory");
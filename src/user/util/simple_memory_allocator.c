@@ -21,6 +21,7 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,28 +31,54 @@
 #include "util/double_linked_list.h"
 #include "util/math_utils.h"
 
+/*
+ * The chunks are laid out contiguously on the data segment. Each one starts with a header that also stores the size of
+ * the chunk immediately before it (boundary tag), so both neighbors of a chunk can be found in constant time.
+ */
 struct MemoryChunk {
-	struct DoubleLinkedListElement listElement;
-	struct DoubleLinkedListElement availableListElement;
+	size_t previousChunkSize;
 	size_t size;
 	uint16_t flags;
 	uint16_t checksum;
-};
-_Static_assert(sizeof(struct MemoryChunk) % 4 == 0, "Expecting an aligned (4 bytes) MemoryChunk.");
+} __attribute__((aligned(8)));
+
+#define ALIGNMENT 8
+_Static_assert(sizeof(struct MemoryChunk) % ALIGNMENT == 0, "Expecting an aligned (8 bytes) MemoryChunk.");
+
+/* An available chunk keeps the list element of its bin inside its data. */
+#define MIN_CHUNK_SIZE sizeof(struct DoubleLinkedListElement)
+_Static_assert(MIN_CHUNK_SIZE % ALIGNMENT == 0, "Expecting an aligned (8 bytes) minimum chunk size.");
 
 #define DATA_SEGMENT_MIN_INCREMENT (1 * 1024 * 1024)
 #define AVAILABLE_FLAG_MASK 0x0001
-#define MIN_CHUNK_SIZE sizeof(uint32_t)
 _Static_assert(sizeof(struct MemoryChunk) + MIN_CHUNK_SIZE <= DATA_SEGMENT_MIN_INCREMENT, "The minimum increment is too small.");
 
-static struct DoubleLinkedList memoryChunkList;
-static struct DoubleLinkedList availableMemoryChunkList;
+/* An available chunk at the end of the data segment that is larger than this is shrunk (the memory is given back to the kernel). */
+#define TRIM_THRESHOLD (2 * DATA_SEGMENT_MIN_INCREMENT)
+
+/*
+ * The small bins hold chunks of a single size (a multiple of "ALIGNMENT"). The large bins hold chunks whose sizes lay
+ * between two consecutive powers of two.
+ */
+#define SMALL_BIN_MAX_SIZE 512
+#define SMALL_BIN_COUNT (SMALL_BIN_MAX_SIZE / ALIGNMENT)
+#define LARGE_BIN_COUNT (32 - 9)
+_Static_assert(SMALL_BIN_MAX_SIZE == 1 << 9, "Expecting the largest small bin size to be 2^9.");
+#define BIN_COUNT (SMALL_BIN_COUNT + LARGE_BIN_COUNT)
+#define BIN_BITMAP_LENGTH ((BIN_COUNT + 31) / 32)
+
+static struct DoubleLinkedList bins[BIN_COUNT];
+static uint32_t nonEmptyBinsBitmap[BIN_BITMAP_LENGTH];
+
+static void* heapBegin;
+static void* heapEnd;
+static struct MemoryChunk* lastMemoryChunk;
 
 static void* (*sbrk)(int increment);
 
 #ifndef NDEBUG
 	static uint16_t calculateChecksum(struct MemoryChunk* memoryChunk) {
-		return fletcher16(memoryChunk, sizeof(struct MemoryChunk) - sizeof(uint16_t));
+		return fletcher16(memoryChunk, offsetof(struct MemoryChunk, checksum));
 	}
 
 	static bool doesChecksumMatchs(struct MemoryChunk* memoryChunk) {
@@ -59,211 +86,271 @@ static void* (*sbrk)(int increment);
 	}
 #endif
 
-static struct MemoryChunk* getMemoryChunkFromAvailableListElement(struct DoubleLinkedListElement* listElement) {
-	if (listElement != NULL) {
-		uint32_t address = ((uint32_t) listElement) - offsetof(struct MemoryChunk, availableListElement);
-		return (struct MemoryChunk*) address;
-	} else {
-		return NULL;
-	}
+static void updateChecksum(struct MemoryChunk* memoryChunk) {
+	#ifndef NDEBUG
+		memoryChunk->checksum = calculateChecksum(memoryChunk);
+	#endif
 }
 
 static bool isAvailable(struct MemoryChunk* memoryChunk) {
 	return (memoryChunk->flags & AVAILABLE_FLAG_MASK) != 0;
 }
 
-static void updateChecksum(struct MemoryChunk* memoryChunk) {
-	#ifndef NDEBUG
-		memoryChunk->checksum = calculateChecksum(memoryChunk);
-	#endif
+static void* getData(struct MemoryChunk* memoryChunk) {
+	return ((void*) memoryChunk) + sizeof(struct MemoryChunk);
 }
 
-static struct MemoryChunk* findAvailableChunk(size_t size) {
-	if (doubleLinkedListSize(&availableMemoryChunkList) == 0) {
-		return NULL;
+static struct MemoryChunk* getNext(struct MemoryChunk* memoryChunk) {
+	void* next = getData(memoryChunk) + memoryChunk->size;
+	assert(next <= heapEnd);
+	return next < heapEnd ? next : NULL;
+}
 
+static struct MemoryChunk* getPrevious(struct MemoryChunk* memoryChunk) {
+	if (((void*) memoryChunk) == heapBegin) {
+		return NULL;
 	} else {
-		struct MemoryChunk* availableMemoryChunk = NULL;
-
-		struct DoubleLinkedListElement* currentListElement = doubleLinkedListFirst(&availableMemoryChunkList);
-		while (currentListElement != NULL) {
-			struct MemoryChunk* currentMemoryChunk = getMemoryChunkFromAvailableListElement(currentListElement);
-			assert(doesChecksumMatchs(currentMemoryChunk));
-			assert(isAvailable(currentMemoryChunk));
-			
-			if (currentMemoryChunk->size >= size) {
-				availableMemoryChunk = currentMemoryChunk;
-				break;
-			}
-			
-			currentListElement = currentListElement->next;
-		}
+		return ((void*) memoryChunk) - memoryChunk->previousChunkSize - sizeof(struct MemoryChunk);
+	}
+}
 
-		assert(availableMemoryChunk == NULL || doesChecksumMatchs(availableMemoryChunk));
-		return availableMemoryChunk;
+static struct DoubleLinkedListElement* getBinListElement(struct MemoryChunk* memoryChunk) {
+	return getData(memoryChunk);
+}
+
+static struct MemoryChunk* getMemoryChunkFromBinListElement(struct DoubleLinkedListElement* listElement) {
+	if (listElement != NULL) {
+		return ((void*) listElement) - sizeof(struct MemoryChunk);
+	} else {
+		return NULL;
 	}
 }
 
-static void removeFromAvailableList(struct MemoryChunk* memoryChunk) {
-	#ifndef NDEBUG
-		struct MemoryChunk* previous = getMemoryChunkFromAvailableListElement(memoryChunk->availableListElement.previous);
-		struct MemoryChunk* next = getMemoryChunkFromAvailableListElement(memoryChunk->availableListElement.next);
-	#endif
+static int calculateBinIndex(size_t size) {
+	assert(size >= MIN_CHUNK_SIZE && size % ALIGNMENT == 0);
+	if (size <= SMALL_BIN_MAX_SIZE) {
+		return size / ALIGNMENT - 1;
+	} else {
+		assert(size <= UINT32_MAX);
+		int log2 = 31 - __builtin_clz((uint32_t) size);
+		return SMALL_BIN_COUNT + log2 - 9;
+	}
+}
 
-	doubleLinkedListRemove(&availableMemoryChunkList, &memoryChunk->availableListElement);
-	#ifndef NDEBUG
-		if (previous != NULL) {
-			updateChecksum(previous);
+static int findNextNonEmptyBin(int binIndex) {
+	for (int i = binIndex / 32; i < BIN_BITMAP_LENGTH; i++) {
+		uint32_t word = nonEmptyBinsBitmap[i];
+		if (i == binIndex / 32) {
+			word &= UINT32_MAX << (binIndex % 32);
 		}
-		if (next != NULL) {
-			updateChecksum(next);
+		if (word != 0) {
+			return i * 32 + __builtin_ctz(word);
 		}
-	#endif
+	}
+	return -1;
 }
 
-static void insertIntoAvailableList(struct MemoryChunk* memoryChunk) {
-	#ifndef NDEBUG
-		struct MemoryChunk* last = getMemoryChunkFromAvailableListElement(doubleLinkedListLast(&availableMemoryChunkList));
-	#endif
+static void insertIntoBin(struct MemoryChunk* memoryChunk) {
+	int binIndex = calculateBinIndex(memoryChunk->size);
+	doubleLinkedListInsertBeforeFirst(&bins[binIndex], getBinListElement(memoryChunk));
+	nonEmptyBinsBitmap[binIndex / 32] |= 1u << (binIndex % 32);
+}
 
-	doubleLinkedListInsertAfterLast(&availableMemoryChunkList, &memoryChunk->availableListElement);
-	#ifndef NDEBUG
-		if (last != NULL) {
-			updateChecksum(last);
-		}
-	#endif
+static void removeFromBin(struct MemoryChunk* memoryChunk) {
+	int binIndex = calculateBinIndex(memoryChunk->size);
+	doubleLinkedListRemove(&bins[binIndex], getBinListElement(memoryChunk));
+	if (doubleLinkedListSize(&bins[binIndex]) == 0) {
+		nonEmptyBinsBitmap[binIndex / 32] &= ~(1u << (binIndex % 32));
+	}
 }
 
-static void insertIntoListAfter(struct MemoryChunk* memoryChunkBefore, struct MemoryChunk* memoryChunk) {
-	#ifndef NDEBUG
-		struct MemoryChunk* next;
-		if (memoryChunkBefore == NULL) {
-			next = (void*) doubleLinkedListFirst(&memoryChunkList);
-		} else {
-			next = (void*) memoryChunkBefore->listElement.next;
+static struct MemoryChunk* findAvailableChunk(size_t size) {
+	int binIndex = calculateBinIndex(size);
+
+	if (binIndex >= SMALL_BIN_COUNT) {
+		/* The chunks of a large bin do not have the same size. */
+		struct DoubleLinkedListElement* listElement = doubleLinkedListFirst(&bins[binIndex]);
+		while (listElement != NULL) {
+			struct MemoryChunk* memoryChunk = getMemoryChunkFromBinListElement(listElement);
+			assert(doesChecksumMatchs(memoryChunk));
+			assert(isAvailable(memoryChunk));
+			if (memoryChunk->size >= size) {
+				return memoryChunk;
+			}
+			listElement = listElement->next;
 		}
-	#endif
+		binIndex++;
+	}
+
+	/* Any chunk from the following bins is large enough. */
+	binIndex = findNextNonEmptyBin(binIndex);
+	if (binIndex != -1) {
+		struct MemoryChunk* memoryChunk = getMemoryChunkFromBinListElement(doubleLinkedListFirst(&bins[binIndex]));
+		assert(doesChecksumMatchs(memoryChunk));
+		assert(isAvailable(memoryChunk));
+		assert(memoryChunk->size >= size);
+		return memoryChunk;
 
-	if (memoryChunkBefore != NULL) {
-		doubleLinkedListInsertAfter(&memoryChunkList, &memoryChunkBefore->listElement, &memoryChunk->listElement);
 	} else {
-		doubleLinkedListInsertBeforeFirst(&memoryChunkList, &memoryChunk->listElement);
+		return NULL;
 	}
-	#ifndef NDEBUG
-		if (memoryChunkBefore != NULL) {
-			updateChecksum(memoryChunkBefore);
-		}
-		if (next != NULL) {
-			updateChecksum(next);
-		}
-	#endif
 }
 
-static void removeFromList(struct MemoryChunk* memoryChunk) {
-	#ifndef NDEBUG
-		struct MemoryChunk* previous = (void*) memoryChunk->listElement.previous;
-		struct MemoryChunk* next = (void*) memoryChunk->listElement.next;
-	#endif
+/* It also updates the boundary tag stored on the next chunk. */
+static void changeSize(struct MemoryChunk* memoryChunk, size_t size) {
+	memoryChunk->size = size;
+	updateChecksum(memoryChunk);
 
-	doubleLinkedListRemove(&memoryChunkList, &memoryChunk->listElement);
-	#ifndef NDEBUG
-		if (previous != NULL) {
-			updateChecksum(previous);
+	struct MemoryChunk* nextMemoryChunk = getNext(memoryChunk);
+	if (nextMemoryChunk != NULL) {
+		nextMemoryChunk->previousChunkSize = size;
+		updateChecksum(nextMemoryChunk);
+	} else {
+		lastMemoryChunk = memoryChunk;
+	}
+}
+
+/* It merges the chunk with its available neighbors and puts the result into a bin. */
+static struct MemoryChunk* makeAvailable(struct MemoryChunk* memoryChunk) {
+	memoryChunk->flags |= AVAILABLE_FLAG_MASK;
+
+	struct MemoryChunk* previousMemoryChunk = getPrevious(memoryChunk);
+	if (previousMemoryChunk != NULL && isAvailable(previousMemoryChunk)) {
+		assert(doesChecksumMatchs(previousMemoryChunk));
+		removeFromBin(previousMemoryChunk);
+		changeSize(previousMemoryChunk, previousMemoryChunk->size + sizeof(struct MemoryChunk) + memoryChunk->size);
+		memoryChunk = previousMemoryChunk;
+	}
+
+	struct MemoryChunk* nextMemoryChunk = getNext(memoryChunk);
+	if (nextMemoryChunk != NULL && isAvailable(nextMemoryChunk)) {
+		assert(doesChecksumMatchs(nextMemoryChunk));
+		removeFromBin(nextMemoryChunk);
+		changeSize(memoryChunk, memoryChunk->size + sizeof(struct MemoryChunk) + nextMemoryChunk->size);
+	}
+
+	updateChecksum(memoryChunk);
+	insertIntoBin(memoryChunk);
+
+	return memoryChunk;
+}
+
+/* The chunk must be in use. What exceeds the size becomes available (if it is large enough to be a chunk). */
+static void split(struct MemoryChunk* memoryChunk, size_t size) {
+	assert(!isAvailable(memoryChunk));
+	assert(memoryChunk->size >= size);
+
+	if (memoryChunk->size - size >= sizeof(struct MemoryChunk) + MIN_CHUNK_SIZE) {
+		struct MemoryChunk* newMemoryChunk = getData(memoryChunk) + size;
+		size_t newMemoryChunkSize = memoryChunk->size - size - sizeof(struct MemoryChunk);
+
+		memoryChunk->size = size;
+		updateChecksum(memoryChunk);
+
+		newMemoryChunk->previousChunkSize = size;
+		newMemoryChunk->flags = 0;
+		changeSize(newMemoryChunk, newMemoryChunkSize);
+		makeAvailable(newMemoryChunk);
+
+	} else {
+		updateChecksum(memoryChunk);
+	}
+}
+
+/* It calls the kernel to allocate more memory. The new memory becomes available (merged with the last chunk if possible). */
+static struct MemoryChunk* extendHeap(size_t size) {
+	int increment = mathUtilsMax(size + sizeof(struct MemoryChunk), DATA_SEGMENT_MIN_INCREMENT);
+
+	/* It needs to be initialized. */
+	if (heapBegin == NULL) {
+		void* sbrkResult = sbrk(0);
+		if (((void*) -1) == sbrkResult) {
+			return NULL;
 		}
-		if (next != NULL) {
-			updateChecksum(next);
+		int padding = (ALIGNMENT - ((uintptr_t) sbrkResult) % ALIGNMENT) % ALIGNMENT;
+		if (((void*) -1) == sbrk(padding)) {
+			return NULL;
 		}
-	#endif
+		heapBegin = sbrkResult + padding;
+		heapEnd = heapBegin;
+	}
+
+	if (((void*) -1) == sbrk(increment)) {
+		return NULL;
+	}
+
+	struct MemoryChunk* newMemoryChunk = heapEnd;
+	heapEnd += increment;
+	newMemoryChunk->previousChunkSize = lastMemoryChunk != NULL ? lastMemoryChunk->size : 0;
+	newMemoryChunk->flags = 0;
+	changeSize(newMemoryChunk, increment - sizeof(struct MemoryChunk));
+	assert(lastMemoryChunk == newMemoryChunk);
+
+	return makeAvailable(newMemoryChunk);
+}
+
+/* It gives back to the kernel most of the available memory at the end of the data segment. */
+static void trimHeap(void) {
+	assert(lastMemoryChunk != NULL);
+	if (isAvailable(lastMemoryChunk) && lastMemoryChunk->size >= TRIM_THRESHOLD) {
+		size_t excess = lastMemoryChunk->size - DATA_SEGMENT_MIN_INCREMENT;
+		assert(excess % ALIGNMENT == 0);
+
+		/* The kernel may have rounded the end of the data segment up. */
+		void* sbrkResult = sbrk(0);
+		if (((void*) -1) != sbrkResult && sbrkResult >= heapEnd && ((void*) -1) != sbrk(-(int) (sbrkResult - heapEnd + excess))) {
+			removeFromBin(lastMemoryChunk);
+			heapEnd -= excess;
+			changeSize(lastMemoryChunk, lastMemoryChunk->size - excess);
+			insertIntoBin(lastMemoryChunk);
+		}
+	}
+}
+
+static size_t roundSize(size_t size) {
+	size = mathUtilsMax(size, MIN_CHUNK_SIZE);
+	if (size % ALIGNMENT != 0) {
+		size += ALIGNMENT - size % ALIGNMENT;
+	}
+	return size;
 }
 
 void simpleMemoryAllocatorInitialize(void* (*newSbrk)(int increment)) {
-	doubleLinkedListInitialize(&memoryChunkList);
-	doubleLinkedListInitialize(&availableMemoryChunkList);
+	for (int i = 0; i < BIN_COUNT; i++) {
+		doubleLinkedListInitialize(&bins[i]);
+	}
+	memset(nonEmptyBinsBitmap, 0, sizeof(nonEmptyBinsBitmap));
+	heapBegin = NULL;
+	heapEnd = NULL;
+	lastMemoryChunk = NULL;
 	sbrk = newSbrk;
 }
 
 void* simpleMemoryAllocatorAcquire(size_t size) {
-	/* It avoids obvious overflows. */
-	if (size == 0 || size > LONG_MAX || size + sizeof(struct MemoryChunk) > LONG_MAX) {
+	/* It avoids obvious overflows (the kernel is called with an "int" increment). */
+	if (size == 0 || size > INT_MAX - sizeof(struct MemoryChunk) - ALIGNMENT) {
 		return NULL;
 
 	} else {
+		size = roundSize(size);
+
 		struct MemoryChunk* availableMemoryChunk = findAvailableChunk(size);
 		if (availableMemoryChunk == NULL) {
-			int increment = mathUtilsMax(size + sizeof(struct MemoryChunk), DATA_SEGMENT_MIN_INCREMENT);
-
-			/* It needs to be initialized. */
-			if (doubleLinkedListSize(&memoryChunkList) == 0) {
-				struct MemoryChunk* newMemoryChunk;
-				bool succeeded = false;
-				void* sbrkResult;
-
-				sbrkResult = sbrk(0);
-				if (((void*) -1) != sbrkResult) {
-					newMemoryChunk = sbrkResult;
-					void* result = sbrk(increment);
-					if (((void*) -1) != result) {
-						insertIntoListAfter(NULL, newMemoryChunk);
-						newMemoryChunk->size = increment - sizeof(struct MemoryChunk);
-						newMemoryChunk->flags = AVAILABLE_FLAG_MASK;
-						insertIntoAvailableList(newMemoryChunk);
-						updateChecksum(newMemoryChunk);
-
-						succeeded = true;
-					}
-				}
-
-				if (!succeeded) {
-					return NULL;
-
-				} else {
-					availableMemoryChunk = newMemoryChunk;
-				}
-
-			} else {
-				/* It needs to call the kernel to allocate more memory. */
-				struct MemoryChunk* lastMemoryChunk = (void*) doubleLinkedListLast(&memoryChunkList);
-				void* result = sbrk(increment);
-				if (((void*) -1) != result) {
-					availableMemoryChunk = ((void*) lastMemoryChunk) + sizeof(struct MemoryChunk) + lastMemoryChunk->size;
-
-					insertIntoListAfter(lastMemoryChunk, availableMemoryChunk);
-					availableMemoryChunk->size = increment - sizeof(struct MemoryChunk);
-					availableMemoryChunk->flags = AVAILABLE_FLAG_MASK;
-					insertIntoAvailableList(availableMemoryChunk);
-					updateChecksum(availableMemoryChunk);
-
-				} else {
-					return NULL;
-				}
+			availableMemoryChunk = extendHeap(size);
+			if (availableMemoryChunk == NULL) {
+				return NULL;
 			}
 		}
 		assert(availableMemoryChunk != NULL);
 		assert(doesChecksumMatchs(availableMemoryChunk));
 		assert(isAvailable(availableMemoryChunk));
+		assert(availableMemoryChunk->size >= size);
 
-		removeFromAvailableList(availableMemoryChunk);
-
-		if (availableMemoryChunk->size < size + sizeof(struct MemoryChunk) + MIN_CHUNK_SIZE) {
-			availableMemoryChunk->flags &= ~AVAILABLE_FLAG_MASK;
-			updateChecksum(availableMemoryChunk);
+		removeFromBin(availableMemoryChunk);
+		availableMemoryChunk->flags &= ~AVAILABLE_FLAG_MASK;
+		split(availableMemoryChunk, size);
 
-		} else {
-			struct MemoryChunk* newMemoryChunk = ((void*) availableMemoryChunk) + sizeof(struct MemoryChunk) + size;
-
-			insertIntoListAfter(availableMemoryChunk, newMemoryChunk);
-			newMemoryChunk->flags = AVAILABLE_FLAG_MASK;
-			newMemoryChunk->size = availableMemoryChunk->size - size - sizeof(struct MemoryChunk);
-			assert(newMemoryChunk->size >= MIN_CHUNK_SIZE);
-			insertIntoAvailableList(newMemoryChunk);
-			updateChecksum(newMemoryChunk);
-
-			availableMemoryChunk->size = size;
-			availableMemoryChunk->flags &= ~AVAILABLE_FLAG_MASK;
-			updateChecksum(availableMemoryChunk);
-		}
-
-		return ((void*) availableMemoryChunk) + sizeof(struct MemoryChunk);
+		return getData(availableMemoryChunk);
 	}
 }
 
@@ -272,40 +359,12 @@ void simpleMemoryAllocatorRelease(void* pointer) {
 		struct MemoryChunk* memoryChunk = (pointer - sizeof(struct MemoryChunk));
 		assert(doesChecksumMatchs(memoryChunk));
 		assert(!isAvailable(memoryChunk));
-		
-		struct MemoryChunk* survivorMemoryChunk = NULL;
-		struct MemoryChunk* previousMemoryChunk = (void*) memoryChunk->listElement.previous;
-		if (previousMemoryChunk != NULL && isAvailable(previousMemoryChunk)) {
-			struct MemoryChunk* previousPreviousMemoryChunk = (void*) previousMemoryChunk->listElement.previous;
-
-			removeFromAvailableList(previousMemoryChunk);
-
-			removeFromList(previousMemoryChunk);
-			removeFromList(memoryChunk);
 
-			survivorMemoryChunk = previousMemoryChunk;
-			survivorMemoryChunk->size += sizeof(struct MemoryChunk) + memoryChunk->size;
-			
-			insertIntoListAfter(previousPreviousMemoryChunk, survivorMemoryChunk);
-
-		} else {
-			survivorMemoryChunk = memoryChunk;
-			survivorMemoryChunk->flags |= AVAILABLE_FLAG_MASK;
-		}
-		assert(survivorMemoryChunk != NULL);
+		struct MemoryChunk* survivorMemoryChunk = makeAvailable(memoryChunk);
 		assert(isAvailable(survivorMemoryChunk));
-		
-		struct MemoryChunk* nextMemoryChunk = (void*) survivorMemoryChunk->listElement.next;
-		if (nextMemoryChunk != NULL && isAvailable(nextMemoryChunk)) {
-			removeFromList(nextMemoryChunk);
-			removeFromAvailableList(nextMemoryChunk);
-
-			survivorMemoryChunk->size += sizeof(struct MemoryChunk) + nextMemoryChunk->size;
+		if (survivorMemoryChunk == lastMemoryChunk) {
+			trimHeap();
 		}
-		
-		insertIntoAvailableList(survivorMemoryChunk);
-		updateChecksum(survivorMemoryChunk);
-		assert(isAvailable(survivorMemoryChunk));
 	}
 }
 
@@ -317,78 +376,43 @@ void* simpleMemoryAllocatorResize(void* pointer, size_t size) {
 	} else if (pointer == NULL) {
 		return simpleMemoryAllocatorAcquire(size);
 
+	} else if (size > INT_MAX - sizeof(struct MemoryChunk) - ALIGNMENT) {
+		return NULL;
+
 	} else {
 		struct MemoryChunk* memoryChunk = (pointer - sizeof(struct MemoryChunk));
 		assert(doesChecksumMatchs(memoryChunk));
 		assert(!isAvailable(memoryChunk));
 
-		if (memoryChunk->size > size) {
+		size = roundSize(size);
+		if (memoryChunk->size >= size) {
 			/* It will be shrunk. */
-			if (memoryChunk->size - size >= sizeof(struct MemoryChunk) + MIN_CHUNK_SIZE) {
-				struct MemoryChunk* nextMemoryChunk = (void*) memoryChunk->listElement.next;
-				struct MemoryChunk* newMemoryChunk = pointer + size;
-
-				if (nextMemoryChunk != NULL && isAvailable(nextMemoryChunk)) {
-					/* Merge with the next one. */
-
-					removeFromList(nextMemoryChunk);
-
-					removeFromAvailableList(nextMemoryChunk);
-
-					newMemoryChunk->size = memoryChunk->size - size - sizeof(struct MemoryChunk) + sizeof(struct MemoryChunk) + nextMemoryChunk->size;
-
-				} else {
-					/* Create a new chunk. */
-					assert(nextMemoryChunk == NULL || ((void*) newMemoryChunk) + sizeof(struct MemoryChunk)
-							+ (memoryChunk->size - size - sizeof(struct MemoryChunk)) == nextMemoryChunk);
-					newMemoryChunk->size = memoryChunk->size - size - sizeof(struct MemoryChunk);
-				}
-
-				insertIntoListAfter(memoryChunk, newMemoryChunk);
-
-				memoryChunk->size = size;
-				updateChecksum(memoryChunk);
-
-				insertIntoAvailableList(newMemoryChunk);
-				newMemoryChunk->flags = AVAILABLE_FLAG_MASK;
-				updateChecksum(newMemoryChunk);
-			}
+			split(memoryChunk, size);
 			return pointer;
 
-		} else if (memoryChunk->size < size) {
+		} else {
 			/* It will be enlarged. */
-			struct MemoryChunk* nextMemoryChunk = (void*) memoryChunk->listElement.next;
-			if (nextMemoryChunk != NULL && isAvailable(nextMemoryChunk)
-					&& size - memoryChunk->size <= sizeof(struct MemoryChunk) + nextMemoryChunk->size) {
-
-				removeFromList(nextMemoryChunk);
-
-				removeFromAvailableList(nextMemoryChunk);
-
-				if (sizeof(struct MemoryChunk) + nextMemoryChunk->size - (size - memoryChunk->size) >= sizeof(struct MemoryChunk) + MIN_CHUNK_SIZE) {
-					/* Create a new chunk. */
-					size_t newMemoryChunkSize = nextMemoryChunk->size + sizeof(struct MemoryChunk) - (size - memoryChunk->size) - sizeof(struct MemoryChunk);
-
-					struct MemoryChunk* newMemoryChunk = ((void*) memoryChunk) + sizeof(struct MemoryChunk) + size;
-					insertIntoListAfter(memoryChunk, newMemoryChunk);
-					newMemoryChunk->size = newMemoryChunkSize;
-					newMemoryChunk->flags = AVAILABLE_FLAG_MASK;
-					insertIntoAvailableList(newMemoryChunk);
-					updateChecksum(newMemoryChunk);
-
-					memoryChunk->size = size;
-
-				} else {
-					/* Use all space available. */
-
-					if (memoryChunk->listElement.next != NULL) {
-						updateChecksum((void*) memoryChunk->listElement.next);
-					}
+			struct MemoryChunk* nextMemoryChunk = getNext(memoryChunk);
+			size_t availableSize = memoryChunk->size;
+			if (nextMemoryChunk != NULL && isAvailable(nextMemoryChunk)) {
+				availableSize += sizeof(struct MemoryChunk) + nextMemoryChunk->size;
+			}
 
-					memoryChunk->size += sizeof(struct MemoryChunk) + nextMemoryChunk->size;
+			bool isLast = nextMemoryChunk == NULL || (isAvailable(nextMemoryChunk) && nextMemoryChunk == lastMemoryChunk);
+			if (availableSize < size && isLast) {
+				/* The new memory is merged with the next chunk (or becomes the next chunk). */
+				nextMemoryChunk = extendHeap(size - availableSize);
+				if (nextMemoryChunk == NULL) {
+					return NULL;
 				}
+				availableSize = memoryChunk->size + sizeof(struct MemoryChunk) + nextMemoryChunk->size;
+			}
 
-				updateChecksum(memoryChunk);
+			if (availableSize >= size) {
+				assert(nextMemoryChunk == getNext(memoryChunk) && isAvailable(nextMemoryChunk));
+				removeFromBin(nextMemoryChunk);
+				changeSize(memoryChunk, availableSize);
+				split(memoryChunk, size);
 				return pointer;
 
 			} else {
@@ -402,80 +426,119 @@ void* simpleMemoryAllocatorResize(void* pointer, size_t size) {
 					return NULL;
 				}
 			}
-
-			return NULL;
-
-		} else {
-			return pointer;
 		}
 	}
 }
 
 bool simpleMemoryAllocatorIsInternalStateValid(void) {
 	bool isValid = true;
-	struct MemoryChunk* memoryChunk = (void*) doubleLinkedListFirst(&memoryChunkList);
-
-	while (memoryChunk != NULL) {
-		#ifndef NDEBUG
-			if (!doesChecksumMatchs(memoryChunk)) {
+	int availableMemoryChunkCount = 0;
+
+	if (heapBegin != NULL) {
+		struct MemoryChunk* previousMemoryChunk = NULL;
+		struct MemoryChunk* memoryChunk = heapBegin;
+		while (isValid && ((void*) memoryChunk) < heapEnd) {
+			#ifndef NDEBUG
+				if (!doesChecksumMatchs(memoryChunk)) {
+					isValid = false;
+				}
+			#endif
+			if (memoryChunk->size < MIN_CHUNK_SIZE || memoryChunk->size % ALIGNMENT != 0 || getData(memoryChunk) + memoryChunk->size > heapEnd) {
+				isValid = false;
+			}
+			if (previousMemoryChunk != NULL && (memoryChunk->previousChunkSize != previousMemoryChunk->size
+					|| (isAvailable(memoryChunk) && isAvailable(previousMemoryChunk)))) {
 				isValid = false;
 			}
-		#endif
+			if (isAvailable(memoryChunk)) {
+				availableMemoryChunkCount++;
+			}
+
+			previousMemoryChunk = memoryChunk;
+			memoryChunk = getData(memoryChunk) + memoryChunk->size;
+		}
+
+		if (previousMemoryChunk != lastMemoryChunk) {
+			isValid = false;
+		}
+	}
+
+	for (int i = 0; isValid && i < BIN_COUNT; i++) {
+		bool isBinEmpty = doubleLinkedListSize(&bins[i]) == 0;
+		if (isBinEmpty != ((nonEmptyBinsBitmap[i / 32] & (1u << (i % 32))) == 0)) {
+			isValid = false;
+		}
 
-		memoryChunk = (void*) memoryChunk->listElement.next;
+		struct DoubleLinkedListElement* listElement = doubleLinkedListFirst(&bins[i]);
+		while (listElement != NULL) {
+			struct MemoryChunk* memoryChunk = getMemoryChunkFromBinListElement(listElement);
+			if (!isAvailable(memoryChunk) || calculateBinIndex(memoryChunk->size) != i) {
+				isValid = false;
+			}
+			availableMemoryChunkCount--;
+			listElement = listElement->next;
+		}
 	}
 
-	return isValid;
+	return isValid && availableMemoryChunkCount == 0;
 }
 
 static void printMemoryChunk(struct MemoryChunk* memoryChunk, int (*printer)(const char* format, ...)) {
 	printer("  memoryChunk=%p\n", memoryChunk);
-	printer("  previousMemoryChunk=%p\n", memoryChunk->listElement.previous);
-	printer("  nextMemoryChunk=%p\n", memoryChunk->listElement.next);
+	printer("  previousMemoryChunk=%p\n", getPrevious(memoryChunk));
+	printer("  nextMemoryChunk=%p\n", getNext(memoryChunk));
 
 	if (isAvailable(memoryChunk)) {
-		printer("  previousAvailableMemoryChunk=%p\n", memoryChunk->availableListElement.previous);
-		printer("  nextAvailableMemoryChunk=%p\n", memoryChunk->availableListElement.next);
+		printer("  binIndex=%d\n", calculateBinIndex(memoryChunk->size));
+		printer("  previousAvailableMemoryChunk=%p\n", getMemoryChunkFromBinListElement(getBinListElement(memoryChunk)->previous));
+		printer("  nextAvailableMemoryChunk=%p\n", getMemoryChunkFromBinListElement(getBinListElement(memoryChunk)->next));
 	}
 
+	printer("  previousChunkSize=%u\n", memoryChunk->previousChunkSize);
 	printer("  size=%u\n", memoryChunk->size);
 	printer("  flags=%.4X\n", memoryChunk->flags);
 	printer("  checksum=%.4X\n", memoryChunk->checksum);
 	#ifndef NDEBUG
 		printer("  expected checksum=%.4X\n", calculateChecksum(memoryChunk));
 	#endif
-	printer("  data=%p\n", ((void*) memoryChunk) + sizeof(struct MemoryChunk));
+	printer("  data=%p\n", getData(memoryChunk));
 	printer("\n");
 }
 
 void simpleMemoryAllocatorPrintStatus(int (*printer)(const char* format, ...)) {
 	uint32_t totalSize = 0;
-	
-	printf("memoryChunkList:\n");
 
-	struct MemoryChunk* memoryChunk = (void*) doubleLinkedListFirst(&memoryChunkList);
-	printer("  firstMemoryChunk=%p\n", memoryChunk);
+	printer("memoryChunks:\n");
+
+	printer("  firstMemoryChunk=%p\n", heapBegin);
 	printer("\n");
 
-	while (memoryChunk != NULL) {
+	struct MemoryChunk* memoryChunk = heapBegin;
+	while (heapBegin != NULL && ((void*) memoryChunk) < heapEnd) {
 		printMemoryChunk(memoryChunk, printer);
-		
+
 		totalSize += sizeof(struct MemoryChunk);
 		totalSize += memoryChunk->size;
-		memoryChunk = (void*) memoryChunk->listElement.next;
+		memoryChunk = getData(memoryChunk) + memoryChunk->size;
 	}
-	
-	printer("  lastMemoryChunk=%p\n", (void*) doubleLinkedListLast(&memoryChunkList));
+
+	printer("  lastMemoryChunk=%p\n", lastMemoryChunk);
 	printer("\n");
 
 	printer("  totalSize=%u\n", totalSize);
 
-	printf("availableMemoryChunkList:\n");
+	printer("bins:\n");
 
-	struct DoubleLinkedListElement* listElement = doubleLinkedListFirst(&availableMemoryChunkList);
-	while (listElement != NULL) {
-		printMemoryChunk(getMemoryChunkFromAvailableListElement(listElement), printer);
+	for (int i = 0; i < BIN_COUNT; i++) {
+		if (doubleLinkedListSize(&bins[i]) > 0) {
+			printer("  binIndex=%d count=%d\n", i, doubleLinkedListSize(&bins[i]));
+			printer("\n");
 
-		listElement = listElement->next;
+			struct DoubleLinkedListElement* listElement = doubleLinkedListFirst(&bins[i]);
+			while (listElement != NULL) {
+				printMemoryChunk(getMemoryChunkFromBinListElement(listElement), printer);
+				listElement = listElement->next;
+			}
+		}
 	}
 }